@@ -408,10 +408,59 @@ static eth_log_t* parse_logs(d_token_t* result) {
   return first;
 }
 
+typedef struct {
+  eth_logs_cb cb;
+  void*       data;
+} log_stream_t;
+
+static in3_ret_t stream_logs(void* data, d_token_t* result) {
+  log_stream_t* stream = data;
+  eth_log_t*    logs   = parse_logs(result);
+  return logs ? stream->cb(stream->data, logs) : IN3_OK;
+}
+
+/** fetches the logs and passes them to the callback chunk by chunk. */
+static in3_ret_t get_logs(in3_t* in3, char* fopt, uint64_t latest, eth_logs_cb cb, void* data) {
+  log_stream_t stream = {.cb = cb, .data = data};
+  char*        error  = NULL;
+  errno               = 0;
+  in3_ret_t res       = filter_get_logs(in3, fopt, latest, stream_logs, &stream, &error);
+  if (res != IN3_OK) set_error(ETIMEDOUT, error ? error : "call to eth_getLogs failed");
+  _free(error);
+  return res;
+}
+
+typedef struct {
+  eth_log_t* first;
+  eth_log_t* last;
+} log_chain_t;
+
+static in3_ret_t append_logs(void* data, eth_log_t* logs) {
+  log_chain_t* chain = data;
+  if (chain->last)
+    chain->last->next = logs;
+  else
+    chain->first = logs;
+  for (chain->last = logs; chain->last->next; chain->last = chain->last->next) {}
+  return IN3_OK;
+}
+
+static void free_logs(eth_log_t* log) {
+  for (eth_log_t* next; log; log = next) {
+    next = log->next;
+    log_free(log);
+  }
+}
+
+in3_ret_t eth_streamLogs(in3_t* in3, char* fopt, eth_logs_cb cb, void* data) {
+  return get_logs(in3, fopt, 0, cb, data);
+}
+
 eth_log_t* eth_getLogs(in3_t* in3, char* fopt) {
-  rpc_init;
-  sb_add_chars(params, fopt);
-  rpc_exec("eth_getLogs", eth_log_t*, parse_logs(result));
+  log_chain_t chain = {.first = NULL, .last = NULL};
+  if (get_logs(in3, fopt, 0, append_logs, &chain) == IN3_OK) return chain.first;
+  free_logs(chain.first);
+  return NULL;
 }
 
 static json_ctx_t* parse_call_result(call_request_t* req, d_token_t* result) {
@@ -544,6 +593,28 @@ bool eth_uninstallFilter(in3_t* in3, size_t id) {
   return filter_remove(in3, id);
 }
 
+in3_ret_t eth_streamFilterChanges(in3_t* in3, size_t id, eth_logs_cb cb, void* data) {
+  if (in3->filters == NULL)
+    return IN3_EFIND;
+  if (id == 0 || id > in3->filters->count)
+    return IN3_EINVAL;
+
+  in3_filter_t* f = in3->filters->array[id - 1];
+  if (!f)
+    return IN3_EFIND;
+  if (f->type != FILTER_EVENT)
+    return IN3_ENOTSUP;
+
+  uint64_t  blkno = eth_blockNumber(in3);
+  char*     fopt_ = filter_opt_set_fromBlock(f->options, f->last_block, !f->is_first_usage);
+  in3_ret_t res   = get_logs(in3, fopt_, blkno, cb, data);
+  _free(fopt_);
+  if (res != IN3_OK) return res;
+  f->last_block     = blkno + 1;
+  f->is_first_usage = false;
+  return IN3_OK;
+}
+
 in3_ret_t eth_getFilterChanges(in3_t* in3, size_t id, bytes32_t** block_hashes, eth_log_t** logs) {
   if (in3->filters == NULL)
     return IN3_EFIND;
@@ -554,27 +625,27 @@ in3_ret_t eth_getFilterChanges(in3_t* in3, size_t id, bytes32_t** block_hashes,
   if (!f)
     return IN3_EFIND;
 
-  uint64_t blkno = eth_blockNumber(in3);
   switch (f->type) {
     case FILTER_EVENT: {
-      char* fopt_ = filter_opt_set_fromBlock(f->options, f->last_block, !f->is_first_usage);
-      *logs       = eth_getLogs(in3, fopt_);
-      _free(fopt_);
-      f->last_block = blkno + 1;
-      f->is_first_usage = false;
+      log_chain_t chain = {.first = NULL, .last = NULL};
+      in3_ret_t   res   = eth_streamFilterChanges(in3, id, append_logs, &chain);
+      if (res != IN3_OK) {
+        free_logs(chain.first);
+        return res;
+      }
+      *logs = chain.first;
       return 0;
     }
-    case FILTER_BLOCK:
+    case FILTER_BLOCK: {
+      uint64_t blkno = eth_blockNumber(in3);
       if (blkno > f->last_block) {
         uint64_t blkcount = blkno - f->last_block;
         *block_hashes     = malloc(sizeof(bytes32_t) * blkcount);
-        for (uint64_t i = f->last_block + 1, j = 0; i <= blkno; i++, j++) {
-          eth_block_t* blk = eth_getBlockByNumber(in3, BLKNUM(i), false);
-          if (blk) {
-            memcpy((*block_hashes)[j], blk->hash, 32);
-            free(blk);
-          } else
-            return IN3_EFIND;
+        in3_ret_t res     = filter_get_block_hashes(in3, f->last_block + 1, blkno, *block_hashes, NULL);
+        if (res != IN3_OK) {
+          free(*block_hashes);
+          *block_hashes = NULL;
+          return res;
         }
         f->last_block = blkno;
         return (int) blkcount;
@@ -582,6 +653,7 @@ in3_ret_t eth_getFilterChanges(in3_t* in3, size_t id, bytes32_t** block_hashes,
         *block_hashes = NULL;
         return 0;
       }
+    }
     default:
       return IN3_ENOTSUP;
   }
@@ -122,6 +122,9 @@ typedef struct eth_log {
   struct eth_log* next;              /**< pointer to next log in list or NULL */
 } eth_log_t;
 
+/** receives the logs of one verified chunk in ascending block order. The logs belong to the callback and must be freed with log_free(). Returning an error stops fetching. */
+typedef in3_ret_t (*eth_logs_cb)(void* data, eth_log_t* logs);
+
 /** A transaction receipt */
 typedef struct eth_tx_receipt {
   bytes32_t  transaction_hash;    /**< the transaction hash */
@@ -163,6 +166,8 @@ in3_ret_t         eth_newBlockFilter(in3_t* in3);
 in3_ret_t         eth_newPendingTransactionFilter(in3_t* in3);                                             /**< Creates a new pending txn filter with specified options and returns its id on success or 0 on failure */
 bool              eth_uninstallFilter(in3_t* in3, size_t id);                                              /**< Uninstalls a filter and returns true on success or false on failure */
 in3_ret_t         eth_getFilterChanges(in3_t* in3, size_t id, bytes32_t** block_hashes, eth_log_t** logs); /**< Sets the logs (for event filter) or blockhashes (for block filter) that match a filter; returns <0 on error, otherwise no. of block hashes matched (for block filter) or 0 (for log filter) */
+in3_ret_t         eth_streamLogs(in3_t* in3, char* fopt, eth_logs_cb cb, void* data);                      /**< Passes the logs to the callback chunk by chunk, so large ranges are never held in memory at once. Returns <0 on error, check eth_last_error() */
+in3_ret_t         eth_streamFilterChanges(in3_t* in3, size_t id, eth_logs_cb cb, void* data);              /**< Passes the logs of an event filter to the callback chunk by chunk; returns <0 on error */
 in3_ret_t         eth_getFilterLogs(in3_t* in3, size_t id, eth_log_t** logs);                              /**< Sets the logs (for event filter) or blockhashes (for block filter) that match a filter; returns <0 on error, otherwise no. of block hashes matched (for block filter) or 0 (for log filter) */
 uint64_t          eth_chainId(in3_t* in3);                                                                 /**< Returns the currently configured chain id */
 uint64_t          eth_getBlockTransactionCountByHash(in3_t* in3, bytes32_t hash);                          /**< Returns the number of transactions in a block from a block matching the given block hash. */
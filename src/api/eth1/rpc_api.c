@@ -187,7 +187,7 @@ static in3_ret_t in3_cacheClear(in3_ctx_t* ctx, in3_response_t** response) {
 }
 
 static in3_ret_t eth_handle_intern(in3_ctx_t* ctx, in3_response_t** response) {
-  if (ctx->len > 1) return IN3_ENOTSUP; // internal handling is only possible for single requests (at least for now)
+  if (ctx->len > 1) return IN3_OK; // internal handling is only possible for single requests (at least for now), so batches are sent as they are
   d_token_t* r      = ctx->requests[0];
   char*      method = d_get_stringk(r, K_METHOD);
   d_token_t* params = d_get(r, K_PARAMS);
@@ -118,6 +118,7 @@ typedef struct in3_request_config {
   bytes_t*           signers;                /**< the addresses of servers requested to sign the blockhash */
   uint8_t            signers_length;         /**< number or addresses */
   uint32_t           time;                   /**< meassured time in ms for the request */
+  uint8_t            skip_signatures;        /**< set by internal callers before sending, if the result is verified through another request of the same context. */
 
 } in3_request_config_t;
 
@@ -216,26 +217,35 @@ typedef struct in3_whitelist {
 typedef struct in3_verified_hash {
   uint64_t  block_number; /**< the number of the block */
   bytes32_t hash;         /**< the blockhash */
+  bytes32_t parent_hash;  /**< the parentHash of the block, so its parent can be verified by hash only */
 } in3_verified_hash_t;
 
+/** a proof node, which was already hashed */
+typedef struct in3_cached_node {
+  bytes32_t hash; /**< the hash of the node */
+  bytes_t   data; /**< a copy of the rlp-encoded node */
+} in3_cached_node_t;
+
 /**
  * Chain definition inside incubed.
  * 
  * for incubed a chain can be any distributed network or database with incubed support.
  */
 typedef struct in3_chain {
-  chain_id_t           chain_id;        /**< chain_id, which could be a free or based on the public ethereum networkId*/
-  in3_chain_type_t     type;            /**< chaintype */
-  uint64_t             last_block;      /**< last blocknumber the nodeList was updated, which is used to detect changed in the nodelist*/
-  int                  nodelist_length; /**< number of nodes in the nodeList */
-  in3_node_t*          nodelist;        /**< array of nodes */
-  in3_node_weight_t*   weights;         /**< stats and weights recorded for each node */
-  bytes_t**            init_addresses;  /**< array of addresses of nodes that should always part of the nodeList */
-  bytes_t*             contract;        /**< the address of the registry contract */
-  bytes32_t            registry_id;     /**< the identifier of the registry */
-  uint8_t              version;         /**< version of the chain */
-  in3_verified_hash_t* verified_hashes; /**< contains the list of already verified blockhashes */
-  in3_whitelist_t*     whitelist;       /**< if set the whitelist of the addresses. */
+  chain_id_t           chain_id;         /**< chain_id, which could be a free or based on the public ethereum networkId*/
+  in3_chain_type_t     type;             /**< chaintype */
+  uint64_t             last_block;       /**< last blocknumber the nodeList was updated, which is used to detect changed in the nodelist*/
+  int                  nodelist_length;  /**< number of nodes in the nodeList */
+  in3_node_t*          nodelist;         /**< array of nodes */
+  in3_node_weight_t*   weights;          /**< stats and weights recorded for each node */
+  bytes_t**            init_addresses;   /**< array of addresses of nodes that should always part of the nodeList */
+  bytes_t*             contract;         /**< the address of the registry contract */
+  bytes32_t            registry_id;      /**< the identifier of the registry */
+  uint8_t              version;          /**< version of the chain */
+  in3_verified_hash_t* verified_hashes;  /**< contains the list of already verified blockheaders */
+  in3_cached_node_t*   cached_nodes;     /**< already hashed nodes of account- and storage-proofs */
+  uint_fast16_t        cached_nodes_len; /**< number of entries allocated for cached_nodes */
+  in3_whitelist_t*     whitelist;        /**< if set the whitelist of the addresses. */
   struct {
     address_t node;           /**< node that reported the last_block which necessitated a nodeList update */
     uint64_t  exp_last_block; /**< the last_block when the nodelist last changed reported by this node */
@@ -424,6 +434,12 @@ typedef struct in3_t_ {
   /** max number of verified hashes to cache */
   uint_fast16_t max_verified_hashes;
 
+  /** max number of hashed proof nodes to cache, which lets proofs against the same block skip hashing the shared nodes. (0 = disabled) */
+  uint_fast16_t max_cached_nodes;
+
+  /** max number of threads used to verify independent parts of a response (only used if build with THREADS) */
+  uint8_t max_threads;
+
   /** specifies the number of milliseconds before the request times out. increasing may be helpful if the device uses a slow connection. */
   uint32_t timeout;
 
@@ -108,6 +108,8 @@ IN3_EXPORT_TEST void initChain(in3_chain_t* chain, chain_id_t chain_id, char* co
   chain->init_addresses       = NULL;
   chain->last_block           = 0;
   chain->verified_hashes      = NULL;
+  chain->cached_nodes         = NULL;
+  chain->cached_nodes_len     = 0;
   chain->contract             = hex_to_new_bytes(contract, 40);
   chain->nodelist             = _malloc(sizeof(in3_node_t) * boot_node_count);
   chain->nodelist_length      = boot_node_count;
@@ -208,6 +210,8 @@ static in3_ret_t in3_client_init(in3_t* c, chain_id_t chain_id) {
   c->max_block_cache      = 0;
   c->max_code_cache       = 0;
   c->max_verified_hashes  = 5;
+  c->max_cached_nodes     = 64;
+  c->max_threads          = 4;
   c->min_deposit          = 0;
   c->node_limit           = 0;
   c->proof                = PROOF_STANDARD;
@@ -271,6 +275,8 @@ in3_ret_t in3_client_register_chain(in3_t* c, chain_id_t chain_id, in3_chain_typ
     chain->last_block           = 0;
     chain->nodelist_upd8_params = _calloc(1, sizeof(*(chain->nodelist_upd8_params)));
     chain->verified_hashes      = NULL;
+    chain->cached_nodes         = NULL;
+    chain->cached_nodes_len     = 0;
     c->chains_length++;
 
   } else {
@@ -385,6 +391,12 @@ void in3_free(in3_t* a) {
   int i;
   for (i = 0; i < a->chains_length; i++) {
     if (a->chains[i].verified_hashes) _free(a->chains[i].verified_hashes);
+    if (a->chains[i].cached_nodes) {
+      for (uint_fast16_t n = 0; n < a->chains[i].cached_nodes_len; n++) {
+        if (a->chains[i].cached_nodes[n].data.data) _free(a->chains[i].cached_nodes[n].data.data);
+      }
+      _free(a->chains[i].cached_nodes);
+    }
     in3_nodelist_clear(a->chains + i);
     b_free(a->chains[i].contract);
     whitelist_free(a->chains[i].whitelist);
@@ -106,7 +106,8 @@ static void free_ctx_intern(in3_ctx_t* ctx, bool is_sub) {
 }
 
 static in3_ret_t configure_request(in3_ctx_t* ctx, in3_request_config_t* conf, d_token_t* request, in3_chain_t* chain) {
-  const in3_t* c = ctx->client;
+  const in3_t* c               = ctx->client;
+  const int    signature_count = conf->skip_signatures ? 0 : c->signature_count;
 
   conf->chain_id     = c->chain_id;
   conf->finality     = c->finality;
@@ -117,12 +118,12 @@ static in3_ret_t configure_request(in3_ctx_t* ctx, in3_request_config_t* conf, d
     conf->use_full_proof = c->proof == PROOF_FULL;
     conf->verification   = VERIFICATION_PROOF;
 
-    if (c->signature_count) {
+    if (signature_count) {
       node_match_t*     signer_nodes = NULL;
       in3_node_filter_t filter       = NODE_FILTER_INIT;
       filter.nodes                   = d_get(d_get(ctx->requests[0], K_IN3), key("signer_nodes"));
       filter.props                   = c->node_props | NODE_PROP_SIGNER;
-      const in3_ret_t res            = in3_node_list_pick_nodes(ctx, &signer_nodes, c->signature_count, filter);
+      const in3_ret_t res            = in3_node_list_pick_nodes(ctx, &signer_nodes, signature_count, filter);
       if (res < 0)
         return ctx_set_error(ctx, "Could not find any nodes for requesting signatures", res);
       const int node_count  = ctx_nodes_len(signer_nodes);
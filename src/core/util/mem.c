@@ -147,9 +147,21 @@ static size_t   max_mem     = 0;
 static size_t   max_cnt     = 0;
 static int      track_count = -1;
 
+#ifdef IN3_THREADS
+#include <pthread.h>
+// tasks may allocate memory from different threads, so the tracker needs a lock.
+static pthread_mutex_t mem_lock = PTHREAD_MUTEX_INITIALIZER;
+#define MEM_LOCK() pthread_mutex_lock(&mem_lock)
+#define MEM_UNLOCK() pthread_mutex_unlock(&mem_lock)
+#else
+#define MEM_LOCK()
+#define MEM_UNLOCK()
+#endif
+
 void* t_malloc(size_t size, char* file, const char* func, int line) {
   void*    ptr = _malloc_(size, file, func, line);
   mem_p_t* t   = _malloc_(sizeof(mem_p_t), file, func, line);
+  MEM_LOCK();
   t->next      = mem_tracker;
   t->ptr       = ptr;
   t->size      = size;
@@ -164,6 +176,7 @@ void* t_malloc(size_t size, char* file, const char* func, int line) {
     //    printf("new max allocated memory %zu bytes ( + %zu bytes ) in %s : %s : %i\n", c_mem, size, file, func, line);
     max_cnt = mem_count;
   }
+  MEM_UNLOCK();
   return ptr;
 }
 
@@ -199,6 +212,7 @@ void t_free(void* ptr, char* file, const char* func, int line) {
   //  if (ptr == NULL)
   //    printf("trying to free a null-pointer in %s : %s : %i\n", file, func, line);
 
+  MEM_LOCK();
   mem_p_t *t = mem_tracker, *prev = NULL;
   while (t) {
     if (ptr == t->ptr) {
@@ -210,6 +224,7 @@ void t_free(void* ptr, char* file, const char* func, int line) {
       else
         prev->next = t->next;
 
+      MEM_UNLOCK();
       _free_(t);
       return;
     }
@@ -217,6 +232,7 @@ void t_free(void* ptr, char* file, const char* func, int line) {
     t    = t->next;
   }
 
+  MEM_UNLOCK();
   //  printf("freeing a pointer which was not allocated anymore %s : %s : %i\n", file, func, line);
   _free_(ptr);
 }
@@ -224,6 +240,7 @@ void* t_realloc(void* ptr, size_t size, size_t oldsize, char* file, const char*
   if (ptr == NULL)
     printf("trying to free a null-pointer in %s : %s : %i\n", file, func, line);
 
+  MEM_LOCK();
   mem_p_t* t = mem_tracker;
   while (t) {
     if (ptr == t->ptr) {
@@ -234,10 +251,13 @@ void* t_realloc(void* ptr, size_t size, size_t oldsize, char* file, const char*
       }
       t->ptr  = _realloc_(ptr, size, oldsize, file, func, line);
       t->size = size;
-      return t->ptr;
+      ptr     = t->ptr;
+      MEM_UNLOCK();
+      return ptr;
     }
     t = t->next;
   }
+  MEM_UNLOCK();
   printf("realloc a pointer which was not allocated anymore %s : %s : %i\n", file, func, line);
   return _realloc_(ptr, size, oldsize, file, func, line);
 }
@@ -0,0 +1,86 @@
+/*******************************************************************************
+ * This file is part of the Incubed project.
+ * Sources: https://github.com/slockit/in3-c
+ * 
+ * Copyright (C) 2018-2019 slock.it GmbH, Blockchains LLC
+ * 
+ * 
+ * COMMERCIAL LICENSE USAGE
+ * 
+ * Licensees holding a valid commercial license may use this file in accordance 
+ * with the commercial license agreement provided with the Software or, alternatively, 
+ * in accordance with the terms contained in a written agreement between you and 
+ * slock.it GmbH/Blockchains LLC. For licensing terms and conditions or further 
+ * information please contact slock.it at in3@slock.it.
+ * 	
+ * Alternatively, this file may be used under the AGPL license as follows:
+ *    
+ * AGPL LICENSE USAGE
+ * 
+ * This program is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Affero General Public License as published by the Free Software 
+ * Foundation, either version 3 of the License, or (at your option) any later version.
+ *  
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY 
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A 
+ * PARTICULAR PURPOSE. See the GNU Affero General Public License for more details.
+ * [Permissions of this strong copyleft license are conditioned on making available 
+ * complete source code of licensed works and modifications, which include larger 
+ * works using a licensed work, under the same license. Copyright and license notices 
+ * must be preserved. Contributors provide an express grant of patent rights.]
+ * You should have received a copy of the GNU Affero General Public License along 
+ * with this program. If not, see <https://www.gnu.org/licenses/>.
+ *******************************************************************************/
+
+#include "parallel.h"
+#ifdef IN3_THREADS
+#include <pthread.h>
+
+/** max number of threads per call */
+#define MAX_THREADS 64
+
+typedef struct {
+  in3_task_t      task;
+  void*           data;
+  int             n;
+  int             chunk; /**< number of indexes a thread takes at once */
+  int             next;  /**< the next index to hand out */
+  pthread_mutex_t lock;
+} task_queue_t;
+
+static void* run_queue(void* arg) {
+  task_queue_t* q = arg;
+  for (;;) {
+    pthread_mutex_lock(&q->lock);
+    int start = q->next;
+    q->next += q->chunk;
+    pthread_mutex_unlock(&q->lock);
+    if (start >= q->n) return NULL;
+    for (int i = start; i < q->n && i < start + q->chunk; i++) q->task(q->data, i);
+  }
+}
+#endif
+
+void in3_run_tasks(in3_task_t task, void* data, int n, int max_threads) {
+#ifdef IN3_THREADS
+  int threads = n < max_threads ? n : max_threads;
+  if (threads > MAX_THREADS) threads = MAX_THREADS;
+  if (threads > 1) {
+    // small chunks keep the threads busy even if the tasks take different time.
+    int          chunk = n / (threads * 4);
+    task_queue_t q     = {.task = task, .data = data, .n = n, .chunk = chunk ? chunk : 1, .next = 0};
+    pthread_t    workers[MAX_THREADS - 1];
+    int          started = 0;
+    pthread_mutex_init(&q.lock, NULL);
+    // if a thread can not be created, the remaining threads simply take more tasks.
+    while (started < threads - 1 && pthread_create(workers + started, NULL, run_queue, &q) == 0) started++;
+    run_queue(&q);
+    while (started) pthread_join(workers[--started], NULL);
+    pthread_mutex_destroy(&q.lock);
+    return;
+  }
+#else
+  (void) max_threads;
+#endif
+  for (int i = 0; i < n; i++) task(data, i);
+}
@@ -0,0 +1,59 @@
+/*******************************************************************************
+ * This file is part of the Incubed project.
+ * Sources: https://github.com/slockit/in3-c
+ * 
+ * Copyright (C) 2018-2019 slock.it GmbH, Blockchains LLC
+ * 
+ * 
+ * COMMERCIAL LICENSE USAGE
+ * 
+ * Licensees holding a valid commercial license may use this file in accordance 
+ * with the commercial license agreement provided with the Software or, alternatively, 
+ * in accordance with the terms contained in a written agreement between you and 
+ * slock.it GmbH/Blockchains LLC. For licensing terms and conditions or further 
+ * information please contact slock.it at in3@slock.it.
+ * 	
+ * Alternatively, this file may be used under the AGPL license as follows:
+ *    
+ * AGPL LICENSE USAGE
+ * 
+ * This program is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Affero General Public License as published by the Free Software 
+ * Foundation, either version 3 of the License, or (at your option) any later version.
+ *  
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY 
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A 
+ * PARTICULAR PURPOSE. See the GNU Affero General Public License for more details.
+ * [Permissions of this strong copyleft license are conditioned on making available 
+ * complete source code of licensed works and modifications, which include larger 
+ * works using a licensed work, under the same license. Copyright and license notices 
+ * must be preserved. Contributors provide an express grant of patent rights.]
+ * You should have received a copy of the GNU Affero General Public License along 
+ * with this program. If not, see <https://www.gnu.org/licenses/>.
+ *******************************************************************************/
+
+/** @file
+ * runs independent tasks on multiple threads.
+ * 
+ * Threads are only used if the library was build with `-DTHREADS=true`, otherwise all tasks run in the calling thread.
+ * */
+
+#ifndef IN3_PARALLEL_H
+#define IN3_PARALLEL_H
+
+/**
+ * a task, which is called for each index.
+ * 
+ * Tasks run concurrently, so they may only write to data owned by their index and must not report errors through the context.
+ */
+typedef void (*in3_task_t)(void* data, int index);
+
+/**
+ * runs the task for all indexes from 0 to n-1 and returns after all tasks are finished.
+ * 
+ * The indexes are handed out in chunks to up to `max_threads` threads (including the calling thread).
+ * If `max_threads` is less than 2 or threads are not supported, the tasks run in order in the calling thread.
+ */
+void in3_run_tasks(in3_task_t task, void* data, int n, int max_threads);
+
+#endif
@@ -112,6 +112,9 @@ bytes_t* sha3(const bytes_t* data);
 /** writes 32 bytes to the pointer. */
 int sha3_to(bytes_t* data, void* dst);
 
+/** hashes n independent messages and writes 32 bytes for each of them to dst. */
+void sha3_many(bytes_t** data, int n, uint8_t* dst);
+
 /** converts a long to 8 bytes */
 void long_to_bytes(uint64_t val, uint8_t* dst);
 
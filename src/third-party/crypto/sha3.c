@@ -93,6 +93,119 @@ void sha3_512_Init(SHA3_CTX *ctx)
 	keccak_Init(ctx, 512);
 }
 
+#ifdef KECCAK_FAST
+/*
+ * Fully unrolled permutation, which keeps the state in local variables.
+ * It uses lane complementing: the lanes 1, 2, 8, 12, 17 and 20 are stored
+ * inverted during the permutation, which removes most of the NOT operations of chi.
+ */
+#define KECCAK_ROUND(A, E, rc) \
+	C0 = A##ba ^ A##ga ^ A##ka ^ A##ma ^ A##sa; \
+	C1 = A##be ^ A##ge ^ A##ke ^ A##me ^ A##se; \
+	C2 = A##bi ^ A##gi ^ A##ki ^ A##mi ^ A##si; \
+	C3 = A##bo ^ A##go ^ A##ko ^ A##mo ^ A##so; \
+	C4 = A##bu ^ A##gu ^ A##ku ^ A##mu ^ A##su; \
+	D0 = C4 ^ ROTL64(C1, 1); \
+	D1 = C0 ^ ROTL64(C2, 1); \
+	D2 = C1 ^ ROTL64(C3, 1); \
+	D3 = C2 ^ ROTL64(C4, 1); \
+	D4 = C3 ^ ROTL64(C0, 1); \
+	B0 = A##ba ^ D0; B1 = ROTL64(A##ge ^ D1, 44); B2 = ROTL64(A##ki ^ D2, 43); B3 = ROTL64(A##mo ^ D3, 21); B4 = ROTL64(A##su ^ D4, 14); \
+	E##ba = B0 ^ (B1 | B2) ^ (rc); \
+	E##be = B1 ^ (~B2 | B3); \
+	E##bi = B2 ^ (B3 & B4); \
+	E##bo = B3 ^ (B4 | B0); \
+	E##bu = B4 ^ (B0 & B1); \
+	B0 = ROTL64(A##bo ^ D3, 28); B1 = ROTL64(A##gu ^ D4, 20); B2 = ROTL64(A##ka ^ D0, 3); B3 = ROTL64(A##me ^ D1, 45); B4 = ROTL64(A##si ^ D2, 61); \
+	E##ga = B0 ^ (B1 | B2); \
+	E##ge = B1 ^ (B2 & B3); \
+	E##gi = B2 ^ (B3 | ~B4); \
+	E##go = B3 ^ (B4 | B0); \
+	E##gu = B4 ^ (B0 & B1); \
+	B0 = ROTL64(A##be ^ D1, 1); B1 = ROTL64(A##gi ^ D2, 6); B2 = ROTL64(A##ko ^ D3, 25); B3 = ROTL64(A##mu ^ D4, 8); B4 = ROTL64(A##sa ^ D0, 18); \
+	E##ka = B0 ^ (B1 | B2); \
+	E##ke = B1 ^ (B2 & B3); \
+	E##ki = B2 ^ (~B3 & B4); \
+	E##ko = ~B3 ^ (B4 | B0); \
+	E##ku = B4 ^ (B0 & B1); \
+	B0 = ROTL64(A##bu ^ D4, 27); B1 = ROTL64(A##ga ^ D0, 36); B2 = ROTL64(A##ke ^ D1, 10); B3 = ROTL64(A##mi ^ D2, 15); B4 = ROTL64(A##so ^ D3, 56); \
+	E##ma = B0 ^ (B1 & B2); \
+	E##me = B1 ^ (B2 | B3); \
+	E##mi = B2 ^ (~B3 | B4); \
+	E##mo = ~B3 ^ (B4 & B0); \
+	E##mu = B4 ^ (B0 | B1); \
+	B0 = ROTL64(A##bi ^ D2, 62); B1 = ROTL64(A##go ^ D3, 55); B2 = ROTL64(A##ku ^ D4, 39); B3 = ROTL64(A##ma ^ D0, 41); B4 = ROTL64(A##se ^ D1, 2); \
+	E##sa = B0 ^ (~B1 & B2); \
+	E##se = ~B1 ^ (B2 | B3); \
+	E##si = B2 ^ (B3 & B4); \
+	E##so = B3 ^ (B4 | B0); \
+	E##su = B4 ^ (B0 & B1);
+
+static void sha3_permutation(uint64_t *state)
+{
+	uint64_t Aba, Abe, Abi, Abo, Abu, Aga, Age, Agi, Ago, Agu, Aka, Ake, Aki, Ako, Aku, Ama, Ame, Ami, Amo, Amu, Asa, Ase, Asi, Aso, Asu;
+	uint64_t Eba, Ebe, Ebi, Ebo, Ebu, Ega, Ege, Egi, Ego, Egu, Eka, Eke, Eki, Eko, Eku, Ema, Eme, Emi, Emo, Emu, Esa, Ese, Esi, Eso, Esu;
+	uint64_t B0, B1, B2, B3, B4, C0, C1, C2, C3, C4, D0, D1, D2, D3, D4;
+	int round;
+
+	Aba = state[ 0];
+	Abe = ~state[ 1];
+	Abi = ~state[ 2];
+	Abo = state[ 3];
+	Abu = state[ 4];
+	Aga = state[ 5];
+	Age = state[ 6];
+	Agi = state[ 7];
+	Ago = ~state[ 8];
+	Agu = state[ 9];
+	Aka = state[10];
+	Ake = state[11];
+	Aki = ~state[12];
+	Ako = state[13];
+	Aku = state[14];
+	Ama = state[15];
+	Ame = state[16];
+	Ami = ~state[17];
+	Amo = state[18];
+	Amu = state[19];
+	Asa = ~state[20];
+	Ase = state[21];
+	Asi = state[22];
+	Aso = state[23];
+	Asu = state[24];
+
+	for (round = 0; round < NumberOfRounds; round += 2) {
+		KECCAK_ROUND(A, E, keccak_round_constants[round])
+		KECCAK_ROUND(E, A, keccak_round_constants[round + 1])
+	}
+
+	state[ 0] = Aba;
+	state[ 1] = ~Abe;
+	state[ 2] = ~Abi;
+	state[ 3] = Abo;
+	state[ 4] = Abu;
+	state[ 5] = Aga;
+	state[ 6] = Age;
+	state[ 7] = Agi;
+	state[ 8] = ~Ago;
+	state[ 9] = Agu;
+	state[10] = Aka;
+	state[11] = Ake;
+	state[12] = ~Aki;
+	state[13] = Ako;
+	state[14] = Aku;
+	state[15] = Ama;
+	state[16] = Ame;
+	state[17] = ~Ami;
+	state[18] = Amo;
+	state[19] = Amu;
+	state[20] = ~Asa;
+	state[21] = Ase;
+	state[22] = Asi;
+	state[23] = Aso;
+	state[24] = Asu;
+}
+#else
 /* Keccak theta() transformation */
 static void keccak_theta(uint64_t *A)
 {
@@ -204,6 +317,8 @@ static void sha3_permutation(uint64_t *state)
 	}
 }
 
+#endif /* KECCAK_FAST */
+
 /**
  * The core transformation. Process the specified block of data.
  *
@@ -363,6 +478,113 @@ void keccak_Final(SHA3_CTX *ctx, unsigned char* result)
 	memzero(ctx, sizeof(SHA3_CTX));
 }
 
+#if KECCAK_X4
+/* 4 keccak states, where each word holds the lanes of 4 independent messages */
+typedef uint64_t keccak_v4 __attribute__((vector_size(32)));
+
+static void keccak_permutation_x4(keccak_v4 *A)
+{
+	keccak_v4 B[25], C[5], D[5];
+	int round, x, y;
+	for (round = 0; round < NumberOfRounds; round++)
+	{
+		/* theta */
+		for (x = 0; x < 5; x++)
+			C[x] = A[x] ^ A[x + 5] ^ A[x + 10] ^ A[x + 15] ^ A[x + 20];
+		for (x = 0; x < 5; x++)
+			D[x] = ROTL64(C[(x + 1) % 5], 1) ^ C[(x + 4) % 5];
+
+		/* rho and pi */
+		B[ 0] = A[ 0] ^ D[0];
+		B[10] = ROTL64(A[ 1] ^ D[1],  1);
+		B[20] = ROTL64(A[ 2] ^ D[2], 62);
+		B[ 5] = ROTL64(A[ 3] ^ D[3], 28);
+		B[15] = ROTL64(A[ 4] ^ D[4], 27);
+		B[16] = ROTL64(A[ 5] ^ D[0], 36);
+		B[ 1] = ROTL64(A[ 6] ^ D[1], 44);
+		B[11] = ROTL64(A[ 7] ^ D[2],  6);
+		B[21] = ROTL64(A[ 8] ^ D[3], 55);
+		B[ 6] = ROTL64(A[ 9] ^ D[4], 20);
+		B[ 7] = ROTL64(A[10] ^ D[0],  3);
+		B[17] = ROTL64(A[11] ^ D[1], 10);
+		B[ 2] = ROTL64(A[12] ^ D[2], 43);
+		B[12] = ROTL64(A[13] ^ D[3], 25);
+		B[22] = ROTL64(A[14] ^ D[4], 39);
+		B[23] = ROTL64(A[15] ^ D[0], 41);
+		B[ 8] = ROTL64(A[16] ^ D[1], 45);
+		B[18] = ROTL64(A[17] ^ D[2], 15);
+		B[ 3] = ROTL64(A[18] ^ D[3], 21);
+		B[13] = ROTL64(A[19] ^ D[4],  8);
+		B[14] = ROTL64(A[20] ^ D[0], 18);
+		B[24] = ROTL64(A[21] ^ D[1],  2);
+		B[ 9] = ROTL64(A[22] ^ D[2], 61);
+		B[19] = ROTL64(A[23] ^ D[3], 56);
+		B[ 4] = ROTL64(A[24] ^ D[4], 14);
+
+		/* chi */
+		for (y = 0; y < 25; y += 5)
+			for (x = 0; x < 5; x++)
+				A[y + x] = B[y + x] ^ (~B[y + (x + 1) % 5] & B[y + (x + 2) % 5]);
+
+		/* iota */
+		A[0] ^= keccak_round_constants[round];
+	}
+}
+
+/**
+ * Calculates the keccak256 hashes of 4 messages at once.
+ * Messages of different length are processed in parallel until the last one is finished.
+ *
+ * @param data the messages (NULL if the length is 0)
+ * @param len the length of the messages
+ * @param digest the targets for the 32 byte hashes (NULL for unused lanes)
+ */
+void keccak_256_x4(const unsigned char* const data[4], const size_t len[4], unsigned char* const digest[4])
+{
+	const size_t block_size = SHA3_256_BLOCK_LENGTH;
+	uint64_t block[4][SHA3_256_BLOCK_LENGTH / 8];
+	size_t blocks[4], max = 0, b, rest;
+	keccak_v4 A[25];
+	int l, i;
+
+	memset(A, 0, sizeof(A));
+	for (l = 0; l < 4; l++) {
+		blocks[l] = len[l] / block_size + 1;
+		if (blocks[l] > max) max = blocks[l];
+	}
+
+	for (b = 0; b < max; b++) {
+		for (l = 0; l < 4; l++) {
+			if (b + 1 < blocks[l])
+				memcpy(block[l], data[l] + b * block_size, block_size);
+			else {
+				/* the last block with padding or an empty one for finished messages */
+				memset(block[l], 0, block_size);
+				if (b + 1 == blocks[l]) {
+					rest = len[l] - b * block_size;
+					if (rest) memcpy(block[l], data[l] + b * block_size, rest);
+					((char*)block[l])[rest] |= 0x01;
+					((char*)block[l])[block_size - 1] |= 0x80;
+				}
+			}
+		}
+		for (i = 0; i < SHA3_256_BLOCK_LENGTH / 8; i++) {
+			keccak_v4 v = {le2me_64(block[0][i]), le2me_64(block[1][i]), le2me_64(block[2][i]), le2me_64(block[3][i])};
+			A[i] ^= v;
+		}
+		keccak_permutation_x4(A);
+
+		for (l = 0; l < 4; l++) {
+			if (b + 1 != blocks[l] || !digest[l]) continue;
+			for (i = 0; i < 4; i++) {
+				uint64_t w = A[i][l];
+				me64_to_le_str(digest[l] + i * 8, &w, 8);
+			}
+		}
+	}
+}
+#endif /* KECCAK_X4 */
+
 void keccak_256(const unsigned char* data, size_t len, unsigned char* digest)
 {
 	SHA3_CTX ctx;
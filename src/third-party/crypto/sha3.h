@@ -78,6 +78,14 @@ void sha3_Final(SHA3_CTX *ctx, unsigned char* result);
 void keccak_Final(SHA3_CTX *ctx, unsigned char* result);
 void keccak_256(const unsigned char* data, size_t len, unsigned char* digest);
 void keccak_512(const unsigned char* data, size_t len, unsigned char* digest);
+
+/* hashing 4 messages in parallel requires vector extensions */
+#if defined(KECCAK_SIMD) && defined(__GNUC__)
+#define KECCAK_X4 1
+void keccak_256_x4(const unsigned char* const data[4], const size_t len[4], unsigned char* const digest[4]);
+#else
+#define KECCAK_X4 0
+#endif
 #endif
 
 void sha3_256(const unsigned char* data, size_t len, unsigned char* digest);
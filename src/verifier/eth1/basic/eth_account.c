@@ -51,11 +51,69 @@ static int      is_not_existened(d_token_t* account) {
   return ((t = d_get(account, K_BALANCE)) && d_type(t) == T_INTEGER && d_int(t) == 0 && (t = d_getl(account, K_CODE_HASH, 32)) && memcmp(t->data, EMPTY_HASH, 32) == 0 && d_get_longk(account, K_NONCE) == 0) && (t = d_getl(account, K_STORAGE_HASH, 32)) && memcmp(t->data, EMPTY_ROOT_HASH, 32) == 0;
 }
 
+/**
+ * checks whether the same value for the same path was already verified against the same root within this context.
+ * This happens when a batch contains multiple requests (like eth_call) for the same block, contracts and storage slots.
+ * For batches the cache_key is set to keccak(root + path + value).
+ */
+static bool is_proof_verified(in3_vctx_t* vc, bytes_t* root, uint8_t* path, bytes_t* value, uint8_t* cache_key) {
+  if (vc->ctx->len < 2) return false;
+  bytes_builder_t* bb = bb_newl(64 + value->len);
+  bb_write_raw_bytes(bb, root->data, root->len);
+  bb_write_raw_bytes(bb, path, 32);
+  bb_write_raw_bytes(bb, value->data, value->len);
+  sha3_to(&bb->b, cache_key);
+  bb_free(bb);
+
+  bytes_t key = bytes(cache_key, 32);
+  return in3_cache_get_entry(vc->ctx->cache, &key) != NULL;
+}
+
+/** marks the proof as verified, so other requests within the batch can skip it. */
+static void set_proof_verified(in3_vctx_t* vc, uint8_t* cache_key) {
+  if (vc->ctx->len < 2) return;
+  bytes_t key = bytes(_malloc(32), 32);
+  memcpy(key.data, cache_key, 32);
+  in3_cache_add_entry(&vc->ctx->cache, key, bytes(NULL, 0))->must_free = false;
+}
+
+/** reads the hashed key of a storage proof into path and its value as rlp-item (empty for 0) into bb. */
+static void read_storage_proof(d_token_t* p, uint8_t* path, bytes_builder_t* bb) {
+  bytes_t storage_key = {.data = path, .len = 32};
+  d_bytes_to(d_get(p, K_KEY), path, 32);
+  sha3_to(&storage_key, path);
+
+  bb->b.len = d_bytes_to(d_get(p, K_VALUE), bb->b.data, 32);
+  if (bb->b.len) {
+    // remove leading zeros!
+    uint8_t*     pp = bb->b.data;
+    uint_fast8_t l  = 32;
+    optimize_len(pp, l);
+    if (l == 0 || (l == 1 && *pp == 0))
+      bb->b.len = 0;
+    else {
+      if (pp != bb->b.data) memmove(bb->b.data, pp, l);
+      bb->b.len = l;
+      rlp_encode_to_item(bb);
+    }
+  }
+}
+
+/** returns the cache of already hashed proof nodes of the chain or NULL if disabled. */
+static in3_cached_node_t* get_node_cache(in3_vctx_t* vc) {
+  in3_chain_t* chain = vc->chain;
+  if (!chain->cached_nodes && vc->ctx->client->max_cached_nodes) {
+    chain->cached_nodes     = _calloc(vc->ctx->client->max_cached_nodes, sizeof(in3_cached_node_t));
+    chain->cached_nodes_len = vc->ctx->client->max_cached_nodes;
+  }
+  return chain->cached_nodes;
+}
+
 static in3_ret_t verify_proof(in3_vctx_t* vc, bytes_t* header, d_token_t* account) {
   d_token_t *     t, *storage_proof, *p;
   int             i;
-  uint8_t         hash[32], val[36];
-  bytes_t**       proof;
+  uint8_t         hash[32], val[36], cache_key[32];
+  d_token_t*      proof;
   bytes_t *       tmp, root, *account_raw, path = {.data = hash, .len = 32};
   bytes_builder_t bb = {.bsize = 36, .b = {.data = val, .len = 0}};
 
@@ -67,16 +125,21 @@ static in3_ret_t verify_proof(in3_vctx_t* vc, bytes_t* header, d_token_t* accoun
   else
     return vc_err(vc, "no address in the account");
 
-  proof = d_create_bytes_vec(d_get(account, K_ACCOUNT_PROOF));
-  if (!proof) return vc_err(vc, "no merkle proof for the account");
   account_raw = serialize_account(account);
+  if (!is_proof_verified(vc, &root, hash, account_raw, cache_key)) {
+    proof = d_get(account, K_ACCOUNT_PROOF);
+    if (!proof) {
+      b_free(account_raw);
+      return vc_err(vc, "no merkle proof for the account");
+    }
 
-  if (!trie_verify_proof(&root, &path, proof, is_not_existened(account) ? NULL : account_raw)) {
-    _free(proof);
-    b_free(account_raw);
-    return vc_err(vc, "invalid account proof");
+    in3_cached_node_t* cache = get_node_cache(vc);
+    if (!trie_verify_proof_cached(&root, &path, proof, is_not_existened(account) ? NULL : account_raw, cache, vc->chain->cached_nodes_len)) {
+      b_free(account_raw);
+      return vc_err(vc, "invalid account proof");
+    }
+    set_proof_verified(vc, cache_key);
   }
-  _free(proof);
   b_free(account_raw);
 
   // now we verify the storage proofs
@@ -90,48 +153,44 @@ static in3_ret_t verify_proof(in3_vctx_t* vc, bytes_t* header, d_token_t* accoun
   //                                "storageHash": "0x56e81f171bcc55a6ff8345e692c0f86e5b48e01b996cadc001622fb5e363b421",
   bool is_empty = memcmp(root.data, EMPTY_ROOT_HASH, 32) == 0;
 
-  for (i = 0, p = storage_proof + 1; i < d_len(storage_proof); i++, p = d_next(p)) {
-    d_token_t* pt = d_get(p, K_PROOF);
-    bb.b.len      = d_bytes_to(d_get(p, K_VALUE), val, 32);
+  // all storage proofs share the upper nodes of the storage trie, so we hash each node only once.
+  // slots already verified by another request of the batch are skipped.
+  in3_cached_node_t* cache = get_node_cache(vc);
+  trie_multiproof_t  mp    = {.cache = cache, .cache_size = vc->chain->cached_nodes_len};
+  in3_ret_t          res   = IN3_OK;
+  if (!is_empty) {
+    for (i = 0, p = storage_proof + 1; i < d_len(storage_proof); i++, p = d_next(p)) {
+      read_storage_proof(p, hash, &bb);
+      if (is_proof_verified(vc, &root, hash, &bb.b, cache_key)) continue;
+      if (!trie_multiproof_add(&mp, d_get(p, K_PROOF))) {
+        trie_multiproof_free(&mp);
+        return vc_err(vc, "no merkle proof for the storage");
+      }
+    }
+  }
+
+  for (i = 0, p = storage_proof + 1; i < d_len(storage_proof) && res == IN3_OK; i++, p = d_next(p)) {
     if (is_empty) {
-      uint8_t* vp = val;
+      d_token_t* pt = d_get(p, K_PROOF);
+      bb.b.len      = d_bytes_to(d_get(p, K_VALUE), val, 32);
+      uint8_t* vp   = val;
       optimize_len(vp, bb.b.len);
       if (bb.b.len > 1 || (bb.b.len == 1 && *vp))
         return vc_err(vc, "empty storagehash, so we exepct 0 values");
       if (d_type(pt) != T_ARRAY || d_len(pt) != 1 || d_type(pt + 1) != T_INTEGER || d_int(pt + 1) != 0x80)
         return vc_err(vc, "invalid proof");
     } else {
-
-      d_bytes_to(d_get(p, K_KEY), hash, 32);
-      sha3_to(&path, hash);
-
-      proof = d_create_bytes_vec(pt);
-      if (!proof) return vc_err(vc, "no merkle proof for the storage");
-
-      // rlp encode the value.
-      if (bb.b.len) {
-        // remove leading zeros!
-        uint8_t*     pp = bb.b.data;
-        uint_fast8_t l  = 32;
-        optimize_len(pp, l);
-        if (l == 0 || (l == 1 && *pp == 0))
-          bb.b.len = 0;
-        else {
-          if (pp != bb.b.data) memmove(bb.b.data, pp, l);
-          bb.b.len = l;
-          rlp_encode_to_item(&bb);
-        }
-      }
-
-      if (!trie_verify_proof(&root, &path, proof, bb.b.len ? &bb.b : NULL)) {
-        _free(proof);
-        return vc_err(vc, "invalid storage proof");
-      }
-      _free(proof);
+      read_storage_proof(p, hash, &bb);
+      if (is_proof_verified(vc, &root, hash, &bb.b, cache_key)) continue;
+      if (!trie_multiproof_verify(&mp, &root, &path, bb.b.len ? &bb.b : NULL))
+        res = vc_err(vc, "invalid storage proof");
+      else
+        set_proof_verified(vc, cache_key);
     }
   }
 
-  return IN3_OK;
+  trie_multiproof_free(&mp);
+  return res;
 }
 
 in3_ret_t eth_verify_account_proof(in3_vctx_t* vc) {
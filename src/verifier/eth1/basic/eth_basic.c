@@ -110,7 +110,7 @@ in3_ret_t in3_verify_eth_basic(in3_vctx_t* vc) {
 }
 
 in3_ret_t eth_handle_intern(in3_ctx_t* ctx, in3_response_t** response) {
-  if (ctx->len > 1) return IN3_ENOTSUP; // internal handling is only possible for single requests (at least for now)
+  if (ctx->len > 1) return IN3_OK; // internal handling is only possible for single requests (at least for now), so batches are sent as they are
   d_token_t* req = ctx->requests[0];
 
   // check method
@@ -48,6 +48,12 @@ in3_ret_t in3_verify_eth_basic(in3_vctx_t* v);
  * verifies internal tx-values.
  */
 in3_ret_t eth_verify_tx_values(in3_vctx_t* vc, d_token_t* tx, bytes_t* raw);
+/**
+ * checks the internal tx-values without reporting to the context, so it can run in parallel for different transactions.
+ * 
+ * returns NULL if the values are valid or the error message.
+ */
+char* eth_check_tx_values(d_token_t* tx, bytes_t* raw);
 
 /**
  * verifies a transaction.
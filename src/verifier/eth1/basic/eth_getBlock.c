@@ -36,6 +36,7 @@
 #include "../../../core/client/keys.h"
 #include "../../../core/util/data.h"
 #include "../../../core/util/mem.h"
+#include "../../../core/util/parallel.h"
 #include "../../../verifier/eth1/nano/eth_nano.h"
 #include "../../../verifier/eth1/nano/merkle.h"
 #include "../../../verifier/eth1/nano/rlp.h"
@@ -44,6 +45,20 @@
 #include "trie.h"
 #include <string.h>
 
+/** the transactions of a block, which are hashed and checked in parallel. */
+typedef struct {
+  trie_kv_t*  items;  /**< the path and the serialized transaction */
+  d_token_t** tokens; /**< the transaction-object or NULL if only the raw transaction is known */
+  char**      errors; /**< the result of checking the tx-values */
+  bytes32_t*  hashes; /**< the transaction hashes */
+} block_txs_t;
+
+static void check_tx(void* data, int i) {
+  block_txs_t* txs = data;
+  sha3_to(&txs->items[i].value, txs->hashes[i]);
+  txs->errors[i] = txs->tokens[i] ? eth_check_tx_values(txs->tokens[i], &txs->items[i].value) : NULL;
+}
+
 static in3_ret_t eth_verify_uncles(in3_vctx_t* vc, bytes32_t uncle_hash, d_token_t* uncles_headers, d_token_t* uncle_hashes) {
   if (!uncles_headers || !uncle_hashes || d_len(uncles_headers) != d_len(uncle_hashes) || d_type(uncles_headers) != d_type(uncle_hashes) || d_type(uncle_hashes) != T_ARRAY)
     return vc_err(vc, "invalid uncles proofs");
@@ -117,16 +132,36 @@ in3_ret_t eth_verify_eth_getBlock(in3_vctx_t* vc, bytes_t* block_hash, uint64_t
     if (!include_full_tx && (!tx_hashs || d_len(transactions) != d_len(tx_hashs)))
       return vc_err(vc, "no transactionhashes found!");
 
-    trie_t* trie = trie_new();
-    for (i = 0, t = transactions + 1; i < d_len(transactions); i++, t = d_next(t)) {
-      bool     is_raw_tx = d_type(t) == T_BYTES;
-      bytes_t* path      = create_tx_path(i);
-      bytes_t* tx        = is_raw_tx ? d_bytes(t) : serialize_tx(t);
-      bytes_t* h         = (full_proof || !include_full_tx) ? sha3(tx) : NULL;
+    // serialize all transactions into one buffer first, so the signatures can be checked in parallel and the trie can be built at once.
+    int              n   = d_len(transactions);
+    block_txs_t      txs = {.items = _malloc(n * (sizeof(trie_kv_t) + 2 * sizeof(void*) + sizeof(bytes32_t) + sizeof(uint32_t) + 5) + 1)};
+    bytes_builder_t* raw = bb_newl(n * 128 + 1);
+    bytes32_t        root;
+    txs.tokens        = (d_token_t**) (txs.items + n);
+    txs.errors        = (char**) (txs.tokens + n);
+    txs.hashes        = (bytes32_t*) (txs.errors + n);
+    uint32_t* offsets = (uint32_t*) (txs.hashes + n);
+    uint8_t*  paths   = (uint8_t*) (offsets + n);
+    for (i = 0, t = transactions + 1; i < n; i++, t = d_next(t)) {
+      bool is_raw_tx     = d_type(t) == T_BYTES;
+      offsets[i]         = is_raw_tx ? UINT32_MAX : raw->b.len;
+      txs.tokens[i]      = is_raw_tx ? NULL : t;
+      txs.items[i].key   = create_tx_path_to(i, paths + i * 5);
+      txs.items[i].value = is_raw_tx ? *d_bytes(t) : bytes(NULL, serialize_tx_to(t, raw));
+    }
+
+    // the buffer may have moved while growing, so we point to the final location.
+    for (i = 0; i < n; i++) {
+      if (offsets[i] != UINT32_MAX) txs.items[i].value.data = raw->b.data + offsets[i];
+    }
+    in3_run_tasks(check_tx, &txs, n, vc->ctx->client->max_threads);
 
-      if (!is_raw_tx) {
-        if (eth_verify_tx_values(vc, t, tx))
+    for (i = 0, t = transactions + 1; i < n; i++, t = d_next(t)) {
+      if (txs.tokens[i]) {
+        if (txs.errors[i]) {
+          vc_err(vc, txs.errors[i]);
           res = IN3_EUNKNOWN;
+        }
 
         if ((t2 = d_getl(t, K_BLOCK_HASH, 32)) && !b_cmp(d_bytes(t2), bhash))
           res = vc_err(vc, "Wrong Blockhash in tx");
@@ -138,24 +173,22 @@ in3_ret_t eth_verify_eth_getBlock(in3_vctx_t* vc, bytes_t* block_hash, uint64_t
           res = vc_err(vc, "Wrong Transaction index in tx");
       }
 
-      if (h && txh) {
-        if (!b_cmp(d_bytes(txh), h))
+      if ((full_proof || !include_full_tx) && txh) {
+        bytes_t h = bytes(txs.hashes[i], 32);
+        if (!b_cmp(d_bytes(txh), &h))
           res = vc_err(vc, "Wrong Transactionhash");
         txh = d_next(txh);
       }
-      trie_set_value(trie, path, tx);
-      if (!is_raw_tx) b_free(tx);
-      b_free(path);
-      if (h) b_free(h);
     }
+    trie_build_root(txs.items, n, root);
+    bb_free(raw);
+    _free(txs.items);
 
     bytes_t t_root = d_to_bytes(d_getl(vc->result, K_TRANSACTIONS_ROOT, 32));
 
-    if (t_root.len != 32 || memcmp(t_root.data, trie->root, 32))
+    if (t_root.len != 32 || memcmp(t_root.data, root, 32))
       res = vc_err(vc, "Wrong Transaction root");
 
-    trie_free(trie);
-
     // verify uncles
     if (res == IN3_OK && full_proof)
       return eth_verify_uncles(vc, d_get_bytesk(vc->result, K_SHA3_UNCLES)->data, d_get(vc->proof, K_UNCLES), d_get(vc->result, K_UNCLES));
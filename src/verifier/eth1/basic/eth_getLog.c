@@ -37,6 +37,7 @@
 #include "../../../core/util/data.h"
 #include "../../../core/util/log.h"
 #include "../../../core/util/mem.h"
+#include "../../../core/util/parallel.h"
 #include "../../../verifier/eth1/nano/eth_nano.h"
 #include "../../../verifier/eth1/nano/merkle.h"
 #include "../../../verifier/eth1/nano/rlp.h"
@@ -49,11 +50,28 @@
 typedef struct receipt {
   bytes32_t tx_hash;
   bytes_t   data;
+  bytes_t   logs; /**< the decoded list of logs or data NULL if not decoded yet */
   bytes_t   block_number;
   bytes32_t block_hash;
   uint32_t  transaction_index;
 } receipt_t;
 
+/** an index of the receipts by txhash, using open addressing. */
+typedef struct {
+  receipt_t* receipts;
+  uint32_t*  slots; /**< index+1 of the receipt or 0 if the slot is empty */
+  uint32_t   mask;  /**< the number of slots - 1 */
+} receipt_index_t;
+
+/** the proof of one block, which is verified independently of the other blocks. */
+typedef struct {
+  d_token_t* proof;    /**< the entry of the logProof */
+  bytes_t    header;   /**< the already verified blockheader */
+  receipt_t* receipts; /**< the first receipt of this block */
+  int        n;        /**< the number of receipts of this block */
+  char*      error;    /**< the error message if the proof is invalid */
+} block_proof_t;
+
 static bool matches_filter_address(d_token_t* tx_params, bytes_t addrs) {
   d_token_t* jaddrs = d_getl(tx_params, K_ADDRESS, 20);
   if (jaddrs == NULL) {
@@ -197,93 +215,118 @@ static in3_ret_t filter_check_latest(d_token_t* req, uint64_t blk, uint64_t curr
   }
 }
 
-in3_ret_t eth_verify_eth_getLog(in3_vctx_t* vc, int l_logs) {
-  in3_ret_t  res = IN3_OK, i = 0;
-  receipt_t* receipts = alloca(sizeof(receipt_t) * l_logs);
-  bytes_t    logddata, tmp, tops;
+/** verifies the tx- and receipt-proofs of one block. */
+static char* verify_block_proof(block_proof_t* b) {
+  bytes_t     tx_root, receipt_root, block_number, path;
+  bytes32_t   block_hash;
+  uint8_t     path_data[5];
+  rlp_index_t header;
+  receipt_t*  r;
+  char*       error = NULL;
+  sha3_to(&b->header, block_hash);
+  rlp_index_list(&b->header, &header);
+  if (rlp_index_get(&header, BLOCKHEADER_RECEIPT_ROOT, &receipt_root) != 1) return "invalid receipt root";
+  if (rlp_index_get(&header, BLOCKHEADER_TRANSACTIONS_ROOT, &tx_root) != 1) return "invalid tx root";
+  if (rlp_index_get(&header, BLOCKHEADER_NUMBER, &block_number) != 1) return "invalid block number";
 
-  // invalid result-token
-  if (!vc->result || d_type(vc->result) != T_ARRAY) return vc_err(vc, "The result must be an array");
-  // no results -> nothing to verify
-  if (l_logs == 0) return IN3_OK;
-  // we require proof
-  if (!vc->proof) return vc_err(vc, "no proof for logs found");
-  if (d_len(d_get(vc->proof, K_LOG_PROOF)) > l_logs) return vc_err(vc, "too many proofs");
-
-  for (d_iterator_t it = d_iter(d_get(vc->proof, K_LOG_PROOF)); it.left; d_iter_next(&it)) {
-    // verify that block number matches key
-    if (d_get_longk(it.token, K_NUMBER) != strtoull(d_get_keystr(it.token->key), NULL, 16))
-      return vc_err(vc, "block number mismatch");
+  // all receipts of a block share the upper nodes of the tx- and receipt-trie, so each node is only hashed once.
+  d_token_t*        jreceipts = d_get(b->proof, K_RECEIPTS);
+  trie_multiproof_t tx_proof = {0}, receipt_proof = {0};
+  for (d_iterator_t receipt = d_iter(jreceipts); receipt.left; d_iter_next(&receipt)) {
+    if (!trie_multiproof_add(&tx_proof, d_get(receipt.token, K_TX_PROOF)) || !trie_multiproof_add(&receipt_proof, d_get(receipt.token, K_PROOF)))
+      error = "missing merkle proof";
+  }
 
-    // verify the blockheader of the log entry
-    bytes_t block = d_to_bytes(d_get(it.token, K_BLOCK)), tx_root, receipt_root;
-    int     bl    = i;
-    if (!block.len || eth_verify_blockheader(vc, &block, NULL) < 0) return vc_err(vc, "invalid blockheader");
-    sha3_to(&block, receipts[i].block_hash);
-    rlp_decode(&block, 0, &block);
-    if (rlp_decode(&block, BLOCKHEADER_RECEIPT_ROOT, &receipt_root) != 1) return vc_err(vc, "invalid receipt root");
-    if (rlp_decode(&block, BLOCKHEADER_TRANSACTIONS_ROOT, &tx_root) != 1) return vc_err(vc, "invalid tx root");
-    if (rlp_decode(&block, BLOCKHEADER_NUMBER, &receipts[i].block_number) != 1) return vc_err(vc, "invalid block number");
-
-    // verify all receipts
-    for (d_iterator_t receipt = d_iter(d_get(it.token, K_RECEIPTS)); receipt.left; d_iter_next(&receipt)) {
-      // verify that txn hash matches key
-      if (i == l_logs) return vc_err(vc, "too many receipts in the proof");
-      receipt_t* r = receipts + i;
-      if (i != bl) memcpy(r, receipts + bl, sizeof(receipt_t)); // copy blocknumber and blockhash
-      i++;
-
-      // verify tx data first
-      r->data              = bytes(NULL, 0);
-      r->transaction_index = d_get_intk(receipt.token, K_TX_INDEX);
-      bytes_t** proof      = d_create_bytes_vec(d_get(receipt.token, K_TX_PROOF));
-      bytes_t*  path       = create_tx_path(r->transaction_index);
-
-      if (!proof || !trie_verify_proof(&tx_root, path, proof, &r->data))
-        res = vc_err(vc, "invalid tx merkle proof");
-      if (proof) _free(proof);
-      if (res != IN3_OK) {
-        if (path) b_free(path);
-        return res;
-      }
+  // verify all transactions
+  r = b->receipts;
+  for (d_iterator_t receipt = d_iter(jreceipts); receipt.left && !error; d_iter_next(&receipt), r++) {
+    memcpy(r->block_hash, block_hash, 32);
+    r->block_number      = block_number;
+    r->data              = bytes(NULL, 0);
+    r->logs              = bytes(NULL, 0);
+    r->transaction_index = d_get_intk(receipt.token, K_TX_INDEX);
+    path                 = create_tx_path_to(r->transaction_index, path_data);
 
-      // check txhash
+    if (!trie_multiproof_verify(&tx_proof, &tx_root, &path, &r->data))
+      error = "invalid tx merkle proof";
+  }
+  trie_multiproof_free(&tx_proof);
 
-      sha3_to(&r->data, r->tx_hash);
-      if (!bytes_cmp(d_to_bytes(d_getl(receipt.token, K_TX_HASH, 32)), bytes(r->tx_hash, 32))) {
-        if (path) b_free(path);
-        return vc_err(vc, "invalid tx hash");
-      }
+  // hash all transactions of the block at once and check the txhashes
+  if (!error && b->n) {
+    bytes_t** txs = _malloc(b->n * (sizeof(bytes_t*) + 32));
+    uint8_t*  h   = (uint8_t*) (txs + b->n);
+    for (int k = 0; k < b->n; k++) txs[k] = &b->receipts[k].data;
+    sha3_many(txs, b->n, h);
+    for (int k = 0; k < b->n; k++) memcpy(b->receipts[k].tx_hash, h + k * 32, 32);
+    _free(txs);
+  }
 
+  r = b->receipts;
+  for (d_iterator_t receipt = d_iter(jreceipts); receipt.left && !error; d_iter_next(&receipt), r++) {
+    // check txhash
+    if (!bytes_cmp(d_to_bytes(d_getl(receipt.token, K_TX_HASH, 32)), bytes(r->tx_hash, 32)))
+      error = "invalid tx hash";
+    else {
       // verify receipt data
-      proof   = d_create_bytes_vec(d_get(receipt.token, K_PROOF));
+      path    = create_tx_path_to(r->transaction_index, path_data);
       r->data = bytes(NULL, 0);
 
-      if (!proof || !trie_verify_proof(&receipt_root, path, proof, &r->data))
-        res = vc_err(vc, "invalid receipt proof");
-      if (proof) _free(proof);
-      if (path) b_free(path);
-      if (res != IN3_OK) return res;
+      if (!trie_multiproof_verify(&receipt_proof, &receipt_root, &path, &r->data))
+        error = "invalid receipt proof";
     }
   }
+  trie_multiproof_free(&receipt_proof);
+  return error;
+}
+
+static void verify_block_task(void* data, int i) {
+  block_proof_t* b = (block_proof_t*) data + i;
+  b->error         = verify_block_proof(b);
+}
+
+static uint32_t receipt_slot(receipt_index_t* index, uint8_t* tx_hash) {
+  // the txhash is already a hash, so the first bytes are good enough to pick the slot.
+  return (tx_hash[0] | tx_hash[1] << 8 | tx_hash[2] << 16 | (uint32_t) tx_hash[3] << 24) & index->mask;
+}
+
+static void receipt_index_init(receipt_index_t* index, receipt_t* receipts, int n) {
+  uint32_t size = 4;
+  while (size < (uint32_t) n * 2) size <<= 1;
+  index->receipts = receipts;
+  index->mask     = size - 1;
+  index->slots    = _calloc(size, sizeof(uint32_t));
+  for (int i = 0; i < n; i++) {
+    uint32_t slot = receipt_slot(index, receipts[i].tx_hash);
+    while (index->slots[slot]) slot = (slot + 1) & index->mask;
+    index->slots[slot] = i + 1;
+  }
+}
+
+static receipt_t* receipt_index_find(receipt_index_t* index, bytes_t tx_hash) {
+  if (tx_hash.len != 32) return NULL;
+  for (uint32_t slot = receipt_slot(index, tx_hash.data); index->slots[slot]; slot = (slot + 1) & index->mask) {
+    receipt_t* r = index->receipts + index->slots[slot] - 1;
+    if (memcmp(r->tx_hash, tx_hash.data, 32) == 0) return r;
+  }
+  return NULL;
+}
 
+/** matches all logs of the result with the verified receipts. */
+static in3_ret_t verify_logs(in3_vctx_t* vc, receipt_index_t* index) {
+  bytes_t  logddata, tmp, tops;
   uint64_t prev_blk = 0;
   for (d_iterator_t it = d_iter(vc->result); it.left; d_iter_next(&it)) {
-    receipt_t* r = NULL;
-    i            = 0;
-    for (int n = 0; n < l_logs; n++) {
-      if (bytes_cmp(d_to_bytes(d_get(it.token, K_TRANSACTION_HASH)), bytes(receipts[n].tx_hash, 32))) {
-        r = receipts + n;
-        break;
-      }
-    }
+    receipt_t* r = receipt_index_find(index, d_to_bytes(d_get(it.token, K_TRANSACTION_HASH)));
+    int        i = 0;
     if (!r) return vc_err(vc, "missing proof for log");
     d_token_t* topics = d_get(it.token, K_TOPICS);
-    rlp_decode(&r->data, 0, &tmp);
+
+    // the logs of a receipt are only decoded once, even if many logs come from the same receipt.
+    if (!r->logs.data && (rlp_decode(&r->data, 0, &tmp) != 2 || rlp_decode(&tmp, 3, &r->logs) != 2)) return vc_err(vc, "invalid log-data");
 
     // verify the log-data
-    if (rlp_decode(&tmp, 3, &logddata) != 2) return vc_err(vc, "invalid log-data");
-    if (rlp_decode(&logddata, d_get_intk(it.token, K_TRANSACTION_LOG_INDEX), &logddata) != 2) return vc_err(vc, "invalid log index");
+    if (rlp_decode(&r->logs, d_get_intk(it.token, K_TRANSACTION_LOG_INDEX), &logddata) != 2) return vc_err(vc, "invalid log index");
 
     // check address
     if (!rlp_decode(&logddata, 0, &tmp) || !bytes_cmp(tmp, d_to_bytes(d_getl(it.token, K_ADDRESS, 20)))) return vc_err(vc, "invalid address");
@@ -311,5 +354,56 @@ in3_ret_t eth_verify_eth_getLog(in3_vctx_t* vc, int l_logs) {
     if (filter_check_latest(vc->request, d_get_longk(it.token, K_BLOCK_NUMBER), vc->currentBlock, it.left == 1) != IN3_OK) return vc_err(vc, "latest check failed");
   }
 
+  return IN3_OK;
+}
+
+in3_ret_t eth_verify_eth_getLog(in3_vctx_t* vc, int l_logs) {
+  in3_ret_t res = IN3_OK, i = 0;
+
+  // invalid result-token
+  if (!vc->result || d_type(vc->result) != T_ARRAY) return vc_err(vc, "The result must be an array");
+  // no results -> nothing to verify
+  if (l_logs == 0) return IN3_OK;
+  // we require proof
+  if (!vc->proof) return vc_err(vc, "no proof for logs found");
+  d_token_t* log_proof = d_get(vc->proof, K_LOG_PROOF);
+  int        n_blocks  = d_len(log_proof);
+  if (n_blocks > l_logs) return vc_err(vc, "too many proofs");
+
+  // the blockheaders are verified first, since this may use and update the verified hashes of the chain.
+  receipt_t*     receipts = _malloc(l_logs * sizeof(receipt_t));
+  block_proof_t* blocks   = _malloc(n_blocks * sizeof(block_proof_t) + 1);
+  block_proof_t* b        = blocks;
+  for (d_iterator_t it = d_iter(log_proof); it.left && res == IN3_OK; d_iter_next(&it), b++) {
+    b->proof    = it.token;
+    b->header   = d_to_bytes(d_get(it.token, K_BLOCK));
+    b->receipts = receipts + i;
+    b->n        = d_len(d_get(it.token, K_RECEIPTS));
+    i += b->n;
+
+    // verify that block number matches key
+    if (d_get_longk(it.token, K_NUMBER) != strtoull(d_get_keystr(it.token->key), NULL, 16))
+      res = vc_err(vc, "block number mismatch");
+    // verify the blockheader of the log entry
+    else if (!b->header.len || eth_verify_blockheader(vc, &b->header, NULL) < 0)
+      res = vc_err(vc, "invalid blockheader");
+    else if (i > l_logs)
+      res = vc_err(vc, "too many receipts in the proof");
+  }
+
+  // the merkle proofs of the blocks are independent, so they may be verified in parallel.
+  if (res == IN3_OK) in3_run_tasks(verify_block_task, blocks, n_blocks, vc->ctx->client->max_threads);
+  for (b = blocks; res == IN3_OK && b < blocks + n_blocks; b++) {
+    if (b->error) res = vc_err(vc, b->error);
+  }
+  _free(blocks);
+
+  if (res == IN3_OK) {
+    receipt_index_t index;
+    receipt_index_init(&index, receipts, i);
+    res = verify_logs(vc, &index);
+    _free(index.slots);
+  }
+  _free(receipts);
   return res;
 }
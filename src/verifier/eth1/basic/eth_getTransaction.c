@@ -37,8 +37,7 @@
 #include "../../../core/util/data.h"
 #include "../../../core/util/mem.h"
 #include "../../../third-party/crypto/bignum.h"
-#include "../../../third-party/crypto/ecdsa.h"
-#include "../../../third-party/crypto/secp256k1.h"
+#include "../../../verifier/eth1/nano/ecrecover.h"
 #include "../../../verifier/eth1/nano/eth_nano.h"
 #include "../../../verifier/eth1/nano/merkle.h"
 #include "../../../verifier/eth1/nano/rlp.h"
@@ -47,7 +46,7 @@
 
 static uint8_t* secp256k1n_2 = (uint8_t*) "\x7F\xFF\xFF\xFF\xFF\xFF\xFF\xFF\xFF\xFF\xFF\xFF\xFF\xFF\xFF\xFF\x5D\x57\x6E\x73\x57\xA4\x50\x1D\xDF\xE9\x2F\x46\x68\x1B\x20\xA0";
 
-in3_ret_t eth_verify_tx_values(in3_vctx_t* vc, d_token_t* tx, bytes_t* raw) {
+char* eth_check_tx_values(d_token_t* tx, bytes_t* raw) {
   d_token_t* t = NULL;
   uint8_t    hash[32], pubkey[65], sdata[64];
   bytes_t    pubkey_bytes = {.len = 64, .data = ((uint8_t*) &pubkey) + 1};
@@ -59,27 +58,27 @@ in3_ret_t eth_verify_tx_values(in3_vctx_t* vc, d_token_t* tx, bytes_t* raw) {
 
   // check transaction hash
   if (sha3_to(raw ? raw : d_get_bytesk(tx, K_RAW), &hash) == 0 && memcmp(hash, d_get_byteskl(tx, K_HASH, 32)->data, 32))
-    return vc_err(vc, "wrong transactionHash");
+    return "wrong transactionHash";
 
   // check raw data
   if ((t = d_get(tx, K_RAW)) && raw && !b_cmp(raw, d_bytes(t)))
-    return vc_err(vc, "invalid raw-value");
+    return "invalid raw-value";
 
   // check standardV
   if ((t = d_get(tx, K_STANDARD_V)) && raw && ((chain_id ? (v - chain_id * 2 - 8) : v) - 27) != (unsigned) d_int(t))
-    return vc_err(vc, "standardV is invalid");
+    return "standardV is invalid";
 
   // check chain id
   if ((t = d_get(tx, K_CHAIN_ID)) && (unsigned) d_int(t) != chain_id)
-    return vc_err(vc, "wrong chain_id");
+    return "wrong chain_id";
 
   // All transaction signatures whose s-value is greater than secp256k1n/2 are considered invalid.
   if (!s || s->len > 32 || (s->len == 32 && memcmp(s->data, secp256k1n_2, 32) > 0))
-    return vc_err(vc, "invalid v-value of the signature");
+    return "invalid v-value of the signature";
 
   // r & s have valid length?
   if (r == NULL || s == NULL || r->len + s->len > 64)
-    return vc_err(vc, "invalid r/s-value of the signature");
+    return "invalid r/s-value of the signature";
 
   // combine r+s
   memset(sdata, 0, 64);
@@ -109,15 +108,20 @@ in3_ret_t eth_verify_tx_values(in3_vctx_t* vc, d_token_t* tx, bytes_t* raw) {
   bb_free(bb);
 
   // verify signature
-  if (ecdsa_recover_pub_from_sig(&secp256k1, pubkey, sdata, hash, (chain_id ? v - chain_id * 2 - 8 : v) - 27))
-    return vc_err(vc, "could not recover signature");
+  if (ecrecover_pub(sdata, (chain_id ? v - chain_id * 2 - 8 : v) - 27, hash, pubkey))
+    return "could not recover signature";
 
   if ((t = d_getl(tx, K_PUBLIC_KEY, 64)) && memcmp(pubkey_bytes.data, t->data, t->len) != 0)
-    return vc_err(vc, "invalid public Key");
+    return "invalid public Key";
 
   if ((t = d_getl(tx, K_FROM, 20)) && sha3_to(&pubkey_bytes, &hash) == 0 && memcmp(hash + 12, t->data, 20))
-    return vc_err(vc, "invalid from address");
-  return IN3_OK;
+    return "invalid from address";
+  return NULL;
+}
+
+in3_ret_t eth_verify_tx_values(in3_vctx_t* vc, d_token_t* tx, bytes_t* raw) {
+  char* error = eth_check_tx_values(tx, raw);
+  return error ? vc_err(vc, error) : IN3_OK;
 }
 
 in3_ret_t eth_verify_eth_getTransaction(in3_vctx_t* vc, bytes_t* tx_hash) {
@@ -136,14 +140,17 @@ in3_ret_t eth_verify_eth_getTransaction(in3_vctx_t* vc, bytes_t* tx_hash) {
 
   res = eth_verify_blockheader(vc, blockHeader, d_get_byteskl(vc->result, K_BLOCK_HASH, 32));
   if (res == IN3_OK) {
-    bytes_t*  path = create_tx_path(d_get_intk(vc->proof, K_TX_INDEX));
-    bytes_t   root, raw_transaction = {.len = 0, .data = NULL};
-    bytes_t** proof = d_create_bytes_vec(d_get(vc->proof, K_MERKLE_PROOF));
-
-    if (rlp_decode_in_list(blockHeader, 4, &root) != 1)
+    uint8_t     path_data[5];
+    bytes_t     path = create_tx_path_to(d_get_intk(vc->proof, K_TX_INDEX), path_data);
+    bytes_t     root, raw_transaction = {.len = 0, .data = NULL};
+    d_token_t*  proof = d_get(vc->proof, K_MERKLE_PROOF);
+    rlp_index_t header;
+    rlp_index_list(blockHeader, &header);
+
+    if (rlp_index_get(&header, BLOCKHEADER_TRANSACTIONS_ROOT, &root) != 1)
       res = vc_err(vc, "no tx root");
     else {
-      if (!proof || !trie_verify_proof(&root, path, proof, &raw_transaction) || raw_transaction.data == NULL)
+      if (!trie_verify_proof_token(&root, &path, proof, &raw_transaction) || raw_transaction.data == NULL)
         res = vc_err(vc, "Could not verify the tx proof");
       else {
         uint8_t proofed_hash[32];
@@ -158,12 +165,9 @@ in3_ret_t eth_verify_eth_getTransaction(in3_vctx_t* vc, bytes_t* tx_hash) {
 
     if (res == IN3_OK && !d_eq(d_get(vc->result, K_TRANSACTION_INDEX), d_get(vc->proof, K_TX_INDEX)))
       res = vc_err(vc, "wrong transaction index");
-    if (res == IN3_OK && (rlp_decode_in_list(blockHeader, BLOCKHEADER_NUMBER, &root) != 1 || d_get_longk(vc->result, K_BLOCK_NUMBER) != bytes_to_long(root.data, root.len)))
+    if (res == IN3_OK && (rlp_index_get(&header, BLOCKHEADER_NUMBER, &root) != 1 || d_get_longk(vc->result, K_BLOCK_NUMBER) != bytes_to_long(root.data, root.len)))
       res = vc_err(vc, "wrong block number");
 
-    if (proof) _free(proof);
-    b_free(path);
-
     bytes_t* tx_data = serialize_tx(vc->result);
     if (res == IN3_OK && !b_cmp(tx_data, &raw_transaction))
       res = vc_err(vc, "Could not verify the transaction data");
@@ -214,17 +218,20 @@ in3_ret_t eth_verify_eth_getTransactionByBlock(in3_vctx_t* vc, d_token_t* blk, u
 
   res = eth_verify_blockheader(vc, blockHeader, d_get_byteskl(vc->result, K_BLOCK_HASH, 32));
   if (res == IN3_OK) {
-    bytes_t*  path = create_tx_path(d_get_intk(vc->proof, K_TX_INDEX));
-    bytes_t   root, raw_transaction = {.len = 0, .data = NULL};
-    bytes_t** proof = d_create_bytes_vec(d_get(vc->proof, K_MERKLE_PROOF));
-
-    if (rlp_decode_in_list(blockHeader, BLOCKHEADER_TRANSACTIONS_ROOT, &root) != 1)
+    uint8_t     path_data[5];
+    bytes_t     path = create_tx_path_to(d_get_intk(vc->proof, K_TX_INDEX), path_data);
+    bytes_t     root, raw_transaction = {.len = 0, .data = NULL};
+    d_token_t*  proof = d_get(vc->proof, K_MERKLE_PROOF);
+    rlp_index_t header;
+    rlp_index_list(blockHeader, &header);
+
+    if (rlp_index_get(&header, BLOCKHEADER_TRANSACTIONS_ROOT, &root) != 1)
       res = vc_err(vc, "no tx root");
     else {
       if (!proof) {
         res = vc_err(vc, "No merkle proof");
       } else {
-        int verified = trie_verify_proof(&root, path, proof, d_type(vc->result) == T_NULL ? NULL : &raw_transaction);
+        int verified = trie_verify_proof_token(&root, &path, proof, d_type(vc->result) == T_NULL ? NULL : &raw_transaction);
         if (d_type(vc->result) == T_NULL && !verified)
           res = vc_err(vc, "Could not prove non-existence of transaction");
         else if (!verified && raw_transaction.data == NULL)
@@ -232,16 +239,13 @@ in3_ret_t eth_verify_eth_getTransactionByBlock(in3_vctx_t* vc, d_token_t* blk, u
       }
     }
 
-    if (proof) _free(proof);
-    b_free(path);
-
     if (d_type(vc->result) != T_NULL) {
       if (res == IN3_OK)
         res = eth_verify_tx_values(vc, vc->result, &raw_transaction);
 
       if (res == IN3_OK && !d_eq(d_get(vc->result, K_TRANSACTION_INDEX), d_get(vc->proof, K_TX_INDEX)))
         res = vc_err(vc, "wrong transaction index");
-      if (res == IN3_OK && (rlp_decode_in_list(blockHeader, BLOCKHEADER_NUMBER, &root) != 1 || d_get_longk(vc->result, K_BLOCK_NUMBER) != bytes_to_long(root.data, root.len)))
+      if (res == IN3_OK && (rlp_index_get(&header, BLOCKHEADER_NUMBER, &root) != 1 || d_get_longk(vc->result, K_BLOCK_NUMBER) != bytes_to_long(root.data, root.len)))
         res = vc_err(vc, "wrong block number");
 
       bytes_t* tx_data = serialize_tx(vc->result);
@@ -116,18 +116,20 @@ bool filter_opt_valid(d_token_t* tx_params) {
   return true;
 }
 
-char* filter_opt_set_fromBlock(char* fopt, uint64_t fromBlock, bool should_overwrite) {
+static char* filter_opt_set_block(char* fopt, const char* name, uint64_t block, bool should_overwrite) {
   size_t pos, len;
-  char   blockstr[40]; // buffer to hold - "fromBlock": "<21 chars for hex repr (upto UINT64_MAX)>",
-  char*  tok = str_find(fopt, "\"fromBlock\"");
+  char   blockstr[48]; // buffer to hold - "<name>": "<21 chars for hex repr (upto UINT64_MAX)>",
+  char   key[16];
+  sprintf(key, "\"%s\"", name);
+  char* tok = str_find(fopt, key);
   if (!tok) {
-    sprintf(blockstr, "\"fromBlock\":\"0x%" PRIx64 "\"%c", fromBlock, str_find(fopt, "\"") ? ',' : '\0');
+    sprintf(blockstr, "%s:\"0x%" PRIx64 "\"%c", key, block, str_find(fopt, "\"") ? ',' : '\0');
     tok = str_find(fopt, "{");
-    pos = fopt - tok + 1;
+    pos = tok - fopt + 1;
     len = 0;
     return str_replace_pos(fopt, pos, len, blockstr);
   } else if (should_overwrite) {
-    sprintf(blockstr, "0x%" PRIx64 "", fromBlock);
+    sprintf(blockstr, "0x%" PRIx64 "", block);
     tok = str_find(str_find(tok + 1, ":") + 1, "\"");
     pos = tok - fopt + 1;
     tok = str_find(tok + 1, "\"");
@@ -140,6 +142,177 @@ char* filter_opt_set_fromBlock(char* fopt, uint64_t fromBlock, bool should_overw
   return tmp;
 }
 
+char* filter_opt_set_fromBlock(char* fopt, uint64_t fromBlock, bool should_overwrite) {
+  return filter_opt_set_block(fopt, "fromBlock", fromBlock, should_overwrite);
+}
+
+static bool filter_opt_is_latest(d_token_t* opt, d_key_t k) {
+  d_token_t* t = d_get(opt, k);
+  return !t || (d_type(t) == T_STRING && strcmp(d_string(t), "earliest")); // latest or pending
+}
+
+static bool filter_opt_block(d_token_t* opt, d_key_t k, uint64_t latest, uint64_t* block) {
+  d_token_t* t = d_get(opt, k);
+  if (filter_opt_is_latest(opt, k))
+    *block = latest;
+  else if (d_type(t) == T_STRING)
+    *block = 0;
+  else if (d_type(t) == T_INTEGER || d_type(t) == T_BYTES)
+    *block = d_long(t);
+  else
+    return false;
+  return true;
+}
+
+/** returns the current blocknumber or 0 if it could not be fetched. */
+static uint64_t filter_block_number(in3_t* in3) {
+  in3_ctx_t* ctx   = in3_client_rpc_ctx(in3, "eth_blockNumber", "[]");
+  uint64_t   blkno = ctx_get_error(ctx, 0) == IN3_OK ? d_get_longk(ctx->responses[0], K_RESULT) : 0;
+  ctx_free(ctx);
+  return blkno;
+}
+
+static in3_ret_t filter_request_failed(in3_ctx_t* ctx, in3_ret_t res, char** error) {
+  if (error && ctx->error) {
+    *error = _malloc(strlen(ctx->error) + 1);
+    strcpy(*error, ctx->error);
+  }
+  return res == IN3_OK ? IN3_EUNKNOWN : res;
+}
+
+static in3_ret_t filter_logs_chunked(in3_t* in3, char* fopt, uint64_t from, uint64_t to, filter_logs_cb cb, void* data, char** error) {
+  uint64_t  chunk = FILTER_LOGS_CHUNK, ends[FILTER_LOGS_BATCH];
+  in3_ret_t res   = IN3_OK;
+
+  while (from <= to) {
+    // build a batch with the next chunks
+    sb_t* req = sb_new("[");
+    int   n   = 0;
+    for (uint64_t start = from; n < FILTER_LOGS_BATCH && start <= to; n++) {
+      ends[n]     = to - start < chunk ? to : start + chunk - 1;
+      char* fopt_ = filter_opt_set_block(fopt, "fromBlock", start, true);
+      char* opt   = filter_opt_set_block(fopt_, "toBlock", ends[n], true);
+      char  head[80];
+      sprintf(head, "%s{\"method\":\"eth_getLogs\",\"jsonrpc\":\"2.0\",\"id\":%i,\"params\":[", n ? "," : "", n + 1);
+      sb_add_chars(sb_add_chars(req, head), opt);
+      sb_add_chars(req, "]}");
+      _free(fopt_);
+      _free(opt);
+      start = ends[n] + 1;
+    }
+    sb_add_char(req, ']');
+
+    // each response is verified on its own, so we can pass on every chunk up to the first failure
+    in3_ctx_t* ctx = ctx_new(in3, req->data);
+    if (!ctx->error && in3_send_ctx(ctx) == IN3_OK && ctx->error) {
+      _free(ctx->error);
+      ctx->error = NULL;
+    }
+    int  done = 0;
+    bool stop = false;
+    for (; done < n && ctx_get_error(ctx, done) == IN3_OK && !stop; done++) {
+      stop = (res = cb(data, d_get(ctx->responses[done], K_RESULT))) != IN3_OK;
+      from = ends[done] + 1;
+    }
+
+    if (done == n && !stop)
+      chunk = chunk * 2 > FILTER_LOGS_CHUNK ? FILTER_LOGS_CHUNK : chunk * 2;
+    else if (!stop && ctx->responses && chunk > 1) {
+      // the node answered, but could not serve the range, so we retry with smaller chunks
+      in3_log_debug("eth_getLogs failed for %" PRIu64 " blocks, splitting the range\n", chunk);
+      chunk /= 2;
+    } else if (!stop)
+      stop = (res = filter_request_failed(ctx, ctx_get_error(ctx, done), error)) != IN3_OK;
+
+    ctx_free(ctx);
+    sb_free(req);
+    if (stop) return res;
+  }
+  return IN3_OK;
+}
+
+in3_ret_t filter_get_logs(in3_t* in3, char* fopt, uint64_t latest, filter_logs_cb cb, void* data, char** error) {
+  json_ctx_t* jopt = parse_json(fopt);
+  if (!jopt) return IN3_EINVAL;
+  d_token_t* opt = jopt->result;
+  uint64_t   from, to;
+
+  // the latest block is only needed, if it bounds a range together with a fixed block.
+  // eth_blockNumber can not be verified, so a node may end the range early (see filter.h).
+  if (!latest && !d_get(opt, K_BLOCK_HASH) && filter_opt_is_latest(opt, K_FROM_BLOCK) != filter_opt_is_latest(opt, K_TO_BLOCK))
+    latest = filter_block_number(in3);
+
+  bool chunked = !d_get(opt, K_BLOCK_HASH) && filter_opt_block(opt, K_FROM_BLOCK, latest, &from) && filter_opt_block(opt, K_TO_BLOCK, latest, &to) && from <= to && to - from >= FILTER_LOGS_CHUNK;
+  json_free(jopt);
+  if (chunked) return filter_logs_chunked(in3, fopt, from, to, cb, data, error);
+
+  // small ranges are fetched as they are
+  sb_t* params = sb_new("[");
+  sb_add_chars(params, fopt);
+  in3_ctx_t* ctx = in3_client_rpc_ctx(in3, "eth_getLogs", sb_add_char(params, ']')->data);
+  sb_free(params);
+  in3_ret_t res = ctx_get_error(ctx, 0);
+  if (res == IN3_OK)
+    res = cb(data, d_get(ctx->responses[0], K_RESULT));
+  else
+    filter_request_failed(ctx, res, error);
+  ctx_free(ctx);
+  return res;
+}
+
+in3_ret_t filter_get_block_hashes(in3_t* in3, uint64_t from, uint64_t to, bytes32_t* hashes, char** error) {
+  bytes32_t parent;
+  bool      linked = false;
+  in3_ret_t res    = IN3_OK;
+  uint64_t  start  = to + 1;
+
+  // we fetch the batches from the newest to the oldest block, so every block can be checked against the parentHash of the next one.
+  while (res == IN3_OK && start > from) {
+    const uint64_t end = start - 1;
+    start              = end - from >= FILTER_BLOCKS_BATCH ? end - FILTER_BLOCKS_BATCH + 1 : from;
+
+    sb_t* req = sb_new("[");
+    char  tmp[120];
+    for (uint64_t i = start; i <= end; i++) {
+      sprintf(tmp, "%s{\"method\":\"eth_getBlockByNumber\",\"jsonrpc\":\"2.0\",\"id\":%i,\"params\":[\"0x%" PRIx64 "\",false]}",
+              i == start ? "" : ",", (int) (i - start + 1), i);
+      sb_add_chars(req, tmp);
+    }
+    sb_add_char(req, ']');
+
+    // only the newest block needs signatures, all others are verified through the parentHash
+    in3_ctx_t* ctx = ctx_new(in3, req->data);
+    for (uint64_t i = start; i <= end && ctx->requests_configs; i++) ctx->requests_configs[i - start].skip_signatures = linked || i < end;
+    if (!ctx->error && in3_send_ctx(ctx) == IN3_OK && ctx->error) {
+      _free(ctx->error);
+      ctx->error = NULL;
+    }
+    for (uint64_t i = end + 1; i > start && res == IN3_OK; i--) {
+      const int n = i - 1 - start;
+      if ((res = ctx_get_error(ctx, n)) != IN3_OK) {
+        filter_request_failed(ctx, res, error);
+        break;
+      }
+      d_token_t* block = d_get(ctx->responses[n], K_RESULT);
+      bytes_t*   hash  = d_bytesl(d_getl(block, K_HASH, 32), 32);
+      bytes_t*   ph    = d_bytesl(d_getl(block, K_PARENT_HASH, 32), 32);
+      if (!hash || hash->len != 32 || !ph || ph->len != 32)
+        res = IN3_EINVALDT;
+      else if (linked && memcmp(hash->data, parent, 32)) {
+        in3_log_warn("Block #%" PRIu64 " is not the parent of the next block!\n", i - 1);
+        res = IN3_EINVALDT;
+      } else {
+        memcpy(hashes[i - 1 - from], hash->data, 32);
+        memcpy(parent, ph->data, 32);
+        linked = true;
+      }
+    }
+    ctx_free(ctx);
+    sb_free(req);
+  }
+  return res;
+}
+
 static void filter_release(in3_filter_t* f) {
   if (f && f->options)
     _free(f->options);
@@ -218,6 +391,17 @@ bool filter_remove(in3_t* in3, size_t id) {
   return true;
 }
 
+static in3_ret_t filter_add_logs(void* data, d_token_t* logs) {
+  sb_t* sb = data;
+  for (d_iterator_t it = d_iter(logs); it.left; d_iter_next(&it)) {
+    char* jr = d_create_json(it.token);
+    if (sb->data[sb->len - 1] != '[') sb_add_char(sb, ',');
+    sb_add_chars(sb, jr);
+    _free(jr);
+  }
+  return IN3_OK;
+}
+
 in3_ret_t filter_get_changes(in3_ctx_t* ctx, size_t id, sb_t* result) {
   in3_t* in3 = ctx->client;
   if (in3->filters == NULL)
@@ -245,22 +429,17 @@ in3_ret_t filter_get_changes(in3_ctx_t* ctx, size_t id, sb_t* result) {
       if (f->last_block > blkno) {
         sb_add_chars(result, "[]");
       } else {
-        sb_t* params = sb_new("[");
         char* fopt_ = filter_opt_set_fromBlock(fopt, f->last_block, !f->is_first_usage);
-        sb_add_chars(params, fopt_);
-        ctx_ = in3_client_rpc_ctx(in3, "eth_getLogs", sb_add_char(params, ']')->data);
-        sb_free(params);
+        char* error = NULL;
+        sb_add_char(result, '[');
+        res = filter_get_logs(in3, fopt_, blkno, filter_add_logs, result, &error);
+        sb_add_char(result, ']');
         _free(fopt_);
-        if ((res = ctx_get_error(ctx_, 0)) != IN3_OK) {
-          ctx_set_error(ctx, ctx_->error, res);
-          ctx_free(ctx_);
+        if (res != IN3_OK) {
+          if (error) ctx_set_error(ctx, error, res);
+          _free(error);
           return ctx_set_error(ctx, "internal error, call to eth_getLogs failed", res);
         }
-        d_token_t* r  = d_get(ctx_->responses[0], K_RESULT);
-        char*      jr = d_create_json(r);
-        sb_add_chars(result, jr);
-        _free(jr);
-        ctx_free(ctx_);
         f->last_block = blkno + 1;
         f->is_first_usage = false;
       }
@@ -268,27 +447,26 @@ in3_ret_t filter_get_changes(in3_ctx_t* ctx, size_t id, sb_t* result) {
     }
     case FILTER_BLOCK:
       if (blkno > f->last_block) {
-        char params[37] = {0};
+        bytes32_t* hashes = _malloc(sizeof(bytes32_t) * (blkno - f->last_block));
+        char*      error  = NULL;
+        if ((res = filter_get_block_hashes(in3, f->last_block + 1, blkno, hashes, &error)) != IN3_OK) {
+          if (error) ctx_set_error(ctx, error, res);
+          _free(error);
+          _free(hashes);
+          return ctx_set_error(ctx, "internal error, call to eth_getBlockByNumber failed", res);
+        }
+        char h[67] = "0x";
         sb_add_char(result, '[');
-        for (uint64_t i = f->last_block + 1, j = 0; i <= blkno; i++, j++) {
-          sprintf(params, "[\"0x%" PRIx64 "\", false]", i);
-          ctx_ = in3_client_rpc_ctx(in3, "eth_getBlockByNumber", params);
-          if ((res = ctx_get_error(ctx_, 0)) != IN3_OK) {
-            // error or block doesn't exist (unlikely)
-            in3_log_warn("Failed to get block by number!\n");
-            continue;
-          }
-          d_token_t* hash  = d_getl(d_get(ctx_->responses[0], K_RESULT), K_HASH, 32);
-          char       h[67] = "0x";
-          bytes_to_hex(d_bytes(hash)->data, 32, h + 2);
-          if (j != 0)
+        for (uint64_t i = 0; i < blkno - f->last_block; i++) {
+          bytes_to_hex(hashes[i], 32, h + 2);
+          if (i != 0)
             sb_add_char(result, ',');
           sb_add_char(result, '"');
           sb_add_chars(result, h);
           sb_add_char(result, '"');
-          ctx_free(ctx_);
         }
         sb_add_char(result, ']');
+        _free(hashes);
         f->last_block = blkno;
         return IN3_OK;
       } else {
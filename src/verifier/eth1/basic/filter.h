@@ -38,10 +38,43 @@
 #include "../../../core/client/client.h"
 #include "../../../core/client/context.h"
 
+#ifndef FILTER_LOGS_CHUNK
+#define FILTER_LOGS_CHUNK 2000 /**< max number of blocks requested with one eth_getLogs-request, when splitting a range */
+#endif
+#ifndef FILTER_LOGS_BATCH
+#define FILTER_LOGS_BATCH 4 /**< number of chunks sent as one batch-request */
+#endif
+#ifndef FILTER_BLOCKS_BATCH
+#define FILTER_BLOCKS_BATCH 64 /**< max number of blocks requested with one batch-request, when polling a block filter */
+#endif
+
+/** receives the verified logs of one chunk. The chunks are passed in ascending block order and freed after the call. */
+typedef in3_ret_t (*filter_logs_cb)(void* data, d_token_t* logs);
+
 in3_ret_t filter_add(in3_t* in3, in3_filter_type_t type, char* options);
 bool      filter_remove(in3_t* in3, size_t id);
 in3_ret_t filter_get_changes(in3_ctx_t* ctx, size_t id, sb_t* result);
 bool      filter_opt_valid(d_token_t* tx_params);
 char*     filter_opt_set_fromBlock(char* fopt, uint64_t toBlock, bool should_overwrite);
 
+/**
+ * fetches the logs matching the filter options and passes them to the callback.
+ * 
+ * Ranges of more than FILTER_LOGS_CHUNK blocks are split into chunks, which are requested in batches and verified independently.
+ * If a node fails to serve a chunk, the chunk size is halved until the range can be served.
+ * `latest` is used to resolve `latest` or missing block numbers. If it is 0, the current blocknumber is fetched when needed.
+ * This blocknumber comes from an unverified `eth_blockNumber`, so a node reporting an old block can cut off the newest blocks of the range.
+ * The proofs only verify the logs returned, not that none are missing, so callers needing the full range should pass a blocknumber they trust.
+ * If the request failed, the error message may be returned in `error` (to be freed by the caller).
+ */
+in3_ret_t filter_get_logs(in3_t* in3, char* fopt, uint64_t latest, filter_logs_cb cb, void* data, char** error);
+
+/**
+ * fetches the hashes of the blocks `from`..`to` with batch-requests and writes them to `hashes` (ascending).
+ * 
+ * Only the newest block is requested with signatures. All older blocks are verified by linking their hash to the parentHash of the next block.
+ * If the request failed, the error message may be returned in `error` (to be freed by the caller).
+ */
+in3_ret_t filter_get_block_hashes(in3_t* in3, uint64_t from, uint64_t to, bytes32_t* hashes, char** error);
+
 #endif //FILTER_H
@@ -35,6 +35,7 @@
 #include "trie.h"
 #include "../../../core/util/log.h"
 #include "../../../core/util/mem.h"
+#include "../../../core/util/utils.h"
 #include "../../../third-party/crypto/sha3.h"
 #include "../../../verifier/eth1/nano/merkle.h"
 #include "../../../verifier/eth1/nano/rlp.h"
@@ -413,6 +414,151 @@ void trie_set_value(trie_t* t, bytes_t* key, bytes_t* value) {
   memcpy(t->root, root, 32);
 }
 
+static inline uint8_t key_nibble(bytes_t* key, int i) {
+  return i & 1 ? key->data[i >> 1] & 0x0F : key->data[i >> 1] >> 4;
+}
+
+static int cmp_kv(const void* a, const void* b) {
+  const bytes_t *x = &((const trie_kv_t*) a)->key, *y = &((const trie_kv_t*) b)->key;
+  int            c = memcmp(x->data, y->data, min(x->len, y->len));
+  return c ? c : (int) x->len - (int) y->len;
+}
+
+/** wraps everything written since start into a rlp-list. */
+static void wrap_list(bytes_builder_t* bb, uint32_t start) {
+  uint8_t         d[5];
+  bytes_builder_t ll = {.bsize = 5, .b = {.len = 0, .data = d}};
+  rlp_add_length(&ll, bb->b.len - start, 0xc0);
+  bb_replace(bb, start, 0, d, ll.b.len);
+}
+
+/** writes the hex-prefix encoded nibbles [from,to) of the key as rlp-item. */
+static void write_path(bytes_builder_t* bb, bytes_t* key, int from, int to, int is_leaf) {
+  int     l     = to - from;
+  uint8_t first = ((is_leaf ? 2 : 0) + (l & 1)) << 4;
+  if (l & 1) first |= key_nibble(key, from++);
+  if (l > 1) rlp_add_length(bb, 1 + l / 2, 0x80);
+  bb_write_byte(bb, first);
+  for (; from < to; from += 2) bb_write_byte(bb, (key_nibble(key, from) << 4) | key_nibble(key, from + 1));
+}
+
+/** a node written to the arena, but not hashed yet */
+typedef struct {
+  uint32_t offset; /**< offset of the placeholder byte in front of the node */
+  uint32_t len;    /**< length of the encoded node */
+} raw_node_t;
+
+/**
+ * replaces the raw nodes with their reference, which is the hash for nodes with 32 bytes or more.
+ * All nodes are hashed at once. Since each node has a placeholder byte in front, the reference never overwrites the next node.
+ */
+static void write_refs(bytes_builder_t* bb, raw_node_t* nodes, int n) {
+  bytes_t  data[16], *ptr[16];
+  uint8_t  hashes[16 * 32];
+  uint32_t w = nodes[0].offset;
+  int      l = 0;
+  for (int i = 0; i < n; i++) {
+    if (nodes[i].len < 32) continue;
+    data[l] = bytes(bb->b.data + nodes[i].offset + 1, nodes[i].len);
+    ptr[l]  = data + l;
+    l++;
+  }
+  for (int i = 0; i < l; i += 8) sha3_many(ptr + i, min(l - i, 8), hashes + i * 32);
+
+  for (int i = 0, j = 0; i < n; i++) {
+    if (nodes[i].len < 32) {
+      memmove(bb->b.data + w, bb->b.data + nodes[i].offset + 1, nodes[i].len);
+      w += nodes[i].len;
+    } else {
+      bb->b.data[w] = 0xa0;
+      memcpy(bb->b.data + w + 1, hashes + 32 * j++, 32);
+      w += 33;
+    }
+  }
+  bb->b.len = w;
+}
+
+/** writes a placeholder byte and the encoded node for the sorted items sharing the first depth nibbles. */
+static void build_node(bytes_builder_t* bb, trie_kv_t* items, int n, int depth) {
+  bb_write_byte(bb, 0);
+  uint32_t   start = bb->b.len;
+  raw_node_t children[16];
+  int        l        = 0;
+  bytes_t*   first    = &items[0].key;
+  int        key_len  = first->len * 2;
+  int        matching = depth;
+
+  if (n == 1) { // leaf
+    write_path(bb, first, depth, key_len, 1);
+    rlp_encode_item(bb, &items[0].value);
+    wrap_list(bb, start);
+    return;
+  }
+
+  // since the items are sorted, the first and the last have the shortest common prefix.
+  bytes_t* last = &items[n - 1].key;
+  while (matching < key_len && matching < (int) last->len * 2 && key_nibble(first, matching) == key_nibble(last, matching)) matching++;
+
+  if (matching > depth) { // extension
+    write_path(bb, first, depth, matching, 0);
+    children[0].offset = bb->b.len;
+    build_node(bb, items, n, matching);
+    children[0].len = bb->b.len - children[0].offset - 1;
+    write_refs(bb, children, 1);
+    wrap_list(bb, start);
+    return;
+  }
+
+  // branch, the key ending here is sorted first and becomes the value.
+  trie_kv_t* value = key_len == depth ? items : NULL;
+  int        i     = value ? 1 : 0;
+  for (int nibble = 0; nibble < 16; nibble++, l++) {
+    int j = i;
+    while (j < n && key_nibble(&items[j].key, depth) == nibble) j++;
+    children[l].offset = bb->b.len;
+    if (j == i)
+      bb_write_raw_bytes(bb, (uint8_t*) "\0\x80", 2);
+    else
+      build_node(bb, items + i, j - i, depth + 1);
+    children[l].len = bb->b.len - children[l].offset - 1;
+    i               = j;
+  }
+  write_refs(bb, children, 16);
+  if (value)
+    rlp_encode_item(bb, &value->value);
+  else
+    bb_write_byte(bb, 0x80);
+  wrap_list(bb, start);
+}
+
+void trie_build_root(trie_kv_t* items, int n, bytes32_t root) {
+  // empty values are not part of the trie
+  int l = 0;
+  for (int i = 0; i < n; i++) {
+    if (items[i].value.len) items[l++] = items[i];
+  }
+  if (!l) {
+    bytes_t empty = bytes((uint8_t*) "\x80", 1);
+    _sha3(&empty, root);
+    return;
+  }
+
+  // sort and remove duplicate keys
+  qsort(items, l, sizeof(trie_kv_t), cmp_kv);
+  for (int i = n = 1; i < l; i++) {
+    if (cmp_kv(items + n - 1, items + i)) n++;
+    items[n - 1] = items[i];
+  }
+  l = n;
+  bytes_builder_t* bb = bb_newl(l * 64 + 128);
+  build_node(bb, items, l, 0);
+
+  // the root is always hashed, even if it is smaller than 32 bytes.
+  bytes_t node = bytes(bb->b.data + 1, bb->b.len - 1);
+  _sha3(&node, root);
+  bb_free(bb);
+}
+
 #ifdef TRIETEST
 static void hexprint(uint8_t* a, int l) {
   (void) a; // unused param if compiled without debug
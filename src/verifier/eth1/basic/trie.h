@@ -112,6 +112,27 @@ void trie_free(trie_t* val);
  */
 void trie_set_value(trie_t* t, bytes_t* key, bytes_t* value);
 
+/**
+ * a key-value pair of a trie.
+ */
+typedef struct {
+  bytes_t key;   /**< the key */
+  bytes_t value; /**< the raw value */
+} trie_kv_t;
+
+/**
+ * calculates the root-hash of a trie containing all given key-value-pairs.
+ * 
+ * Instead of inserting each pair with `trie_set_value`, the pairs are sorted by key and the trie is built bottom-up,
+ * so each node is encoded and hashed exactly once. Siblings are hashed together.
+ * Pairs with empty values are removed and duplicate keys are merged into one pair. Since the sort is not stable,
+ * it is not defined which value is kept if the same key comes with different values.
+ *
+ * The items are sorted and compacted in place, so afterwards an index no longer refers to the same pair.
+ * The values are not owned by the trie, so callers freeing them must keep their own references.
+ */
+void trie_build_root(trie_kv_t* items, int n, bytes32_t root);
+
 #ifdef TEST
 void trie_dump(trie_t* trie, uint8_t with_hash);
 #endif
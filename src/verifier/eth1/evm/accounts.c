@@ -37,20 +37,63 @@
 #include "../../../core/util/utils.h"
 #include "big.h"
 #include "gas.h"
-#ifdef EVM_GAS
-/**
- * sets a variable value to 32byte word.
- */
+#include <string.h>
+
+#define INDEX_MIN_SIZE 8
+
+/** FNV-1a hash of the key */
+static uint32_t index_hash(uint8_t* key, wlen_t len) {
+  uint32_t h = 2166136261u;
+  for (wlen_t i = 0; i < len; i++) h = (h ^ key[i]) * 16777619u;
+  return h;
+}
+
+void* evm_index_find(evm_index_t* index, uint8_t* key, wlen_t len) {
+  if (!index->used) return NULL;
+  for (uint32_t mask = index->size - 1, i = index_hash(key, len) & mask;; i = (i + 1) & mask) {
+    uint8_t* entry = index->entries[i];
+    if (!entry) return NULL;
+    if (memcmp(entry, key, len) == 0) return entry;
+  }
+}
+
+static void index_insert(evm_index_t* index, uint8_t* entry, wlen_t len) {
+  uint32_t mask = index->size - 1, i = index_hash(entry, len) & mask;
+  while (index->entries[i]) i = (i + 1) & mask;
+  index->entries[i] = entry;
+  index->used++;
+}
+
+/** keeps the load factor below 50% */
+void evm_index_add(evm_index_t* index, void* entry, wlen_t len) {
+  if ((index->used + 1) * 2 > index->size) {
+    void**   old      = index->entries;
+    uint32_t old_size = index->size;
+    index->size       = old_size ? old_size * 2 : INDEX_MIN_SIZE;
+    index->entries    = _calloc(index->size, sizeof(void*));
+    index->used       = 0;
+    for (uint32_t i = 0; i < old_size; i++) {
+      if (old[i]) index_insert(index, old[i], len);
+    }
+    if (old) _free(old);
+  }
+  index_insert(index, entry, len);
+}
+
+void evm_index_free(evm_index_t* index) {
+  if (index->entries) _free(index->entries);
+  index->entries = NULL;
+  index->size    = 0;
+  index->used    = 0;
+}
 
+#ifdef EVM_GAS
 account_t* evm_get_account(evm_t* evm, address_t adr, wlen_t create) {
   if (!adr) return NULL;
-  account_t* ac = evm->accounts;
 
   // check if we already have the account.
-  while (ac) {
-    if (memcmp(ac->address, adr, 20) == 0) return ac;
-    ac = ac->next;
-  }
+  account_t* ac = evm_index_find(&evm->account_index, adr, 20);
+  if (ac) return ac;
 
   // if this is a internal call take it from the parent
   if (evm->parent) {
@@ -60,9 +103,11 @@ account_t* evm_get_account(evm_t* evm, address_t adr, wlen_t create) {
       // clone and add account
       account_t* a = _malloc(sizeof(account_t));
       memcpy(a, ac, sizeof(account_t));
-      a->storage    = NULL;
+      a->storage = NULL;
+      memset(&a->storage_index, 0, sizeof(evm_index_t));
       a->next       = evm->accounts;
       evm->accounts = a;
+      evm_index_add(&evm->account_index, a, 20);
       return a;
     }
   }
@@ -92,6 +137,7 @@ account_t* evm_get_account(evm_t* evm, address_t adr, wlen_t create) {
     ac->storage   = NULL;
     ac->next      = evm->accounts;
     evm->accounts = ac;
+    evm_index_add(&evm->account_index, ac, 20);
 
     // set balance & nonce
     uint256_set(balance, l_balance, ac->balance);
@@ -122,17 +168,13 @@ storage_t* evm_get_storage(evm_t* evm, address_t adr, uint8_t* s_key, wlen_t s_k
   account_t* ac = evm_get_account(evm, adr, create);
   if (!ac) return NULL;
 
-  storage_t* s = ac->storage;
-
   // create full word key
   uint8_t key_data[32], *data;
   uint256_set(s_key, s_key_len, key_data);
 
   // find existing entry
-  while (s) {
-    if (memcmp(s->key, key_data, 32) == 0) return s;
-    s = s->next;
-  }
+  storage_t* s = evm_index_find(&ac->storage_index, key_data, 32);
+  if (s) return s;
 
   // not found?, but if we have parents, we try to copy the entry from there first
   if (evm->parent) {
@@ -143,6 +185,7 @@ storage_t* evm_get_storage(evm_t* evm, address_t adr, uint8_t* s_key, wlen_t s_k
       memcpy(s, parent_s, sizeof(storage_t));
       s->next     = ac->storage;
       ac->storage = s;
+      evm_index_add(&ac->storage_index, s, 32);
       return s;
     }
   }
@@ -159,6 +202,7 @@ storage_t* evm_get_storage(evm_t* evm, address_t adr, uint8_t* s_key, wlen_t s_k
     // add to account
     s->next     = ac->storage;
     ac->storage = s;
+    evm_index_add(&ac->storage_index, s, 32);
 
     // set the value
     uint256_set(data, l, s->value);
@@ -178,79 +222,49 @@ void copy_state(evm_t* dst, evm_t* src) {
     src->logs  = NULL;
   }
 
-  account_t *sa = src->accounts, *prv = NULL;
+  // the src only contains the entries touched by the subcall, so merging them costs O(changes).
+  account_t *sa = src->accounts, *next_a, *keep_a = NULL;
   while (sa) {
-    // find the account in the dst-state
-    account_t *a = dst->accounts, *da = NULL;
-    while (a) {
-      if (memcmp(a->address, sa->address, 20) == 0) {
-        da = a;
-        break;
-      }
-      a = a->next;
-    }
+    next_a        = sa->next;
+    account_t* da = evm_index_find(&dst->account_index, sa->address, 20);
     if (!da) {
-      // the account does not exist yet, so we simply move it
-
-      // remove from src
-      if (prv == NULL)
-        src->accounts = sa->next;
-      else
-        prv->next = sa->next;
-
-      // add to dst
+      // the account does not exist yet, so we simply move it including its storage
       sa->next      = dst->accounts;
       dst->accounts = sa;
-
-      // next item...
-      sa = prv == NULL ? src->accounts : prv->next;
-      continue;
+      evm_index_add(&dst->account_index, sa, 20);
     } else {
       // clone data
       memcpy(da->balance, sa->balance, 32);
       memcpy(da->nonce, sa->nonce, 32);
       da->code = sa->code;
 
-      // clone storage
-      storage_t *ss = sa->storage, *ps = NULL, *ds, *s;
+      // merge storage
+      storage_t *ss = sa->storage, *next_s, *keep_s = NULL;
       while (ss) {
-        // find the storage in the parent
-        ds = NULL;
-        s  = da->storage;
-        while (s) {
-          if (memcmp(s->key, ss->key, 32) == 0) {
-            ds = s;
-            break;
-          }
-          s = s->next;
-        }
-
-        if (ds)
+        next_s        = ss->next;
+        storage_t* ds = evm_index_find(&da->storage_index, ss->key, 32);
+        if (ds) {
           memcpy(ds->value, ss->value, 32);
-        else {
+          ss->next = keep_s;
+          keep_s   = ss;
+        } else {
           // move the storage to the parent
-          // remove from src
-          if (ps == NULL)
-            sa->storage = ss->next;
-          else
-            ps->next = ss->next;
-
-          // add to dst
           ss->next    = da->storage;
           da->storage = ss;
-
-          // next item...
-          ss = ps == NULL ? sa->storage : ps->next;
-          continue;
+          evm_index_add(&da->storage_index, ss, 32);
         }
-
-        ps = ss;
-        ss = ss->next;
+        ss = next_s;
       }
+
+      // whatever was not moved stays in the src and will be freed with it.
+      sa->storage = keep_s;
+      sa->next    = keep_a;
+      keep_a      = sa;
     }
-    prv = sa;
-    sa  = sa->next;
+    sa = next_a;
   }
+  src->accounts = keep_a;
+  evm_index_free(&src->account_index);
 }
 
 /**
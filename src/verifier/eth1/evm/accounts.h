@@ -41,6 +41,15 @@ account_t* evm_get_account(evm_t* evm, address_t adr, wlen_t create);
 /** get account storage */
 storage_t* evm_get_storage(evm_t* evm, address_t adr, uint8_t* s_key, wlen_t s_key_len, wlen_t create);
 
+/** finds the entry starting with the given key or returns NULL. */
+void* evm_index_find(evm_index_t* index, uint8_t* key, wlen_t len);
+
+/** adds a entry, which must not be part of the index yet. */
+void evm_index_add(evm_index_t* index, void* entry, wlen_t len);
+
+/** frees the slots of the index, but not the entries. */
+void evm_index_free(evm_index_t* index);
+
 /** copy state. */
 void copy_state(evm_t* dst, evm_t* src);
 
@@ -33,11 +33,109 @@
  *******************************************************************************/
 
 #include "big.h"
+#include "../../../core/util/mem.h"
 #include "../../../core/util/utils.h"
-#include "../../../third-party/tommath/tommath.h"
 #include <stdlib.h>
 #include <string.h>
 
+/** max number of 64bit-words used for intermediate results (65 bytes as used for ADDMOD). */
+#define BIG_WORDS 9
+
+/** converts a big endian number into little endian 64bit words. */
+static void big_to_words(const uint8_t* a, uint32_t la, uint64_t* w, int n) {
+  memset(w, 0, n * sizeof(uint64_t));
+  for (uint32_t i = 0; i < la; i++) w[i >> 3] |= (uint64_t) a[la - 1 - i] << ((i & 7) << 3);
+}
+
+/** writes the words as big endian number without leading zeros and returns the length (at least 1). */
+static wlen_t words_to_big(const uint64_t* w, int n, uint8_t* dst) {
+  int l = n * 8;
+  while (l > 1 && !(uint8_t)(w[(l - 1) >> 3] >> (((l - 1) & 7) << 3))) l--;
+  for (int i = 0; i < l; i++) dst[l - 1 - i] = w[i >> 3] >> ((i & 7) << 3);
+  return l;
+}
+
+/** r = a * b, truncated to nr words. r must not overlap with a or b. */
+static void words_mul(const uint64_t* a, int na, const uint64_t* b, int nb, uint64_t* r, int nr) {
+  memset(r, 0, nr * sizeof(uint64_t));
+  for (int i = 0; i < na && i < nr; i++) {
+    uint64_t c = 0;
+    for (int j = 0; j < nb && i + j < nr; j++) r[i + j] = big_mac(a[i], b[j], r[i + j], &c);
+    if (i + nb < nr) r[i + nb] = c;
+  }
+}
+
+/**
+ * divides u (m words) by v (n words, v[n-1] != 0) using Knuth's algorithm D.
+ * q gets m words (may be NULL) and r gets n words. scratch must hold m + n + 1 words.
+ */
+static void words_divmod(const uint64_t* u, int m, const uint64_t* v, int n, uint64_t* q, uint64_t* r, uint64_t* scratch) {
+  uint64_t *un = scratch, *vn = scratch + m + 1, qhat, rhat, c, k, t, hi, lo;
+  int       s = big_clz64(v[n - 1]), i, j, overflow;
+
+  if (q) memset(q, 0, m * sizeof(uint64_t));
+  if (m < n) {
+    memcpy(r, u, m * sizeof(uint64_t));
+    memset(r + m, 0, (n - m) * sizeof(uint64_t));
+    return;
+  }
+
+  // normalize, so the highest bit of the divisor is set
+  for (i = n - 1; i > 0; i--) vn[i] = s ? (v[i] << s) | (v[i - 1] >> (64 - s)) : v[i];
+  vn[0] = v[0] << s;
+  un[m] = s ? u[m - 1] >> (64 - s) : 0;
+  for (i = m - 1; i > 0; i--) un[i] = s ? (u[i] << s) | (u[i - 1] >> (64 - s)) : u[i];
+  un[0] = u[0] << s;
+
+  for (j = m - n; j >= 0; j--) {
+    // estimate the next word of the quotient
+    if (un[j + n] >= vn[n - 1]) {
+      qhat     = UINT64_MAX;
+      rhat     = un[j + n - 1] + vn[n - 1];
+      overflow = rhat < vn[n - 1];
+    } else {
+      qhat     = big_div128(un[j + n], un[j + n - 1], vn[n - 1], &rhat);
+      overflow = 0;
+    }
+    while (n > 1 && !overflow) {
+      hi = 0;
+      lo = big_mac(qhat, vn[n - 2], 0, &hi);
+      if (hi < rhat || (hi == rhat && lo <= un[j + n - 2])) break;
+      qhat--;
+      rhat += vn[n - 1];
+      overflow = rhat < vn[n - 1];
+    }
+
+    // multiply and subtract
+    for (i = 0, c = 0, k = 0; i < n; i++) {
+      lo        = big_mac(qhat, vn[i], 0, &c);
+      t         = un[i + j] - lo;
+      hi        = t > un[i + j];
+      un[i + j] = t - k;
+      k         = hi + (un[i + j] > t);
+    }
+    t         = un[j + n] - c;
+    hi        = t > un[j + n];
+    un[j + n] = t - k;
+
+    if (hi || un[j + n] > t) {
+      // the estimate was one too big, so we add it back
+      qhat--;
+      for (i = 0, c = 0; i < n; i++) {
+        t         = un[i + j] + c;
+        c         = t < c;
+        un[i + j] = t + vn[i];
+        c += un[i + j] < t;
+      }
+      un[j + n] += c;
+    }
+    if (q) q[j] = qhat;
+  }
+
+  // denormalize the remainder
+  for (i = 0; i < n; i++) r[i] = s ? (un[i] >> s) | (un[i + 1] << (64 - s)) : un[i];
+}
+
 uint8_t big_is_zero(uint8_t* data, wlen_t l) {
   optimize_len(data, l);
   return l == 1 && !*data;
@@ -179,28 +277,43 @@ int big_mul(uint8_t* a, wlen_t la, uint8_t* b, wlen_t lb, uint8_t* res, wlen_t m
     return lr;
   }
 
-  uint8_t     out[66], *p = out;
-  uint32_t    val = 0;
-  int_fast8_t i = la + lb, xs = la - 1, ys, x, y;
-
-  for (ys = lb - 1; ys >= 0; val >>= 8, ys--) {
-    for (x = xs, y = ys; x >= 0 && y < lb; x--, y++) val += (uint32_t) a[x] * b[y];
-    out[--i] = val & 0xFF;
+  if (la > 32 || lb > 32) return -1;
+
+  uint64_t x[4], y[4], r[8];
+  uint8_t  out[64];
+  int      nr = max < 57 ? (max + 7) / 8 : 8;
+  big_to_words(a, la, x, 4);
+  big_to_words(b, lb, y, 4);
+  words_mul(x, 4, y, 4, r, nr);
+  wlen_t l = words_to_big(r, nr, out);
+  if (l > max) {
+    memcpy(res, out + l - max, max);
+    return max;
   }
+  memcpy(res, out, l);
+  return l;
+}
 
-  for (ys = 0, xs = la - 2; xs >= 0; xs--, val >>= 8) {
-    for (x = xs, y = ys; x >= 0 && y < lb; x--, y++) val += (uint32_t) a[x] * b[y];
-    out[--i] = val & 0xFF;
+int big_mulmod(uint8_t* a, wlen_t la, uint8_t* b, wlen_t lb, uint8_t* m, wlen_t lm, uint8_t* res) {
+  optimize_len(a, la);
+  optimize_len(b, lb);
+  optimize_len(m, lm);
+  if (la > 32 || lb > 32 || lm > 32) return -1;
+  if (lm == 1 && *m == 0) {
+    *res = 0;
+    return 1;
   }
-  out[--i] = val & 0xFF;
-  i        = la + lb;
-  optimize_len(p, i);
-  if (i > max) {
-    memcpy(res, p + i - max, max);
-    i = max;
-  } else
-    memcpy(res, p, i);
-  return i;
+
+  // the full 512 bit product is reduced with a single division, since a barrett or montgomery reduction
+  // would need a precomputation as expensive as the division for every new modulus.
+  uint64_t x[4], y[4], p[8], mw[4], r[4], scratch[13];
+  int      k = (lm + 7) / 8;
+  big_to_words(a, la, x, 4);
+  big_to_words(b, lb, y, 4);
+  big_to_words(m, lm, mw, k);
+  words_mul(x, 4, y, 4, p, 8);
+  words_divmod(p, 8, mw, k, NULL, r, scratch);
+  return words_to_big(r, k, res);
 }
 
 int big_bitlen(uint8_t* a, wlen_t la) {
@@ -245,41 +358,37 @@ int big_exp(uint8_t* a, wlen_t la, uint8_t* b, wlen_t lb, uint8_t* res) {
     }
     if (p != res) memmove(res, p, l);
     return l;
-  } else {
-    uint8_t mod[33];
-    memset(mod + 1, 0, 32);
-    *mod = 1;
-
-    // we use gmp for now
-    mp_int ma, mb, mc, mm;
-    mp_init(&ma);
-    mp_init(&mb);
-    mp_init(&mc);
-    mp_init(&mm);
-
-    // Convert the 1024-bit number 'input' into an mpz_t, with the most significant byte
-    // first and using native endianness within each byte.
-    mp_import(&ma, la, 1, sizeof(uint8_t), 1, 0, a);
-    mp_import(&mb, lb, 1, sizeof(uint8_t), 1, 0, b);
-    mp_import(&mm, 33, 1, sizeof(uint8_t), 1, 0, mod);
-
-    ma.sign = mb.sign = mc.sign = 0;
-    mp_exptmod(&ma, &mb, &mm, &mc);
-    size_t ml;
-    mp_export(res, &ml, 1, sizeof(uint8_t), 1, 0, &mc);
-
-    mp_clear(&ma);
-    mp_clear(&mb);
-    mp_clear(&mc);
-    mp_clear(&mm);
-
-    if (ml == 0) {
-      *res = 0;
-      return 1;
-    }
+  }
 
-    return ml;
+  // windowed exponentiation with 4 bit windows modulo 2^256
+  uint64_t table[16][4], x[4], t[4];
+  int      started = 0;
+  if (la > 32) {
+    a += la - 32;
+    la = 32;
   }
+  big_to_words(a, la, table[1], 4);
+  for (int i = 2; i < 16; i++) words_mul(table[i - 1], 4, table[1], 4, table[i], 4);
+
+  for (wlen_t i = 0; i < lb; i++) {
+    for (int n = 0; n < 2; n++) {
+      uint8_t w = n ? b[i] & 0xF : b[i] >> 4;
+      if (started) {
+        for (int k = 0; k < 4; k++) {
+          words_mul(x, 4, x, 4, t, 4);
+          memcpy(x, t, sizeof(x));
+        }
+        if (w) {
+          words_mul(x, 4, table[w], 4, t, 4);
+          memcpy(x, t, sizeof(x));
+        }
+      } else if (w) {
+        memcpy(x, table[w], sizeof(x));
+        started = 1;
+      }
+    }
+  }
+  return words_to_big(x, 4, res);
 }
 
 int big_log256(uint8_t* a, wlen_t len) {
@@ -291,149 +400,42 @@ int big_log256(uint8_t* a, wlen_t len) {
 }
 
 int big_divmod(uint8_t* n, wlen_t ln, uint8_t* d, wlen_t ld, uint8_t* q, wlen_t* qlen, uint8_t* remain, wlen_t* remain_len) {
-  int_fast8_t j, i;
-  wlen_t      l = 8;
+  wlen_t l = 8;
 
   optimize_len(n, ln);
   optimize_len(d, ld);
 
-  if (ld < 8) {
-    // we can use long here
-    uint64_t ur = 0, ud = bytes_to_long(d, ld);
-    uint8_t  pp[8], *p  = pp;
-
-    if (ln < 9) {
-      // shortcurt for pure long operation
-      ur = bytes_to_long(n, ln);
-      long_to_bytes(ur / ud, p);
-      optimize_len(p, l);
+  if (ln < 9 && ld < 9) {
+    // shortcurt for pure long operation
+    uint64_t ur = bytes_to_long(n, ln), ud = bytes_to_long(d, ld);
+    uint8_t  pp[8], *p = pp;
+    long_to_bytes(ur / ud, p);
+    optimize_len(p, l);
+    if (q) {
       memcpy(q, p, l);
       *qlen = l;
-      l     = 8;
-      p     = pp;
-      long_to_bytes(ur % ud, p);
-      optimize_len(p, l);
-      if (remain) {
-        memcpy(remain, p, l);
-        *remain_len = l;
-      }
-      return 0;
     }
-
-    // iterate over n with divisor as long
-    for (i = 0, j = -1; i < ln; i++) {
-      ur = (ur << 8) | n[i];
-      if (ur < ud) {
-        if (j >= 0) q[++j] = 0;
-      } else {
-        q[++j] = ur / ud;
-        ur     = ur % ud;
-      }
-    }
-
-    *qlen = j + 1;
-    long_to_bytes(ur, p);
+    l = 8;
+    p = pp;
+    long_to_bytes(ur % ud, p);
     optimize_len(p, l);
     if (remain) {
       memcpy(remain, p, l);
       *remain_len = l;
     }
     return 0;
-  } else {
-    size_t ql, rl;
-
-    mp_int mq, mr, mn, md;
-    mp_init(&mq);
-    mp_init(&mr);
-    mp_init(&mn);
-    mp_init(&md);
-
-    mp_import(&mn, ln, 1, sizeof(uint8_t), 1, 0, n);
-    mp_import(&md, ld, 1, sizeof(uint8_t), 1, 0, d);
-
-    if (remain && q)
-      mp_div(&mn, &md, &mq, &mr);
-    else if (remain)
-      mp_div(&mn, &md, NULL, &mr);
-    else
-      mp_div(&mn, &md, &mq, NULL);
-
-    if (q) {
-      mp_export(q, &ql, 1, sizeof(uint8_t), 1, 0, &mq);
-      *qlen = ql;
-      if (!ql) {
-        *q    = 0;
-        *qlen = 1;
-      }
-    }
-    if (remain) {
-      mp_export(remain, &rl, 1, sizeof(uint8_t), 1, 0, &mr);
-      *remain_len = rl;
-      if (!rl) {
-        *remain     = 0;
-        *remain_len = 1;
-      }
-    }
-
-    mp_clear(&mq);
-    mp_clear(&mr);
-    mp_clear(&mn);
-    mp_clear(&md);
+  }
 
-    return 0;
+  if (ln > BIG_WORDS * 8 || ld > BIG_WORDS * 8) return -1;
 
-    /*
-
-
-    uint8_t      row[32], tmp[33], tmp2[33];
-    wlen_t val, min, max;
-    int          res;
-    memset(row, 0, 32);
-
-    for (i = 0, j = -1; i < ln; i++) {
-      memmove(row, row + 1, 31);
-      row[31] = n[i];
-      if (big_cmp(row, 32, d, ld) < 0) {
-        if (j >= 0) q[++j] = 0;
-      } else {
-        val = 128;
-        min = 1;
-        max = 255;
-        while (true) {
-          TRY(l = big_mul(&val, 1, d, ld, tmp, 33))
-          res = big_cmp(row, 32, tmp, l);
-          if (res < 0) {
-            max = val;
-            val = min + (max - min) / 2;
-            if (val == min) break;
-          } else if (res > 0) {
-            min = val;
-            val = min + (max - min) / 2;
-            if (val == min) val++;
-          } else
-            break;
-        }
-        q[++j] = val;
-        if (res) {
-          TRY(l = big_mul(&val, 1, d, ld, tmp, 33))
-          TRY(l = big_sub(row, 32, tmp, l, tmp2))
-          memset(row, 0, 32);
-          memcpy(row + 32 - l, tmp2, l);
-        } else
-          memset(row, 0, 32);
-      }
-    }
+  uint64_t un[BIG_WORDS], vn[BIG_WORDS], qw[BIG_WORDS], rw[BIG_WORDS], scratch[2 * BIG_WORDS + 1];
+  int      m = (ln + 7) / 8, k = (ld + 7) / 8;
+  big_to_words(n, ln, un, m);
+  big_to_words(d, ld, vn, k);
+  words_divmod(un, m, vn, k, q ? qw : NULL, rw, scratch);
 
-    uint8_t*     p  = row;
-    wlen_t pl = 32;
-    optimize_len(p, pl);
-    if (remain) {
-      memcpy(remain, p, pl);
-      *remain_len = pl;
-    }
-    *qlen = j + 1;
-  */
-  }
+  if (q) *qlen = words_to_big(qw, m, q);
+  if (remain) *remain_len = words_to_big(rw, k, remain);
   return 0;
 }
 
@@ -527,3 +529,212 @@ int big_mod(uint8_t* a, wlen_t la, uint8_t* b, wlen_t lb, wlen_t sig, uint8_t* r
   TRY(big_divmod(a, la, b, lb, tmp, &l2, res, &l));
   return l;
 }
+
+/** state of a modexp-operation. All buffers are taken from one arena. */
+typedef struct modexp {
+  const uint64_t* m;       /**< the modulus */
+  int             n;       /**< number of words of the modulus */
+  uint64_t        m_inv;   /**< -m^-1 mod 2^64 for montgomery multiplication */
+  uint64_t        mask;    /**< mask for the highest word if the modulus is a power of 2 */
+  uint64_t*       t;       /**< scratch for products (2n + 2 words) */
+  uint64_t*       scratch; /**< scratch for the division (3n + 2 words) */
+  void (*mul)(struct modexp* ctx, uint64_t* r, const uint64_t* a, const uint64_t* b);
+} modexp_t;
+
+/** r = a * b * R^-1 mod m (montgomery multiplication, CIOS) */
+static inline void mont_mul(modexp_t* ctx, const int n, uint64_t* r, const uint64_t* a, const uint64_t* b) {
+  const uint64_t* m = ctx->m;
+  uint64_t *      t = ctx->t, c, u;
+  memset(t, 0, (n + 2) * sizeof(uint64_t));
+  for (int i = 0; i < n; i++) {
+    c = 0;
+    for (int j = 0; j < n; j++) t[j] = big_mac(a[j], b[i], t[j], &c);
+    t[n] += c;
+    t[n + 1] = t[n] < c;
+
+    u = t[0] * ctx->m_inv;
+    c = 0;
+    big_mac(u, m[0], t[0], &c);
+    for (int j = 1; j < n; j++) t[j - 1] = big_mac(u, m[j], t[j], &c);
+    t[n - 1] = t[n] + c;
+    t[n]     = t[n + 1] + (t[n - 1] < c);
+  }
+
+  // the result is smaller than 2m, so we may need to subtract m once
+  uint64_t borrow = 0, d;
+  for (int i = 0; i < n; i++) {
+    d      = t[i] - m[i];
+    r[i]   = d - borrow;
+    borrow = (t[i] < m[i]) | (d < borrow);
+  }
+  if (borrow && !t[n]) memcpy(r, t, n * sizeof(uint64_t));
+}
+
+/** montgomery multiplication for any length. */
+static void modexp_mul_mont(modexp_t* ctx, uint64_t* r, const uint64_t* a, const uint64_t* b) {
+  mont_mul(ctx, ctx->n, r, a, b);
+}
+
+/** fast path for moduli up to 256 bits, where the compiler can unroll the loops. */
+static void modexp_mul_mont4(modexp_t* ctx, uint64_t* r, const uint64_t* a, const uint64_t* b) {
+  mont_mul(ctx, 4, r, a, b);
+}
+
+/** r = a * b mod 2^k */
+static void modexp_mul_pow2(modexp_t* ctx, uint64_t* r, const uint64_t* a, const uint64_t* b) {
+  words_mul(a, ctx->n, b, ctx->n, ctx->t, ctx->n);
+  ctx->t[ctx->n - 1] &= ctx->mask;
+  memcpy(r, ctx->t, ctx->n * sizeof(uint64_t));
+}
+
+/** r = a * b mod m for even moduli using a full product and a division */
+static void modexp_mul_div(modexp_t* ctx, uint64_t* r, const uint64_t* a, const uint64_t* b) {
+  words_mul(a, ctx->n, b, ctx->n, ctx->t, 2 * ctx->n);
+  words_divmod(ctx->t, 2 * ctx->n, ctx->m, ctx->n, NULL, r, ctx->scratch);
+}
+
+/** reduces a big endian number of any length modulo m, by adding one word after the other. */
+static void modexp_reduce(modexp_t* ctx, const uint8_t* data, uint32_t len, uint64_t* r) {
+  const int n = ctx->n;
+  uint64_t* t = ctx->t;
+  memset(r, 0, n * sizeof(uint64_t));
+  for (uint32_t first = len % 8 ? len % 8 : 8; len; data += first, len -= first, first = 8) {
+    memcpy(t + 1, r, n * sizeof(uint64_t));
+    t[0] = bytes_to_long(data, first);
+    words_divmod(t, n + 1, ctx->m, n, NULL, r, ctx->scratch);
+  }
+}
+
+/** returns the window size for the sliding window exponentiation. */
+static int modexp_window(uint64_t bits) {
+  return bits > 671 ? 6 : (bits > 239 ? 5 : (bits > 79 ? 4 : (bits > 23 ? 3 : 1)));
+}
+
+/** number of words for the scratch arena, which fits on the stack for moduli up to 256 bits. */
+#define MODEXP_STACK_WORDS 256
+
+int big_modexp(const uint8_t* base, uint32_t l_base, const uint8_t* exp, uint32_t l_exp, const uint8_t* mod, uint32_t l_mod, uint8_t* res) {
+  const uint8_t* m_data = mod;
+  uint32_t       lm     = l_mod;
+  memset(res, 0, l_mod);
+  while (lm && !*m_data) {
+    m_data++;
+    lm--;
+  }
+  while (l_exp && !*exp) {
+    exp++;
+    l_exp--;
+  }
+  while (l_base && !*base) {
+    base++;
+    l_base--;
+  }
+  // x % 0 = 0 and x % 1 = 0
+  if (!lm || (lm == 1 && *m_data == 1)) return 0;
+  // x^0 = 1
+  if (!l_exp) {
+    res[l_mod - 1] = 1;
+    return 0;
+  }
+
+  modexp_t  ctx;
+  uint64_t  bits  = (uint64_t) l_exp * 8 - big_clz64(*exp) + 56;
+  int       w     = modexp_window(bits), n = (lm + 7) / 8, pow2 = 0;
+  uint32_t  words = n * ((1 << (w - 1)) + 8) + 4, i;
+  uint64_t  stack[MODEXP_STACK_WORDS], *arena = words > MODEXP_STACK_WORDS ? _malloc(words * sizeof(uint64_t)) : stack;
+  uint64_t *m = arena, *x = m + n, *g = x + n, *table = g + n;
+
+  ctx.n       = n;
+  ctx.m       = m;
+  ctx.t       = table + (n << (w - 1));
+  ctx.scratch = ctx.t + 2 * n + 2;
+  big_to_words(m_data, lm, m, n);
+
+  // check for a power of 2
+  if ((*m_data & (*m_data - 1)) == 0) {
+    for (pow2 = 1, i = 1; i < lm && pow2; i++) pow2 = !m_data[i];
+  }
+
+  if (pow2) {
+    // we only need to truncate the products
+    uint32_t k  = (lm - 1) * 8 + 63 - big_clz64(*m_data);
+    uint32_t lb = l_base > (k + 7) / 8 ? (k + 7) / 8 : l_base;
+    ctx.mul     = modexp_mul_pow2;
+    ctx.n       = n = (k + 63) / 64;
+    ctx.mask    = k % 64 ? (1ULL << (k % 64)) - 1 : UINT64_MAX;
+    big_to_words(base + l_base - lb, lb, g, n);
+    g[n - 1] &= ctx.mask;
+    memset(x, 0, n * sizeof(uint64_t));
+    x[0] = 1;
+  } else if (m[0] & 1) {
+    // odd modulus: montgomery multiplication with R = 2^(64n)
+    uint64_t inv = 1;
+    for (i = 0; i < 6; i++) inv *= 2 - m[0] * inv;
+    ctx.m_inv = -inv;
+    ctx.mul   = n == 4 ? modexp_mul_mont4 : modexp_mul_mont;
+
+    // x = R mod m and R^2 mod m
+    uint8_t one = 1;
+    modexp_reduce(&ctx, &one, 1, x);
+    for (int k = 0; k < n; k++) {
+      memcpy(ctx.t + 1, x, n * sizeof(uint64_t));
+      ctx.t[0] = 0;
+      words_divmod(ctx.t, n + 1, m, n, NULL, x, ctx.scratch);
+    }
+    memcpy(table, x, n * sizeof(uint64_t));
+    for (int k = 0; k < n; k++) {
+      memcpy(ctx.t + 1, table, n * sizeof(uint64_t));
+      ctx.t[0] = 0;
+      words_divmod(ctx.t, n + 1, m, n, NULL, table, ctx.scratch);
+    }
+    // g = base * R mod m
+    modexp_reduce(&ctx, base, l_base, g);
+    modexp_mul_mont(&ctx, g, g, table);
+  } else {
+    ctx.mul = modexp_mul_div;
+    modexp_reduce(&ctx, base, l_base, g);
+    memset(x, 0, n * sizeof(uint64_t));
+    x[0] = 1;
+  }
+
+  // table of the odd powers g, g^3, g^5, ...
+  memcpy(table, g, n * sizeof(uint64_t));
+  if (w > 1) {
+    ctx.mul(&ctx, g, g, g);
+    for (i = 1; i < (1U << (w - 1)); i++) ctx.mul(&ctx, table + i * n, table + (i - 1) * n, g);
+  }
+
+  // sliding window from the highest bit
+  for (int64_t b = bits - 1; b >= 0;) {
+    int bit = (exp[l_exp - 1 - (b >> 3)] >> (b & 7)) & 1;
+    if (!bit) {
+      ctx.mul(&ctx, x, x, x);
+      b--;
+      continue;
+    }
+    // find the longest window ending with a 1
+    int     len = 1, val = 1;
+    int64_t e   = b - w + 1 < 0 ? 0 : b - w + 1;
+    for (int64_t k = e; k < b; k++) {
+      if ((exp[l_exp - 1 - (k >> 3)] >> (k & 7)) & 1) {
+        len = (int) (b - k) + 1;
+        break;
+      }
+    }
+    for (int k = 1; k < len; k++) val = (val << 1) | ((exp[l_exp - 1 - ((b - k) >> 3)] >> ((b - k) & 7)) & 1);
+    for (int k = 0; k < len; k++) ctx.mul(&ctx, x, x, x);
+    ctx.mul(&ctx, x, x, table + (val >> 1) * n);
+    b -= len;
+  }
+
+  // convert back from montgomery form
+  if (ctx.mul == modexp_mul_mont || ctx.mul == modexp_mul_mont4) {
+    memset(g, 0, n * sizeof(uint64_t));
+    g[0] = 1;
+    modexp_mul_mont(&ctx, x, x, g);
+  }
+
+  for (i = 0; i < (uint32_t) n * 8 && i < l_mod; i++) res[l_mod - 1 - i] = x[i >> 3] >> ((i & 7) << 3);
+  if (arena != stack) _free(arena);
+  return 0;
+}
@@ -51,8 +51,76 @@ int32_t big_int(uint8_t* val, wlen_t len);
 int     big_add(uint8_t* a, wlen_t len_a, uint8_t* b, wlen_t len_b, uint8_t* out, wlen_t max);
 int     big_sub(uint8_t* a, wlen_t len_a, uint8_t* b, wlen_t len_b, uint8_t* out);
 int     big_mul(uint8_t* a, wlen_t la, uint8_t* b, wlen_t lb, uint8_t* res, wlen_t max);
+int     big_mulmod(uint8_t* a, wlen_t la, uint8_t* b, wlen_t lb, uint8_t* m, wlen_t lm, uint8_t* res);
 int     big_div(uint8_t* a, wlen_t la, uint8_t* b, wlen_t lb, wlen_t sig, uint8_t* res);
 int     big_mod(uint8_t* a, wlen_t la, uint8_t* b, wlen_t lb, wlen_t sig, uint8_t* res);
 int     big_exp(uint8_t* a, wlen_t la, uint8_t* b, wlen_t lb, uint8_t* res);
 int     big_log256(uint8_t* a, wlen_t len);
+
+/** computes base^exp % mod for numbers of any length and writes exactly l_mod bytes (big endian) to res. */
+int big_modexp(const uint8_t* base, uint32_t l_base, const uint8_t* exp, uint32_t l_exp, const uint8_t* mod, uint32_t l_mod, uint8_t* res);
+
+/* helpers for arithmetic on little endian 64bit words. */
+
+#ifdef __SIZEOF_INT128__
+/** returns the lower word of a * b + c + carry and stores the upper word in carry. */
+static inline uint64_t big_mac(uint64_t a, uint64_t b, uint64_t c, uint64_t* carry) {
+  unsigned __int128 r = (unsigned __int128) a * b + c + *carry;
+  *carry      = r >> 64;
+  return (uint64_t) r;
+}
+
+/** divides (hi,lo) by d and returns the quotient. hi must be smaller than d. */
+static inline uint64_t big_div128(uint64_t hi, uint64_t lo, uint64_t d, uint64_t* rest) {
+  unsigned __int128 n = ((unsigned __int128) hi << 64) | lo;
+  *rest       = (uint64_t)(n % d);
+  return (uint64_t)(n / d);
+}
+#else
+static inline uint64_t big_mac(uint64_t a, uint64_t b, uint64_t c, uint64_t* carry) {
+  uint64_t al = a & 0xFFFFFFFF, ah = a >> 32, bl = b & 0xFFFFFFFF, bh = b >> 32;
+  uint64_t ll = al * bl, lh = al * bh, hl = ah * bl;
+  uint64_t mid = (ll >> 32) + (lh & 0xFFFFFFFF) + (hl & 0xFFFFFFFF);
+  uint64_t lo  = (ll & 0xFFFFFFFF) | (mid << 32);
+  uint64_t hi  = ah * bh + (lh >> 32) + (hl >> 32) + (mid >> 32);
+  lo += c;
+  hi += lo < c;
+  lo += *carry;
+  hi += lo < *carry;
+  *carry = hi;
+  return lo;
+}
+
+/** divides (hi,lo) by d (Hacker's Delight divlu). d must be normalized (highest bit set) and hi < d. */
+static inline uint64_t big_div128(uint64_t hi, uint64_t lo, uint64_t d, uint64_t* rest) {
+  const uint64_t b = 1ULL << 32;
+  uint64_t       dh = d >> 32, dl = d & 0xFFFFFFFF, l1 = lo >> 32, l0 = lo & 0xFFFFFFFF, q1, q0, rhat, un21;
+
+  q1   = hi / dh;
+  rhat = hi - q1 * dh;
+  while (q1 >= b || q1 * dl > b * rhat + l1) {
+    q1--;
+    if ((rhat += dh) >= b) break;
+  }
+  un21 = hi * b + l1 - q1 * d;
+  q0   = un21 / dh;
+  rhat = un21 - q0 * dh;
+  while (q0 >= b || q0 * dl > b * rhat + l0) {
+    q0--;
+    if ((rhat += dh) >= b) break;
+  }
+  *rest = un21 * b + l0 - q0 * d;
+  return q1 * b + q0;
+}
+#endif
+
+static inline int big_clz64(uint64_t x) {
+#if defined(__GNUC__) || defined(__clang__)
+  return __builtin_clzll(x);
+#else
+  int n = 0;
+  for (; !(x & 0x8000000000000000ULL); x <<= 1) n++;
+  return n;
+#endif
+}
 #endif
\ No newline at end of file
@@ -0,0 +1,1028 @@
+/*******************************************************************************
+ * This file is part of the Incubed project.
+ * Sources: https://github.com/slockit/in3-c
+ * 
+ * Copyright (C) 2018-2019 slock.it GmbH, Blockchains LLC
+ * 
+ * 
+ * COMMERCIAL LICENSE USAGE
+ * 
+ * Licensees holding a valid commercial license may use this file in accordance 
+ * with the commercial license agreement provided with the Software or, alternatively, 
+ * in accordance with the terms contained in a written agreement between you and 
+ * slock.it GmbH/Blockchains LLC. For licensing terms and conditions or further 
+ * information please contact slock.it at in3@slock.it.
+ * 	
+ * Alternatively, this file may be used under the AGPL license as follows:
+ *    
+ * AGPL LICENSE USAGE
+ * 
+ * This program is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Affero General Public License as published by the Free Software 
+ * Foundation, either version 3 of the License, or (at your option) any later version.
+ *  
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY 
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A 
+ * PARTICULAR PURPOSE. See the GNU Affero General Public License for more details.
+ * [Permissions of this strong copyleft license are conditioned on making available 
+ * complete source code of licensed works and modifications, which include larger 
+ * works using a licensed work, under the same license. Copyright and license notices 
+ * must be preserved. Contributors provide an express grant of patent rights.]
+ * You should have received a copy of the GNU Affero General Public License along 
+ * with this program. If not, see <https://www.gnu.org/licenses/>.
+ *******************************************************************************/
+
+#include "bn254.h"
+#include "../../../core/util/utils.h"
+#include "big.h"
+#include <string.h>
+
+typedef struct {
+  uint64_t v[4];
+} fp_t; /**< element of Fp in montgomery form (little endian words) */
+
+typedef struct {
+  fp_t a, b;
+} fp2_t; /**< a + b*u with u^2 = -1 */
+
+typedef struct {
+  fp2_t c0, c1, c2;
+} fp6_t; /**< c0 + c1*v + c2*v^2 with v^3 = 9 + u */
+
+typedef struct {
+  fp6_t c0, c1;
+} fp12_t; /**< c0 + c1*w with w^2 = v */
+
+typedef struct {
+  fp_t x, y, z;
+} g1_t; /**< jacobian coordinates, z = 0 is the point at infinity */
+
+typedef struct {
+  fp2_t x, y, z;
+} g2_t; /**< jacobian coordinates on the twist, z = 0 is the point at infinity */
+
+typedef struct {
+  fp2_t x, y;
+} g2_affine_t;
+
+// constants
+static const uint64_t BN_P[4]  = {0x3c208c16d87cfd47ULL, 0x97816a916871ca8dULL, 0xb85045b68181585dULL, 0x30644e72e131a029ULL};
+static const uint64_t BN_R[4]  = {0x43e1f593f0000001ULL, 0x2833e84879b97091ULL, 0xb85045b68181585dULL, 0x30644e72e131a029ULL};
+static const uint64_t BN_INV   = 0x87d20782e4866389ULL; /**< -p^-1 mod 2^64 */
+static const uint64_t BN_X     = 0x44e992b44a6909f1ULL; /**< the curve parameter x */
+static const fp_t     FP_R2    = {{0xf32cfc5b538afa89ULL, 0xb5e71911d44501fbULL, 0x47ab1eff0a417ff6ULL, 0x06d89f71cab8351fULL}};
+static const fp_t     FP_ONE   = {{0xd35d438dc58f0d9dULL, 0x0a78eb28f5c70b3dULL, 0x666ea36f7879462cULL, 0x0e0a77c19a07df2fULL}};
+static const fp_t     FP_B     = {{0x7a17caa950ad28d7ULL, 0x1f6ac17ae15521b9ULL, 0x334bea4e696bd284ULL, 0x2a1f6744ce179d8eULL}};
+static const fp_t     FP_2_INV = {{0x87bee7d24f060572ULL, 0xd0fd2add2f1c6ae5ULL, 0x8f5f7492fcfd4f44ULL, 0x1f37631a3d9cbfacULL}};
+
+/** b / (9 + u) of the twisted curve */
+static const fp2_t TWIST_B = {{{0x3bf938e377b802a8ULL, 0x020b1b273633535dULL, 0x26b7edf049755260ULL, 0x2514c6324384a86dULL}}, {{0x38e7ecccd1dcff67ULL, 0x65f0b37d93ce0d3eULL, 0xd749d0dd22ac00aaULL, 0x0141b9ce4a688d4dULL}}};
+
+/** (9 + u)^((p^k - 1) / 3) for k = 1..3 */
+static const fp2_t FROB6_C1[3] = {
+    {{{0xb5773b104563ab30ULL, 0x347f91c8a9aa6454ULL, 0x7a007127242e0991ULL, 0x1956bcd8118214ecULL}}, {{0x6e849f1ea0aa4757ULL, 0xaa1c7b6d89f89141ULL, 0xb6e713cdfae0ca3aULL, 0x26694fbb4e82ebc3ULL}}},
+    {{{0x3350c88e13e80b9cULL, 0x7dce557cdb5e56b9ULL, 0x6001b4b8b615564aULL, 0x2682e617020217e0ULL}}, {{0, 0, 0, 0}}},
+    {{{0xc9af22f716ad6badULL, 0xb311782a4aa662b2ULL, 0x19eeaf64e248c7f4ULL, 0x20273e77e3439f82ULL}}, {{0xacc02860f7ce93acULL, 0x3933d5817ba76b4cULL, 0x69e6188b446c8467ULL, 0x0a46036d4417cc55ULL}}}};
+
+/** (9 + u)^((2p^k - 2) / 3) for k = 1..3 */
+static const fp2_t FROB6_C2[3] = {
+    {{{0x7361d77f843abe92ULL, 0xa5bb2bd3273411fbULL, 0x9c941f314b3e2399ULL, 0x15df9cddbb9fd3ecULL}}, {{0x5dddfd154bd8c949ULL, 0x62cb29a5a4445b60ULL, 0x37bc870a0c7dd2b9ULL, 0x24830a9d3171f0fdULL}}},
+    {{{0x71930c11d782e155ULL, 0xa6bb947cffbe3323ULL, 0xaa303344d4741444ULL, 0x2c3b3f0d26594943ULL}}, {{0, 0, 0, 0}}},
+    {{{0x448a93a57b6762dfULL, 0xbfd62df528fdeadfULL, 0xd858f5d00e9bd47aULL, 0x06b03d4d3476ec58ULL}}, {{0x2b19daf4bcc936d1ULL, 0xa1a54e7a56f4299fULL, 0xb533eee05adeaef1ULL, 0x170c812b84dda0b2ULL}}}};
+
+/** (9 + u)^((p^k - 1) / 6) for k = 1..3 */
+static const fp2_t FROB12_C1[3] = {
+    {{{0xaf9ba69633144907ULL, 0xca6b1d7387afb78aULL, 0x11bded5ef08a2087ULL, 0x02f34d751a1f3a7cULL}}, {{0xa222ae234c492d72ULL, 0xd00f02a4565de15bULL, 0xdc2ff3a253dfc926ULL, 0x10a75716b3899551ULL}}},
+    {{{0xca8d800500fa1bf2ULL, 0xf0c5d61468b39769ULL, 0x0e201271ad0d4418ULL, 0x04290f65bad856e6ULL}}, {{0, 0, 0, 0}}},
+    {{{0x365316184e46d97dULL, 0x0af7129ed4c96d9fULL, 0x659da72fca1009b5ULL, 0x08116d8983a20d23ULL}}, {{0xb1df4af7c39c1939ULL, 0x3d9f02878a73bf7fULL, 0x9b2220928caf0ae0ULL, 0x26684515eff054a6ULL}}}};
+
+/** the frobenius endomorphism on the twist: (9 + u)^((p - 1) / 3) and (9 + u)^((p - 1) / 2) */
+static const fp2_t TWIST_Q_X = {{{0xb5773b104563ab30ULL, 0x347f91c8a9aa6454ULL, 0x7a007127242e0991ULL, 0x1956bcd8118214ecULL}}, {{0x6e849f1ea0aa4757ULL, 0xaa1c7b6d89f89141ULL, 0xb6e713cdfae0ca3aULL, 0x26694fbb4e82ebc3ULL}}};
+static const fp2_t TWIST_Q_Y = {{{0xe4bbdd0c2936b629ULL, 0xbb30f162e133bacbULL, 0x31a9d1b6f9645366ULL, 0x253570bea500f8ddULL}}, {{0xa1d77ce45ffe77c7ULL, 0x07affd117826d1dbULL, 0x6d16bd27bb7edc6bULL, 0x2c87200285defeccULL}}};
+
+/** 6x + 2 in non-adjacent form (little endian) for the miller loop */
+static const int8_t ATE_LOOP[66] = {0, 0, 0, 1, 0, 1, 0, -1, 0, 0, -1, 0, 0, 0, 1, 0, 0, -1, 0, -1, 0, 0, 0, 1, 0, -1, 0, 0, 0, 0, -1, 0, 0, 1, 0, -1, 0, 0, 1, 0, 0, 0, 0, 0, -1, 0, 0, -1, 0, 1, 0, -1, 0, 0, 0, -1, 0, -1, 0, 0, 0, 1, 0, -1, 0, 1};
+
+// ---- Fp ----
+
+static inline uint64_t adc(uint64_t a, uint64_t b, uint64_t* carry) {
+  uint64_t r = a + *carry, c = r < a;
+  r += b;
+  *carry = c + (r < b);
+  return r;
+}
+
+static inline uint64_t sbb(uint64_t a, uint64_t b, uint64_t* borrow) {
+  uint64_t t = a - b, r = t - *borrow;
+  *borrow = (a < b) | (t < *borrow);
+  return r;
+}
+
+/** subtracts p if the value (with an additional carry word) is not smaller than p. */
+static inline void fp_reduce(uint64_t* v, uint64_t carry) {
+  uint64_t t[4], borrow = 0;
+  for (int i = 0; i < 4; i++) t[i] = sbb(v[i], BN_P[i], &borrow);
+  if (carry || !borrow) memcpy(v, t, sizeof(t));
+}
+
+static inline void fp_add(fp_t* r, const fp_t* a, const fp_t* b) {
+  uint64_t carry = 0;
+  for (int i = 0; i < 4; i++) r->v[i] = adc(a->v[i], b->v[i], &carry);
+  fp_reduce(r->v, carry);
+}
+
+static inline void fp_sub(fp_t* r, const fp_t* a, const fp_t* b) {
+  uint64_t borrow = 0, carry = 0;
+  for (int i = 0; i < 4; i++) r->v[i] = sbb(a->v[i], b->v[i], &borrow);
+  if (borrow) {
+    for (int i = 0; i < 4; i++) r->v[i] = adc(r->v[i], BN_P[i], &carry);
+  }
+}
+
+static inline int fp_is_zero(const fp_t* a) {
+  return !(a->v[0] | a->v[1] | a->v[2] | a->v[3]);
+}
+
+static inline void fp_neg(fp_t* r, const fp_t* a) {
+  if (fp_is_zero(a))
+    *r = *a;
+  else {
+    uint64_t borrow = 0;
+    for (int i = 0; i < 4; i++) r->v[i] = sbb(BN_P[i], a->v[i], &borrow);
+  }
+}
+
+static inline int fp_eq(const fp_t* a, const fp_t* b) {
+  return !memcmp(a, b, sizeof(fp_t));
+}
+
+/** montgomery multiplication (CIOS) */
+static void fp_mul(fp_t* r, const fp_t* a, const fp_t* b) {
+  uint64_t t[6] = {0}, c, m;
+  for (int i = 0; i < 4; i++) {
+    c = 0;
+    for (int j = 0; j < 4; j++) t[j] = big_mac(a->v[j], b->v[i], t[j], &c);
+    t[4] += c;
+    t[5] = t[4] < c;
+
+    m = t[0] * BN_INV;
+    c = 0;
+    big_mac(m, BN_P[0], t[0], &c);
+    for (int j = 1; j < 4; j++) t[j - 1] = big_mac(m, BN_P[j], t[j], &c);
+    t[3] = t[4] + c;
+    t[4] = t[5] + (t[3] < c);
+  }
+  memcpy(r->v, t, 4 * sizeof(uint64_t));
+  fp_reduce(r->v, t[4]);
+}
+
+static inline void fp_sqr(fp_t* r, const fp_t* a) {
+  fp_mul(r, a, a);
+}
+
+/** a^(p-2) */
+static void fp_inv(fp_t* r, const fp_t* a) {
+  fp_t     res = FP_ONE, base = *a;
+  uint64_t e[4];
+  memcpy(e, BN_P, sizeof(e));
+  e[0] -= 2;
+  for (int i = 255; i >= 0; i--) {
+    fp_sqr(&res, &res);
+    if ((e[i >> 6] >> (i & 63)) & 1) fp_mul(&res, &res, &base);
+  }
+  *r = res;
+}
+
+/** reads a big endian value and converts it to montgomery form. returns -1 if the value is not smaller than p. */
+static int fp_from_bytes(fp_t* r, const uint8_t* data) {
+  uint64_t borrow = 0;
+  for (int i = 0; i < 4; i++) r->v[i] = bytes_to_long((uint8_t*) data + 24 - i * 8, 8);
+  for (int i = 0; i < 4; i++) sbb(r->v[i], BN_P[i], &borrow);
+  if (!borrow) return -1;
+  fp_mul(r, r, &FP_R2);
+  return 0;
+}
+
+static void fp_to_bytes(const fp_t* a, uint8_t* dst) {
+  fp_t one = {{1, 0, 0, 0}}, t;
+  fp_mul(&t, a, &one);
+  for (int i = 0; i < 4; i++) long_to_bytes(t.v[i], dst + 24 - i * 8);
+}
+
+// ---- Fp2 ----
+
+static inline void fp2_add(fp2_t* r, const fp2_t* x, const fp2_t* y) {
+  fp_add(&r->a, &x->a, &y->a);
+  fp_add(&r->b, &x->b, &y->b);
+}
+
+static inline void fp2_sub(fp2_t* r, const fp2_t* x, const fp2_t* y) {
+  fp_sub(&r->a, &x->a, &y->a);
+  fp_sub(&r->b, &x->b, &y->b);
+}
+
+static inline void fp2_neg(fp2_t* r, const fp2_t* x) {
+  fp_neg(&r->a, &x->a);
+  fp_neg(&r->b, &x->b);
+}
+
+static inline void fp2_dbl(fp2_t* r, const fp2_t* x) {
+  fp2_add(r, x, x);
+}
+
+static inline int fp2_is_zero(const fp2_t* x) {
+  return fp_is_zero(&x->a) && fp_is_zero(&x->b);
+}
+
+static inline int fp2_eq(const fp2_t* x, const fp2_t* y) {
+  return !memcmp(x, y, sizeof(fp2_t));
+}
+
+static inline void fp2_conj(fp2_t* r, const fp2_t* x) {
+  r->a = x->a;
+  fp_neg(&r->b, &x->b);
+}
+
+static void fp2_mul(fp2_t* r, const fp2_t* x, const fp2_t* y) {
+  fp_t t0, t1, t2, t3;
+  fp_mul(&t0, &x->a, &y->a);
+  fp_mul(&t1, &x->b, &y->b);
+  fp_add(&t2, &x->a, &x->b);
+  fp_add(&t3, &y->a, &y->b);
+  fp_mul(&t2, &t2, &t3);
+  fp_sub(&t2, &t2, &t0);
+  fp_sub(&r->b, &t2, &t1);
+  fp_sub(&r->a, &t0, &t1);
+}
+
+static void fp2_sqr(fp2_t* r, const fp2_t* x) {
+  fp_t t0, t1, t2;
+  fp_add(&t0, &x->a, &x->b);
+  fp_sub(&t1, &x->a, &x->b);
+  fp_mul(&t2, &x->a, &x->b);
+  fp_mul(&r->a, &t0, &t1);
+  fp_add(&r->b, &t2, &t2);
+}
+
+static inline void fp2_mul_fp(fp2_t* r, const fp2_t* x, const fp_t* y) {
+  fp_mul(&r->a, &x->a, y);
+  fp_mul(&r->b, &x->b, y);
+}
+
+/** multiplies with the non residue 9 + u */
+static void fp2_mul_xi(fp2_t* r, const fp2_t* x) {
+  fp_t a, b;
+  fp_add(&a, &x->a, &x->a); // 2a
+  fp_add(&a, &a, &a);       // 4a
+  fp_add(&a, &a, &a);       // 8a
+  fp_add(&a, &a, &x->a);    // 9a
+  fp_add(&b, &x->b, &x->b);
+  fp_add(&b, &b, &b);
+  fp_add(&b, &b, &b);
+  fp_add(&b, &b, &x->b);    // 9b
+  fp_sub(&a, &a, &x->b);    // 9a - b
+  fp_add(&r->b, &b, &x->a); // 9b + a
+  r->a = a;
+}
+
+static void fp2_inv(fp2_t* r, const fp2_t* x) {
+  fp_t t0, t1;
+  fp_sqr(&t0, &x->a);
+  fp_sqr(&t1, &x->b);
+  fp_add(&t0, &t0, &t1);
+  fp_inv(&t0, &t0);
+  fp_mul(&r->a, &x->a, &t0);
+  fp_mul(&t1, &x->b, &t0);
+  fp_neg(&r->b, &t1);
+}
+
+// ---- Fp6 ----
+
+static inline void fp6_add(fp6_t* r, const fp6_t* x, const fp6_t* y) {
+  fp2_add(&r->c0, &x->c0, &y->c0);
+  fp2_add(&r->c1, &x->c1, &y->c1);
+  fp2_add(&r->c2, &x->c2, &y->c2);
+}
+
+static inline void fp6_sub(fp6_t* r, const fp6_t* x, const fp6_t* y) {
+  fp2_sub(&r->c0, &x->c0, &y->c0);
+  fp2_sub(&r->c1, &x->c1, &y->c1);
+  fp2_sub(&r->c2, &x->c2, &y->c2);
+}
+
+static inline void fp6_neg(fp6_t* r, const fp6_t* x) {
+  fp2_neg(&r->c0, &x->c0);
+  fp2_neg(&r->c1, &x->c1);
+  fp2_neg(&r->c2, &x->c2);
+}
+
+/** multiplies with v */
+static inline void fp6_mul_v(fp6_t* r, const fp6_t* x) {
+  fp2_t t;
+  fp2_mul_xi(&t, &x->c2);
+  r->c2 = x->c1;
+  r->c1 = x->c0;
+  r->c0 = t;
+}
+
+static void fp6_mul(fp6_t* r, const fp6_t* x, const fp6_t* y) {
+  fp2_t t0, t1, t2, s0, s1, c0, c1, c2;
+  fp2_mul(&t0, &x->c0, &y->c0);
+  fp2_mul(&t1, &x->c1, &y->c1);
+  fp2_mul(&t2, &x->c2, &y->c2);
+
+  // c0 = ((x1 + x2)(y1 + y2) - t1 - t2) * xi + t0
+  fp2_add(&s0, &x->c1, &x->c2);
+  fp2_add(&s1, &y->c1, &y->c2);
+  fp2_mul(&c0, &s0, &s1);
+  fp2_sub(&c0, &c0, &t1);
+  fp2_sub(&c0, &c0, &t2);
+  fp2_mul_xi(&c0, &c0);
+  fp2_add(&c0, &c0, &t0);
+
+  // c1 = (x0 + x1)(y0 + y1) - t0 - t1 + t2 * xi
+  fp2_add(&s0, &x->c0, &x->c1);
+  fp2_add(&s1, &y->c0, &y->c1);
+  fp2_mul(&c1, &s0, &s1);
+  fp2_sub(&c1, &c1, &t0);
+  fp2_sub(&c1, &c1, &t1);
+  fp2_mul_xi(&s0, &t2);
+  fp2_add(&c1, &c1, &s0);
+
+  // c2 = (x0 + x2)(y0 + y2) - t0 - t2 + t1
+  fp2_add(&s0, &x->c0, &x->c2);
+  fp2_add(&s1, &y->c0, &y->c2);
+  fp2_mul(&c2, &s0, &s1);
+  fp2_sub(&c2, &c2, &t0);
+  fp2_sub(&c2, &c2, &t2);
+  fp2_add(&r->c2, &c2, &t1);
+  r->c0 = c0;
+  r->c1 = c1;
+}
+
+/** multiplies with the sparse element b0 + b1*v */
+static void fp6_mul_01(fp6_t* r, const fp6_t* x, const fp2_t* b0, const fp2_t* b1) {
+  fp2_t t0, t1, s, c0, c1, c2;
+  fp2_mul(&t0, &x->c0, b0);
+  fp2_mul(&t1, &x->c1, b1);
+
+  // c0 = ((x1 + x2) * b1 - t1) * xi + t0
+  fp2_add(&s, &x->c1, &x->c2);
+  fp2_mul(&c0, &s, b1);
+  fp2_sub(&c0, &c0, &t1);
+  fp2_mul_xi(&c0, &c0);
+  fp2_add(&c0, &c0, &t0);
+
+  // c1 = (x0 + x1)(b0 + b1) - t0 - t1
+  fp2_add(&s, &x->c0, &x->c1);
+  fp2_add(&c1, b0, b1);
+  fp2_mul(&c1, &c1, &s);
+  fp2_sub(&c1, &c1, &t0);
+  fp2_sub(&c1, &c1, &t1);
+
+  // c2 = (x0 + x2) * b0 - t0 + t1
+  fp2_add(&s, &x->c0, &x->c2);
+  fp2_mul(&c2, &s, b0);
+  fp2_sub(&c2, &c2, &t0);
+  fp2_add(&r->c2, &c2, &t1);
+  r->c0 = c0;
+  r->c1 = c1;
+}
+
+static void fp6_inv(fp6_t* r, const fp6_t* x) {
+  fp2_t t0, t1, t2, s, d;
+  // t0 = x0^2 - x1 x2 xi
+  fp2_sqr(&t0, &x->c0);
+  fp2_mul(&s, &x->c1, &x->c2);
+  fp2_mul_xi(&s, &s);
+  fp2_sub(&t0, &t0, &s);
+  // t1 = x2^2 xi - x0 x1
+  fp2_sqr(&t1, &x->c2);
+  fp2_mul_xi(&t1, &t1);
+  fp2_mul(&s, &x->c0, &x->c1);
+  fp2_sub(&t1, &t1, &s);
+  // t2 = x1^2 - x0 x2
+  fp2_sqr(&t2, &x->c1);
+  fp2_mul(&s, &x->c0, &x->c2);
+  fp2_sub(&t2, &t2, &s);
+  // d = 1 / (x0 t0 + (x2 t1 + x1 t2) xi)
+  fp2_mul(&d, &x->c2, &t1);
+  fp2_mul(&s, &x->c1, &t2);
+  fp2_add(&d, &d, &s);
+  fp2_mul_xi(&d, &d);
+  fp2_mul(&s, &x->c0, &t0);
+  fp2_add(&d, &d, &s);
+  fp2_inv(&d, &d);
+  fp2_mul(&r->c0, &t0, &d);
+  fp2_mul(&r->c1, &t1, &d);
+  fp2_mul(&r->c2, &t2, &d);
+}
+
+/** frobenius map x^(p^k) for k = 1..3 */
+static void fp6_frobenius(fp6_t* r, const fp6_t* x, int k) {
+  if (k & 1) {
+    fp2_conj(&r->c0, &x->c0);
+    fp2_conj(&r->c1, &x->c1);
+    fp2_conj(&r->c2, &x->c2);
+  } else
+    *r = *x;
+  fp2_mul(&r->c1, &r->c1, FROB6_C1 + k - 1);
+  fp2_mul(&r->c2, &r->c2, FROB6_C2 + k - 1);
+}
+
+// ---- Fp12 ----
+
+static void fp12_set_one(fp12_t* r) {
+  memset(r, 0, sizeof(fp12_t));
+  r->c0.c0.a = FP_ONE;
+}
+
+static int fp12_is_one(const fp12_t* x) {
+  fp12_t one;
+  fp12_set_one(&one);
+  return !memcmp(x, &one, sizeof(fp12_t));
+}
+
+static void fp12_mul(fp12_t* r, const fp12_t* x, const fp12_t* y) {
+  fp6_t t0, t1, s0, s1;
+  fp6_mul(&t0, &x->c0, &y->c0);
+  fp6_mul(&t1, &x->c1, &y->c1);
+  fp6_add(&s0, &x->c0, &x->c1);
+  fp6_add(&s1, &y->c0, &y->c1);
+  fp6_mul(&s0, &s0, &s1);
+  fp6_sub(&s0, &s0, &t0);
+  fp6_sub(&r->c1, &s0, &t1);
+  fp6_mul_v(&t1, &t1);
+  fp6_add(&r->c0, &t0, &t1);
+}
+
+static void fp12_sqr(fp12_t* r, const fp12_t* x) {
+  fp6_t t, s0, s1;
+  // c0 = (x0 + x1)(x0 + x1 v) - t - t v, c1 = 2t with t = x0 x1
+  fp6_mul(&t, &x->c0, &x->c1);
+  fp6_add(&s0, &x->c0, &x->c1);
+  fp6_mul_v(&s1, &x->c1);
+  fp6_add(&s1, &s1, &x->c0);
+  fp6_mul(&s0, &s0, &s1);
+  fp6_sub(&s0, &s0, &t);
+  fp6_mul_v(&s1, &t);
+  fp6_sub(&r->c0, &s0, &s1);
+  fp6_add(&r->c1, &t, &t);
+}
+
+/** x^(p^6), which is the inverse for elements of the cyclotomic subgroup */
+static inline void fp12_conj(fp12_t* r, const fp12_t* x) {
+  r->c0 = x->c0;
+  fp6_neg(&r->c1, &x->c1);
+}
+
+static void fp12_inv(fp12_t* r, const fp12_t* x) {
+  fp6_t t0, t1;
+  fp6_mul(&t0, &x->c0, &x->c0);
+  fp6_mul(&t1, &x->c1, &x->c1);
+  fp6_mul_v(&t1, &t1);
+  fp6_sub(&t0, &t0, &t1);
+  fp6_inv(&t0, &t0);
+  fp6_mul(&r->c0, &x->c0, &t0);
+  fp6_mul(&t1, &x->c1, &t0);
+  fp6_neg(&r->c1, &t1);
+}
+
+static void fp12_frobenius(fp12_t* r, const fp12_t* x, int k) {
+  const fp2_t* c = FROB12_C1 + k - 1;
+  fp6_frobenius(&r->c0, &x->c0, k);
+  fp6_frobenius(&r->c1, &x->c1, k);
+  fp2_mul(&r->c1.c0, &r->c1.c0, c);
+  fp2_mul(&r->c1.c1, &r->c1.c1, c);
+  fp2_mul(&r->c1.c2, &r->c1.c2, c);
+}
+
+/** multiplies with the sparse line c0 + (c3 + c4 v) w */
+static void fp12_mul_034(fp12_t* r, const fp2_t* c0, const fp2_t* c3, const fp2_t* c4) {
+  fp6_t a, b, e;
+  fp2_t s;
+  fp2_mul(&a.c0, &r->c0.c0, c0);
+  fp2_mul(&a.c1, &r->c0.c1, c0);
+  fp2_mul(&a.c2, &r->c0.c2, c0);
+  fp6_mul_01(&b, &r->c1, c3, c4);
+  fp2_add(&s, c0, c3);
+  fp6_add(&e, &r->c0, &r->c1);
+  fp6_mul_01(&e, &e, &s, c4);
+  fp6_sub(&e, &e, &a);
+  fp6_sub(&r->c1, &e, &b);
+  fp6_mul_v(&b, &b);
+  fp6_add(&r->c0, &a, &b);
+}
+
+/** x^BN_X followed by the conjugation */
+static void fp12_exp_by_neg_x(fp12_t* r, const fp12_t* x) {
+  fp12_t res = *x;
+  for (int i = 61; i >= 0; i--) {
+    fp12_sqr(&res, &res);
+    if ((BN_X >> i) & 1) fp12_mul(&res, &res, x);
+  }
+  fp12_conj(r, &res);
+}
+
+// ---- G1 ----
+
+static inline int g1_is_inf(const g1_t* p) {
+  return fp_is_zero(&p->z);
+}
+
+/** dbl-2009-l */
+static void g1_dbl(g1_t* r, const g1_t* p) {
+  fp_t a, b, c, d, e, f;
+  if (g1_is_inf(p)) {
+    *r = *p;
+    return;
+  }
+  fp_sqr(&a, &p->x);
+  fp_sqr(&b, &p->y);
+  fp_sqr(&c, &b);
+  fp_add(&d, &p->x, &b);
+  fp_sqr(&d, &d);
+  fp_sub(&d, &d, &a);
+  fp_sub(&d, &d, &c);
+  fp_add(&d, &d, &d);
+  fp_add(&e, &a, &a);
+  fp_add(&e, &e, &a);
+  fp_sqr(&f, &e);
+  fp_mul(&r->z, &p->y, &p->z);
+  fp_add(&r->z, &r->z, &r->z);
+  fp_sub(&r->x, &f, &d);
+  fp_sub(&r->x, &r->x, &d);
+  fp_sub(&d, &d, &r->x);
+  fp_mul(&r->y, &e, &d);
+  fp_add(&c, &c, &c);
+  fp_add(&c, &c, &c);
+  fp_add(&c, &c, &c);
+  fp_sub(&r->y, &r->y, &c);
+}
+
+/** add-2007-bl */
+static void g1_add(g1_t* r, const g1_t* p, const g1_t* q) {
+  fp_t z1z1, z2z2, u1, u2, s1, s2, h, i, j, rr, v;
+  if (g1_is_inf(p)) {
+    *r = *q;
+    return;
+  }
+  if (g1_is_inf(q)) {
+    *r = *p;
+    return;
+  }
+  fp_sqr(&z1z1, &p->z);
+  fp_sqr(&z2z2, &q->z);
+  fp_mul(&u1, &p->x, &z2z2);
+  fp_mul(&u2, &q->x, &z1z1);
+  fp_mul(&s1, &p->y, &q->z);
+  fp_mul(&s1, &s1, &z2z2);
+  fp_mul(&s2, &q->y, &p->z);
+  fp_mul(&s2, &s2, &z1z1);
+  fp_sub(&h, &u2, &u1);
+  fp_sub(&rr, &s2, &s1);
+  if (fp_is_zero(&h)) {
+    if (fp_is_zero(&rr))
+      g1_dbl(r, p);
+    else
+      memset(r, 0, sizeof(g1_t));
+    return;
+  }
+  fp_add(&i, &h, &h);
+  fp_sqr(&i, &i);
+  fp_mul(&j, &h, &i);
+  fp_add(&rr, &rr, &rr);
+  fp_mul(&v, &u1, &i);
+
+  fp_add(&i, &p->z, &q->z);
+  fp_sqr(&i, &i);
+  fp_sub(&i, &i, &z1z1);
+  fp_sub(&i, &i, &z2z2);
+  fp_mul(&r->z, &i, &h);
+
+  fp_sqr(&r->x, &rr);
+  fp_sub(&r->x, &r->x, &j);
+  fp_sub(&r->x, &r->x, &v);
+  fp_sub(&r->x, &r->x, &v);
+
+  fp_sub(&v, &v, &r->x);
+  fp_mul(&s1, &s1, &j);
+  fp_add(&s1, &s1, &s1);
+  fp_mul(&r->y, &rr, &v);
+  fp_sub(&r->y, &r->y, &s1);
+}
+
+/** reads and validates a point. (0,0) is the point at infinity. */
+static int g1_from_bytes(g1_t* r, const uint8_t* data) {
+  fp_t l, t;
+  if (fp_from_bytes(&r->x, data) || fp_from_bytes(&r->y, data + 32)) return -1;
+  if (fp_is_zero(&r->x) && fp_is_zero(&r->y)) {
+    memset(&r->z, 0, sizeof(fp_t));
+    return 0;
+  }
+  r->z = FP_ONE;
+
+  // y^2 = x^3 + b
+  fp_sqr(&l, &r->y);
+  fp_sqr(&t, &r->x);
+  fp_mul(&t, &t, &r->x);
+  fp_add(&t, &t, &FP_B);
+  return fp_eq(&l, &t) ? 0 : -1;
+}
+
+static void g1_to_bytes(const g1_t* p, uint8_t* dst) {
+  fp_t zi, zi2, t;
+  if (g1_is_inf(p)) {
+    memset(dst, 0, 64);
+    return;
+  }
+  fp_inv(&zi, &p->z);
+  fp_sqr(&zi2, &zi);
+  fp_mul(&t, &p->x, &zi2);
+  fp_to_bytes(&t, dst);
+  fp_mul(&zi2, &zi2, &zi);
+  fp_mul(&t, &p->y, &zi2);
+  fp_to_bytes(&t, dst + 32);
+}
+
+/** window size for the wNAF scalar multiplication */
+#define WNAF_W 5
+
+/** multiplies with a scalar using the window non-adjacent form. */
+static void g1_mul(g1_t* r, const g1_t* p, const uint8_t* scalar) {
+  g1_t     table[1 << (WNAF_W - 2)], p2, neg;
+  int8_t   naf[258];
+  uint64_t k[4], borrow, carry;
+  int      len = 0, i;
+
+  // since the group order is r, we can reduce the scalar first
+  for (i = 0; i < 4; i++) k[i] = bytes_to_long((uint8_t*) scalar + 24 - i * 8, 8);
+  for (;;) {
+    uint64_t t[4];
+    borrow = 0;
+    for (i = 0; i < 4; i++) t[i] = sbb(k[i], BN_R[i], &borrow);
+    if (borrow) break;
+    memcpy(k, t, sizeof(k));
+  }
+
+  // compute the wNAF digits
+  while (k[0] | k[1] | k[2] | k[3]) {
+    int d = 0;
+    if (k[0] & 1) {
+      d = k[0] & ((1 << WNAF_W) - 1);
+      if (d >= (1 << (WNAF_W - 1))) d -= 1 << WNAF_W;
+      borrow = carry = 0;
+      if (d > 0)
+        for (i = 0; i < 4; i++) k[i] = sbb(k[i], i ? 0 : (uint64_t) d, &borrow);
+      else
+        for (i = 0; i < 4; i++) k[i] = adc(k[i], i ? 0 : (uint64_t) -d, &carry);
+    }
+    naf[len++] = d;
+    for (i = 0; i < 3; i++) k[i] = (k[i] >> 1) | (k[i + 1] << 63);
+    k[3] >>= 1;
+  }
+
+  // precompute p, 3p, 5p, ...
+  table[0] = *p;
+  g1_dbl(&p2, p);
+  for (i = 1; i < (1 << (WNAF_W - 2)); i++) g1_add(table + i, table + i - 1, &p2);
+
+  memset(r, 0, sizeof(g1_t));
+  for (i = len - 1; i >= 0; i--) {
+    g1_dbl(r, r);
+    if (naf[i] > 0)
+      g1_add(r, r, table + (naf[i] >> 1));
+    else if (naf[i] < 0) {
+      neg = table[(-naf[i]) >> 1];
+      fp_neg(&neg.y, &neg.y);
+      g1_add(r, r, &neg);
+    }
+  }
+}
+
+// ---- G2 ----
+
+static inline int g2_is_inf(const g2_t* p) {
+  return fp2_is_zero(&p->z);
+}
+
+static void g2_dbl(g2_t* r, const g2_t* p) {
+  fp2_t a, b, c, d, e, f;
+  if (g2_is_inf(p)) {
+    *r = *p;
+    return;
+  }
+  fp2_sqr(&a, &p->x);
+  fp2_sqr(&b, &p->y);
+  fp2_sqr(&c, &b);
+  fp2_add(&d, &p->x, &b);
+  fp2_sqr(&d, &d);
+  fp2_sub(&d, &d, &a);
+  fp2_sub(&d, &d, &c);
+  fp2_dbl(&d, &d);
+  fp2_dbl(&e, &a);
+  fp2_add(&e, &e, &a);
+  fp2_sqr(&f, &e);
+  fp2_mul(&r->z, &p->y, &p->z);
+  fp2_dbl(&r->z, &r->z);
+  fp2_sub(&r->x, &f, &d);
+  fp2_sub(&r->x, &r->x, &d);
+  fp2_sub(&d, &d, &r->x);
+  fp2_mul(&r->y, &e, &d);
+  fp2_dbl(&c, &c);
+  fp2_dbl(&c, &c);
+  fp2_dbl(&c, &c);
+  fp2_sub(&r->y, &r->y, &c);
+}
+
+static void g2_add(g2_t* r, const g2_t* p, const g2_t* q) {
+  fp2_t z1z1, z2z2, u1, u2, s1, s2, h, i, j, rr, v;
+  if (g2_is_inf(p)) {
+    *r = *q;
+    return;
+  }
+  if (g2_is_inf(q)) {
+    *r = *p;
+    return;
+  }
+  fp2_sqr(&z1z1, &p->z);
+  fp2_sqr(&z2z2, &q->z);
+  fp2_mul(&u1, &p->x, &z2z2);
+  fp2_mul(&u2, &q->x, &z1z1);
+  fp2_mul(&s1, &p->y, &q->z);
+  fp2_mul(&s1, &s1, &z2z2);
+  fp2_mul(&s2, &q->y, &p->z);
+  fp2_mul(&s2, &s2, &z1z1);
+  fp2_sub(&h, &u2, &u1);
+  fp2_sub(&rr, &s2, &s1);
+  if (fp2_is_zero(&h)) {
+    if (fp2_is_zero(&rr))
+      g2_dbl(r, p);
+    else
+      memset(r, 0, sizeof(g2_t));
+    return;
+  }
+  fp2_dbl(&i, &h);
+  fp2_sqr(&i, &i);
+  fp2_mul(&j, &h, &i);
+  fp2_dbl(&rr, &rr);
+  fp2_mul(&v, &u1, &i);
+
+  fp2_add(&i, &p->z, &q->z);
+  fp2_sqr(&i, &i);
+  fp2_sub(&i, &i, &z1z1);
+  fp2_sub(&i, &i, &z2z2);
+  fp2_mul(&r->z, &i, &h);
+
+  fp2_sqr(&r->x, &rr);
+  fp2_sub(&r->x, &r->x, &j);
+  fp2_sub(&r->x, &r->x, &v);
+  fp2_sub(&r->x, &r->x, &v);
+
+  fp2_sub(&v, &v, &r->x);
+  fp2_mul(&s1, &s1, &j);
+  fp2_dbl(&s1, &s1);
+  fp2_mul(&r->y, &rr, &v);
+  fp2_sub(&r->y, &r->y, &s1);
+}
+
+/** checks r * p == infinity */
+static int g2_in_subgroup(const g2_affine_t* p) {
+  g2_t q, res;
+  q.x = p->x;
+  q.y = p->y;
+  memset(&q.z, 0, sizeof(fp2_t));
+  q.z.a = FP_ONE;
+  memset(&res, 0, sizeof(g2_t));
+  for (int i = 253; i >= 0; i--) {
+    g2_dbl(&res, &res);
+    if ((BN_R[i >> 6] >> (i & 63)) & 1) g2_add(&res, &res, &q);
+  }
+  return g2_is_inf(&res);
+}
+
+/** reads and validates a point on the twist. returns 1 for the point at infinity. */
+static int g2_from_bytes(g2_affine_t* r, const uint8_t* data) {
+  fp2_t l, t;
+  if (fp_from_bytes(&r->x.b, data) || fp_from_bytes(&r->x.a, data + 32) || fp_from_bytes(&r->y.b, data + 64) || fp_from_bytes(&r->y.a, data + 96)) return -1;
+  if (fp2_is_zero(&r->x) && fp2_is_zero(&r->y)) return 1;
+
+  // y^2 = x^3 + b / xi
+  fp2_sqr(&l, &r->y);
+  fp2_sqr(&t, &r->x);
+  fp2_mul(&t, &t, &r->x);
+  fp2_add(&t, &t, &TWIST_B);
+  if (!fp2_eq(&l, &t)) return -1;
+  return g2_in_subgroup(r) ? 0 : -1;
+}
+
+// ---- pairing ----
+
+/** a pair for the miller loop with the current point r in homogeneous projective coordinates. */
+typedef struct {
+  fp_t        px, py;
+  g2_affine_t q;
+  g2_t        r;
+} pair_t;
+
+/** evaluates the line at p and multiplies it into f */
+static void ell(fp12_t* f, pair_t* pair, fp2_t* c0, fp2_t* c3, fp2_t* c4) {
+  fp2_mul_fp(c0, c0, &pair->py);
+  fp2_mul_fp(c3, c3, &pair->px);
+  fp12_mul_034(f, c0, c3, c4);
+}
+
+/** doubling step for r (homogeneous projective coordinates) including the line evaluation */
+static void doubling_step(fp12_t* f, pair_t* pair) {
+  g2_t* r = &pair->r;
+  fp2_t a, b, c, e, ff, g, h, i, j, es;
+  fp2_mul(&a, &r->x, &r->y);
+  fp2_mul_fp(&a, &a, &FP_2_INV);
+  fp2_sqr(&b, &r->y);
+  fp2_sqr(&c, &r->z);
+  fp2_dbl(&e, &c);
+  fp2_add(&e, &e, &c);
+  fp2_mul(&e, &e, &TWIST_B);
+  fp2_dbl(&ff, &e);
+  fp2_add(&ff, &ff, &e);
+  fp2_add(&g, &b, &ff);
+  fp2_mul_fp(&g, &g, &FP_2_INV);
+  fp2_add(&h, &r->y, &r->z);
+  fp2_sqr(&h, &h);
+  fp2_sub(&h, &h, &b);
+  fp2_sub(&h, &h, &c);
+  fp2_sub(&i, &e, &b);
+  fp2_sqr(&j, &r->x);
+  fp2_sqr(&es, &e);
+
+  fp2_sub(&r->x, &b, &ff);
+  fp2_mul(&r->x, &r->x, &a);
+  fp2_sqr(&r->y, &g);
+  fp2_sub(&r->y, &r->y, &es);
+  fp2_sub(&r->y, &r->y, &es);
+  fp2_sub(&r->y, &r->y, &es);
+  fp2_mul(&r->z, &b, &h);
+
+  fp2_neg(&h, &h);
+  fp2_dbl(&a, &j);
+  fp2_add(&j, &a, &j);
+  ell(f, pair, &h, &j, &i);
+}
+
+/** addition step r = r + q (q affine) including the line evaluation */
+static void addition_step(fp12_t* f, pair_t* pair, const fp2_t* qx, const fp2_t* qy) {
+  g2_t* r = &pair->r;
+  fp2_t theta, lambda, c, d, e, ff, g, h, j, t;
+  fp2_mul(&t, qy, &r->z);
+  fp2_sub(&theta, &r->y, &t);
+  fp2_mul(&t, qx, &r->z);
+  fp2_sub(&lambda, &r->x, &t);
+  fp2_sqr(&c, &theta);
+  fp2_sqr(&d, &lambda);
+  fp2_mul(&e, &lambda, &d);
+  fp2_mul(&ff, &r->z, &c);
+  fp2_mul(&g, &r->x, &d);
+  fp2_add(&h, &e, &ff);
+  fp2_sub(&h, &h, &g);
+  fp2_sub(&h, &h, &g);
+  fp2_mul(&r->x, &lambda, &h);
+  fp2_sub(&t, &g, &h);
+  fp2_mul(&t, &t, &theta);
+  fp2_mul(&r->y, &e, &r->y);
+  fp2_sub(&r->y, &t, &r->y);
+  fp2_mul(&r->z, &r->z, &e);
+
+  fp2_mul(&j, &theta, qx);
+  fp2_mul(&t, &lambda, qy);
+  fp2_sub(&j, &j, &t);
+  fp2_neg(&theta, &theta);
+  ell(f, pair, &lambda, &theta, &j);
+}
+
+static void miller_loop(fp12_t* f, pair_t* pairs, uint32_t n) {
+  fp2_t    x, y;
+  uint32_t k;
+  fp12_set_one(f);
+  for (k = 0; k < n; k++) {
+    pairs[k].r.x = pairs[k].q.x;
+    pairs[k].r.y = pairs[k].q.y;
+    memset(&pairs[k].r.z, 0, sizeof(fp2_t));
+    pairs[k].r.z.a = FP_ONE;
+  }
+
+  for (int i = sizeof(ATE_LOOP) - 1; i > 0; i--) {
+    if (i != sizeof(ATE_LOOP) - 1) fp12_sqr(f, f);
+    for (k = 0; k < n; k++) doubling_step(f, pairs + k);
+    if (ATE_LOOP[i - 1] == 0) continue;
+    for (k = 0; k < n; k++) {
+      if (ATE_LOOP[i - 1] > 0)
+        addition_step(f, pairs + k, &pairs[k].q.x, &pairs[k].q.y);
+      else {
+        fp2_neg(&y, &pairs[k].q.y);
+        addition_step(f, pairs + k, &pairs[k].q.x, &y);
+      }
+    }
+  }
+
+  for (k = 0; k < n; k++) {
+    // q1 = pi(q), q2 = -pi^2(q)
+    fp2_conj(&x, &pairs[k].q.x);
+    fp2_mul(&x, &x, &TWIST_Q_X);
+    fp2_conj(&y, &pairs[k].q.y);
+    fp2_mul(&y, &y, &TWIST_Q_Y);
+    addition_step(f, pairs + k, &x, &y);
+    fp2_conj(&x, &x);
+    fp2_mul(&x, &x, &TWIST_Q_X);
+    fp2_conj(&y, &y);
+    fp2_mul(&y, &y, &TWIST_Q_Y);
+    fp2_neg(&y, &y);
+    addition_step(f, pairs + k, &x, &y);
+  }
+}
+
+/** f^((p^12 - 1) / r) */
+static void final_exponentiation(fp12_t* res, const fp12_t* f) {
+  fp12_t r, t, y0, y1, y3, y4, y5, y6, y8, y9;
+
+  // easy part: f^((p^6 - 1)(p^2 + 1))
+  fp12_inv(&t, f);
+  fp12_conj(&r, f);
+  fp12_mul(&r, &r, &t);
+  fp12_frobenius(&t, &r, 2);
+  fp12_mul(&r, &t, &r);
+
+  // hard part (Fuentes-Castaneda et al.)
+  fp12_exp_by_neg_x(&y0, &r);
+  fp12_sqr(&y1, &y0);
+  fp12_sqr(&t, &y1);
+  fp12_mul(&y3, &t, &y1);
+  fp12_exp_by_neg_x(&y4, &y3);
+  fp12_sqr(&y5, &y4);
+  fp12_exp_by_neg_x(&y6, &y5);
+  fp12_conj(&y3, &y3);
+  fp12_conj(&y6, &y6);
+  fp12_mul(&t, &y6, &y4);   // y7
+  fp12_mul(&y8, &t, &y3);   // y8
+  fp12_mul(&y9, &y8, &y1);  // y9
+  fp12_mul(&t, &y8, &y4);   // y10
+  fp12_mul(&t, &t, &r);     // y11
+  fp12_frobenius(&y0, &y9, 1);
+  fp12_mul(&t, &y0, &t);    // y13
+  fp12_frobenius(&y8, &y8, 2);
+  fp12_mul(&t, &y8, &t);    // y14
+  fp12_conj(&r, &r);
+  fp12_mul(&r, &r, &y9);
+  fp12_frobenius(&r, &r, 3);
+  fp12_mul(res, &r, &t);
+}
+
+// ---- api ----
+
+int bn254_g1_add(const uint8_t* a, const uint8_t* b, uint8_t* res) {
+  g1_t p, q;
+  if (g1_from_bytes(&p, a) || g1_from_bytes(&q, b)) return -1;
+  g1_add(&p, &p, &q);
+  g1_to_bytes(&p, res);
+  return 0;
+}
+
+int bn254_g1_mul(const uint8_t* a, const uint8_t* scalar, uint8_t* res) {
+  g1_t p, q;
+  if (g1_from_bytes(&p, a)) return -1;
+  g1_mul(&q, &p, scalar);
+  g1_to_bytes(&q, res);
+  return 0;
+}
+
+/** number of pairs, which are evaluated within one miller loop */
+#define MAX_PAIRS 8
+
+int bn254_pairing_check(const uint8_t* data, uint32_t pairs) {
+  pair_t   batch[MAX_PAIRS];
+  fp12_t   f, acc;
+  g1_t     p;
+  uint32_t n = 0;
+  int      res;
+  fp12_set_one(&acc);
+
+  for (uint32_t i = 0; i < pairs; i++, data += 192) {
+    if (g1_from_bytes(&p, data)) return -1;
+    if ((res = g2_from_bytes(&batch[n].q, data + 64)) < 0) return -1;
+    // pairs with a point at infinity do not change the result
+    if (res == 1 || g1_is_inf(&p)) continue;
+    batch[n].px = p.x;
+    batch[n].py = p.y;
+    if (++n == MAX_PAIRS) {
+      miller_loop(&f, batch, n);
+      fp12_mul(&acc, &acc, &f);
+      n = 0;
+    }
+  }
+  if (n) {
+    miller_loop(&f, batch, n);
+    fp12_mul(&acc, &acc, &f);
+  }
+
+  final_exponentiation(&f, &acc);
+  return fp12_is_one(&f);
+}
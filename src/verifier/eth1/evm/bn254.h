@@ -0,0 +1,61 @@
+/*******************************************************************************
+ * This file is part of the Incubed project.
+ * Sources: https://github.com/slockit/in3-c
+ * 
+ * Copyright (C) 2018-2019 slock.it GmbH, Blockchains LLC
+ * 
+ * 
+ * COMMERCIAL LICENSE USAGE
+ * 
+ * Licensees holding a valid commercial license may use this file in accordance 
+ * with the commercial license agreement provided with the Software or, alternatively, 
+ * in accordance with the terms contained in a written agreement between you and 
+ * slock.it GmbH/Blockchains LLC. For licensing terms and conditions or further 
+ * information please contact slock.it at in3@slock.it.
+ * 	
+ * Alternatively, this file may be used under the AGPL license as follows:
+ *    
+ * AGPL LICENSE USAGE
+ * 
+ * This program is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Affero General Public License as published by the Free Software 
+ * Foundation, either version 3 of the License, or (at your option) any later version.
+ *  
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY 
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A 
+ * PARTICULAR PURPOSE. See the GNU Affero General Public License for more details.
+ * [Permissions of this strong copyleft license are conditioned on making available 
+ * complete source code of licensed works and modifications, which include larger 
+ * works using a licensed work, under the same license. Copyright and license notices 
+ * must be preserved. Contributors provide an express grant of patent rights.]
+ * You should have received a copy of the GNU Affero General Public License along 
+ * with this program. If not, see <https://www.gnu.org/licenses/>.
+ *******************************************************************************/
+
+/** @file 
+ * arithmetic on the alt_bn128 (BN254) curve as used by the precompiled contracts 0x06 - 0x08.
+ * 
+ * All points are encoded as in the precompiled contracts (32 bytes per coordinate, big endian).
+ * The field elements are kept in montgomery form with 4x64bit words and no memory is allocated.
+ * */
+
+#ifndef in3_bn254_h__
+#define in3_bn254_h__
+
+#include <stdint.h>
+
+/** adds two G1-points (64 bytes each). returns 0 on success or -1 if a point is invalid. */
+int bn254_g1_add(const uint8_t* a, const uint8_t* b, uint8_t* res);
+
+/** multiplies a G1-point (64 bytes) with a 32 byte scalar. returns 0 on success or -1 if the point is invalid. */
+int bn254_g1_mul(const uint8_t* a, const uint8_t* scalar, uint8_t* res);
+
+/**
+ * checks if the product of the optimal ate pairings of all pairs equals 1.
+ * 
+ * Each pair takes 192 bytes: the G1-point (x,y) followed by the G2-point (x_imag, x_real, y_imag, y_real).
+ * returns 1 if the check succeeds, 0 if not and -1 if any point is invalid.
+ */
+int bn254_pairing_check(const uint8_t* data, uint32_t pairs);
+
+#endif
@@ -71,9 +71,11 @@ void evm_free(evm_t* evm) {
       ac->storage = s->next;
       _free(s);
     }
+    evm_index_free(&ac->storage_index);
     evm->accounts = ac->next;
     _free(ac);
   }
+  evm_index_free(&evm->account_index);
 #endif
 }
 
@@ -124,6 +126,12 @@ int evm_prepare_evm(evm_t*      evm,
   evm->return_data.data = NULL;
   evm->return_data.len  = 0;
 
+#ifdef EVM_TRACE
+  evm->tracer      = evm_get_tracer();
+  evm->call_depth  = 0;
+  evm->code_hashed = 0;
+#endif
+
   evm->caller  = caller;
   evm->origin  = origin;
   evm->account = (mode == EVM_CALL_MODE_CALLCODE) ? address : account;
@@ -131,6 +139,7 @@ int evm_prepare_evm(evm_t*      evm,
 
 #ifdef EVM_GAS
   evm->accounts = NULL;
+  memset(&evm->account_index, 0, sizeof(evm_index_t));
   evm->gas      = 0;
   evm->logs     = NULL;
   evm->parent   = NULL;
@@ -179,6 +188,11 @@ int evm_sub_call(evm_t*    parent,
   evm.call_data.len   = l_data;
   evm.call_value.data = value;
   evm.call_value.len  = l_value;
+#ifdef EVM_TRACE
+  evm.tracer      = parent->tracer;
+  evm.call_depth  = parent->call_depth + 1;
+  evm.code_hashed = 0;
+#endif
 
   // if this is a static call, we set the static flag which can be checked before any state-chage occur.
   if (mode == EVM_CALL_MODE_STATIC) evm.properties |= EVM_PROP_STATIC;
@@ -197,8 +211,9 @@ int evm_sub_call(evm_t*    parent,
 
   // if we have returndata we write them into memory
   if ((success == 0 || success == EVM_ERROR_SUCCESS_CONSUME_GAS) && evm.return_data.data) {
-    // if we have a target to write the result to we do.
-    if (out_len) res = evm_mem_write(parent, out_offset, evm.return_data, out_len);
+    // if we have a target to write the result to we do, but only as many bytes as returned.
+    uint32_t l = evm.return_data.len < out_len ? evm.return_data.len : out_len;
+    if (l) res = evm_mem_write(parent, out_offset, bytes(evm.return_data.data, l), l);
 
     UPDATE_ACCOUNT_CODE(&evm, new_account);
 
@@ -221,6 +236,7 @@ int evm_sub_call(evm_t*    parent,
  * run a evm-call
  */
 int evm_call(void*     vc,
+             bool      in_task,
              address_t address,
              uint8_t* value, wlen_t l_value,
              uint8_t* data, uint32_t l_data,
@@ -230,7 +246,8 @@ int evm_call(void*     vc,
              bytes_t** result) {
 
   evm_t evm;
-  int   res    = evm_prepare_evm(&evm, address, address, caller, caller, in3_get_env, vc, 0);
+  void* env    = in3_env_new(vc, in_task);
+  int   res    = evm_prepare_evm(&evm, address, address, caller, caller, in3_get_env, env, 0);
   evm.chain_id = chain_id;
 
   // check if the caller is empty
@@ -257,6 +274,7 @@ int evm_call(void*     vc,
   if (res == 0 && evm.return_data.data)
     *result = b_dup(&evm.return_data);
   evm_free(&evm);
+  in3_env_free(env);
 
   return res;
 }
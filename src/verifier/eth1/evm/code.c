@@ -135,14 +135,19 @@ static in3_ret_t in3_get_code_from_client(in3_vctx_t* vc, char* cache_key, addre
   }
 }
 
-in3_ret_t in3_get_code(in3_vctx_t* vc, address_t address, cache_entry_t** target) {
-  // search in thew cache of the current context
+in3_ret_t in3_get_cached_code(in3_vctx_t* vc, address_t address, cache_entry_t** target) {
   for (cache_entry_t* en = vc->ctx->cache; en; en = en->next) {
     if (en->key.len == 20 && memcmp(address, en->key.data, 20) == 0) {
       *target = en;
       return IN3_OK;
     }
   }
+  return IN3_EFIND;
+}
+
+in3_ret_t in3_get_code(in3_vctx_t* vc, address_t address, cache_entry_t** target) {
+  // search in thew cache of the current context
+  if (in3_get_cached_code(vc, address, target) == IN3_OK) return IN3_OK;
 
   // the cache key is always "C"+the hexaddress (without prefix)
   char key_str[43];
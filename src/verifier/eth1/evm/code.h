@@ -46,4 +46,11 @@
  */
 in3_ret_t in3_get_code(in3_vctx_t* vc, address_t address, cache_entry_t** target);
 
+/**
+ * finds code already added to the context-cache by in3_get_code.
+ * Since it only reads the context, it can be used by evms running as parallel tasks.
+ * returns IN3_EFIND if the code is not cached yet.
+ */
+in3_ret_t in3_get_cached_code(in3_vctx_t* vc, address_t address, cache_entry_t** target);
+
 #endif
\ No newline at end of file
@@ -34,37 +34,126 @@
 
 #include "../../../core/client/keys.h"
 #include "../../../core/client/verifier.h"
+#include "../../../core/util/mem.h"
+#include "../../../core/util/utils.h"
+#include "accounts.h"
 #include "big.h"
 #include "code.h"
 #include "evm.h"
+#include <string.h>
 
-static d_token_t* get_account(in3_vctx_t* vc, d_token_t* accounts, uint8_t* address) {
-  int        i;
-  d_token_t* t = NULL;
+/** a account of the proof, indexed by its address. */
+typedef struct {
+  address_t   address; /**< must be the first member, since it is used as key in the index */
+  d_token_t*  token;   /**< the account-token of the proof */
+  evm_index_t storage; /**< the index of all storage proofs of this account */
+} env_account_t;
 
-  if (!accounts) {
-    vc_err(vc, "no accounts");
-    return NULL;
+/** a entry of the storageProof, indexed by its key. */
+typedef struct {
+  bytes32_t  key;   /**< the storage key left-padded to 32 bytes */
+  d_token_t* token; /**< the storage proof-token */
+} env_storage_t;
+
+/** the enviroment used to verify a eth_call. */
+typedef struct {
+  in3_vctx_t*    vc;       /**< the verification context */
+  env_account_t* accounts; /**< all accounts of the proof */
+  env_storage_t* storage;  /**< all storage proofs of all accounts */
+  evm_index_t    index;    /**< the index of the accounts */
+  bool           in_task;  /**< the evm runs as parallel task, so the context is only read */
+} in3_env_t;
+
+void* in3_env_new(void* vc_ptr, bool in_task) {
+  in3_vctx_t* vc        = vc_ptr;
+  in3_env_t*  env       = _calloc(1, sizeof(in3_env_t));
+  d_token_t*  accounts  = d_get(vc->proof, K_ACCOUNTS);
+  int         l_storage = 0;
+  env->vc               = vc;
+  env->in_task          = in_task;
+  if (!d_len(accounts)) return env;
+
+  // count the storage proofs first, so we can put all of them into one allocation.
+  for (d_iterator_t iter = d_iter(accounts); iter.left; d_iter_next(&iter))
+    l_storage += d_len(d_get(iter.token, K_STORAGE_PROOF));
+
+  env->accounts     = _calloc(d_len(accounts), sizeof(env_account_t));
+  env->storage      = l_storage ? _malloc(l_storage * sizeof(env_storage_t)) : NULL;
+  env_account_t* ac = env->accounts;
+  env_storage_t* s  = env->storage;
+
+  for (d_iterator_t iter = d_iter(accounts); iter.left; d_iter_next(&iter)) {
+    bytes_t* address = d_get_byteskl(iter.token, K_ADDRESS, 20);
+    // if a address is used twice, the first one wins.
+    if (!address || evm_index_find(&env->index, address->data, 20)) continue;
+    memcpy(ac->address, address->data, 20);
+    ac->token = iter.token;
+    evm_index_add(&env->index, ac, 20);
+
+    for (d_iterator_t sp = d_iter(d_get(iter.token, K_STORAGE_PROOF)); sp.left; d_iter_next(&sp)) {
+      bytes_t k = d_to_bytes(d_get(sp.token, K_KEY));
+      if (!k.data || k.len > 32) continue;
+      uint256_set(k.data, k.len, s->key);
+      if (evm_index_find(&ac->storage, s->key, 32)) continue;
+      s->token = sp.token;
+      evm_index_add(&ac->storage, s, 32);
+      s++;
+    }
+    ac++;
   }
-  for (i = 0, t = accounts + 1; i < d_len(accounts); i++, t = d_next(t)) {
-    if (memcmp(d_get_byteskl(t, K_ADDRESS, 20)->data, address, 20) == 0)
-      return t;
+  return env;
+}
+
+void in3_env_free(void* env_ptr) {
+  in3_env_t* env = env_ptr;
+  for (env_account_t* ac = env->accounts; ac && ac < env->accounts + env->index.used; ac++)
+    evm_index_free(&ac->storage);
+  evm_index_free(&env->index);
+  if (env->accounts) _free(env->accounts);
+  if (env->storage) _free(env->storage);
+  _free(env);
+}
+
+/** reports the error to the context, unless the evm runs as task, which is verified again without task if it fails. */
+static void env_err(in3_env_t* env, char* msg) {
+  if (!env->in_task) vc_err(env->vc, msg);
+}
+
+static d_token_t* get_account(in3_env_t* env, uint8_t* address) {
+  if (!env->accounts) {
+    env_err(env, "no accounts");
+    return NULL;
   }
-  vc_err(vc, "The account could not be found!");
+  env_account_t* ac = evm_index_find(&env->index, address, 20);
+  if (ac) return ac->token;
+  env_err(env, "The account could not be found!");
   return NULL;
 }
 
-int in3_get_env(void* evm_ptr, uint16_t evm_key, uint8_t* in_data, int in_len, uint8_t** out_data, int offset, int len) {
+static in3_ret_t get_code(in3_env_t* env, address_t address, cache_entry_t** entry) {
+  return env->in_task ? in3_get_cached_code(env->vc, address, entry) : in3_get_code(env->vc, address, entry);
+}
+
+static d_token_t* get_storage(in3_env_t* env, uint8_t* address, uint8_t* key, int l_key) {
+  bytes32_t      k;
+  env_account_t* ac = evm_index_find(&env->index, address, 20);
+  if (!ac || l_key > 32) return NULL;
+  uint256_set(key, l_key, k);
+  env_storage_t* s = evm_index_find(&ac->storage, k, 32);
+  return s ? s->token : NULL;
+}
+
+static int get_env(void* evm_ptr, uint16_t evm_key, uint8_t* in_data, int in_len, uint8_t** out_data, int offset, int len) {
   bytes_t*  res = NULL;
   in3_ret_t ret = IN3_OK;
 
-  d_token_t *t, *t2;
-  int        i;
+  d_token_t* t;
 
   evm_t* evm = evm_ptr;
   if (!evm) return EVM_ERROR_INVALID_ENV;
-  in3_vctx_t* vc = evm->env_ptr;
-  if (!vc) return EVM_ERROR_INVALID_ENV;
+  in3_env_t* env = evm->env_ptr;
+  if (!env || !env->vc) return EVM_ERROR_INVALID_ENV;
+  in3_vctx_t* vc = env->vc;
 
   switch (evm_key) {
     case EVM_ENV_BLOCKHEADER:
@@ -74,35 +163,26 @@ int in3_get_env(void* evm_ptr, uint16_t evm_key, uint8_t* in_data, int in_len, u
       return res->len;
 
     case EVM_ENV_BALANCE:
-      if (!(t = get_account(vc, d_get(vc->proof, K_ACCOUNTS), in_data)) || !(t = d_get(t, K_BALANCE)))
+      if (!(t = get_account(env, in_data)) || !(t = d_get(t, K_BALANCE)))
         return EVM_ERROR_INVALID_ENV;
       bytes_t b1 = d_to_bytes(t);
       *out_data  = b1.data;
       return b1.len;
 
     case EVM_ENV_NONCE:
-      if (!(t = get_account(vc, d_get(vc->proof, K_ACCOUNTS), in_data)) || !(t = d_get(t, K_NONCE)))
+      if (!(t = get_account(env, in_data)) || !(t = d_get(t, K_NONCE)))
         return EVM_ERROR_INVALID_ENV;
       bytes_t b2 = d_to_bytes(t);
       *out_data  = b2.data;
       return b2.len;
 
     case EVM_ENV_STORAGE:
-      if (!(t = get_account(vc, d_get(vc->proof, K_ACCOUNTS), evm->address)) || !(t = d_get(t, K_STORAGE_PROOF)))
+      if (!get_account(env, evm->address) || !(t = get_storage(env, evm->address, in_data, in_len)))
         return EVM_ERROR_INVALID_ENV;
-
-      for (i = 0, t2 = t + 1; i < d_len(t); i++, t2 = d_next(t2)) {
-        bytes_t k = d_to_bytes(d_get(t2, K_KEY));
-        if (!k.data) return EVM_ERROR_INVALID_ENV;
-
-        if (big_cmp(in_data, in_len, k.data, k.len) == 0) {
-          k = d_to_bytes(d_get(t2, K_VALUE));
-          if (!k.data) return EVM_ERROR_INVALID_ENV;
-          *out_data = k.data;
-          return k.len;
-        }
-      }
-      return EVM_ERROR_INVALID_ENV;
+      bytes_t b3 = d_to_bytes(d_get(t, K_VALUE));
+      if (!b3.data) return EVM_ERROR_INVALID_ENV;
+      *out_data = b3.data;
+      return b3.len;
 
     case EVM_ENV_BLOCKHASH:
       return EVM_ERROR_UNSUPPORTED_CALL_OPCODE;
@@ -110,7 +190,7 @@ int in3_get_env(void* evm_ptr, uint16_t evm_key, uint8_t* in_data, int in_len, u
     case EVM_ENV_CODE_SIZE: {
       if (in_len != 20) return EVM_ERROR_INVALID_ENV;
       cache_entry_t* entry = NULL;
-      ret                  = in3_get_code(vc, in_data, &entry);
+      ret                  = get_code(env, in_data, &entry);
       if (ret < 0) return ret;
       if (!entry) return EVM_ERROR_INVALID_ENV;
       *out_data = entry->buffer;
@@ -118,17 +198,15 @@ int in3_get_env(void* evm_ptr, uint16_t evm_key, uint8_t* in_data, int in_len, u
     }
     case EVM_ENV_CODE_HASH: {
       if (in_len != 20) return EVM_ERROR_INVALID_ENV;
-      if (!(t = get_account(vc, d_get(vc->proof, K_ACCOUNTS), evm->address)) || !(t = d_get(t, K_STORAGE_PROOF)))
+      if (!(t = get_account(env, in_data)) || !(t = d_getl(t, K_CODE_HASH, 32)))
         return EVM_ERROR_INVALID_ENV;
-      t = d_getl(t, K_CODE_HASH, 32);
-      if (!t) return EVM_ERROR_INVALID_ENV;
       *out_data = t->data;
       return 32;
     }
     case EVM_ENV_CODE_COPY: {
       if (in_len != 20) return EVM_ERROR_INVALID_ENV;
       cache_entry_t* entry = NULL;
-      ret                  = in3_get_code(vc, in_data, &entry);
+      ret                  = get_code(env, in_data, &entry);
       if (ret < 0) return ret;
       if (!entry) return EVM_ERROR_INVALID_ENV;
       *out_data = entry->value.data + offset;
@@ -138,3 +216,11 @@ int in3_get_env(void* evm_ptr, uint16_t evm_key, uint8_t* in_data, int in_len, u
   }
   return -2;
 }
+
+int in3_get_env(void* evm_ptr, uint16_t evm_key, uint8_t* in_data, int in_len, uint8_t** out_data, int offset, int len) {
+  evm_t* evm = evm_ptr;
+  if (!evm) return EVM_ERROR_INVALID_ENV;
+  int res;
+  EVM_TRACE_TIMED(evm, env, evm_key, res, get_env(evm_ptr, evm_key, in_data, in_len, out_data, offset, len));
+  return res;
+}
@@ -509,16 +509,41 @@ int evm_execute(evm_t* evm) {
   }
 }
 
+#ifdef EVM_TRACE
+static evm_tracer_t* evm_tracer = NULL;
+
+void          evm_set_tracer(evm_tracer_t* tracer) { evm_tracer = tracer; }
+evm_tracer_t* evm_get_tracer() { return evm_tracer; }
+
+/** executes the opcode and passes the step to the tracer. */
+static int evm_execute_traced(evm_t* evm) {
+  evm_trace_step_t step = {
+      .pc         = evm->pos,
+      .op         = evm->code.data[evm->pos],
+      .gas        = evm->gas,
+      .call_depth = evm->call_depth,
+      .stack_size = evm->stack_size,
+      .mem_size   = evm->memory.b.len};
+  uint64_t start = evm_trace_ns();
+  int      res   = evm_execute(evm);
+  step.ns        = evm_trace_ns() - start;
+  evm->tracer->step(evm->tracer, evm, &step);
+  return res;
+}
+#endif
+
 int evm_run(evm_t* evm, address_t code_address) {
 
   INIT_GAS(evm);
+  int res = 0;
 
   // for precompiled we simply execute it there
-  if (evm_is_precompiled(evm, code_address))
-    return evm_run_precompiled(evm, code_address);
+  if (evm_is_precompiled(evm, code_address)) {
+    EVM_TRACE_TIMED(evm, precompiled, code_address[19], res, evm_run_precompiled(evm, code_address));
+    return res;
+  }
   // timeout is simply used in case we don't use gas to make sure we don't run a infite loop.
   uint32_t timeout = 0xFFFFFFFF;
-  int      res     = 0;
 #ifdef DEBUG
   uint32_t last     = 0;
   uint64_t last_gas = 0;
@@ -534,7 +559,12 @@ int evm_run(evm_t* evm, address_t code_address) {
     });
 
     // execute the opcode
-    res = evm_execute(evm);
+#ifdef EVM_TRACE
+    if (evm->tracer && evm->tracer->step)
+      res = evm_execute_traced(evm);
+    else
+#endif
+      res = evm_execute(evm);
     // display the result of the opcode (only if the debug flag is set)
 #ifdef EVM_GAS
     // debug gas output
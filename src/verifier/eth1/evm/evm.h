@@ -50,18 +50,31 @@ typedef enum evm_state {
 } evm_state_t;
 
 #ifdef EVM_GAS
-#define gas_options       \
-  struct {                \
-    account_t*  accounts; \
-    struct evm* parent;   \
-    logs_t*     logs;     \
-    uint64_t    refund;   \
-    uint64_t    init_gas; \
+#define gas_options                \
+  struct {                         \
+    account_t*  accounts;          \
+    evm_index_t account_index;     \
+    struct evm* parent;            \
+    logs_t*     logs;              \
+    uint64_t    refund;            \
+    uint64_t    init_gas;          \
   }
 #else
 #define gas_options
 #endif
 
+#ifdef EVM_TRACE
+#define trace_options               \
+  struct {                          \
+    struct evm_tracer* tracer;      \
+    uint32_t           call_depth;  \
+    uint8_t            code_hashed; \
+    bytes32_t          code_hash;   \
+  }
+#else
+#define trace_options
+#endif
+
 #define EVM_ERROR_EMPTY_STACK -20             /**< the no more elements on the stack  */
 #define EVM_ERROR_INVALID_OPCODE -21          /**< the opcode is not supported  */
 #define EVM_ERROR_BUFFER_TOO_SMALL -22        /**< reading data from a position, which is not initialized  */
@@ -204,8 +217,20 @@ typedef enum evm_state {
  */
 typedef int (*evm_get_env)(void* evm, uint16_t evm_key, uint8_t* in_data, int in_len, uint8_t** out_data, int offset, int len);
 
+/**
+ * open addressing hash index (linear probing) used to find accounts and storage entries.
+ *
+ * Each entry must start with its key (the address of a account_t or the key of a storage_t).
+ * The index does not own the entries, which are still kept in the linked lists.
+ */
+typedef struct evm_index {
+  void**   entries; /**< the slots (size is always a power of 2) */
+  uint32_t size;    /**< number of slots */
+  uint32_t used;    /**< number of occupied slots */
+} evm_index_t;
+
 typedef struct account_storage {
-  bytes32_t               key;
+  bytes32_t               key; /**< must be the first member, since it is used as key in the evm_index_t */
   bytes32_t               value;
   struct account_storage* next;
 } storage_t;
@@ -216,11 +241,12 @@ typedef struct logs {
 } logs_t;
 
 typedef struct account {
-  address_t       address;
+  address_t       address; /**< must be the first member, since it is used as key in the evm_index_t */
   bytes32_t       balance;
   bytes32_t       nonce;
   bytes_t         code;
   storage_t*      storage;
+  evm_index_t     storage_index; /**< index of all storage-entries of this account */
   struct account* next;
 } account_t;
 
@@ -255,9 +281,62 @@ typedef struct evm {
   bytes_t  gas_price;  /**< current gasprice */
   uint64_t gas;
   gas_options;
+  trace_options;
 
 } evm_t;
 
+#ifdef EVM_TRACE
+/** a single step of the evm, which is passed to the tracer after executing the opcode. */
+typedef struct evm_trace_step {
+  uint32_t pc;         /**< the position of the opcode within the code */
+  uint8_t  op;         /**< the opcode */
+  uint64_t gas;        /**< the gas left before executing the opcode */
+  uint32_t call_depth; /**< the depth of the call (0 for the root-call) */
+  int      stack_size; /**< number of items on the stack before executing the opcode */
+  uint32_t mem_size;   /**< size of the memory before executing the opcode */
+  uint64_t ns;         /**< nanoseconds spent executing the opcode (including subcalls) */
+} evm_trace_step_t;
+
+/**
+ * a tracer receives callbacks while the evm is running.
+ *
+ * Each callback is optional.
+ */
+typedef struct evm_tracer {
+  void (*step)(struct evm_tracer* tracer, evm_t* evm, evm_trace_step_t* step);          /**< called after each opcode */
+  void (*env)(struct evm_tracer* tracer, evm_t* evm, uint16_t evm_key, uint64_t ns);     /**< called after each request to in3_get_env */
+  void (*precompiled)(struct evm_tracer* tracer, evm_t* evm, uint8_t address, uint64_t ns); /**< called after running a precompiled contract */
+  void* ptr;                                                                              /**< custom data */
+} evm_tracer_t;
+
+/**
+ * sets the tracer used for all evms created with evm_call (NULL disables tracing).
+ *
+ * The tracer is shared by all evms and its callbacks are not synchronized, so tracing requires the evms to run in one thread.
+ * If build with THREADS, set max_threads of the client to 1 while a tracer is registered.
+ */
+void evm_set_tracer(evm_tracer_t* tracer);
+
+/** returns the tracer used for new evms. */
+evm_tracer_t* evm_get_tracer();
+
+/** monotonic time in nanoseconds */
+uint64_t evm_trace_ns();
+
+/** executes the call and reports the time spent to the callback of the tracer, if set. */
+#define EVM_TRACE_TIMED(evm, callback, arg, res, call)                                     \
+  do {                                                                                    \
+    if ((evm)->tracer && (evm)->tracer->callback) {                                       \
+      uint64_t _start = evm_trace_ns();                                                   \
+      res             = call;                                                             \
+      (evm)->tracer->callback((evm)->tracer, (evm), (arg), evm_trace_ns() - _start);       \
+    } else                                                                                \
+      res = call;                                                                         \
+  } while (0)
+#else
+#define EVM_TRACE_TIMED(evm, callback, arg, res, call) res = call
+#endif
+
 int evm_stack_push(evm_t* evm, uint8_t* data, uint8_t len);
 int evm_stack_push_ref(evm_t* evm, uint8_t** dst, uint8_t len);
 int evm_stack_push_int(evm_t* evm, uint32_t val);
@@ -289,14 +368,26 @@ int evm_sub_call(evm_t*   parent,
 
 int  evm_ensure_memory(evm_t* evm, uint32_t max_pos);
 int  in3_get_env(void* evm_ptr, uint16_t evm_key, uint8_t* in_data, int in_len, uint8_t** out_data, int offset, int len);
-int  evm_call(void*    vc,
-              uint8_t  address[20],
-              uint8_t* value, wlen_t l_value,
-              uint8_t* data, uint32_t l_data,
-              uint8_t   caller[20],
-              uint64_t  gas,
-              uint64_t  chain_id,
-              bytes_t** result);
+
+/**
+ * creates the enviroment used by in3_get_env, which indexes the accounts and storage proofs of the verification context.
+ * 
+ * With `in_task` the enviroment only reads from the context, so evms of different requests can run as parallel tasks.
+ * Code must then be cached before (see in3_get_cached_code) and errors are not reported to the context.
+ */
+void* in3_env_new(void* vc, bool in_task);
+/** frees the enviroment created with in3_env_new */
+void in3_env_free(void* env);
+/** runs a eth_call against the proof of the verification context (see in3_env_new for `in_task`). */
+int evm_call(void*    vc,
+             bool     in_task,
+             uint8_t  address[20],
+             uint8_t* value, wlen_t l_value,
+             uint8_t* data, uint32_t l_data,
+             uint8_t   caller[20],
+             uint64_t  gas,
+             uint64_t  chain_id,
+             bytes_t** result);
 void evm_print_stack(evm_t* evm, uint64_t last_gas, uint32_t pos);
 void evm_free(evm_t* evm);
 
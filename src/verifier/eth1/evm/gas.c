@@ -49,6 +49,7 @@ void update_account_code(evm_t* evm, account_t* new_account) {
 
 void evm_init(evm_t* evm) {
   evm->accounts = NULL;
+  memset(&evm->account_index, 0, sizeof(evm_index_t));
   evm->gas      = 0;
   evm->logs     = NULL;
   evm->parent   = NULL;
@@ -103,6 +104,7 @@ int selfdestruct_gas(evm_t* evm) {
     self_account->storage = s->next;
     _free(s);
   }
+  evm_index_free(&self_account->storage_index);
   evm->state = EVM_STATE_STOPPED;
   return 0;
 }
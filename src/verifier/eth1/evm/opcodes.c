@@ -61,7 +61,15 @@ int op_math(evm_t* evm, uint8_t op, uint8_t mod) {
       l = big_sub(a, la, b, lb, res);
       break;
     case MATH_MUL:
-      l = big_mul(a, la, b, lb, res, mod ? 65 : 32);
+      if (mod) {
+        // MULMOD reduces the full product directly
+        uint8_t* mod_data;
+        int      modl = evm_stack_pop_ref(evm, &mod_data);
+        if (modl < 0) return modl;
+        l   = big_mulmod(a, la, b, lb, mod_data, modl, res);
+        mod = 0;
+      } else
+        l = big_mul(a, la, b, lb, res, 32);
       break;
     case MATH_DIV:
       l = big_div(a, la, b, lb, 0, res);
@@ -650,6 +658,7 @@ int op_selfdestruct(evm_t* evm) {
     self_account->storage = s->next;
     _free(s);
   }
+  evm_index_free(&self_account->storage_index);
   evm->state = EVM_STATE_STOPPED;
   return 0;
 }
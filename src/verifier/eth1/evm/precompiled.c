@@ -35,11 +35,10 @@
 #include "precompiled.h"
 #include "../../../core/util/mem.h"
 #include "../../../core/util/utils.h"
-#include "../../../third-party/crypto/ecdsa.h"
 #include "../../../third-party/crypto/ripemd160.h"
-#include "../../../third-party/crypto/secp256k1.h"
 #include "../../../third-party/crypto/sha2.h"
-#include "../../../third-party/tommath/tommath.h"
+#include "../nano/ecrecover.h"
+#include "big.h"
 #include "evm.h"
 #include "gas.h"
 #ifndef MAX
@@ -58,23 +57,30 @@ uint8_t evm_is_precompiled(evm_t* evm, address_t address) {
 
 int pre_ecrecover(evm_t* evm) {
   subgas(G_PRE_EC_RECOVER);
-  if (evm->call_data.len < 128) return 0;
 
-  uint8_t pubkey[65], *vdata = evm->call_data.data + 32, vl = 32;
+  // missing input bytes are treated as zeros
+  uint8_t input[128], *data = evm->call_data.data;
+  if (evm->call_data.len < 128) {
+    memset(input, 0, 128);
+    if (evm->call_data.len) memcpy(input, evm->call_data.data, evm->call_data.len);
+    data = input;
+  }
+
+  uint8_t pubkey[65], *vdata = data + 32, vl = 32;
   optimize_len(vdata, vl);
-  if (vl > 1) return 0;
+  if (vl > 1 || (*vdata != 27 && *vdata != 28)) return 0;
 
   // verify signature
-  if (ecdsa_recover_pub_from_sig(&secp256k1, pubkey, evm->call_data.data + 64, evm->call_data.data, *vdata >= 27 ? *vdata - 27 : *vdata) == 0) {
-    evm->return_data.data = _malloc(20);
-    evm->return_data.len  = 20;
+  if (ecrecover_pub(data + 64, *vdata - 27, data, pubkey) == 0) {
+    evm->return_data.data = _calloc(32, 1);
+    evm->return_data.len  = 32;
 
     uint8_t hash[32];
 
-    // hash it and return the last 20 bytes as address
+    // hash it and return the last 20 bytes as address, left padded to a word
     bytes_t public_key = {.data = pubkey + 1, .len = 64};
     if (sha3_to(&public_key, hash) == 0)
-      memcpy(evm->return_data.data, hash + 12, 20);
+      memcpy(evm->return_data.data + 12, hash + 12, 20);
   }
   return 0;
 }
@@ -104,38 +110,48 @@ int pre_identity(evm_t* evm) {
   return 0;
 }
 
+/** returns the byte of the call data at the given offset, which is zero if it is out of range. */
+static inline uint8_t call_data_at(evm_t* evm, uint64_t offset) {
+  return offset < evm->call_data.len ? evm->call_data.data[offset] : 0;
+}
+
+/** reads a length of the modexp header and returns 1 if it does not fit in 32 bits. */
+static int modexp_len(evm_t* evm, uint32_t offset, uint32_t* len) {
+  uint8_t tmp[32] = {0};
+  if (offset < evm->call_data.len) memcpy(tmp, evm->call_data.data + offset, MIN(32, evm->call_data.len - offset));
+  *len = bytes_to_int(tmp + 28, 4);
+  for (int i = 0; i < 28; i++) {
+    if (tmp[i]) return 1;
+  }
+  return 0;
+}
+
 int pre_modexp(evm_t* evm) {
-  if (evm->call_data.len < 96) return -1;
-  uint8_t      res[64];
-  uint_fast8_t hp     = 0;
-  uint32_t     l_base = bytes_to_int(evm->call_data.data + 28, 4);
-  uint32_t     l_exp  = bytes_to_int(evm->call_data.data + 28 + 32, 4);
-  uint32_t     l_mod  = bytes_to_int(evm->call_data.data + 28 + 64, 4);
-  if (evm->call_data.len < 96 + l_base + l_exp + l_mod) return -1;
-  bytes_t b_base = bytes(evm->call_data.data + 96, l_base);
-  bytes_t b_exp  = bytes(evm->call_data.data + 96 + l_base, l_exp);
-  bytes_t b_mod  = bytes(evm->call_data.data + 96 + l_base + l_exp, l_mod);
+  uint32_t l_base, l_exp, l_mod;
+  if (modexp_len(evm, 0, &l_base) || modexp_len(evm, 64, &l_mod)) return EVM_ERROR_OUT_OF_GAS;
+  if (modexp_len(evm, 32, &l_exp)) {
+    // such an exponent could only be paid if the multiplication is free, which means the result is empty.
+    if (l_base || l_mod) return EVM_ERROR_OUT_OF_GAS;
+    return 0;
+  }
+  uint64_t total = 96 + (uint64_t) l_base + l_exp + l_mod;
 
-#ifdef EVM_GAS
+  // the gas may allow operands much larger than the call data, so we reject lengths we would not want to allocate or compute.
+  if (l_base > MODEXP_MAX_LEN || l_exp > MODEXP_MAX_LEN || l_mod > MODEXP_MAX_LEN) return EVM_ERROR_OUT_OF_GAS;
 
+#ifdef EVM_GAS
+  // index of the highest bit of the first 32 bytes of the exponent
+  uint64_t hp = 0, ael;
   for (uint32_t i = 0; i < MIN(l_exp, 32); i++) {
-    if (b_exp.data[i]) {
-      for (int n = 7; n >= 0; n--) {
-        if (b_exp.data[i] >> n) {
-          hp = ((l_exp - i - 1) << 3) + n;
-          break;
-        }
-      }
+    uint8_t b = call_data_at(evm, 96 + (uint64_t) l_base + i);
+    if (b) {
+      int n = 7;
+      while (!(b >> n)) n--;
+      hp = ((MIN(l_exp, 32) - i - 1) << 3) + n;
       break;
     }
   }
-  uint64_t ael;
-  if (l_exp <= 32 && hp == 0)
-    ael = 0;
-  else if (l_exp <= 32)
-    ael = hp;
-  else
-    ael = 8 * (l_exp - 32) + hp;
+  ael = l_exp <= 32 ? hp : 8 * ((uint64_t) l_exp - 32) + hp;
 
   // calc gas
   //  floor(mult_complexity(max(length_of_MODULUS, length_of_BASE)) * max(ADJUSTED_EXPONENT_LENGTH, 1) / GQUADDIVISOR)
@@ -147,33 +163,23 @@ int pre_modexp(evm_t* evm) {
   else
     lm = lm * lm / 16 + 480 * lm - 199680;
 
+  if (ael > 1 && lm > UINT64_MAX / ael) return EVM_ERROR_OUT_OF_GAS;
   subgas(lm * MAX(1, ael) / G_PRE_MODEXP_GQUAD_DIVISOR);
-
 #endif
-  // we use gmp for now
-  mp_int m_base, m_exp, m_mod, m_res;
-  mp_init(&m_base);
-  mp_init(&m_exp);
-  mp_init(&m_mod);
-  mp_init(&m_res);
-
-  mp_import(&m_base, b_base.len, 1, sizeof(uint8_t), 1, 0, b_base.data);
-  mp_import(&m_exp, b_exp.len, 1, sizeof(uint8_t), 1, 0, b_exp.data);
-  mp_import(&m_mod, b_mod.len, 1, sizeof(uint8_t), 1, 0, b_mod.data);
-
-  m_base.sign = m_exp.sign = m_mod.sign = 0;
-  mp_exptmod(&m_base, &m_exp, &m_mod, &m_res);
-  size_t ml;
-  mp_export(res, &ml, 1, sizeof(uint8_t), 1, 0, &m_res);
-
-  mp_clear(&m_base);
-  mp_clear(&m_exp);
-  mp_clear(&m_mod);
-  mp_clear(&m_res);
-
-  evm->return_data.data = _malloc(ml);
-  evm->return_data.len  = ml;
-  memcpy(evm->return_data.data, res, ml);
+  if (!l_mod) return 0;
+
+  // missing call data is treated as zeros, so we only copy if the input is too short.
+  uint8_t* data = evm->call_data.data;
+  if (evm->call_data.len < total) {
+    data = _calloc(total, 1);
+    memcpy(data, evm->call_data.data, evm->call_data.len);
+  }
+
+  evm->return_data.data = _malloc(l_mod);
+  evm->return_data.len  = l_mod;
+  big_modexp(data + 96, l_base, data + 96 + l_base, l_exp, data + 96 + l_base + l_exp, l_mod, evm->return_data.data);
+
+  if (data != evm->call_data.data) _free(data);
   return 0;
 }
 
@@ -193,6 +199,8 @@ int evm_run_precompiled(evm_t* evm, const address_t address) {
       return pre_ec_add(evm);
     case 7:
       return pre_ec_mul(evm);
+    case 8:
+      return pre_ec_pairing(evm);
     case 9:
       return pre_blake2(evm);
     default:
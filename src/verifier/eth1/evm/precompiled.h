@@ -37,11 +37,17 @@
 
 #include "evm.h"
 
+#ifndef MODEXP_MAX_LEN
+#define MODEXP_MAX_LEN 1024 /**< max length in bytes of base, exponent and modulus of the MODEXP precompile */
+#endif
+
 int     evm_run_precompiled(evm_t* evm, const uint8_t address[20]);
 uint8_t evm_is_precompiled(evm_t* evm, uint8_t address[20]);
 
+int pre_modexp(evm_t* evm);
 int pre_ec_add(evm_t* evm);
 int pre_ec_mul(evm_t* evm);
+int pre_ec_pairing(evm_t* evm);
 int pre_blake2(evm_t* evm);
 
 #endif
\ No newline at end of file
@@ -0,0 +1,173 @@
+/*******************************************************************************
+ * This file is part of the Incubed project.
+ * Sources: https://github.com/slockit/in3-c
+ * 
+ * Copyright (C) 2018-2019 slock.it GmbH, Blockchains LLC
+ * 
+ * 
+ * COMMERCIAL LICENSE USAGE
+ * 
+ * Licensees holding a valid commercial license may use this file in accordance 
+ * with the commercial license agreement provided with the Software or, alternatively, 
+ * in accordance with the terms contained in a written agreement between you and 
+ * slock.it GmbH/Blockchains LLC. For licensing terms and conditions or further 
+ * information please contact slock.it at in3@slock.it.
+ * 	
+ * Alternatively, this file may be used under the AGPL license as follows:
+ *    
+ * AGPL LICENSE USAGE
+ * 
+ * This program is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Affero General Public License as published by the Free Software 
+ * Foundation, either version 3 of the License, or (at your option) any later version.
+ *  
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY 
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A 
+ * PARTICULAR PURPOSE. See the GNU Affero General Public License for more details.
+ * [Permissions of this strong copyleft license are conditioned on making available 
+ * complete source code of licensed works and modifications, which include larger 
+ * works using a licensed work, under the same license. Copyright and license notices 
+ * must be preserved. Contributors provide an express grant of patent rights.]
+ * You should have received a copy of the GNU Affero General Public License along 
+ * with this program. If not, see <https://www.gnu.org/licenses/>.
+ *******************************************************************************/
+
+#ifdef EVM_TRACE
+#define _POSIX_C_SOURCE 199309L
+#include "trace.h"
+#include "../../../core/util/mem.h"
+#include "../../../core/util/stringbuilder.h"
+#include "../../../core/util/utils.h"
+#include "accounts.h"
+#include <inttypes.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+/** counter for a position within a code. */
+typedef struct {
+  uint8_t               key[36]; /**< codehash + pc */
+  evm_profile_counter_t counter;
+} profile_pc_t;
+
+uint64_t evm_trace_ns() {
+  struct timespec t;
+  clock_gettime(CLOCK_MONOTONIC, &t);
+  return (uint64_t) t.tv_sec * 1000000000ULL + t.tv_nsec;
+}
+
+/** the codehash of the running code, which is calculated once per evm, since the code lives as long as the evm. */
+static uint8_t* get_code_hash(evm_t* evm) {
+  if (!evm->code_hashed) {
+    sha3_to(&evm->code, evm->code_hash);
+    evm->code_hashed = 1;
+  }
+  return evm->code_hash;
+}
+
+static void profile_step(evm_tracer_t* tracer, evm_t* evm, evm_trace_step_t* step) {
+  evm_profile_t* profile = (evm_profile_t*) tracer;
+  profile->ops[step->op].count++;
+  profile->ops[step->op].ns += step->ns;
+
+  uint8_t key[36];
+  memcpy(key, get_code_hash(evm), 32);
+  int_to_bytes(step->pc, key + 32);
+  profile_pc_t* p = evm_index_find(&profile->pcs, key, 36);
+  if (!p) {
+    p = _calloc(1, sizeof(profile_pc_t));
+    memcpy(p->key, key, 36);
+    evm_index_add(&profile->pcs, p, 36);
+  }
+  p->counter.count++;
+  p->counter.ns += step->ns;
+}
+
+static void profile_env(evm_tracer_t* tracer, evm_t* evm, uint16_t evm_key, uint64_t ns) {
+  UNUSED_VAR(evm);
+  UNUSED_VAR(evm_key);
+  ((evm_profile_t*) tracer)->env.count++;
+  ((evm_profile_t*) tracer)->env.ns += ns;
+}
+
+static void profile_precompiled(evm_tracer_t* tracer, evm_t* evm, uint8_t address, uint64_t ns) {
+  UNUSED_VAR(evm);
+  UNUSED_VAR(address);
+  ((evm_profile_t*) tracer)->precompiled.count++;
+  ((evm_profile_t*) tracer)->precompiled.ns += ns;
+}
+
+evm_profile_t* evm_profile_new() {
+  evm_profile_t* profile      = _calloc(1, sizeof(evm_profile_t));
+  profile->tracer.step        = profile_step;
+  profile->tracer.env         = profile_env;
+  profile->tracer.precompiled = profile_precompiled;
+  profile->tracer.ptr         = profile;
+  return profile;
+}
+
+static void free_entries(evm_index_t* index) {
+  for (uint32_t i = 0; i < index->size; i++) {
+    if (index->entries[i]) _free(index->entries[i]);
+  }
+  evm_index_free(index);
+}
+
+void evm_profile_free(evm_profile_t* profile) {
+  free_entries(&profile->pcs);
+  _free(profile);
+}
+
+static int compare_pcs(const void* a, const void* b) {
+  uint64_t na = (*(profile_pc_t**) a)->counter.ns, nb = (*(profile_pc_t**) b)->counter.ns;
+  return na < nb ? 1 : (na > nb ? -1 : 0);
+}
+
+static void add_counter(sb_t* sb, evm_profile_counter_t* counter) {
+  char tmp[64];
+  sprintf(tmp, "\"count\":%" PRIu64 ",\"ns\":%" PRIu64, counter->count, counter->ns);
+  sb_add_chars(sb, tmp);
+}
+
+char* evm_profile_to_json(evm_profile_t* profile, uint32_t max_pcs) {
+  char  tmp[64];
+  sb_t* sb = sb_new("{\"ops\":[");
+  for (int i = 0, n = 0; i < 256; i++) {
+    if (!profile->ops[i].count) continue;
+    sprintf(tmp, "%s{\"op\":\"0x%02x\",", n++ ? "," : "", i);
+    sb_add_chars(sb, tmp);
+    add_counter(sb, profile->ops + i);
+    sb_add_char(sb, '}');
+  }
+
+  // sort the positions by time
+  profile_pc_t** pcs = _malloc(sizeof(profile_pc_t*) * (profile->pcs.used + 1));
+  uint32_t       len = 0;
+  for (uint32_t i = 0; i < profile->pcs.size; i++) {
+    if (profile->pcs.entries[i]) pcs[len++] = profile->pcs.entries[i];
+  }
+  qsort(pcs, len, sizeof(profile_pc_t*), compare_pcs);
+
+  sb_add_chars(sb, "],\"pcs\":[");
+  for (uint32_t i = 0; i < len && i < max_pcs; i++) {
+    bytes_t code_hash = bytes(pcs[i]->key, 32);
+    sb_add_bytes(sb, i ? ",{\"code\":" : "{\"code\":", &code_hash, 1, false);
+    sprintf(tmp, ",\"pc\":%u,", bytes_to_int(pcs[i]->key + 32, 4));
+    sb_add_chars(sb, tmp);
+    add_counter(sb, &pcs[i]->counter);
+    sb_add_char(sb, '}');
+  }
+  _free(pcs);
+
+  sb_add_chars(sb, "],\"env\":{");
+  add_counter(sb, &profile->env);
+  sb_add_chars(sb, "},\"precompiled\":{");
+  add_counter(sb, &profile->precompiled);
+  sb_add_chars(sb, "}}");
+
+  char* res = sb->data;
+  _free(sb);
+  return res;
+}
+
+#endif
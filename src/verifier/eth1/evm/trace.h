@@ -0,0 +1,89 @@
+/*******************************************************************************
+ * This file is part of the Incubed project.
+ * Sources: https://github.com/slockit/in3-c
+ * 
+ * Copyright (C) 2018-2019 slock.it GmbH, Blockchains LLC
+ * 
+ * 
+ * COMMERCIAL LICENSE USAGE
+ * 
+ * Licensees holding a valid commercial license may use this file in accordance 
+ * with the commercial license agreement provided with the Software or, alternatively, 
+ * in accordance with the terms contained in a written agreement between you and 
+ * slock.it GmbH/Blockchains LLC. For licensing terms and conditions or further 
+ * information please contact slock.it at in3@slock.it.
+ * 	
+ * Alternatively, this file may be used under the AGPL license as follows:
+ *    
+ * AGPL LICENSE USAGE
+ * 
+ * This program is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Affero General Public License as published by the Free Software 
+ * Foundation, either version 3 of the License, or (at your option) any later version.
+ *  
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY 
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A 
+ * PARTICULAR PURPOSE. See the GNU Affero General Public License for more details.
+ * [Permissions of this strong copyleft license are conditioned on making available 
+ * complete source code of licensed works and modifications, which include larger 
+ * works using a licensed work, under the same license. Copyright and license notices 
+ * must be preserved. Contributors provide an express grant of patent rights.]
+ * You should have received a copy of the GNU Affero General Public License along 
+ * with this program. If not, see <https://www.gnu.org/licenses/>.
+ *******************************************************************************/
+
+/** @file
+ * profiler for the evm, which aggregates the steps reported to a evm_tracer_t.
+ * 
+ * This is only available if build with `-DEVM_TRACE=true`.
+ * */
+
+#include "evm.h"
+#ifndef evm_trace_h__
+#define evm_trace_h__
+#ifdef EVM_TRACE
+
+/** a counter aggregating calls and time spent. */
+typedef struct evm_profile_counter {
+  uint64_t count; /**< number of calls */
+  uint64_t ns;    /**< cumulative time in nanoseconds */
+} evm_profile_counter_t;
+
+/**
+ * the profiler.
+ * 
+ * Since the tracer is the first member, a pointer to the profile can be passed to evm_set_tracer.
+ * The counters are not synchronized, so a profile must only be fed by evms running in the same thread.
+ */
+typedef struct evm_profile {
+  evm_tracer_t          tracer;      /**< the tracer to register */
+  evm_profile_counter_t ops[256];    /**< counters for each opcode */
+  evm_profile_counter_t env;         /**< time spent requesting data from the enviroment */
+  evm_profile_counter_t precompiled; /**< time spent in precompiled contracts */
+  evm_index_t           pcs;         /**< counters for each codehash + pc */
+} evm_profile_t;
+
+/** creates a new profiler, which can be registered with `evm_set_tracer(&profile->tracer)`. */
+evm_profile_t* evm_profile_new();
+
+/** frees the profiler. */
+void evm_profile_free(evm_profile_t* profile);
+
+/**
+ * creates a json-string with the result of the profiler. 
+ * 
+ * The result must be freed by the caller and looks like this:
+ * 
+ * ```js
+ * {
+ *   "ops": [{"op":"0x01","count":12,"ns":3400}],                  // all executed opcodes
+ *   "pcs": [{"code":"0x..","pc":132,"count":12,"ns":2323}],      // the hottest positions, sorted by time
+ *   "env": {"count":2,"ns":2000},                                 // in3_get_env
+ *   "precompiled": {"count":0,"ns":0}
+ * }
+ * ```
+ */
+char* evm_profile_to_json(evm_profile_t* profile, uint32_t max_pcs);
+
+#endif
+#endif
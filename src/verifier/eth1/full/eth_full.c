@@ -38,13 +38,126 @@
 #include "../../../core/util/data.h"
 #include "../../../core/util/log.h"
 #include "../../../core/util/mem.h"
+#include "../../../core/util/parallel.h"
 #include "../../../third-party/crypto/ecdsa.h"
 #include "../../../verifier/eth1/basic/eth_basic.h"
 #include "../../../verifier/eth1/nano/merkle.h"
 #include "../../../verifier/eth1/nano/serialize.h"
+#include "../evm/code.h"
 #include "../evm/evm.h"
 #include <string.h>
 
+/** runs the eth_call of the request against its proof. */
+static int run_call(in3_vctx_t* vc, bool in_task, bytes_t** result) {
+  d_token_t* tx      = d_get_at(d_get(vc->request, K_PARAMS), 0);
+  bytes_t*   address = d_get_byteskl(tx, K_TO, 20);
+  address_t  zeros;
+  memset(zeros, 0, 20);
+  bytes_t* from      = d_get_byteskl(tx, K_FROM, 20);
+  bytes_t* value     = d_get_bytesk(tx, K_VALUE);
+  bytes_t* data      = d_get_bytesk(tx, K_DATA);
+  bytes_t  gas       = d_to_bytes(d_get(tx, K_GAS_LIMIT));
+  uint64_t gas_limit = bytes_to_long(gas.data, gas.len);
+  if (!gas_limit) gas_limit = 0xFFFFFFFFFFFFFF;
+  return evm_call(vc, in_task, address ? address->data : zeros, value ? value->data : zeros, value ? value->len : 1, data ? data->data : zeros, data ? data->len : 0, from ? from->data : zeros, gas_limit, vc->chain->chain_id, result);
+}
+
+/** a eth_call of a batch, which runs as task. */
+typedef struct {
+  in3_vctx_t vc;       /**< the verification context of the request */
+  bytes32_t  call_key; /**< the key marking the result as verified in the cache of the context */
+  int        ret;      /**< the return code of the evm */
+  bytes_t*   result;   /**< the data returned by the evm */
+} batch_call_t;
+
+/**
+ * creates the key marking the result of a request as verified.
+ * A call returns the same result for the same block, so the key is keccak(index + blockhash + result).
+ */
+static void get_call_key(in3_vctx_t* vc, int index, uint8_t* call_key) {
+  bytes32_t        block_hash;
+  bytes_t          result = d_to_bytes(vc->result);
+  bytes_builder_t* bb     = bb_newl(36 + result.len);
+  sha3_to(d_get_bytesk(vc->proof, K_BLOCK), block_hash);
+  bb_write_int(bb, index);
+  bb_write_raw_bytes(bb, block_hash, 32);
+  bb_write_raw_bytes(bb, result.data, result.len);
+  sha3_to(&bb->b, call_key);
+  bb_free(bb);
+}
+
+static bool is_call_verified(in3_ctx_t* ctx, uint8_t* call_key) {
+  bytes_t k = bytes(call_key, 32);
+  return in3_cache_get_entry(ctx->cache, &k) != NULL;
+}
+
+static void call_task(void* data, int index) {
+  batch_call_t* call = (batch_call_t*) data + index;
+  call->ret          = run_call(&call->vc, true, &call->result);
+}
+
+/**
+ * runs the evms of all eth_calls of a batch, starting with the current request, as parallel tasks.
+ * 
+ * The account proofs and the code of all calls are verified and cached first, so the tasks only read from the context.
+ * Each matching result is marked as verified in the cache of the context, all others are verified again without task,
+ * which reports the error.
+ */
+static in3_ret_t verify_batch_calls(in3_vctx_t* vc) {
+  in3_ctx_t*     ctx = vc->ctx;
+  int            cur = vc->config - ctx->requests_configs, n = 0;
+  in3_ret_t      res = IN3_OK;
+  cache_entry_t* code;
+  batch_call_t*  calls = _malloc((ctx->len - cur) * sizeof(batch_call_t));
+
+  for (int i = cur; i < ctx->len && res == IN3_OK; i++) {
+    batch_call_t* call = calls + n;
+    d_token_t*    in3  = d_get(ctx->responses[i], K_IN3);
+    call->vc           = *vc;
+    call->vc.request   = ctx->requests[i];
+    call->vc.result    = d_get(ctx->responses[i], K_RESULT);
+    call->vc.config    = ctx->requests_configs + i;
+    call->vc.proof     = d_get(in3, K_PROOF);
+    call->result       = NULL;
+    char* method       = d_get_stringk(call->vc.request, K_METHOD);
+    if (!method || strcmp(method, "eth_call") || !call->vc.result || !d_get_bytesk(call->vc.proof, K_BLOCK) || call->vc.config->verification == VERIFICATION_NEVER) continue;
+    call->vc.last_validator_change = d_get_longk(in3, K_LAST_VALIDATOR_CHANGE);
+    call->vc.currentBlock          = d_get_longk(in3, K_CURRENT_BLOCK);
+
+    get_call_key(&call->vc, i, call->call_key);
+    if (is_call_verified(ctx, call->call_key)) continue;
+    // the account proof of the current request was already verified.
+    if (i != cur && eth_verify_account_proof(&call->vc) < 0) res = vc_err(vc, "proof could not be validated");
+    for (d_iterator_t iter = d_iter(d_get(call->vc.proof, K_ACCOUNTS)); iter.left && res == IN3_OK; d_iter_next(&iter)) {
+      bytes_t* address = d_get_byteskl(iter.token, K_ADDRESS, 20);
+      if (address && d_get(iter.token, K_CODE)) res = in3_get_code(&call->vc, address->data, &code);
+    }
+    n++;
+  }
+
+  if (res == IN3_OK && n > 1) {
+#ifdef DEBUG
+    in3_log_level_t old = in3_log_get_level();
+    in3_log_set_level(LOG_ERROR);
+#endif
+    in3_run_tasks(call_task, calls, n, ctx->client->max_threads);
+#ifdef DEBUG
+    in3_log_set_level(old);
+#endif
+    for (int i = 0; i < n; i++) {
+      if (calls[i].ret == 0 && calls[i].result && b_cmp(d_bytes(calls[i].vc.result), calls[i].result)) {
+        bytes_t cache_key = bytes(_malloc(32), 32);
+        memcpy(cache_key.data, calls[i].call_key, 32);
+        in3_cache_add_entry(&ctx->cache, cache_key, bytes(NULL, 0))->must_free = false;
+      }
+    }
+  }
+
+  for (int i = 0; i < n; i++) b_free(calls[i].result);
+  _free(calls);
+  return res;
+}
+
 int in3_verify_eth_full(in3_vctx_t* vc) {
   char* method = d_get_stringk(vc->request, K_METHOD);
   if (vc->config->verification == VERIFICATION_NEVER)
@@ -60,24 +173,24 @@ int in3_verify_eth_full(in3_vctx_t* vc) {
 
   if (strcmp(method, "eth_call") == 0) {
     if (eth_verify_account_proof(vc) < 0) return vc_err(vc, "proof could not be validated");
-    d_token_t* tx      = d_get_at(d_get(vc->request, K_PARAMS), 0);
-    bytes_t*   address = d_get_byteskl(tx, K_TO, 20);
-    address_t  zeros;
-    memset(zeros, 0, 20);
-    int      res       = 0;
-    bytes_t* from      = d_get_byteskl(tx, K_FROM, 20);
-    bytes_t* value     = d_get_bytesk(tx, K_VALUE);
-    bytes_t* data      = d_get_bytesk(tx, K_DATA);
-    bytes_t  gas       = d_to_bytes(d_get(tx, K_GAS_LIMIT));
-    bytes_t* result    = NULL;
-    uint64_t gas_limit = bytes_to_long(gas.data, gas.len);
-    if (!gas_limit) gas_limit = 0xFFFFFFFFFFFFFF;
+
+    // the calls of a batch run in parallel, so most of them are already verified here.
+    if (vc->ctx->len > 1) {
+      bytes32_t call_key;
+      in3_ret_t ret = verify_batch_calls(vc);
+      if (ret < 0) return ret;
+      get_call_key(vc, vc->config - vc->ctx->requests_configs, call_key);
+      if (is_call_verified(vc->ctx, call_key)) return IN3_OK;
+    }
+
+    int      res    = 0;
+    bytes_t* result = NULL;
 #ifdef DEBUG
     in3_log_level_t old = in3_log_get_level();
     in3_log_set_level(LOG_ERROR);
 #endif
 
-    int ret = evm_call(vc, address ? address->data : zeros, value ? value->data : zeros, value ? value->len : 1, data ? data->data : zeros, data ? data->len : 0, from ? from->data : zeros, gas_limit, vc->chain->chain_id, &result);
+    int ret = run_call(vc, false, &result);
 #ifdef DEBUG
     in3_log_set_level(old);
 #endif
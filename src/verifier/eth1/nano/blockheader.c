@@ -35,8 +35,8 @@
 #include "../../../core/client/context.h"
 #include "../../../core/client/keys.h"
 #include "../../../core/util/mem.h"
-#include "../../../third-party/crypto/ecdsa.h"
-#include "../../../third-party/crypto/secp256k1.h"
+#include "../../../third-party/crypto/sha3.h"
+#include "../../../verifier/eth1/nano/ecrecover.h"
 #include "../../../verifier/eth1/nano/eth_nano.h"
 #include "../../../verifier/eth1/nano/merkle.h"
 #include "../../../verifier/eth1/nano/rlp.h"
@@ -45,17 +45,19 @@
 #include <string.h>
 
 #ifdef POA
-/** gets the signer from a blockheader in a aura chain.*/
-static in3_ret_t get_aura_signer(in3_vctx_t* vc, bytes_t* header, uint8_t* dst) {
-  bytes_t         sig, bare;
-  uint8_t         d[4], bare_hash[32], pub_key[65];
+/** calculates the hash signed by the validator of a aura block and returns the signature. */
+static void get_aura_seal(bytes_t* header, uint8_t* seal_hash, bytes_t* sig) {
+  bytes_t         bare;
+  uint8_t         d[4];
   bytes_builder_t ll = {.bsize = 4, .b = {.len = 0, .data = (uint8_t*) &d}};
   struct SHA3_CTX ctx;
+  rlp_index_t     fields;
 
   // get the raw data without the sealed field
-  rlp_decode(header, 0, &bare);
-  rlp_decode(&bare, 12, &sig);
-  bare.len = sig.len + sig.data - bare.data;
+  rlp_index_list(header, &fields);
+  rlp_index_get(&fields, BLOCKHEADER_EXTRA_DATA, sig);
+  bare     = fields.list;
+  bare.len = sig->len + sig->data - bare.data;
 
   // calculate the list prefix
   rlp_add_length(&ll, bare.len, 0xc0);
@@ -64,37 +66,43 @@ static in3_ret_t get_aura_signer(in3_vctx_t* vc, bytes_t* header, uint8_t* dst)
   sha3_256_Init(&ctx);
   sha3_Update(&ctx, ll.b.data, ll.b.len);
   sha3_Update(&ctx, bare.data, bare.len);
-  keccak_Final(&ctx, bare_hash);
-
-  // copy the whole header
-  rlp_decode(header, 0, &bare);
+  keccak_Final(&ctx, seal_hash);
 
   // we have 3 sealed fields the messagehash is calculated hash = sha3( concat ( bare_hash | rlp_encode ( sealed_fields[2] ) ) )
-  if (rlp_decode(&bare, BLOCKHEADER_SEALED_FIELD3, &sig) == 1) {
+  if (rlp_index_get(&fields, BLOCKHEADER_SEALED_FIELD3, sig) == 1) {
     bb_clear(&ll);
-    rlp_add_length(&ll, sig.len, 0xc0);
+    rlp_add_length(&ll, sig->len, 0xc0);
 
     sha3_256_Init(&ctx);
-    sha3_Update(&ctx, bare_hash, 32);
+    sha3_Update(&ctx, seal_hash, 32);
     sha3_Update(&ctx, ll.b.data, ll.b.len);
-    sha3_Update(&ctx, sig.data, sig.len);
-    keccak_Final(&ctx, bare_hash);
+    sha3_Update(&ctx, sig->data, sig->len);
+    keccak_Final(&ctx, seal_hash);
   }
   // get the signature
-  rlp_decode(&bare, BLOCKHEADER_SEALED_FIELD2, &sig);
+  rlp_index_get(&fields, BLOCKHEADER_SEALED_FIELD2, sig);
+}
 
-  // recover signature
-  if (ecdsa_recover_pub_from_sig(&secp256k1, pub_key, sig.data, bare_hash, sig.data[64]))
-    return vc_err(vc, "The signature of a validator could not recover!");
+/** hashes the public key and takes the last 20 bytes as address. */
+static void pub_to_address(const uint8_t* pub_key, uint8_t* dst) {
+  uint8_t hash[32];
+  bytes_t b = {.data = (uint8_t*) pub_key + 1, .len = 64};
+  sha3_to(&b, hash);
+  memcpy(dst, hash + 12, 20);
+}
 
-  // hash the public key
-  sha3_256_Init(&ctx);
-  sha3_Update(&ctx, pub_key + 1, 64);
-  keccak_Final(&ctx, bare_hash);
+/** gets the signer from a blockheader in a aura chain.*/
+static in3_ret_t get_aura_signer(in3_vctx_t* vc, bytes_t* header, uint8_t* dst) {
+  bytes_t sig;
+  uint8_t seal_hash[32], pub_key[65];
+
+  get_aura_seal(header, seal_hash, &sig);
 
-  // and take the last 20 bytes as address
-  memcpy(dst, bare_hash + 12, 20);
+  // recover signature
+  if (sig.len != 65 || ecrecover_pub(sig.data, sig.data[64], seal_hash, pub_key))
+    return vc_err(vc, "The signature of a validator could not recover!");
 
+  pub_to_address(pub_key, dst);
   return IN3_OK;
 }
 
@@ -146,9 +154,13 @@ static in3_ret_t add_aura_validators(in3_vctx_t* vc, vhist_t** vhp) {
     uint8_t          hash[32], signer[20];
     int              passed   = 0;
     uint8_t*         proposer = NULL;
-    bytes_builder_t* curr     = vh_get_validators_for_block(vh, prf_blkno);
-    size_t           currl    = curr->b.len / 20;
+    bytes_t*         curr     = vh_get_validators(vh, prf_blkno);
+    size_t           currl    = curr ? curr->len / 20 : 0;
     i                         = 0;
+    if (!currl) {
+      _free(blocks);
+      return vc_err(vc, "no validators");
+    }
 
     while (fblk) {
       // check signature of proposer
@@ -157,8 +169,7 @@ static in3_ret_t add_aura_validators(in3_vctx_t* vc, vhist_t** vhp) {
 
       // check if it was signed by the right validator
       rlp_decode_in_list(fblk, BLOCKHEADER_SEALED_FIELD1, &tmp);
-      proposer = &curr->b.data[(bytes_to_long(tmp.data, tmp.len) % currl) * 20];
-      bb_free(curr);
+      proposer = &curr->data[(bytes_to_long(tmp.data, tmp.len) % currl) * 20];
       if (memcmp(signer, proposer, 20) != 0) {
         _free(blocks);
         return vc_err(vc, "the block was signed by the wrong key");
@@ -184,15 +195,15 @@ static in3_ret_t add_aura_validators(in3_vctx_t* vc, vhist_t** vhp) {
       return vc_err(vc, "not enough finality to accept state");
 
     // Verify receipt
-    bytes_t* path = create_tx_path(d_get_intk(prf, K_TX_INDEX));
+    uint8_t path_data[5];
+    bytes_t path = create_tx_path_to(d_get_intk(prf, K_TX_INDEX), path_data);
 
     // verify the merkle proof for the receipt
     if (rlp_decode_in_list(prf_blk, BLOCKHEADER_RECEIPT_ROOT, &tmp) != 1)
       return vc_err(vc, "no receipt_root");
 
-    bytes_t** proof       = d_create_bytes_vec(d_get(prf, K_PROOF));
-    bytes_t   raw_receipt = {.len = 0, .data = NULL};
-    if (!proof || !trie_verify_proof(&tmp, path, proof, &raw_receipt))
+    bytes_t raw_receipt = {.len = 0, .data = NULL};
+    if (!trie_verify_proof_token(&tmp, &path, d_get(prf, K_PROOF), &raw_receipt))
       return vc_err(vc, "Could not verify the merkle proof");
 
     rlp_decode(&raw_receipt, 0, &raw_receipt);
@@ -234,7 +245,6 @@ static in3_ret_t add_aura_validators(in3_vctx_t* vc, vhist_t** vhp) {
     if (!bytes_cmp(tmp, vbb->b))
       return vc_err(vc, "wrong data in log");
 
-    _free(proof);
     bb_free(vbb);
 
     vh_add_state(vh, sitr.token, false);
@@ -273,43 +283,62 @@ static vhist_engine_t eth_get_engine(in3_vctx_t* vc, bytes_t* header, d_token_t*
 }
 
 static bytes_t* eth_get_validator(bytes_t* header, int* val_len, vhist_t* vh) {
-  bytes_builder_t* validators = NULL;
-  bytes_t *        proposer, b;
+  bytes_t *validators = NULL, b;
 
   rlp_decode_in_list(header, BLOCKHEADER_NUMBER, &b);
-  validators = vh_get_validators_for_block(vh, bytes_to_long(b.data, b.len));
-  if (val_len) *val_len = validators->b.len / 20;
+  validators = vh_get_validators(vh, bytes_to_long(b.data, b.len));
+  if (!validators || validators->len < 20) return NULL;
+  if (val_len) *val_len = validators->len / 20;
 
   // the nonce used to find out who's turn it is to sign.
   rlp_decode_in_list(header, BLOCKHEADER_SEALED_FIELD1, &b);
 
-  b.data   = &validators->b.data[(bytes_to_long(b.data, b.len) % (validators->b.len / 20)) * 20];
-  b.len    = 20;
-  proposer = b_dup(&b);
-  bb_free(validators);
-  return proposer;
+  b.data = &validators->data[(bytes_to_long(b.data, b.len) % (validators->len / 20)) * 20];
+  b.len  = 20;
+  return b_dup(&b);
 }
 
 in3_ret_t eth_verify_authority(in3_vctx_t* vc, bytes_t** blocks, uint16_t needed_finality, vhist_t* vh) {
-  bytes_t tmp, *proposer, *b = blocks[0];
-  uint8_t hash[32], signer[20];
-  int     val_len = 0, passed = 0, i = 0, ret = 0;
+  bytes_t      tmp, sig, *proposer, *b = blocks[0];
+  uint8_t      hash[32], signer[20], *seal_hashes;
+  int          val_len = 0, passed = 0, i = 0, n = 0, ret = 0;
+  char*        err = NULL;
+  ecrecover_t* sigs;
+
+  // recover the signers of all blocks with one batch
+  while (blocks[n]) n++;
+  if (!n) return vc_err(vc, "no validators");
+  sigs        = _malloc(n * (sizeof(ecrecover_t) + 32));
+  seal_hashes = (uint8_t*) (sigs + n);
+  for (i = 0; i < n; i++) {
+    get_aura_seal(blocks[i], seal_hashes + i * 32, &sig);
+    sigs[i] = (ecrecover_t){.sig = sig.data, .hash = seal_hashes + i * 32, .recid = sig.len == 65 ? sig.data[64] : 0, .res = sig.len != 65};
+  }
+  ecrecover_pub_batch(sigs, n);
 
   // check if the parent hashes match
-  while (b) {
+  for (i = 0; b && !err;) {
     // find the validator with permission to sign this block.
-    if ((proposer = eth_get_validator(b, b == blocks[0] ? &val_len : NULL, vh)) == NULL)
-      return vc_err(vc, "could not find the validator for the block");
+    if ((proposer = eth_get_validator(b, b == blocks[0] ? &val_len : NULL, vh)) == NULL) {
+      err = "could not find the validator for the block";
+      break;
+    }
 
     // check signature of proposer
-    if (get_aura_signer(vc, b, signer))
-      return vc_err(vc, "could not get the signer");
+    if (sigs[i].res) {
+      b_free(proposer);
+      err = "could not get the signer";
+      break;
+    }
+    pub_to_address(sigs[i].pub, signer);
 
     // check if it was signed by the right validator
     ret = memcmp(signer, proposer->data, 20);
     b_free(proposer);
-    if (ret != 0)
-      return vc_err(vc, "the block was signed by the wrong key");
+    if (ret != 0) {
+      err = "the block was signed by the wrong key";
+      break;
+    }
 
     // calculate the blockhash
     sha3_to(b, &hash);
@@ -319,10 +348,12 @@ in3_ret_t eth_verify_authority(in3_vctx_t* vc, bytes_t** blocks, uint16_t needed
 
     // check if the next blocks parent_hash matches
     if (b && (rlp_decode_in_list(b, BLOCKHEADER_PARENT_HASH, &tmp) != 1 || memcmp(hash, tmp.data, 32) != 0))
-      return vc_err(vc, "The parent hashes of the finality blocks don't match");
-
-    passed++;
+      err = "The parent hashes of the finality blocks don't match";
+    else
+      passed++;
   }
+  _free(sigs);
+  if (err) return vc_err(vc, err);
 
   // we could not find any validators
   if (val_len == 0)
@@ -332,7 +363,7 @@ in3_ret_t eth_verify_authority(in3_vctx_t* vc, bytes_t** blocks, uint16_t needed
 }
 #endif
 
-static void add_verified(int max, in3_chain_t* chain, uint64_t number, bytes32_t hash) {
+static void add_verified(int max, in3_chain_t* chain, uint64_t number, bytes32_t hash, bytes_t* parent_hash) {
   if (!max) return;
   if (!chain->verified_hashes) chain->verified_hashes = _calloc(max, sizeof(in3_verified_hash_t));
   int      oldest_index  = 0;
@@ -346,6 +377,7 @@ static void add_verified(int max, in3_chain_t* chain, uint64_t number, bytes32_t
   }
   chain->verified_hashes[oldest_index].block_number = number;
   memcpy(chain->verified_hashes[oldest_index].hash, hash, 32);
+  memcpy(chain->verified_hashes[oldest_index].parent_hash, parent_hash->data, 32);
 }
 
 /** verify the header */
@@ -358,7 +390,7 @@ in3_ret_t eth_verify_blockheader(in3_vctx_t* vc, bytes_t* header, bytes_t* expec
   bytes32_t    block_hash;
   uint64_t     header_number = 0;
   d_token_t *  sig, *signatures;
-  bytes_t      temp, *sig_hash;
+  bytes_t      temp, parent_hash, *sig_hash;
 
   // generate the blockhash;
   sha3_to(header, &block_hash);
@@ -368,6 +400,8 @@ in3_ret_t eth_verify_blockheader(in3_vctx_t* vc, bytes_t* header, bytes_t* expec
     header_number = bytes_to_long(temp.data, temp.len);
   else
     return vc_err(vc, "Could not rlpdecode the blocknumber");
+  if (rlp_decode_in_list(header, BLOCKHEADER_PARENT_HASH, &parent_hash) != 1 || parent_hash.len != 32)
+    return vc_err(vc, "Could not rlpdecode the parentHash");
 
   // if we have a blockhash we verify it
   if (expected_blockhash && memcmp(block_hash, expected_blockhash->data, 32))
@@ -381,6 +415,10 @@ in3_ret_t eth_verify_blockheader(in3_vctx_t* vc, bytes_t* header, bytes_t* expec
           return vc_err(vc, "invalid blockhash");
         else
           return IN3_OK;
+      } else if (vc->chain->verified_hashes[i].block_number == header_number + 1 && memcmp(vc->chain->verified_hashes[i].parent_hash, block_hash, 32) == 0) {
+        // the header is the parent of a verified header, so we can trust it without signatures or finality
+        add_verified(vc->ctx->client->max_verified_hashes, vc->chain, header_number, block_hash, &parent_hash);
+        return IN3_OK;
       }
     }
   }
@@ -403,6 +441,7 @@ in3_ret_t eth_verify_blockheader(in3_vctx_t* vc, bytes_t* header, bytes_t* expec
       // now we verify these block headers
       res = eth_verify_authority(vc, blocks, vc->config->finality, vh);
       _free(blocks);
+      if (res == IN3_OK) add_verified(vc->ctx->client->max_verified_hashes, vc->chain, header_number, block_hash, &parent_hash);
     }
     vh_free(vh);
     return res;
@@ -429,18 +468,23 @@ in3_ret_t eth_verify_blockheader(in3_vctx_t* vc, bytes_t* header, bytes_t* expec
     msg.data = msg_data;
     msg.len  = 32;
 
-    int confirmed = 0; // confirmed is a bitmask for each signature one bit on order to ensure we have all requested signatures
+    // only if this signature has the correct blockhash and blocknumber we will verify it.
+    d_token_t** sigs = _malloc(d_len(signatures) * sizeof(d_token_t*));
+    int         n    = 0;
     for (i = 0, sig = signatures + 1; i < (uint32_t) d_len(signatures); i++, sig = d_next(sig)) {
-      // only if this signature has the correct blockhash and blocknumber we will verify it.
       if (d_get_longk(sig, K_BLOCK) == header_number && ((sig_hash = d_get_byteskl(sig, K_BLOCK_HASH, 32)) ? memcmp(sig_hash->data, block_hash, 32) == 0 : 1))
-        confirmed |= eth_verify_signature(vc, &msg, sig);
+        sigs[n++] = sig;
     }
 
+    // confirmed is a bitmask for each signature one bit on order to ensure we have all requested signatures
+    int confirmed = eth_verify_signatures(vc, &msg, sigs, n);
+    _free(sigs);
+
     if (confirmed != (1 << vc->config->signers_length) - 1) // we must collect all signatures!
       return vc_err(vc, "missing signatures");
 
     // ok, is is verified, so we should add it to the verified hashes
-    add_verified(vc->ctx->client->max_verified_hashes, vc->chain, header_number, block_hash);
+    add_verified(vc->ctx->client->max_verified_hashes, vc->chain, header_number, block_hash, &parent_hash);
   }
 
   return IN3_OK;
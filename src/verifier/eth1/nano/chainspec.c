@@ -48,6 +48,15 @@ typedef struct spec_ {
 
 static spec_t* specs = NULL;
 
+// the rlp encoded specs of the built in chains, generated with scripts/update_chainspec.sh
+static const struct {
+  chain_id_t  chain_id;
+  const char* bin;
+} BUILTIN_SPECS[] = {
+    {0x2a, CHAINSPEC_KOVAN},
+    {0x1, CHAINSPEC_MAINNET},
+    {0x5, CHAINSPEC_GOERLI}};
+
 static void* log_error(char* msg) {
   UNUSED_VAR(msg);
   in3_log_error(msg);
@@ -176,6 +185,14 @@ chainspec_t* chainspec_create_from_json(d_token_t* data) {
       spec->consensus_transitions     = _realloc(spec->consensus_transitions, sizeof(consensus_transition_t) * spec->consensus_transitions_len, sizeof(consensus_transition_t));
       for (d_iterator_t iter = d_iter(multi); iter.left; d_iter_next(&iter))
         fill_aura(iter.token, spec->consensus_transitions + (n++), d_get_keystr(iter.token->key));
+
+      // the transitions are searched by block, so we make sure they are sorted
+      for (int i = 1; i < n; i++) {
+        consensus_transition_t t = spec->consensus_transitions[i];
+        int                    j = i;
+        for (; j && spec->consensus_transitions[j - 1].transition_block > t.transition_block; j--) spec->consensus_transitions[j] = spec->consensus_transitions[j - 1];
+        spec->consensus_transitions[j] = t;
+      }
     } else
       fill_aura(params, spec->consensus_transitions, NULL);
 
@@ -191,20 +208,26 @@ chainspec_t* chainspec_create_from_json(d_token_t* data) {
   return spec;
 }
 
-eip_t chainspec_get_eip(chainspec_t* spec, uint64_t block_number) {
-  for (int i = spec->eip_transitions_len - 1; i >= 0; i--) {
-    if (spec->eip_transitions[i].transition_block <= block_number)
-      return spec->eip_transitions[i].eips;
+// finds the last transition starting at or before the block with a binary search.
+// both transition types start with the transition_block, so we only need the size of the entries.
+static uint32_t find_transition(void* transitions, uint32_t len, size_t size, uint64_t block_number) {
+  uint32_t lo = 0, hi = len;
+  while (hi - lo > 1) {
+    const uint32_t mid = (lo + hi) / 2;
+    if (*(uint64_t*) ((uint8_t*) transitions + mid * size) <= block_number)
+      lo = mid;
+    else
+      hi = mid;
   }
-  return spec->eip_transitions->eips;
+  return lo;
+}
+
+eip_t chainspec_get_eip(chainspec_t* spec, uint64_t block_number) {
+  return spec->eip_transitions[find_transition(spec->eip_transitions, spec->eip_transitions_len, sizeof(eip_transition_t), block_number)].eips;
 }
 
 consensus_transition_t* chainspec_get_consensus(chainspec_t* spec, uint64_t block_number) {
-  for (int i = spec->consensus_transitions_len - 1; i >= 0; i--) {
-    if (spec->consensus_transitions[i].transition_block <= block_number)
-      return spec->consensus_transitions + i;
-  }
-  return spec->consensus_transitions;
+  return spec->consensus_transitions + find_transition(spec->consensus_transitions, spec->consensus_transitions_len, sizeof(consensus_transition_t), block_number);
 }
 
 static void add_rlp(bytes_builder_t* bb, uint64_t val) {
@@ -245,39 +268,49 @@ chainspec_t* chainspec_from_bin(void* raw) {
   bytes_t data = bytes(raw, 0xFFFFFF); // since we ond't know the length we give a max size, but the length is encoded in the first bytes
 
   if (rlp_decode(&data, 0, &data) != 2) return log_error("invalid data");
-  bytes_t      tmp, t2;
+  bytes_t      tmp, t2, eips, consensus;
   unsigned int n;
   if (rlp_decode(&data, 0, &tmp) != 1 || tmp.len != 1 || *tmp.data != 1)
     return log_error("Invalid version");
+  if (rlp_decode(&data, 3, &eips) != 2) return log_error("Invalid eips");
+  if (rlp_decode(&data, 4, &consensus) != 2) return log_error("Invalid consensus list");
 
-  chainspec_t* spec = _malloc(sizeof(chainspec_t));
-  if (rlp_decode(&data, 1, &tmp) != 1) return log_error("Invalid networkid");
+  // the spec and all transitions are stored in one allocation, while validators and contracts point to the raw data.
+  const unsigned int eips_len      = rlp_decode_len(&eips) >> 1;
+  const unsigned int consensus_len = rlp_decode_len(&consensus) / 4;
+  chainspec_t*       spec          = _malloc(sizeof(chainspec_t) + sizeof(eip_transition_t) * eips_len + sizeof(consensus_transition_t) * consensus_len);
+  if (!spec) return log_error("not enough memory for chainspec!");
+  spec->eip_transitions_len       = eips_len;
+  spec->eip_transitions           = (eip_transition_t*) (spec + 1);
+  spec->consensus_transitions_len = consensus_len;
+  spec->consensus_transitions     = (consensus_transition_t*) (spec->eip_transitions + eips_len);
+
+  char* err = NULL;
+  if (rlp_decode(&data, 1, &tmp) != 1) err = "Invalid networkid";
   spec->network_id = bytes_to_long(tmp.data, tmp.len);
-  if (rlp_decode(&data, 2, &tmp) != 1) return log_error("Invalid nonce");
+  if (!err && rlp_decode(&data, 2, &tmp) != 1) err = "Invalid nonce";
   spec->account_start_nonce = bytes_to_long(tmp.data, tmp.len);
-  if (rlp_decode(&data, 3, &tmp) != 2) return log_error("Invalid eips");
-  spec->eip_transitions_len = rlp_decode_len(&tmp) >> 1;
-  spec->eip_transitions     = _malloc(sizeof(eip_transition_t) * spec->eip_transitions_len);
-  for (n = 0; n < spec->eip_transitions_len; n++) {
-    if (rlp_decode(&tmp, n * 2, &t2) != 1) return log_error("Invalid block");
+  for (n = 0; n < eips_len && !err; n++) {
+    if (rlp_decode(&eips, n * 2, &t2) != 1) err = "Invalid block";
     spec->eip_transitions[n].transition_block = bytes_to_long(t2.data, t2.len);
-    if (rlp_decode(&tmp, n * 2 + 1, &t2) != 1) return log_error("Invalid eips");
-    memcpy(&spec->eip_transitions[n].eips, t2.data, sizeof(eip_t));
+    if (!err && (rlp_decode(&eips, n * 2 + 1, &t2) != 1 || t2.len < sizeof(eip_t))) err = "Invalid eips";
+    if (!err) memcpy(&spec->eip_transitions[n].eips, t2.data, sizeof(eip_t));
   }
-  if (rlp_decode(&data, 4, &tmp) != 2) return log_error("Invalid consensus list");
-  spec->consensus_transitions_len = rlp_decode_len(&tmp) / 4;
-  spec->consensus_transitions     = _malloc(sizeof(consensus_transition_t) * spec->consensus_transitions_len);
-  for (n = 0; n < spec->consensus_transitions_len; n++) {
+  for (n = 0; n < consensus_len && !err; n++) {
     consensus_transition_t* tr = spec->consensus_transitions + n;
-    if (rlp_decode(&tmp, n * 4, &t2) != 1) return log_error("Invalid block");
+    if (rlp_decode(&consensus, n * 4, &t2) != 1) err = "Invalid block";
     tr->transition_block = bytes_to_long(t2.data, t2.len);
-    if (rlp_decode(&tmp, n * 4 + 1, &t2) != 1) return log_error("Invalid type");
+    if (!err && rlp_decode(&consensus, n * 4 + 1, &t2) != 1) err = "Invalid type";
     tr->type = bytes_to_int(t2.data, t2.len);
-    if (rlp_decode(&tmp, n * 4 + 2, &t2) != 1) return log_error("Invalid validators");
+    if (!err && rlp_decode(&consensus, n * 4 + 2, &t2) != 1) err = "Invalid validators";
     tr->validators = t2;
-    if (rlp_decode(&tmp, n * 4 + 3, &t2) != 1) return log_error("Invalid contract");
+    if (!err && rlp_decode(&consensus, n * 4 + 3, &t2) != 1) err = "Invalid contract";
     tr->contract = t2.len == 0 ? NULL : t2.data;
   }
+  if (err) {
+    _free(spec);
+    return log_error(err);
+  }
 
   return spec;
 }
@@ -291,13 +324,10 @@ chainspec_t* chainspec_get(chain_id_t chain_id) {
 
   chainspec_t* spec = NULL;
 
-  // not found -> lazy init
-  if (chain_id == 0x2a) // KOVAN
-    spec = chainspec_from_bin(CHAINSPEC_KOVAN);
-  else if (chain_id == 0x1) // MAINNET
-    spec = chainspec_from_bin(CHAINSPEC_MAINNET);
-  else if (chain_id == 0x5) // GOERLI
-    spec = chainspec_from_bin(CHAINSPEC_GOERLI);
+  // not found -> lazy init from the embedded snapshot
+  for (unsigned int i = 0; i < sizeof(BUILTIN_SPECS) / sizeof(BUILTIN_SPECS[0]) && !spec; i++) {
+    if (BUILTIN_SPECS[i].chain_id == chain_id) spec = chainspec_from_bin((void*) BUILTIN_SPECS[i].bin);
+  }
 
   if (spec) {
     s           = _malloc(sizeof(spec_t));
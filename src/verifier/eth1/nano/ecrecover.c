@@ -0,0 +1,871 @@
+/*******************************************************************************
+ * This file is part of the Incubed project.
+ * Sources: https://github.com/slockit/in3-c
+ * 
+ * Copyright (C) 2018-2019 slock.it GmbH, Blockchains LLC
+ * 
+ * 
+ * COMMERCIAL LICENSE USAGE
+ * 
+ * Licensees holding a valid commercial license may use this file in accordance 
+ * with the commercial license agreement provided with the Software or, alternatively, 
+ * in accordance with the terms contained in a written agreement between you and 
+ * slock.it GmbH/Blockchains LLC. For licensing terms and conditions or further 
+ * information please contact slock.it at in3@slock.it.
+ * 	
+ * Alternatively, this file may be used under the AGPL license as follows:
+ *    
+ * AGPL LICENSE USAGE
+ * 
+ * This program is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Affero General Public License as published by the Free Software 
+ * Foundation, either version 3 of the License, or (at your option) any later version.
+ *  
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY 
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A 
+ * PARTICULAR PURPOSE. See the GNU Affero General Public License for more details.
+ * [Permissions of this strong copyleft license are conditioned on making available 
+ * complete source code of licensed works and modifications, which include larger 
+ * works using a licensed work, under the same license. Copyright and license notices 
+ * must be preserved. Contributors provide an express grant of patent rights.]
+ * You should have received a copy of the GNU Affero General Public License along 
+ * with this program. If not, see <https://www.gnu.org/licenses/>.
+ *******************************************************************************/
+
+#include "ecrecover.h"
+#include "../../../core/util/mem.h"
+#include "../../../third-party/crypto/ecdsa.h"
+#include "../../../third-party/crypto/secp256k1.h"
+#include <string.h>
+
+#ifdef __SIZEOF_INT128__
+
+typedef unsigned __int128 u128_t;
+
+#define M52 0xFFFFFFFFFFFFFULL
+#define M48 0x0FFFFFFFFFFFFULL
+#define P0 0xFFFFEFFFFFC2FULL      /**< lowest limb of p */
+#define R256 0x1000003D1ULL        /**< 2^256 mod p */
+#define R260 0x1000003D10ULL       /**< 2^260 mod p */
+#define WINDOW_R 5                 /**< wNAF window for the recovered point */
+#define WINDOW_G 8                 /**< wNAF window for the generator (precomputed table) */
+#define WNAF_MAX 132               /**< max digits of a 129 bit scalar */
+#define BATCH_STACK 8              /**< number of signatures to recover without allocating */
+
+/** field element mod p as 5x52 bit limbs (the top limb holds 48 bits once normalized). */
+typedef struct {
+  uint64_t n[5];
+} fe_t;
+
+/** scalar mod n as 4x64 bit little endian words. */
+typedef struct {
+  uint64_t d[4];
+} sc_t;
+
+/** affine point */
+typedef struct {
+  fe_t x, y;
+} ge_t;
+
+/** jacobian point */
+typedef struct {
+  fe_t x, y, z;
+  int  inf;
+} gej_t;
+
+/** intermediate state of one signature within a batch. */
+typedef struct {
+  sc_t  r, s, e, pre_sc;
+  ge_t  R;
+  gej_t q;
+  fe_t  pre_fe;
+} rec_t;
+
+static const fe_t FE_ONE  = {{1, 0, 0, 0, 0}};
+static const fe_t FE_BETA = {{0x96c28719501eeULL, 0x7512f58995c13ULL, 0xc3434e99cf049ULL, 0x07106e64479eaULL, 0x07ae96a2b657cULL}};
+
+static const sc_t SC_ONE          = {{1, 0, 0, 0}};
+static const sc_t SC_N            = {{0xBFD25E8CD0364141ULL, 0xBAAEDCE6AF48A03BULL, 0xFFFFFFFFFFFFFFFEULL, 0xFFFFFFFFFFFFFFFFULL}};
+static const sc_t SC_N_HALF       = {{0xDFE92F46681B20A0ULL, 0x5D576E7357A4501DULL, 0xFFFFFFFFFFFFFFFFULL, 0x7FFFFFFFFFFFFFFFULL}};
+static const sc_t SC_MINUS_LAMBDA = {{0xe0cfc810b51283cfULL, 0xa880b9fc8ec739c2ULL, 0x5ad9e3fd77ed9ba4ULL, 0xac9c52b33fa3cf1fULL}};
+static const sc_t SC_MINUS_B1     = {{0x6f547fa90abfe4c3ULL, 0xe4437ed6010e8828ULL, 0, 0}};
+static const sc_t SC_MINUS_B2     = {{0xd765cda83db1562cULL, 0x8a280ac50774346dULL, 0xfffffffffffffffeULL, 0xffffffffffffffffULL}};
+static const sc_t SC_G1           = {{0xe893209a45dbb031ULL, 0x3daa8a1471e8ca7fULL, 0xe86c90e49284eb15ULL, 0x3086d221a7d46bcdULL}};
+static const sc_t SC_G2           = {{0x1571b4ae8ac47f71ULL, 0x221208ac9df506c6ULL, 0x6f547fa90abfe4c4ULL, 0xe4437ed6010e8828ULL}};
+static const uint64_t SC_C[3]     = {0x402DA1732FC9BEBFULL, 0x4551231950B75FC4ULL, 1}; /**< 2^256 - n */
+static const sc_t SC_P            = {{0xFFFFFFFEFFFFFC2FULL, 0xFFFFFFFFFFFFFFFFULL, 0xFFFFFFFFFFFFFFFFULL, 0xFFFFFFFFFFFFFFFFULL}}; /**< p as words */
+
+/** odd multiples 1G, 3G, ... 127G */
+static const ge_t G_TABLE[64] = {
+    {{{0x2815b16f81798ULL, 0xdb2dce28d959fULL, 0xe870b07029bfcULL, 0xbbac55a06295cULL, 0x079be667ef9dcULL}}, {{0x7d08ffb10d4b8ULL, 0x48a68554199c4ULL, 0xe1108a8fd17b4ULL, 0xc4655da4fbfc0ULL, 0x0483ada7726a3ULL}}},
+    {{{0x1f113bce036f9ULL, 0x45836f99b0860ULL, 0x89d5229b531c8ULL, 0xc31049344f85fULL, 0x0f9308a019258ULL}}, {{0x9fd7584b8e672ULL, 0x9934c2231b6cbULL, 0xa37f3566500a9ULL, 0xe8140fe337e62ULL, 0x0388f7b0f632dULL}}},
+    {{{0x8d569b240efe4ULL, 0xbddc619ab7cbaULL, 0xa5c5128e88b84ULL, 0x209355b4a7250ULL, 0x02f8bde4d1a07ULL}}, {{0x87d3aa6ac62d6ULL, 0x1bab0d6840dcaULL, 0x6c9c426f78827ULL, 0xe3d6d4dba9ddaULL, 0x0d8ac222636e5ULL}}},
+    {{{0xbddedcac4f9bcULL, 0x7e0330e39ce92ULL, 0x2ea7a0e3d419bULL, 0xb4eaa398f365fULL, 0x05cbdf0646e5dULL}}, {{0x82628087264daULL, 0xb813fde7b5a50ULL, 0x61a54dba813d0ULL, 0x5960a3178d6d8ULL, 0x06aebca40ba25ULL}}},
+    {{{0xf110dfc27ccbeULL, 0x974c57e714c35ULL, 0xf559abde09796ULL, 0xf65309ad178a9ULL, 0x0acd484e2f0c7ULL}}, {{0xc262ac64f9c37ULL, 0xa4375f8e0f05cULL, 0x63b61e9add888ULL, 0xd9fd643809717ULL, 0x0cc338921b0a7ULL}}},
+    {{{0xc17895da008cbULL, 0x0be5c17891bbeULL, 0x0c65aac564998ULL, 0x411e5ef4246b7ULL, 0x0774ae7f858a9ULL}}, {{0xd74c9c953c61bULL, 0xe2dff9d6a8301ULL, 0x7b7b365372db1ULL, 0x5e190243dd56dULL, 0x0d984a032eb6bULL}}},
+    {{{0xddf8f19405aa8ULL, 0xc6610e58cddeeULL, 0x3748651b075fbULL, 0x288bc7d1d205cULL, 0x0f28773c2d975ULL}}, {{0x5cb52db03ed81ULL, 0xda521fa91f29bULL, 0x5cdaf473a1a06ULL, 0x0a89758212eb6ULL, 0x00ab0902e8d88ULL}}},
+    {{{0xdbcf8e27e080eULL, 0x6f3c85f79e44aULL, 0x95ff41131e594ULL, 0xea965a465ae30ULL, 0x0d7924d4f7d43ULL}}, {{0x4dc9ff6a26b58ULL, 0x2bd896d3a5c50ULL, 0x8cc6defea40afULL, 0x72a683842ec22ULL, 0x0581e2872a86cULL}}},
+    {{{0x4faa04a2d4a34ULL, 0xae79b9768766eULL, 0x7eacf21eb9898ULL, 0x7750a420fee80ULL, 0x0defdea4cdb67ULL}}, {{0x199f69e56eb77ULL, 0xa04a95c0f6cfbULL, 0x2a93daeced1f4ULL, 0x5168e997b0eadULL, 0x04211ab069463ULL}}},
+    {{{0x5656138385b6cULL, 0xebd7e86d27747ULL, 0x44f4979f06acfULL, 0x43d293ef5cff4ULL, 0x02b4ea0a797a4ULL}}, {{0x0c854e5c09b7aULL, 0x0c50269763b57ULL, 0xa1c86131a01f6ULL, 0x5d93b343083b5ULL, 0x085e89bc03794ULL}}},
+    {{{0x40aef25be59d5ULL, 0x0271f81071813ULL, 0xce333301d9ad4ULL, 0x12564f93fa332ULL, 0x0352bbf4a4cddULL}}, {{0xd3d8bcf81998cULL, 0x2e71b1039c67bULL, 0xdda3e1f4a1b3bULL, 0xf534d59c18259ULL, 0x0321eb4075348ULL}}},
+    {{{0xcdadd4ecacc3fULL, 0xdfeff5ff29dc9ULL, 0x9879124e42ab8ULL, 0xd11b023001055ULL, 0x02fa2104d6b38ULL}}, {{0xba76b532b7d67ULL, 0xecfc882648423ULL, 0xbd5dd80181d70ULL, 0xd865b64569335ULL, 0x002de1068295dULL}}},
+    {{{0xa0cd7f5453714ULL, 0x84e09572e269cULL, 0x6edda83263c3dULL, 0xd68dab21a9b06ULL, 0x09248279b09b4ULL}}, {{0xa32ce97cb3402ULL, 0x2a887912ffe54ULL, 0xea2b1ff3fc0deULL, 0xaade5d1aa71bdULL, 0x073016f7bf234ULL}}},
+    {{{0x96d443dee8729ULL, 0x144bf615c07e9ULL, 0x0beb7522f570eULL, 0xbf278e70132fbULL, 0x0daed4f2be3a8ULL}}, {{0x0e52290be1c55ULL, 0x30f3afa726ab4ULL, 0xef8d7003f83c2ULL, 0x98e8d4a1aca87ULL, 0x0a69dce4a7d6cULL}}},
+    {{{0x3b5e87d22e7dbULL, 0xe9fdf281b0e6aULL, 0xbb19f9011ecd9ULL, 0x812e8acf28d7cULL, 0x0c44d12c7065dULL}}, {{0x9063f0e0e6482ULL, 0x861edf61c5a03ULL, 0x982fdac0e106eULL, 0x6cdc76c45926cULL, 0x02119a460ce32ULL}}},
+    {{{0xc65cbd269e6b4ULL, 0x5336c28063b61ULL, 0xed60853152b69ULL, 0x8504c89a20cfdULL, 0x06a245bf6dc69ULL}}, {{0xe6348100d8a82ULL, 0x48d0423b6efd5ULL, 0x16a24ad8b33baULL, 0x4a708b3f5126fULL, 0x0e022cf42c2bdULL}}},
+    {{{0xae57f0d0bd6a5ULL, 0x0b0bec1146f95ULL, 0xe541084ce1330ULL, 0xe627c077e3d2fULL, 0x01697ffa6fd9dULL}}, {{0xe9d63d01b2396ULL, 0x009e498ae7adeULL, 0x4557433a2cf15ULL, 0x6f5d27561506eULL, 0x0b9c398f18680ULL}}},
+    {{{0x2345ef27a7479ULL, 0x60ffb7f61df98ULL, 0x834cb0d9deb83ULL, 0x718b986d0f07eULL, 0x0605bdb019981ULL}}, {{0x1e1e9056b8c49ULL, 0xe84fb14db43b0ULL, 0xc96fe23c26bfaULL, 0xd20681a78d93eULL, 0x002972d2de4f8ULL}}},
+    {{{0x1c7e9d87ff33dULL, 0x354959b10cfe3ULL, 0xa215e10dcb01cULL, 0xbf497402fdc45ULL, 0x062d14dab4150ULL}}, {{0x5642483b25eafULL, 0x2967ab472235fULL, 0x0eed0db01aa13ULL, 0xb01098088a195ULL, 0x080fc06bd8cc5ULL}}},
+    {{{0x55c2f86308b6fULL, 0xf56b9b8b425e5ULL, 0x408e56b2c50e9ULL, 0x27dade5b4b06cULL, 0x080c60ad0040fULL}}, {{0x01f56430bd57aULL, 0x4cbe7024eb1aaULL, 0xfe72f70a65eedULL, 0xc30f26e66bad7ULL, 0x01c38303f1cc5ULL}}},
+    {{{0xeabb0fa03c8fbULL, 0x9487d847049d5ULL, 0xcc54d344cc5dcULL, 0xad54aa74c6348ULL, 0x07a9375ad6167ULL}}, {{0x499ec224dc7f7ULL, 0xa10c70ce2b02dULL, 0x9269046bdc59eULL, 0x726909559e0d7ULL, 0x00d0e3fa9eca8ULL}}},
+    {{{0x51f459bc3ffc9ULL, 0xc39b68df504bbULL, 0x5447a79bb408eULL, 0xb54c907a9ed04ULL, 0x0d528ecd9b696ULL}}, {{0x465b521409933ULL, 0x405c520dbc063ULL, 0x1fd656ebc4345ULL, 0xe5f99966f2188ULL, 0x0eecf41253136ULL}}},
+    {{{0x31808f8b45963ULL, 0x5e4a7ecb13872ULL, 0x8ecdad0526611ULL, 0x3412ea25f514eULL, 0x0049370a4b5f4ULL}}, {{0x3052a12949c9aULL, 0xafbb5b6764b65ULL, 0x12fd62a54c3f3ULL, 0xed428b3081b05ULL, 0x0758f3f41afd6ULL}}},
+    {{{0x13eb1fc345d74ULL, 0x1e0e1498e2f1cULL, 0x64702ef881d81ULL, 0x8cbbd73df930dULL, 0x077f230936ee8ULL}}, {{0xeb3c7671c60d6ULL, 0x30d97077cbbe8ULL, 0xba1b37896c953ULL, 0xb6400a08266e9ULL, 0x0958ef42a7886ULL}}},
+    {{{0x8531b7739f530ULL, 0x74ab9d4dbaeb2ULL, 0xc7c0bce58c800ULL, 0xe4b9ea44887e5ULL, 0x0f2dac991cc4cULL}}, {{0x17dba703a3c37ULL, 0xeb0598e4fd1a1ULL, 0xc2531df9eb5fbULL, 0x8dad4da1f32deULL, 0x0e0dedc9b3b2fULL}}},
+    {{{0xa4850c690d45bULL, 0xdfc9dae3debcbULL, 0xe2520125a216cULL, 0x21fb1b4be8fbbULL, 0x0463b3d9f6626ULL}}, {{0x377b01af7307eULL, 0x7c970a1de31cbULL, 0xd8622d7c622e2ULL, 0x6c3543114306dULL, 0x05ed430d78c29ULL}}},
+    {{{0x496b49998f247ULL, 0xc14328a2d1a32ULL, 0xf3b59976b98faULL, 0x6e2a09232d4afULL, 0x0f16f804244e4ULL}}, {{0x79962c4e31df6ULL, 0xc26e5cce26d65ULL, 0xf4e33d92a6c53ULL, 0x3f7e13d206fcdULL, 0x0cedabd9b8220ULL}}},
+    {{{0xe15f7151d41d1ULL, 0x15ace27c65369ULL, 0x4311af55d2453ULL, 0x4563b0352b7a1ULL, 0x0caf754272dc8ULL}}, {{0xf908318a04476ULL, 0xb7962232a5c32ULL, 0x5e460575f4fa9ULL, 0xf5f2a41b643faULL, 0x0cb474660ef35ULL}}},
+    {{{0x97bc86f082120ULL, 0x07cb86d7c1244ULL, 0x9979d8b44a09cULL, 0xb986f85d0f170ULL, 0x02600ca4b282cULL}}, {{0xbe9475a7e4b40ULL, 0x74ab5f0ef44b0ULL, 0xddbb45d5ac6beULL, 0x5bd6a693b03fcULL, 0x04119b88753c1ULL}}},
+    {{{0x2a7746998e435ULL, 0x85e24f7dc8c60ULL, 0x12220bc01c486ULL, 0x432c338ec53cdULL, 0x07635ca72d7e8ULL}}, {{0x76f302c5b9c61ULL, 0x61d57048bad9eULL, 0xf78e6d74ecfc0ULL, 0x9d613d1d5e590ULL, 0x0091b64960948ULL}}},
+    {{{0x50743bf56cc18ULL, 0x3479d468fbc1aULL, 0xeee8a66b7f2b3ULL, 0x570cdbbf4a87dULL, 0x0754e3239f325ULL}}, {{0xd98093c536683ULL, 0xd0197a695d0c5ULL, 0x4ea49a023ee33ULL, 0xa30fb3cd0ed30ULL, 0x00673fb86e5bdULL}}},
+    {{{0x2694691d9b9e8ULL, 0x661d1c952f9feULL, 0x2d570f0330800ULL, 0xe96aff57859c8ULL, 0x0e3e6bd1071a1ULL}}, {{0x02af4920e37f5ULL, 0x3993e90c41670ULL, 0x79a3cb6a5a228ULL, 0xe76f40c0aa583ULL, 0x059c9e0bba394ULL}}},
+    {{{0x47fdcf04aa6ebULL, 0xf32ba35f4b4ccULL, 0xf732985c4ccb1ULL, 0x033826ae73d88ULL, 0x0186b483d056aULL}}, {{0x797f86e80888bULL, 0x90895138b4a4aULL, 0x04180ab21fb80ULL, 0xf77e2e17446e2ULL, 0x03b952d32c67cULL}}},
+    {{{0x321724ce0963fULL, 0xd2b737d9c91a8ULL, 0x4be4f725442e6ULL, 0x6ce544c98561fULL, 0x0df9d70a6b987ULL}}, {{0x8c45cf2ba2417ULL, 0x2720ef9da217bULL, 0xdc39d4ab15722ULL, 0x6ccd5f862b785ULL, 0x055eb2dafd84dULL}}},
+    {{{0x64c5f34ce7143ULL, 0x4f849ed8995deULL, 0x5dce0f8ab5255ULL, 0xe87a497ca815dULL, 0x05edd5cc23c51ULL}}, {{0x706ab7399a868ULL, 0xc0d17a2905cdcULL, 0x0c89ad0c13c66ULL, 0x130661e8cec03ULL, 0x0efae9c8dbc14ULL}}},
+    {{{0xd362f84614fbaULL, 0xa1c355b17a722ULL, 0x87e9e777aa3fbULL, 0x6830da12fe022ULL, 0x0290798c2b647ULL}}, {{0x03afd41943e7aULL, 0x94db2a23146d0ULL, 0x79af25d5b29c0ULL, 0x0621988d00bcfULL, 0x0e38da76dcd44ULL}}},
+    {{{0xfdecef4053b45ULL, 0x2fe360257362dULL, 0x150ac39cd2955ULL, 0xf5b3054754efaULL, 0x0af3c423a95d9ULL}}, {{0xfeded498fd9c6ULL, 0xa667a15581bc2ULL, 0x35cfb40c8cd5aULL, 0x2b749a93b0e6fULL, 0x0f98a3fd831ebULL}}},
+    {{{0xfed50d884249aULL, 0xb26dcf98df8d2ULL, 0x9bf274906bb66ULL, 0xe745cccaa28c9ULL, 0x0766dbb24d134ULL}}, {{0x24f97cbac5996ULL, 0x65fa06cedd2c9ULL, 0x0da38b897584aULL, 0xe5e38dcc88798ULL, 0x0744b1152eacbULL}}},
+    {{{0x2e666191abe3eULL, 0x4f6c596a58ce9ULL, 0x784f41645f7b4ULL, 0x759ba21277c33ULL, 0x059dbf46f8c94ULL}}, {{0xe216c4a307f6eULL, 0x9a7919798cd85ULL, 0x48309a042ce73ULL, 0xbc300f4ea6ce6ULL, 0x0c534ad44175fULL}}},
+    {{{0xdc6018cfd87b8ULL, 0x711a95e73cb62ULL, 0x4e9a4a8dd647eULL, 0x4537305e691e7ULL, 0x0f13ada95103cULL}}, {{0x8419bdaf5733dULL, 0x1a6a75c257077ULL, 0x8341f326949e2ULL, 0x4de663bf4bc80ULL, 0x0e13817b44ee1ULL}}},
+    {{{0x550015a88522cULL, 0xc06ebadfb6488ULL, 0x59cca4cda1869ULL, 0xced06d4167a2cULL, 0x07754b4fa0e8aULL}}, {{0x48b57841163a2ULL, 0x350b6cbcc537aULL, 0x020b8fa8d1e4eULL, 0x9d82224b967c3ULL, 0x030e93e864e66ULL}}},
+    {{{0x28c99e2262519ULL, 0x95de8041d2a68ULL, 0xabef9d701858fULL, 0xe048aa3874d46ULL, 0x0948dcadf5990ULL}}, {{0xa2cae5347d57eULL, 0xefbd2ef1d2cbbULL, 0x4b1bc25df9154ULL, 0xe597d5d28a322ULL, 0x0e491a42537f6ULL}}},
+    {{{0x28a8a3d7c77abULL, 0xf5ac0bfa15703ULL, 0x202ec37fb224cULL, 0x6c1689c7b48f8ULL, 0x07962414450c7ULL}}, {{0xfa5b29db83437ULL, 0x051f04ac5760aULL, 0x3ef6f6b12507aULL, 0xb4760d5c1fc13ULL, 0x0100b610ec4ffULL}}},
+    {{{0xd085137ec47caULL, 0x7225b8847bb0dULL, 0x4d915485a1697ULL, 0x4b54b15b16064ULL, 0x0351408783496ULL}}, {{0xd15a0de293311ULL, 0x7c15c2378b7e7ULL, 0xe8127fc6039e7ULL, 0x05448e1652c48ULL, 0x0ef0afbb20562ULL}}},
+    {{{0x43d3f7b527eafULL, 0xeb8df787b4429ULL, 0xd8bc54993e947ULL, 0x3e4bc79ce2c9dULL, 0x0d3cc30ad6b48ULL}}, {{0x34db04eede0a4ULL, 0x6290358630afbULL, 0xf9508ae3c2ad4ULL, 0x278d89c5e9be8ULL, 0x08b378a22d827ULL}}},
+    {{{0x5ba0ff4847610ULL, 0x3db913f649397ULL, 0xfefe08b2b2982ULL, 0x2860ce1c78fcbULL, 0x01624d8478073ULL}}, {{0x6e2a404078575ULL, 0xf5282be4c8cc0ULL, 0xcd9d4ca896878ULL, 0x903e0914448c6ULL, 0x068651cf9b6daULL}}},
+    {{{0x7b4fd5fc61cd4ULL, 0x4b5af207da6dfULL, 0x3e62a98519247ULL, 0xa8a26902c9563ULL, 0x0733ce80da955ULL}}, {{0x673bc1dc5ea1dULL, 0xe0201e4578c54ULL, 0xdb9fcce3e1ef8ULL, 0xdf7d485a4d8b8ULL, 0x0f5435a2bd2baULL}}},
+    {{{0x58dfab81c045cULL, 0x092171e699ef2ULL, 0xbd3b49f8966c5ULL, 0x5064cf1a1c33bULL, 0x015d944125494ULL}}, {{0x7bbe9efe4070dULL, 0xbacebfc685fc3ULL, 0x3b84177434800ULL, 0x3e7234f5137b7ULL, 0x0d56eb30b6946ULL}}},
+    {{{0x38599d0717940ULL, 0x7c9d2b8aaaac1ULL, 0xce70d271c2141ULL, 0xe675b612136e5ULL, 0x0a1d0fcf2ec9dULL}}, {{0x12d39c197a629ULL, 0xa54070f3d5192ULL, 0x09667f2641462ULL, 0xa3cab2e907373ULL, 0x0edd77f50bcb5ULL}}},
+    {{{0xa37331cb36980ULL, 0xdee8245c06c7cULL, 0xf84dbe9a790baULL, 0x8ccc5780c0735ULL, 0x0e22fbe15c0afULL}}, {{0xd06d77d31da06ULL, 0x154964799be43ULL, 0xf53a1a7a38289ULL, 0xd60c88b430a69ULL, 0x00a855babad5cULL}}},
+    {{{0x9452246cfa9b3ULL, 0x394704eaa7400ULL, 0x1155f5f69635eULL, 0xe8e20ee13473cULL, 0x0311091dd9860ULL}}, {{0x0f0b1286d8374ULL, 0xa64feee685bd8ULL, 0x8c06830871ec5ULL, 0xf04fffd1f0478ULL, 0x066db656f87d1ULL}}},
+    {{{0x7d4232ec2dbdfULL, 0xb45a934078186ULL, 0x3e6ac24883928ULL, 0xbe89b31c0442dULL, 0x034c1fd04d301ULL}}, {{0x21857ba73abeeULL, 0xeeb487443dc53ULL, 0x0174136d57f1cULL, 0x1b5954bd46f73ULL, 0x009414685e97bULL}}},
+    {{{0xa5e6b049b8d63ULL, 0xabbcd08affcc2ULL, 0x57eb42a8d13f3ULL, 0x701c1c14de5b5ULL, 0x0f219ea5d6b54ULL}}, {{0x2962a400766d1ULL, 0x3c07b27fb8d8cULL, 0xcccf6b1f4b08dULL, 0x40b0f73af4544ULL, 0x04cb95957e83dULL}}},
+    {{{0x6912469a0b448ULL, 0x90bca62708723ULL, 0xf45de26543a54ULL, 0xfbaab1f683db8ULL, 0x0d7b8740f74a8ULL}}, {{0xe0315eaa4593bULL, 0x5ed3c049b3411ULL, 0xad4717eff15dbULL, 0xc92ee1010f337ULL, 0x0fa77968128d9ULL}}},
+    {{{0x4d3091aa824bfULL, 0x32abdd94289feULL, 0x3a3335ead5bcdULL, 0x6f0ef86f7c98dULL, 0x032d31c222f8fULL}}, {{0xd14b8462e1661ULL, 0x9e6f26e961118ULL, 0x5b9e1da2e6dacULL, 0x56e39ccd3d791ULL, 0x05f3032f58921ULL}}},
+    {{{0xf86cbc18347b5ULL, 0x7cd59592c4340ULL, 0xd9831ea8793d7ULL, 0xb32671045a155ULL, 0x07461f371914aULL}}, {{0x847b3cc092ff6ULL, 0xf50c986ea6b39ULL, 0xaa442542eee1fULL, 0xbec0cbdddcae0ULL, 0x08ec0ba238b96ULL}}},
+    {{{0x698bad7b2b2d6ULL, 0x2c3e67453d287ULL, 0xa38206a6d716bULL, 0x860074356a25aULL, 0x0ee079adb1df1ULL}}, {{0xac479ec1c8c1eULL, 0x9af04c4e25ebaULL, 0xcc5f9f6a44698ULL, 0xbe5c4c5f37e0eULL, 0x08dc2412aafe3ULL}}},
+    {{{0xd8616ba9da6b5ULL, 0x31874c9dc72bfULL, 0xee620f7e65de3ULL, 0x83f0467b18302ULL, 0x016ec93e447ecULL}}, {{0x6778e25b0674dULL, 0x6a50e49713962ULL, 0xa5804a39d5818ULL, 0xfb40d0e8c2a7cULL, 0x05e4631150e62ULL}}},
+    {{{0x96065d537bd99ULL, 0x97f98b6aa485bULL, 0xfa70b6bd88558ULL, 0xf6f038978290aULL, 0x0eaa5f980c245ULL}}, {{0x041024edc07dcULL, 0x9d7e6ea67fb18ULL, 0xc994624d78486ULL, 0x2e0819a528391ULL, 0x0f65f5d3e292cULL}}},
+    {{{0xc4b6b35a49f51ULL, 0x877151342ea96ULL, 0xa02439958ae04ULL, 0xc132692ee1910ULL, 0x0078c9407544aULL}}, {{0x675f194a3ddb4ULL, 0x583c064d2462bULL, 0x39a5e68fa1fbdULL, 0x9b85d54047955ULL, 0x0f3e0319169ebULL}}},
+    {{{0x578d9702857a5ULL, 0xae7a6fc688726ULL, 0x31aea0001cdc8ULL, 0xa77016dcd8384ULL, 0x0494f4be219a1ULL}}, {{0x4b031880d562cULL, 0x30d767ed6e55fULL, 0xe36ba2af925ceULL, 0xa5f339ba7f075ULL, 0x042242a969283ULL}}},
+    {{{0xc1e665c1fe9b5ULL, 0xea58faa70ebf4ULL, 0x44ea549d28211ULL, 0xd86c6bc7f2f51ULL, 0x0a598a8030da6ULL}}, {{0x26dbd2d864e6bULL, 0xb65b35f86a100ULL, 0x0737aec23fc63ULL, 0x2c307e4b4a714ULL, 0x0204b5d6f8482ULL}}},
+    {{{0xadc3e58595997ULL, 0x0f12570a184dbULL, 0xdbeafec208f02ULL, 0x2b5d09192f5f2ULL, 0x0c41916365abbULL}}, {{0x6e96b58fa9913ULL, 0x450f34bfc0ed1ULL, 0x8984989d5caf9ULL, 0x7efa49d245b32ULL, 0x004f14351d008ULL}}},
+    {{{0x73a5514742881ULL, 0xd2e0a36acfe4cULL, 0xa03bc5b92a2e0ULL, 0xfa475a724604dULL, 0x0841d6063a586ULL}}, {{0x36de01a8d6154ULL, 0xd6744c169ce7aULL, 0x7543698e62562ULL, 0x59e81904f9a1cULL, 0x0073867f59c06ULL}}},
+};
+
+// -- field arithmetic
+
+static inline uint64_t read_be64(const uint8_t* b) {
+  uint64_t r = 0;
+  for (int i = 0; i < 8; i++) r = (r << 8) | b[i];
+  return r;
+}
+
+static inline void write_be64(uint8_t* b, uint64_t v) {
+  for (int i = 7; i >= 0; i--, v >>= 8) b[i] = v & 0xFF;
+}
+
+static void words_from_b32(uint64_t* w, const uint8_t* b) {
+  for (int i = 0; i < 4; i++) w[i] = read_be64(b + 24 - i * 8);
+}
+
+static void fe_from_words(fe_t* r, const uint64_t* w) {
+  r->n[0] = w[0] & M52;
+  r->n[1] = (w[0] >> 52 | w[1] << 12) & M52;
+  r->n[2] = (w[1] >> 40 | w[2] << 24) & M52;
+  r->n[3] = (w[2] >> 28 | w[3] << 36) & M52;
+  r->n[4] = w[3] >> 16;
+}
+
+/** writes a normalized field element as 32 bytes big endian */
+static void fe_to_b32(uint8_t* b, const fe_t* a) {
+  write_be64(b + 24, a->n[0] | a->n[1] << 52);
+  write_be64(b + 16, a->n[1] >> 12 | a->n[2] << 40);
+  write_be64(b + 8, a->n[2] >> 24 | a->n[3] << 28);
+  write_be64(b, a->n[3] >> 36 | a->n[4] << 16);
+}
+
+/** reduces the 10 limb product to 5 limbs with a magnitude of 1. */
+static inline void fe_reduce(fe_t* r, const uint64_t* t) {
+  uint64_t r0, r1, r2, r3, r4, top;
+  u128_t   c;
+  c  = (u128_t) t[5] * R260 + t[0];
+  r0 = (uint64_t) c & M52;
+  c >>= 52;
+  c += (u128_t) t[6] * R260 + t[1];
+  r1 = (uint64_t) c & M52;
+  c >>= 52;
+  c += (u128_t) t[7] * R260 + t[2];
+  r2 = (uint64_t) c & M52;
+  c >>= 52;
+  c += (u128_t) t[8] * R260 + t[3];
+  r3 = (uint64_t) c & M52;
+  c >>= 52;
+  c += (u128_t) t[9] * R260 + t[4];
+  r4 = (uint64_t) c & M52;
+  c >>= 52;
+  // everything above 2^256 is folded into the lowest limbs again
+  top = ((uint64_t) c << 4) | (r4 >> 48);
+  r4 &= M48;
+  c       = (u128_t) top * R256 + r0;
+  r->n[0] = (uint64_t) c & M52;
+  r->n[1] = r1 + (uint64_t) (c >> 52);
+  r->n[2] = r2;
+  r->n[3] = r3;
+  r->n[4] = r4;
+}
+
+/** r = a * b, the limbs of a and b must be less than 2^56. */
+static void fe_mul(fe_t* r, const fe_t* a, const fe_t* b) {
+  const uint64_t *x = a->n, *y = b->n;
+  uint64_t        t[10];
+  u128_t          c;
+  c    = (u128_t) x[0] * y[0];
+  t[0] = (uint64_t) c & M52;
+  c >>= 52;
+  c += (u128_t) x[0] * y[1] + (u128_t) x[1] * y[0];
+  t[1] = (uint64_t) c & M52;
+  c >>= 52;
+  c += (u128_t) x[0] * y[2] + (u128_t) x[1] * y[1] + (u128_t) x[2] * y[0];
+  t[2] = (uint64_t) c & M52;
+  c >>= 52;
+  c += (u128_t) x[0] * y[3] + (u128_t) x[1] * y[2] + (u128_t) x[2] * y[1] + (u128_t) x[3] * y[0];
+  t[3] = (uint64_t) c & M52;
+  c >>= 52;
+  c += (u128_t) x[0] * y[4] + (u128_t) x[1] * y[3] + (u128_t) x[2] * y[2] + (u128_t) x[3] * y[1] + (u128_t) x[4] * y[0];
+  t[4] = (uint64_t) c & M52;
+  c >>= 52;
+  c += (u128_t) x[1] * y[4] + (u128_t) x[2] * y[3] + (u128_t) x[3] * y[2] + (u128_t) x[4] * y[1];
+  t[5] = (uint64_t) c & M52;
+  c >>= 52;
+  c += (u128_t) x[2] * y[4] + (u128_t) x[3] * y[3] + (u128_t) x[4] * y[2];
+  t[6] = (uint64_t) c & M52;
+  c >>= 52;
+  c += (u128_t) x[3] * y[4] + (u128_t) x[4] * y[3];
+  t[7] = (uint64_t) c & M52;
+  c >>= 52;
+  c += (u128_t) x[4] * y[4];
+  t[8] = (uint64_t) c & M52;
+  t[9] = (uint64_t) (c >> 52);
+  fe_reduce(r, t);
+}
+
+/** r = a^2, the limbs of a must be less than 2^56. */
+static void fe_sqr(fe_t* r, const fe_t* a) {
+  const uint64_t* x = a->n;
+  uint64_t        t[10], x0 = x[0] * 2, x1 = x[1] * 2, x2 = x[2] * 2, x3 = x[3] * 2;
+  u128_t          c;
+  c    = (u128_t) x[0] * x[0];
+  t[0] = (uint64_t) c & M52;
+  c >>= 52;
+  c += (u128_t) x0 * x[1];
+  t[1] = (uint64_t) c & M52;
+  c >>= 52;
+  c += (u128_t) x0 * x[2] + (u128_t) x[1] * x[1];
+  t[2] = (uint64_t) c & M52;
+  c >>= 52;
+  c += (u128_t) x0 * x[3] + (u128_t) x1 * x[2];
+  t[3] = (uint64_t) c & M52;
+  c >>= 52;
+  c += (u128_t) x0 * x[4] + (u128_t) x1 * x[3] + (u128_t) x[2] * x[2];
+  t[4] = (uint64_t) c & M52;
+  c >>= 52;
+  c += (u128_t) x1 * x[4] + (u128_t) x2 * x[3];
+  t[5] = (uint64_t) c & M52;
+  c >>= 52;
+  c += (u128_t) x2 * x[4] + (u128_t) x[3] * x[3];
+  t[6] = (uint64_t) c & M52;
+  c >>= 52;
+  c += (u128_t) x3 * x[4];
+  t[7] = (uint64_t) c & M52;
+  c >>= 52;
+  c += (u128_t) x[4] * x[4];
+  t[8] = (uint64_t) c & M52;
+  t[9] = (uint64_t) (c >> 52);
+  fe_reduce(r, t);
+}
+
+static inline void fe_sqr_n(fe_t* r, const fe_t* a, int n) {
+  fe_sqr(r, a);
+  while (--n) fe_sqr(r, r);
+}
+
+static inline void fe_add(fe_t* r, const fe_t* a) {
+  for (int i = 0; i < 5; i++) r->n[i] += a->n[i];
+}
+
+static inline void fe_mul_int(fe_t* r, uint64_t k) {
+  for (int i = 0; i < 5; i++) r->n[i] *= k;
+}
+
+/** r = -a, where a has a magnitude of at most m. */
+static inline void fe_negate(fe_t* r, const fe_t* a, uint64_t m) {
+  r->n[0] = P0 * 2 * (m + 1) - a->n[0];
+  r->n[1] = M52 * 2 * (m + 1) - a->n[1];
+  r->n[2] = M52 * 2 * (m + 1) - a->n[2];
+  r->n[3] = M52 * 2 * (m + 1) - a->n[3];
+  r->n[4] = M48 * 2 * (m + 1) - a->n[4];
+}
+
+/** propagates the carries, so the result has a magnitude of 1. */
+static void fe_normalize_weak(fe_t* r) {
+  uint64_t t0 = r->n[0], t1 = r->n[1], t2 = r->n[2], t3 = r->n[3], t4 = r->n[4], x = t4 >> 48;
+  t4 &= M48;
+  t0 += x * R256;
+  t1 += t0 >> 52;
+  t0 &= M52;
+  t2 += t1 >> 52;
+  t1 &= M52;
+  t3 += t2 >> 52;
+  t2 &= M52;
+  t4 += t3 >> 52;
+  t3 &= M52;
+  r->n[0] = t0, r->n[1] = t1, r->n[2] = t2, r->n[3] = t3, r->n[4] = t4;
+}
+
+/** reduces to the unique representation less than p. */
+static void fe_normalize(fe_t* r) {
+  uint64_t t0, t1, t2, t3, t4, x;
+  fe_normalize_weak(r);
+  t0 = r->n[0], t1 = r->n[1], t2 = r->n[2], t3 = r->n[3], t4 = r->n[4];
+  x  = (t4 >> 48) | ((t4 == M48) & ((t1 & t2 & t3) == M52) & (t0 >= P0));
+  t0 += x * R256;
+  t1 += t0 >> 52;
+  t0 &= M52;
+  t2 += t1 >> 52;
+  t1 &= M52;
+  t3 += t2 >> 52;
+  t2 &= M52;
+  t4 += t3 >> 52;
+  t3 &= M52;
+  r->n[0] = t0, r->n[1] = t1, r->n[2] = t2, r->n[3] = t3, r->n[4] = t4 & M48;
+}
+
+static int fe_normalizes_to_zero(const fe_t* a) {
+  fe_t t = *a;
+  fe_normalize(&t);
+  return (t.n[0] | t.n[1] | t.n[2] | t.n[3] | t.n[4]) == 0;
+}
+
+/** computes a^(2^223 - 1) and the intermediate powers needed by fe_inv and fe_sqrt */
+static void fe_pow_x223(fe_t* x223, fe_t* x22, fe_t* x2, const fe_t* a) {
+  fe_t x3, x6, x9, x11, x44, x88, x176, x220;
+  fe_sqr(x2, a);
+  fe_mul(x2, x2, a);
+  fe_sqr(&x3, x2);
+  fe_mul(&x3, &x3, a);
+  fe_sqr_n(&x6, &x3, 3);
+  fe_mul(&x6, &x6, &x3);
+  fe_sqr_n(&x9, &x6, 3);
+  fe_mul(&x9, &x9, &x3);
+  fe_sqr_n(&x11, &x9, 2);
+  fe_mul(&x11, &x11, x2);
+  fe_sqr_n(x22, &x11, 11);
+  fe_mul(x22, x22, &x11);
+  fe_sqr_n(&x44, x22, 22);
+  fe_mul(&x44, &x44, x22);
+  fe_sqr_n(&x88, &x44, 44);
+  fe_mul(&x88, &x88, &x44);
+  fe_sqr_n(&x176, &x88, 88);
+  fe_mul(&x176, &x176, &x88);
+  fe_sqr_n(&x220, &x176, 44);
+  fe_mul(&x220, &x220, &x44);
+  fe_sqr_n(x223, &x220, 3);
+  fe_mul(x223, x223, &x3);
+}
+
+/** r = a^(p-2) */
+static void fe_inv(fe_t* r, const fe_t* a) {
+  fe_t x223, x22, x2, t;
+  fe_pow_x223(&x223, &x22, &x2, a);
+  fe_sqr_n(&t, &x223, 23);
+  fe_mul(&t, &t, &x22);
+  fe_sqr_n(&t, &t, 5);
+  fe_mul(&t, &t, a);
+  fe_sqr_n(&t, &t, 3);
+  fe_mul(&t, &t, &x2);
+  fe_sqr_n(&t, &t, 2);
+  fe_mul(r, &t, a);
+}
+
+/** r = a^((p+1)/4), returns 1 if this is the square root of a. */
+static int fe_sqrt(fe_t* r, const fe_t* a) {
+  fe_t x223, x22, x2, t;
+  fe_pow_x223(&x223, &x22, &x2, a);
+  fe_sqr_n(&t, &x223, 23);
+  fe_mul(&t, &t, &x22);
+  fe_sqr_n(&t, &t, 6);
+  fe_mul(&t, &t, &x2);
+  fe_sqr_n(r, &t, 2);
+  fe_sqr(&t, r);
+  fe_negate(&t, &t, 1);
+  fe_add(&t, a);
+  return fe_normalizes_to_zero(&t);
+}
+
+// -- scalar arithmetic
+
+static int sc_cmp(const sc_t* a, const sc_t* b) {
+  for (int i = 3; i >= 0; i--) {
+    if (a->d[i] != b->d[i]) return a->d[i] > b->d[i] ? 1 : -1;
+  }
+  return 0;
+}
+
+static inline int sc_is_zero(const sc_t* a) {
+  return (a->d[0] | a->d[1] | a->d[2] | a->d[3]) == 0;
+}
+
+/** r = a - b, returning the borrow. */
+static uint64_t sc_sub_words(sc_t* r, const sc_t* a, const sc_t* b) {
+  uint64_t borrow = 0;
+  for (int i = 0; i < 4; i++) {
+    u128_t t = (u128_t) a->d[i] - b->d[i] - borrow;
+    r->d[i]  = (uint64_t) t;
+    borrow   = (uint64_t) (t >> 64) & 1;
+  }
+  return borrow;
+}
+
+/** reduces the nw words of w (nw <= 8) mod n by folding the upper words with 2^256 - n. */
+static void sc_reduce(sc_t* r, uint64_t* w, int nw) {
+  while (nw > 4) {
+    uint64_t t[8] = {w[0], w[1], w[2], w[3], 0, 0, 0, 0};
+    for (int i = 4; i < nw; i++) {
+      u128_t c = 0;
+      int    k = i - 4;
+      for (int j = 0; j < 3; j++, k++) {
+        c += (u128_t) w[i] * SC_C[j] + t[k];
+        t[k] = (uint64_t) c;
+        c >>= 64;
+      }
+      for (; c; k++) {
+        c += t[k];
+        t[k] = (uint64_t) c;
+        c >>= 64;
+      }
+    }
+    for (nw = 8; nw > 4 && !t[nw - 1]; nw--) {}
+    memcpy(w, t, sizeof(t));
+  }
+  memcpy(r->d, w, 32);
+  if (sc_cmp(r, &SC_N) >= 0) sc_sub_words(r, r, &SC_N);
+}
+
+static void sc_mul(sc_t* r, const sc_t* a, const sc_t* b) {
+  uint64_t w[8] = {0};
+  for (int i = 0; i < 4; i++) {
+    u128_t c = 0;
+    for (int j = 0; j < 4; j++) {
+      c += (u128_t) a->d[i] * b->d[j] + w[i + j];
+      w[i + j] = (uint64_t) c;
+      c >>= 64;
+    }
+    w[i + 4] = (uint64_t) c;
+  }
+  sc_reduce(r, w, 8);
+}
+
+/** r = round(a * b / 2^384) */
+static void sc_mul_shift384(sc_t* r, const sc_t* a, const sc_t* b) {
+  uint64_t w[8] = {0};
+  for (int i = 0; i < 4; i++) {
+    u128_t c = 0;
+    for (int j = 0; j < 4; j++) {
+      c += (u128_t) a->d[i] * b->d[j] + w[i + j];
+      w[i + j] = (uint64_t) c;
+      c >>= 64;
+    }
+    w[i + 4] = (uint64_t) c;
+  }
+  u128_t c = ((u128_t) w[7] << 64 | w[6]) + (w[5] >> 63);
+  r->d[0]  = (uint64_t) c;
+  r->d[1]  = (uint64_t) (c >> 64);
+  r->d[2] = r->d[3] = 0;
+}
+
+static void sc_add(sc_t* r, const sc_t* a, const sc_t* b) {
+  uint64_t w[5];
+  u128_t   c = 0;
+  for (int i = 0; i < 4; i++) {
+    c += (u128_t) a->d[i] + b->d[i];
+    w[i] = (uint64_t) c;
+    c >>= 64;
+  }
+  w[4] = (uint64_t) c;
+  sc_reduce(r, w, w[4] ? 5 : 4);
+}
+
+static void sc_negate(sc_t* r, const sc_t* a) {
+  if (sc_is_zero(a))
+    *r = *a;
+  else
+    sc_sub_words(r, &SC_N, a);
+}
+
+/** r = a^(n-2) using a fixed 4 bit window. */
+static void sc_inv(sc_t* r, const sc_t* a) {
+  sc_t e, pw[16], t;
+  sc_sub_words(&e, &SC_N, &SC_ONE);
+  sc_sub_words(&e, &e, &SC_ONE);
+  pw[0] = SC_ONE;
+  pw[1] = *a;
+  for (int i = 2; i < 16; i++) sc_mul(pw + i, pw + i - 1, a);
+  t = pw[e.d[3] >> 60];
+  for (int i = 62; i >= 0; i--) {
+    int nibble = (e.d[i >> 4] >> ((i & 15) * 4)) & 15;
+    for (int j = 0; j < 4; j++) sc_mul(&t, &t, &t);
+    if (nibble) sc_mul(&t, &t, pw + nibble);
+  }
+  *r = t;
+}
+
+/** splits k into r1 + r2 * lambda with r1 and r2 having about 128 bits each. */
+static void sc_split_lambda(sc_t* r1, sc_t* r2, const sc_t* k) {
+  sc_t c1, c2;
+  sc_mul_shift384(&c1, k, &SC_G1);
+  sc_mul_shift384(&c2, k, &SC_G2);
+  sc_mul(&c1, &c1, &SC_MINUS_B1);
+  sc_mul(&c2, &c2, &SC_MINUS_B2);
+  sc_add(r2, &c1, &c2);
+  sc_mul(r1, r2, &SC_MINUS_LAMBDA);
+  sc_add(r1, r1, k);
+}
+
+/** computes the wNAF of a (at most 129 bits) with odd digits less than 2^(w-1) and returns the number of digits. */
+static int sc_wnaf(int8_t* wnaf, const sc_t* a, int w) {
+  uint64_t k0 = a->d[0], k1 = a->d[1], k2 = a->d[2];
+  int      len = 0;
+  memset(wnaf, 0, WNAF_MAX);
+  for (int i = 0; k0 | k1 | k2; i++) {
+    if (k0 & 1) {
+      int d = (int) (k0 & ((1 << w) - 1));
+      if (d >= 1 << (w - 1)) d -= 1 << w;
+      wnaf[i] = (int8_t) d;
+      len     = i + 1;
+      if (d > 0)
+        k0 -= (uint64_t) d;
+      else {
+        u128_t c = (u128_t) k0 + (uint64_t) -d;
+        k0       = (uint64_t) c;
+        if (c >> 64 && !++k1) k2++;
+      }
+    }
+    k0 = k0 >> 1 | k1 << 63;
+    k1 = k1 >> 1 | k2 << 63;
+    k2 >>= 1;
+  }
+  return len;
+}
+
+// -- group operations
+
+static void gej_double(gej_t* r, const gej_t* a) {
+  fe_t y2, s, m, t, u;
+  if (a->inf) {
+    r->inf = 1;
+    return;
+  }
+  fe_sqr(&y2, &a->y);         // Y^2
+  fe_mul(&s, &a->x, &y2);     // S = 4 X Y^2
+  fe_mul_int(&s, 4);          //
+  fe_sqr(&m, &a->x);          // M = 3 X^2
+  fe_mul_int(&m, 3);          //
+  fe_sqr(&t, &y2);            // 8 Y^4
+  fe_mul_int(&t, 8);          //
+  fe_mul(&r->z, &a->z, &a->y); // Z3 = 2 Y Z
+  fe_mul_int(&r->z, 2);
+  fe_normalize_weak(&r->z);
+  fe_sqr(&r->x, &m); // X3 = M^2 - 2 S
+  fe_negate(&u, &s, 4);
+  fe_mul_int(&u, 2);
+  fe_add(&r->x, &u);
+  fe_normalize_weak(&r->x);
+  fe_negate(&u, &r->x, 1); // Y3 = M (S - X3) - 8 Y^4
+  fe_add(&u, &s);
+  fe_mul(&r->y, &m, &u);
+  fe_negate(&t, &t, 8);
+  fe_add(&r->y, &t);
+  fe_normalize_weak(&r->y);
+  r->inf = 0;
+}
+
+/** r = a + b with b in affine coordinates (8M + 3S). */
+static void gej_add_ge(gej_t* r, const gej_t* a, const ge_t* b) {
+  fe_t z12, u2, s2, h, rr, hh, hhh, v, t;
+  if (a->inf) {
+    r->x   = b->x;
+    r->y   = b->y;
+    r->z   = FE_ONE;
+    r->inf = 0;
+    return;
+  }
+  fe_sqr(&z12, &a->z);
+  fe_mul(&u2, &b->x, &z12);
+  fe_mul(&s2, &b->y, &a->z);
+  fe_mul(&s2, &s2, &z12);
+  fe_negate(&h, &a->x, 1);
+  fe_add(&h, &u2);
+  fe_negate(&rr, &a->y, 1);
+  fe_add(&rr, &s2);
+  if (fe_normalizes_to_zero(&h)) {
+    if (fe_normalizes_to_zero(&rr))
+      gej_double(r, a);
+    else
+      r->inf = 1;
+    return;
+  }
+  fe_sqr(&hh, &h);
+  fe_mul(&hhh, &h, &hh);
+  fe_mul(&v, &a->x, &hh);
+  fe_mul(&t, &a->y, &hhh);
+  fe_mul(&r->z, &a->z, &h);
+  fe_sqr(&r->x, &rr); // X3 = R^2 - H^3 - 2 V
+  fe_negate(&hhh, &hhh, 1);
+  fe_add(&r->x, &hhh);
+  fe_negate(&u2, &v, 1);
+  fe_mul_int(&u2, 2);
+  fe_add(&r->x, &u2);
+  fe_normalize_weak(&r->x);
+  fe_negate(&u2, &r->x, 1); // Y3 = R (V - X3) - Y1 H^3
+  fe_add(&u2, &v);
+  fe_mul(&r->y, &rr, &u2);
+  fe_negate(&t, &t, 1);
+  fe_add(&r->y, &t);
+  fe_normalize_weak(&r->y);
+  r->inf = 0;
+}
+
+/** r = a + b (12M + 4S). */
+static void gej_add(gej_t* r, const gej_t* a, const gej_t* b) {
+  fe_t z12, z22, u1, u2, s1, s2, h, rr, hh, hhh, v, z;
+  if (a->inf) {
+    *r = *b;
+    return;
+  }
+  if (b->inf) {
+    *r = *a;
+    return;
+  }
+  fe_sqr(&z12, &a->z);
+  fe_sqr(&z22, &b->z);
+  fe_mul(&u1, &a->x, &z22);
+  fe_mul(&u2, &b->x, &z12);
+  fe_mul(&s1, &a->y, &b->z);
+  fe_mul(&s1, &s1, &z22);
+  fe_mul(&s2, &b->y, &a->z);
+  fe_mul(&s2, &s2, &z12);
+  fe_negate(&h, &u1, 1);
+  fe_add(&h, &u2);
+  fe_negate(&rr, &s1, 1);
+  fe_add(&rr, &s2);
+  if (fe_normalizes_to_zero(&h)) {
+    if (fe_normalizes_to_zero(&rr))
+      gej_double(r, a);
+    else
+      r->inf = 1;
+    return;
+  }
+  fe_sqr(&hh, &h);
+  fe_mul(&hhh, &h, &hh);
+  fe_mul(&v, &u1, &hh);
+  fe_mul(&z, &a->z, &b->z);
+  fe_mul(&r->z, &z, &h);
+  fe_mul(&s1, &s1, &hhh);
+  fe_sqr(&r->x, &rr); // X3 = R^2 - H^3 - 2 V
+  fe_negate(&hhh, &hhh, 1);
+  fe_add(&r->x, &hhh);
+  fe_negate(&u2, &v, 1);
+  fe_mul_int(&u2, 2);
+  fe_add(&r->x, &u2);
+  fe_normalize_weak(&r->x);
+  fe_negate(&u2, &r->x, 1); // Y3 = R (V - X3) - S1 H^3
+  fe_add(&u2, &v);
+  fe_mul(&r->y, &rr, &u2);
+  fe_negate(&s1, &s1, 1);
+  fe_add(&r->y, &s1);
+  fe_normalize_weak(&r->y);
+  r->inf = 0;
+}
+
+static inline void fe_negate_weak(fe_t* r) {
+  fe_negate(r, r, 1);
+  fe_normalize_weak(r);
+}
+
+/**
+ * r = u1 * G + u2 * R
+ * 
+ * Both scalars are split with the endomorphism lambda*(x,y) = (beta*x,y), so
+ * four 128 bit wNAFs are processed by one shared doubling chain.
+ */
+static void ecmult(gej_t* r, const ge_t* R, const sc_t* u1, const sc_t* u2) {
+  sc_t   k[4];
+  int8_t wnaf[4][WNAF_MAX];
+  int    neg[4], len[4], bits = 0;
+  gej_t  tr[1 << (WINDOW_R - 2)], trl[1 << (WINDOW_R - 2)], d;
+
+  sc_split_lambda(k, k + 1, u2);
+  sc_split_lambda(k + 2, k + 3, u1);
+  for (int i = 0; i < 4; i++) {
+    if ((neg[i] = sc_cmp(k + i, &SC_N_HALF) > 0)) sc_negate(k + i, k + i);
+    len[i] = sc_wnaf(wnaf[i], k + i, i < 2 ? WINDOW_R : WINDOW_G);
+    if (len[i] > bits) bits = len[i];
+  }
+
+  // odd multiples of R and lambda*R
+  tr[0].x   = R->x;
+  tr[0].y   = R->y;
+  tr[0].z   = FE_ONE;
+  tr[0].inf = 0;
+  gej_double(&d, tr);
+  for (int i = 1; i < (1 << (WINDOW_R - 2)); i++) gej_add(tr + i, tr + i - 1, &d);
+  for (int i = 0; i < (1 << (WINDOW_R - 2)); i++) {
+    trl[i] = tr[i];
+    fe_mul(&trl[i].x, &tr[i].x, &FE_BETA);
+  }
+
+  r->inf = 1;
+  for (int i = bits - 1; i >= 0; i--) {
+    gej_double(r, r);
+    for (int j = 0; j < 2; j++) {
+      int n = wnaf[j][i];
+      if (!n) continue;
+      d = (j ? trl : tr)[(n < 0 ? -n : n) >> 1];
+      if ((n < 0) ^ neg[j]) fe_negate_weak(&d.y);
+      gej_add(r, r, &d);
+    }
+    for (int j = 2; j < 4; j++) {
+      int n = wnaf[j][i];
+      if (!n) continue;
+      ge_t p = G_TABLE[(n < 0 ? -n : n) >> 1];
+      if (j == 3) fe_mul(&p.x, &p.x, &FE_BETA);
+      if ((n < 0) ^ neg[j]) fe_negate_weak(&p.y);
+      gej_add_ge(r, r, &p);
+    }
+  }
+}
+
+/** computes R from r and the recovery id, returns 0 on success. */
+static int lift_x(ge_t* R, const sc_t* r, int recid) {
+  sc_t x = *r;
+  fe_t y2;
+  if (recid & 2) {
+    // x = r + n must still be less than p
+    u128_t c = 0;
+    for (int i = 0; i < 4; i++) {
+      c += (u128_t) x.d[i] + SC_N.d[i];
+      x.d[i] = (uint64_t) c;
+      c >>= 64;
+    }
+    if (c || sc_cmp(&x, &SC_P) >= 0) return 1;
+  }
+  fe_from_words(&R->x, x.d);
+  fe_sqr(&y2, &R->x);
+  fe_mul(&y2, &y2, &R->x);
+  y2.n[0] += 7;
+  if (!fe_sqrt(&R->y, &y2)) return 1;
+  fe_normalize(&R->y);
+  if ((R->y.n[0] & 1) != (uint64_t) (recid & 1)) {
+    fe_negate(&R->y, &R->y, 1);
+    fe_normalize(&R->y);
+  }
+  return 0;
+}
+
+void ecrecover_pub_batch(ecrecover_t* sigs, int n) {
+  rec_t  stack_buf[BATCH_STACK];
+  rec_t* recs = n > BATCH_STACK ? _malloc(sizeof(rec_t) * n) : stack_buf;
+  sc_t   sc_acc = SC_ONE, sc_i = SC_ONE, t;
+  fe_t   fe_acc = FE_ONE, fe_i = FE_ONE, z2;
+  int    valid  = 0;
+
+  // parse the signatures and compute R
+  for (int i = 0; i < n; i++) {
+    rec_t*   rec = recs + i;
+    uint64_t w[4];
+    words_from_b32(rec->r.d, sigs[i].sig);
+    words_from_b32(rec->s.d, sigs[i].sig + 32);
+    words_from_b32(w, sigs[i].hash);
+    sc_reduce(&rec->e, w, 4);
+    sc_negate(&rec->e, &rec->e);
+    sigs[i].res = sc_is_zero(&rec->r) || sc_is_zero(&rec->s) || sc_cmp(&rec->r, &SC_N) >= 0 || sc_cmp(&rec->s, &SC_N) >= 0 || lift_x(&rec->R, &rec->r, sigs[i].recid);
+    if (sigs[i].res) continue;
+    rec->pre_sc = sc_acc;
+    sc_mul(&sc_acc, &sc_acc, &rec->r);
+    valid++;
+  }
+
+  // one inversion for all r
+  if (valid) sc_inv(&sc_i, &sc_acc);
+  for (int i = n - 1; i >= 0; i--) {
+    rec_t* rec = recs + i;
+    if (sigs[i].res) continue;
+    sc_mul(&t, &sc_i, &rec->pre_sc);
+    sc_mul(&sc_i, &sc_i, &rec->r);
+    sc_mul(&rec->e, &rec->e, &t); // -e / r
+    sc_mul(&rec->s, &rec->s, &t); //  s / r
+  }
+
+  // Q = (s R - e G) / r
+  valid = 0;
+  for (int i = 0; i < n; i++) {
+    rec_t* rec = recs + i;
+    if (sigs[i].res) continue;
+    ecmult(&rec->q, &rec->R, &rec->e, &rec->s);
+    if ((sigs[i].res = rec->q.inf)) continue;
+    rec->pre_fe = fe_acc;
+    fe_mul(&fe_acc, &fe_acc, &rec->q.z);
+    valid++;
+  }
+
+  // one inversion for all z
+  if (valid) fe_inv(&fe_i, &fe_acc);
+  for (int i = n - 1; i >= 0; i--) {
+    rec_t* rec = recs + i;
+    if (sigs[i].res) continue;
+    fe_t zi;
+    fe_mul(&zi, &fe_i, &rec->pre_fe);
+    fe_mul(&fe_i, &fe_i, &rec->q.z);
+    fe_sqr(&z2, &zi);
+    fe_mul(&rec->q.x, &rec->q.x, &z2);
+    fe_mul(&z2, &z2, &zi);
+    fe_mul(&rec->q.y, &rec->q.y, &z2);
+    fe_normalize(&rec->q.x);
+    fe_normalize(&rec->q.y);
+    sigs[i].pub[0] = 0x04;
+    fe_to_b32(sigs[i].pub + 1, &rec->q.x);
+    fe_to_b32(sigs[i].pub + 33, &rec->q.y);
+  }
+
+  if (recs != stack_buf) _free(recs);
+}
+
+int ecrecover_pub(const uint8_t* sig, int recid, const uint8_t* hash, uint8_t* pub) {
+  ecrecover_t e = {.sig = sig, .hash = hash, .recid = recid};
+  ecrecover_pub_batch(&e, 1);
+  if (!e.res) memcpy(pub, e.pub, 65);
+  return e.res;
+}
+
+#else
+
+int ecrecover_pub(const uint8_t* sig, int recid, const uint8_t* hash, uint8_t* pub) {
+  return ecdsa_recover_pub_from_sig(&secp256k1, pub, sig, hash, recid);
+}
+
+void ecrecover_pub_batch(ecrecover_t* sigs, int n) {
+  for (int i = 0; i < n; i++) sigs[i].res = ecrecover_pub(sigs[i].sig, sigs[i].recid, sigs[i].hash, sigs[i].pub);
+}
+
+#endif
@@ -0,0 +1,71 @@
+/*******************************************************************************
+ * This file is part of the Incubed project.
+ * Sources: https://github.com/slockit/in3-c
+ * 
+ * Copyright (C) 2018-2019 slock.it GmbH, Blockchains LLC
+ * 
+ * 
+ * COMMERCIAL LICENSE USAGE
+ * 
+ * Licensees holding a valid commercial license may use this file in accordance 
+ * with the commercial license agreement provided with the Software or, alternatively, 
+ * in accordance with the terms contained in a written agreement between you and 
+ * slock.it GmbH/Blockchains LLC. For licensing terms and conditions or further 
+ * information please contact slock.it at in3@slock.it.
+ * 	
+ * Alternatively, this file may be used under the AGPL license as follows:
+ *    
+ * AGPL LICENSE USAGE
+ * 
+ * This program is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Affero General Public License as published by the Free Software 
+ * Foundation, either version 3 of the License, or (at your option) any later version.
+ *  
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY 
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A 
+ * PARTICULAR PURPOSE. See the GNU Affero General Public License for more details.
+ * [Permissions of this strong copyleft license are conditioned on making available 
+ * complete source code of licensed works and modifications, which include larger 
+ * works using a licensed work, under the same license. Copyright and license notices 
+ * must be preserved. Contributors provide an express grant of patent rights.]
+ * You should have received a copy of the GNU Affero General Public License along 
+ * with this program. If not, see <https://www.gnu.org/licenses/>.
+ *******************************************************************************/
+
+/** @file 
+ * secp256k1 public key recovery.
+ * 
+ * Uses the GLV endomorphism, a 5x52 bit field and interleaved wNAF (Strauss-Shamir) multiplication
+ * to compute u1*G + u2*R in one pass. Without 128bit integer support it falls back to the trezor-crypto implementation.
+ * */
+
+#ifndef ecrecover_h__
+#define ecrecover_h__
+
+#include <stdint.h>
+
+/** a single signature to recover within a batch. */
+typedef struct {
+  const uint8_t* sig;     /**< 64 bytes r and s */
+  const uint8_t* hash;    /**< 32 bytes message hash */
+  int            recid;   /**< recovery id (0-3) */
+  int            res;     /**< result, 0 on success */
+  uint8_t        pub[65]; /**< the recovered uncompressed public key (0x04 prefix) */
+} ecrecover_t;
+
+/**
+ * recovers the public key from the signature.
+ * 
+ * This is a drop-in replacement for `ecdsa_recover_pub_from_sig(&secp256k1, ...)`
+ * and returns 0 on success.
+ */
+int ecrecover_pub(const uint8_t* sig, int recid, const uint8_t* hash, uint8_t* pub);
+
+/**
+ * recovers n signatures sharing one scalar and one field inversion.
+ * 
+ * The result of each signature is written into its `res` and `pub`.
+ */
+void ecrecover_pub_batch(ecrecover_t* sigs, int n);
+
+#endif
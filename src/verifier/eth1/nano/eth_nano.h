@@ -57,6 +57,13 @@ in3_ret_t eth_verify_blockheader(in3_vctx_t* vc, bytes_t* header, bytes_t* expec
  */
 int eth_verify_signature(in3_vctx_t* vc, bytes_t* msg_hash, d_token_t* sig);
 
+/** 
+ * verifies the signatures of a blockheader, which are recovered with one batch.
+ * 
+ * This function will return the bitmask of all signers found, like `eth_verify_signature` does for a single signature.
+ */
+int eth_verify_signatures(in3_vctx_t* vc, bytes_t* msg_hash, d_token_t** sigs, int len);
+
 /**
  *  returns the address of the signature if the msg_hash is correct
  */
@@ -88,4 +95,11 @@ void in3_register_eth_nano();
  * The result must be freed after use!
  */
 bytes_t* create_tx_path(uint32_t index);
+
+/**
+ * rlp-encodes the transaction_index into dst, which must hold at least 5 bytes.
+ * 
+ * returns the path pointing to dst, so nothing needs to be freed.
+ */
+bytes_t create_tx_path_to(uint32_t index, uint8_t* dst);
 #endif // in3_eth_nano_h__
\ No newline at end of file
@@ -32,6 +32,7 @@
  * with this program. If not, see <https://www.gnu.org/licenses/>.
  *******************************************************************************/
 
+#include "../../../core/client/client.h"
 #include "../../../core/util/mem.h"
 #include "../../../core/util/utils.h"
 #include <stdint.h>
@@ -42,14 +43,6 @@
 #include "merkle.h"
 #include "rlp.h"
 
-static int nibble_len(uint8_t* a) {
-  int i = 0;
-  for (i = 0;; i++) {
-    if (a[i] == 0xFF) return i;
-  }
-  return -1;
-}
-
 int trie_matching_nibbles(uint8_t* a, uint8_t* b) {
   int i = 0;
   for (i = 0;; i++) {
@@ -72,110 +65,169 @@ uint8_t* trie_path_to_nibbles(bytes_t path, int use_prefix) {
   return n;
 }
 
-static int check_node(bytes_t* raw_node, uint8_t** key, bytes_t* expectedValue, int is_last_node, bytes_t* last_value, uint8_t* next_hash, size_t* depth) {
-  bytes_t node, val;
-  (*depth)++;
-  if (*depth > MERKLE_DEPTH_MAX)
-    return 0;
+/** a cursor over 4 bit nibbles packed in bytes. */
+typedef struct {
+  const uint8_t* data; /**< the packed bytes */
+  int            pos;  /**< the current nibble */
+  int            len;  /**< the number of nibbles */
+} nibbles_t;
+
+static inline uint8_t nibble_at(const uint8_t* data, int i) {
+  return i & 1 ? data[i >> 1] & 0x0F : data[i >> 1] >> 4;
+}
+
+/** returns the number of nibbles both cursors have in common starting at their current position. */
+static int matching_nibbles(const nibbles_t* a, const nibbles_t* b) {
+  int i = 0;
+  while (a->pos + i < a->len && b->pos + i < b->len && nibble_at(a->data, a->pos + i) == nibble_at(b->data, b->pos + i)) i++;
+  return i;
+}
+
+/**
+ * checks one node of the proof and finds the next expected hash.
+ * 
+ * embedded nodes (shorter than 32 bytes) are part of their parent node and checked within the same call.
+ */
+static int check_node(bytes_t* raw_node, nibbles_t* key, bytes_t* expectedValue, int is_last_node, bytes_t* last_value, uint8_t* next_hash, size_t* depth) {
+  bytes_t     node, val;
+  rlp_index_t items;
 
   // decode the list into war values
   rlp_decode(raw_node, 0, &node);
-  switch (rlp_decode_len(&node)) {
+  while (++(*depth) <= MERKLE_DEPTH_MAX) {
+    switch (rlp_index(&node, &items)) {
 
-    case 17: // branch
-      if (**key == 0xFF) {
+      case 17: // branch
+        if (key->pos == key->len) {
 
-        // if this is no the last node or the value is an embedded, which means more to come.
-        if (!is_last_node || rlp_decode(&node, 16, &node) != 1)
-          return 0;
+          // if this is no the last node or the value is an embedded, which means more to come.
+          if (!is_last_node || rlp_index_get(&items, 16, &node) != 1)
+            return 0;
+
+          *last_value = node;
+          return 1;
+        }
 
-        last_value->data = node.data;
-        last_value->len  = node.len;
+        if (rlp_index_get(&items, nibble_at(key->data, key->pos++), &val) == 2) {
+          // we have an embedded node as next
+          node = val;
+          continue;
+        } else if (val.len != 32) // no hash, so we make sure the next hash is an empty hash
+          memset(next_hash, 0, 32);
+        else
+          memcpy(next_hash, val.data, 32);
         return 1;
-      }
 
-      if (rlp_decode(&node, **key, &val) == 2) {
-        rlp_decode(&node, (**key) - 1, &node);
-        *key += 1;
-
-        // we have an embedded node as next
-        node.data += node.len;
-        node.len = val.data + val.len - node.data;
-
-        // check the embedded
-        return check_node(&node, key, expectedValue, *(*key + 1) == 0xFF, last_value, next_hash, depth);
-
-      } else if (val.len != 32) // no hash, so we make sure the next hash is an empty hash
-        memset(next_hash, 0, 32);
-      else
-        memcpy(next_hash, val.data, 32);
-      *key += 1;
-      return 1;
-
-    case 2: // leaf or extension
-      if (rlp_decode(&node, 0, &val) != 1)
-        return 0;
-      else {
-        uint8_t* path_nibbles  = trie_path_to_nibbles(val, 1);
-        int      matching      = trie_matching_nibbles(path_nibbles, *key);
-        int      node_path_len = nibble_len(path_nibbles);
-        int      is_leaf       = val.data[0] & 32;
-        _free(path_nibbles);
-
-        // if the relativeKey in the leaf does not math our rest key, we throw!
-        if (node_path_len != matching)
-          // so we have a wrong leaf here, if we actually expected this node to not exist,
-          // the last node in this path may be a different leaf or a branch with a empty hash
-          return expectedValue == NULL && is_last_node;
-
-        *key += node_path_len;
-        if (rlp_decode(&node, 1, &val) == 2) { // this is an embedded node
-          rlp_decode(&node, 0, &node);
-          node.data += node.len;
-          node.len = val.data + val.len - node.data;
-
-          // check the embedded node
-          return check_node(&node, key, expectedValue, *(key + 1) == NULL, last_value, next_hash, depth);
-
-        } else if (**key == 0xFF) {
-          // readed the end, if this is the last node, it is ok.
-          if (!is_last_node) return 0;
-
-          // if we are proven a value which shouldn't exist this must throw an error
-          if (expectedValue == NULL && is_leaf)
-            return 0;
-        } else if (is_leaf && expectedValue != NULL)
+      case 2: // leaf or extension
+        if (rlp_index_get(&items, 0, &val) != 1 || !val.len)
           return 0;
-      }
+        else {
+          // the first nibble holds the leaf-flag and whether the path has an odd length
+          nibbles_t path     = {.data = val.data, .pos = (val.data[0] & 0x10) ? 1 : 2, .len = val.len * 2};
+          int       matching = matching_nibbles(&path, key);
+          int       is_leaf  = val.data[0] & 32;
+
+          // if the relativeKey in the leaf does not math our rest key, we throw!
+          if (path.len - path.pos != matching)
+            // so we have a wrong leaf here, if we actually expected this node to not exist,
+            // the last node in this path may be a different leaf or a branch with a empty hash
+            return expectedValue == NULL && is_last_node;
+
+          key->pos += matching;
+          if (rlp_index_get(&items, 1, &val) == 2) { // this is an embedded node
+            node = val;
+            continue;
+          } else if (key->pos == key->len) {
+            // readed the end, if this is the last node, it is ok.
+            if (!is_last_node) return 0;
 
-      // copy the leafs data as last_value and next_hash
-      last_value->data = val.data;
-      last_value->len  = val.len;
-      memcpy(next_hash, val.data, (val.len >= 32) ? 32 : val.len);
-      return 1;
+            // if we are proven a value which shouldn't exist this must throw an error
+            if (expectedValue == NULL && is_leaf)
+              return 0;
+          } else if (is_leaf && expectedValue != NULL)
+            return 0;
+        }
+
+        // copy the leafs data as last_value and next_hash
+        *last_value = val;
+        memcpy(next_hash, val.data, (val.len >= 32) ? 32 : val.len);
+        return 1;
 
-    default: // empty node
-      // only if we expect no value we accept a empty node as last node
-      return (expectedValue == NULL && is_last_node);
+      default: // empty node
+        // only if we expect no value we accept a empty node as last node
+        return (expectedValue == NULL && is_last_node);
+    }
   }
-  return 1;
+  return 0;
 }
 
-int trie_verify_proof(bytes_t* rootHash, bytes_t* path, bytes_t** proof, bytes_t* expectedValue) {
-  int      res        = 1;
-  uint8_t* full_key   = trie_path_to_nibbles(*path, 0);
-  uint8_t *key        = full_key, expected_hash[32], node_hash[32];
-  bytes_t  last_value = {.data = NULL, .len = 0};
+/** finds the slot of a node in the cache. The middle of a node is part of a hash or the value, so it is a good index. */
+static in3_cached_node_t* cached_node(in3_cached_node_t* cache, int cache_size, bytes_t* node) {
+  uint32_t index = node->len;
+  if (node->len >= 8) index ^= bytes_to_int(node->data + node->len / 2 - 2, 4);
+  return cache + (index % cache_size);
+}
+
+/** hashes up to 8 nodes at once and writes the hashes to dst. Nodes found in the cache are not hashed again. */
+static void hash_nodes(bytes_t** nodes, int n, uint8_t* dst, in3_cached_node_t* cache, int cache_size) {
+  if (!cache || !cache_size) {
+    sha3_many(nodes, n, dst);
+    return;
+  }
+
+  bytes_t*           todo[8];
+  in3_cached_node_t* slots[8];
+  uint8_t            hashes[32 * 8];
+  int                l = 0;
+
+  for (int i = 0; i < n; i++) {
+    in3_cached_node_t* c = cached_node(cache, cache_size, nodes[i]);
+    if (b_cmp(&c->data, nodes[i]))
+      memcpy(dst + i * 32, c->hash, 32);
+    else {
+      slots[l]  = c;
+      todo[l++] = nodes[i];
+    }
+  }
+  if (!l) return;
+
+  sha3_many(todo, l, hashes);
+  for (int i = 0, j = 0; i < n; i++) {
+    if (j == l || todo[j] != nodes[i]) continue;
+
+    // store a copy, since the proof will be freed with the response.
+    in3_cached_node_t* c = slots[j];
+    if (c->data.data) _free(c->data.data);
+    c->data = bytes(_malloc(nodes[i]->len), nodes[i]->len);
+    memcpy(c->data.data, nodes[i]->data, c->data.len);
+    memcpy(c->hash, hashes + j * 32, 32);
+    memcpy(dst + i * 32, hashes + j++ * 32, 32);
+  }
+}
+
+/** verifies n proof nodes, taken either from the NULL-terminated vector or from the json-array. */
+static int verify_proof(bytes_t* rootHash, bytes_t* path, bytes_t** proof, d_token_t* token, int n, bytes_t* expectedValue, in3_cached_node_t* cache, int cache_size) {
+  int       res        = 1;
+  nibbles_t key        = {.data = path->data, .pos = 0, .len = path->len * 2};
+  bytes_t   last_value = {.data = NULL, .len = 0}, *nodes[8];
+  uint8_t   expected_hash[32], hashes[32 * 8];
+  size_t    depth = 0;
 
   // start with root hash
   memcpy(expected_hash, rootHash->data, 32);
 
-  size_t depth = 0;
-  for (; *proof; proof += 1) {
-    // create and check the hash of node
-    if (!(res = sha3_to(*proof, node_hash) == 0 && memcmp(expected_hash, node_hash, 32) == 0)) break;
-    // check embedded nodes and find the next expected hash
-    if (!(res = check_node(*proof, &key, expectedValue, *(proof + 1) == NULL, &last_value, expected_hash, &depth))) break;
+  // hash up to 8 nodes at once, so they can be calculated in parallel
+  for (int i = 0; i < n && res;) {
+    int m = min(n - i, 8);
+    for (int j = 0; j < m; j++, token = token ? d_next(token) : NULL) nodes[j] = proof ? proof[i + j] : d_bytes(token);
+    hash_nodes(nodes, m, hashes, cache, cache_size);
+
+    for (int j = 0; j < m && res; j++, i++) {
+      // check the hash of node
+      if (!(res = memcmp(expected_hash, hashes + j * 32, 32) == 0)) break;
+      // check embedded nodes and find the next expected hash
+      res = check_node(nodes[j], &key, expectedValue, i == n - 1, &last_value, expected_hash, &depth);
+    }
   }
 
   if (res && expectedValue != NULL) {
@@ -191,10 +243,138 @@ int trie_verify_proof(bytes_t* rootHash, bytes_t* path, bytes_t** proof, bytes_t
       res = 0;
   }
 
-  if (full_key) _free(full_key);
   return res;
 }
 
+int trie_verify_proof(bytes_t* rootHash, bytes_t* path, bytes_t** proof, bytes_t* expectedValue) {
+  int n = 0;
+  while (proof[n]) n++;
+  return verify_proof(rootHash, path, proof, NULL, n, expectedValue, NULL, 0);
+}
+
+int trie_verify_proof_token(bytes_t* rootHash, bytes_t* path, d_token_t* proof, bytes_t* expectedValue) {
+  if (!proof || d_type(proof) != T_ARRAY) return 0;
+  return verify_proof(rootHash, path, NULL, proof + 1, d_len(proof), expectedValue, NULL, 0);
+}
+
+int trie_verify_proof_cached(bytes_t* rootHash, bytes_t* path, d_token_t* proof, bytes_t* expectedValue, in3_cached_node_t* cache, int cache_size) {
+  if (!proof || d_type(proof) != T_ARRAY) return 0;
+  return verify_proof(rootHash, path, NULL, proof + 1, d_len(proof), expectedValue, cache, cache_size);
+}
+
+/** orders nodes by their raw content, so duplicates are found before hashing them. */
+static int cmp_node_data(const void* a, const void* b) {
+  const bytes_t *x = &((const trie_proof_node_t*) a)->data, *y = &((const trie_proof_node_t*) b)->data;
+  return x->len == y->len ? memcmp(x->data, y->data, x->len) : (x->len < y->len ? -1 : 1);
+}
+
+/** orders nodes by their hash. */
+static int cmp_node_hash(const void* a, const void* b) {
+  return memcmp(((const trie_proof_node_t*) a)->hash, ((const trie_proof_node_t*) b)->hash, 32);
+}
+
+int trie_multiproof_add(trie_multiproof_t* mp, d_token_t* proof) {
+  if (!proof || d_type(proof) != T_ARRAY) return 0;
+  int n = d_len(proof);
+  if (mp->len + n > mp->size) {
+    int size  = max(mp->len + n, mp->size * 2);
+    mp->nodes = mp->nodes ? _realloc(mp->nodes, size * sizeof(trie_proof_node_t), mp->size * sizeof(trie_proof_node_t)) : _malloc(size * sizeof(trie_proof_node_t));
+    mp->size  = size;
+  }
+  for (d_token_t* t = proof + 1; n; n--, t = d_next(t)) {
+    if (d_type(t) == T_BYTES) mp->nodes[mp->len++].data = *d_bytes(t);
+  }
+  return 1;
+}
+
+/** removes duplicate nodes, hashes the new ones and sorts all by hash. */
+static void multiproof_prepare(trie_multiproof_t* mp) {
+  if (mp->hashed == mp->len) return;
+  trie_proof_node_t* nodes = mp->nodes + mp->hashed;
+  int                n     = mp->len - mp->hashed, l = 0;
+  bytes_t*           data[8];
+  uint8_t            hashes[32 * 8];
+
+  // identical nodes have identical hashes, so we only keep one of them.
+  qsort(nodes, n, sizeof(trie_proof_node_t), cmp_node_data);
+  for (int i = 0; i < n; i++) {
+    if (!l || cmp_node_data(nodes + l - 1, nodes + i)) nodes[l++] = nodes[i];
+  }
+
+  // hash up to 8 nodes at once
+  for (int i = 0; i < l; i += 8) {
+    int m = min(l - i, 8);
+    for (int j = 0; j < m; j++) data[j] = &nodes[i + j].data;
+    hash_nodes(data, m, hashes, mp->cache, mp->cache_size);
+    for (int j = 0; j < m; j++) memcpy(nodes[i + j].hash, hashes + j * 32, 32);
+  }
+
+  // sort all by hash and remove nodes we already had before
+  mp->len = mp->hashed + l;
+  qsort(mp->nodes, mp->len, sizeof(trie_proof_node_t), cmp_node_hash);
+  for (int i = l = 0; i < mp->len; i++) {
+    if (!l || cmp_node_hash(mp->nodes + l - 1, mp->nodes + i)) mp->nodes[l++] = mp->nodes[i];
+  }
+  mp->len = mp->hashed = l;
+}
+
+/** finds the node with the given hash. */
+static bytes_t* multiproof_find(trie_multiproof_t* mp, uint8_t* hash) {
+  int lo = 0, hi = mp->len - 1;
+  while (lo <= hi) {
+    int m = (lo + hi) >> 1, c = memcmp(mp->nodes[m].hash, hash, 32);
+    if (!c) return &mp->nodes[m].data;
+    if (c < 0)
+      lo = m + 1;
+    else
+      hi = m - 1;
+  }
+  return NULL;
+}
+
+int trie_multiproof_verify(trie_multiproof_t* mp, bytes_t* rootHash, bytes_t* path, bytes_t* expectedValue) {
+  nibbles_t key        = {.data = path->data, .pos = 0, .len = path->len * 2}, saved_key;
+  bytes_t   last_value = {.data = NULL, .len = 0}, saved_value, *node;
+  uint8_t   expected_hash[32], saved_hash[32];
+  size_t    depth = 0, saved_depth;
+  int       res   = 0;
+
+  multiproof_prepare(mp);
+  memcpy(expected_hash, rootHash->data, 32);
+  if (!(node = multiproof_find(mp, expected_hash))) return 0;
+
+  while (node) {
+    // we only know a node is the last one, if the proof does not contain the next, so we check it as inner node first.
+    saved_key   = key;
+    saved_value = last_value;
+    saved_depth = depth;
+    memcpy(saved_hash, expected_hash, 32);
+    bytes_t* next = check_node(node, &key, expectedValue, 0, &last_value, expected_hash, &depth) ? multiproof_find(mp, expected_hash) : NULL;
+    if (!next) {
+      key        = saved_key;
+      last_value = saved_value;
+      depth      = saved_depth;
+      memcpy(expected_hash, saved_hash, 32);
+      res = check_node(node, &key, expectedValue, 1, &last_value, expected_hash, &depth);
+    }
+    node = next;
+  }
+
+  if (res && expectedValue != NULL) {
+    if (expectedValue->data == NULL) {
+      if (last_value.data) *expectedValue = last_value;
+    } else if (last_value.data == NULL || !b_cmp(expectedValue, &last_value))
+      res = 0;
+  }
+  return res;
+}
+
+void trie_multiproof_free(trie_multiproof_t* mp) {
+  if (mp->nodes) _free(mp->nodes);
+  mp->nodes = NULL;
+  mp->len = mp->size = mp->hashed = 0;
+}
+
 void trie_free_proof(bytes_t** proof) {
   for (bytes_t** p = proof; *p; p += 1) b_free(*p);
   _free(proof);
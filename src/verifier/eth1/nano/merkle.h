@@ -38,6 +38,7 @@
  * */
 
 #include "../../../core/util/bytes.h"
+#include "../../../core/util/data.h"
 
 #ifndef MERKLE_H
 #define MERKLE_H
@@ -61,6 +62,64 @@
  */
 int trie_verify_proof(bytes_t* rootHash, bytes_t* path, bytes_t** proof, bytes_t* expectedValue);
 
+struct in3_cached_node;
+
+/**
+ * verifies a merkle proof given as json-array of the nodes.
+ * 
+ * This works like `trie_verify_proof`, but reads the nodes directly from the token without creating a vector first.
+ * returns 0 if the proof is NULL or not an array.
+ */
+int trie_verify_proof_token(bytes_t* rootHash, bytes_t* path, d_token_t* proof, bytes_t* expectedValue);
+
+/**
+ * verifies a merkle proof like `trie_verify_proof_token`, but looks up the hashes of the nodes in the cache first.
+ * 
+ * The cache is indexed by the content of a node and holds a copy of it, so it stays valid for any root.
+ * Nodes not found will be hashed and added. If the cache is NULL, all nodes are hashed.
+ */
+int trie_verify_proof_cached(bytes_t* rootHash, bytes_t* path, d_token_t* proof, bytes_t* expectedValue, struct in3_cached_node* cache, int cache_size);
+
+/** a proof node of a multiproof. */
+typedef struct {
+  bytes32_t hash; /**< the hash of the node */
+  bytes_t   data; /**< the rlp-encoded node, pointing into the json-proof */
+} trie_proof_node_t;
+
+/**
+ * a set of proof nodes of one trie, which can be used to verify many keys at once.
+ * 
+ * Proofs for neighbouring keys share most of their nodes, so each unique node is only hashed and stored once.
+ * The struct must be initialized with zeros and freed with `trie_multiproof_free`.
+ */
+typedef struct {
+  trie_proof_node_t*      nodes;      /**< the unique nodes sorted by hash */
+  int                     len;        /**< number of nodes */
+  int                     size;       /**< number of allocated nodes */
+  int                     hashed;     /**< number of nodes already hashed and sorted */
+  struct in3_cached_node* cache;      /**< optional cache for the hashes of the nodes */
+  int                     cache_size; /**< number of entries in the cache */
+} trie_multiproof_t;
+
+/**
+ * adds all nodes of a json-array of proof nodes.
+ * 
+ * The nodes are not copied, so the token must live as long as the multiproof. returns 0 if the proof is not an array.
+ */
+int trie_multiproof_add(trie_multiproof_t* mp, d_token_t* proof);
+
+/**
+ * verifies the value of one path with all nodes added so far.
+ * 
+ * The expectedValue works like in `trie_verify_proof`.
+ */
+int trie_multiproof_verify(trie_multiproof_t* mp, bytes_t* rootHash, bytes_t* path, bytes_t* expectedValue);
+
+/**
+ * frees the nodes of the multiproof.
+ */
+void trie_multiproof_free(trie_multiproof_t* mp);
+
 /**
  * helper function split a path into 4-bit nibbles.
  * 
@@ -209,7 +209,8 @@ static in3_ret_t verify_nodelist_data(in3_vctx_t* vc, const uint32_t node_limit,
 
 in3_ret_t eth_verify_in3_nodelist(in3_vctx_t* vc, uint32_t node_limit, bytes_t* seed, d_token_t* required_addresses) {
   uint8_t         hash[32], val[36];
-  bytes_t         root, **proof, *account_raw, path = {.data = hash, .len = 32};
+  bytes_t         root, *account_raw, path = {.data = hash, .len = 32};
+  d_token_t*      proof;
   d_token_t *     server_list = d_get(vc->result, K_NODES), *storage_proof, *t;
   bytes_builder_t bb          = {.bsize = 36, .b = {.data = val, .len = 0}};
 
@@ -236,16 +237,14 @@ in3_ret_t eth_verify_in3_nodelist(in3_vctx_t* vc, uint32_t node_limit, bytes_t*
   if (rlp_decode_in_list(blockHeader, BLOCKHEADER_STATE_ROOT, &root) != 1) return vc_err(vc, "no state root in the header");
   if (!b_cmp(d_get_byteskl(account, K_ADDRESS, 20), registry_contract)) return vc_err(vc, "wrong address in the account proof");
 
-  proof = d_create_bytes_vec(d_get(account, K_ACCOUNT_PROOF));
+  proof = d_get(account, K_ACCOUNT_PROOF);
   if (!proof) return vc_err(vc, "no merkle proof for the account");
   account_raw = serialize_account(account);
   sha3_to(registry_contract, hash);
-  if (!trie_verify_proof(&root, &path, proof, account_raw)) {
-    _free(proof);
+  if (!trie_verify_proof_token(&root, &path, proof, account_raw)) {
     b_free(account_raw);
     return vc_err(vc, "invalid account proof");
   }
-  _free(proof);
   b_free(account_raw);
 
   // now verify storage proofs
@@ -260,7 +259,7 @@ in3_ret_t eth_verify_in3_nodelist(in3_vctx_t* vc, uint32_t node_limit, bytes_t*
     d_bytes_to(d_get(it.token, K_KEY), hash, 32);
     sha3_to(&path, hash);
 
-    proof = d_create_bytes_vec(d_get(it.token, K_PROOF));
+    proof = d_get(it.token, K_PROOF);
     if (!proof) return vc_err(vc, "no merkle proof for the storage");
 
     // rlp encode the value.
@@ -268,11 +267,8 @@ in3_ret_t eth_verify_in3_nodelist(in3_vctx_t* vc, uint32_t node_limit, bytes_t*
       rlp_encode_to_item(&bb);
 
     // verify merkle proof
-    if (!trie_verify_proof(&root, &path, proof, bb.b.len ? &bb.b : NULL)) {
-      _free(proof);
+    if (!trie_verify_proof_token(&root, &path, proof, bb.b.len ? &bb.b : NULL))
       return vc_err(vc, "invalid storage proof");
-    }
-    _free(proof);
   }
 
   // now verify the nodelist
@@ -301,7 +297,8 @@ static in3_ret_t verify_whitelist_data(in3_vctx_t* vc, d_token_t* server_list, d
 
 in3_ret_t eth_verify_in3_whitelist(in3_vctx_t* vc) {
   uint8_t         hash[32], val[36];
-  bytes_t         root, **proof, *account_raw, path = {.data = hash, .len = 32};
+  bytes_t         root, *account_raw, path = {.data = hash, .len = 32};
+  d_token_t*      proof;
   d_token_t *     server_list = d_get(vc->result, K_NODES), *storage_proof, *t;
   bytes_builder_t bb          = {.bsize = 36, .b = {.data = val, .len = 0}};
 
@@ -331,17 +328,15 @@ in3_ret_t eth_verify_in3_whitelist(in3_vctx_t* vc) {
   if (rlp_decode_in_list(blockHeader, BLOCKHEADER_STATE_ROOT, &root) != 1) return vc_err(vc, "no state root in the header");
   if (!b_cmp(d_get_byteskl(account, K_ADDRESS, 20), wl_contract)) return vc_err(vc, "wrong address in the account proof");
 
-  proof = d_create_bytes_vec(d_get(account, K_ACCOUNT_PROOF));
+  proof = d_get(account, K_ACCOUNT_PROOF);
   if (!proof) return vc_err(vc, "no merkle proof for the account");
 
   account_raw = serialize_account(account);
   sha3_to(wl_contract, hash);
-  if (!trie_verify_proof(&root, &path, proof, account_raw)) {
-    _free(proof);
+  if (!trie_verify_proof_token(&root, &path, proof, account_raw)) {
     b_free(account_raw);
     return vc_err(vc, "invalid account proof");
   }
-  _free(proof);
   b_free(account_raw);
 
   // now verify storage proofs
@@ -356,7 +351,7 @@ in3_ret_t eth_verify_in3_whitelist(in3_vctx_t* vc) {
     d_bytes_to(d_get(it.token, K_KEY), hash, 32);
     sha3_to(&path, hash);
 
-    proof = d_create_bytes_vec(d_get(it.token, K_PROOF));
+    proof = d_get(it.token, K_PROOF);
     if (!proof) return vc_err(vc, "no merkle proof for the storage");
 
     // rlp encode the value.
@@ -364,11 +359,8 @@ in3_ret_t eth_verify_in3_whitelist(in3_vctx_t* vc) {
       rlp_encode_to_item(&bb);
 
     // verify merkle proof
-    if (!trie_verify_proof(&root, &path, proof, bb.b.len ? &bb.b : NULL)) {
-      _free(proof);
+    if (!trie_verify_proof_token(&root, &path, proof, bb.b.len ? &bb.b : NULL))
       return vc_err(vc, "invalid storage proof");
-    }
-    _free(proof);
   }
 
   return verify_whitelist_data(vc, server_list, storage_proof);
@@ -91,6 +91,56 @@ int rlp_decode(bytes_t* b, int index, bytes_t* dst) {
     return 0; /* data OK, but item at index doesn't exist */
 }
 
+int rlp_index(bytes_t* b, rlp_index_t* idx) {
+  size_t  p, i, l, n, h;
+  uint8_t c;
+  int     t;
+  idx->list  = *b;
+  idx->error = 0;
+  for (p = 0, i = 0; i < b->len; i += h + l, p++) {
+    c = b->data[i];
+    if (c < 0x80) { // single byte-item
+      h = 0, l = 1, t = 1;
+    } else if (c < 0xb8) { // 0-55 length-item
+      h = 1, l = c - 0x80, t = 1;
+    } else if (c < 0xc0) { // very long item
+      h = c - 0xb6, l = 0, t = 1;
+    } else if (c < 0xf8) { // 0-55 byte long list
+      h = 1, l = c - 0xc0, t = 2;
+    } else { // very long list
+      h = c - 0xf6, l = 0, t = 2;
+    }
+
+    // the length of the length must fit into the remaining bytes and into a size_t
+    if (h > b->len - i || h > sizeof(size_t) + 1) {
+      idx->error = -1;
+      break;
+    }
+    for (n = 1; n < h; n++) l = (l << 8) | b->data[i + n];
+    if (l > b->len - i - h) {
+      idx->error = -1;
+      break;
+    }
+    if (p < RLP_INDEX_MAX) {
+      idx->items[p] = bytes(b->data + i + h, l);
+      idx->types[p] = t;
+    }
+  }
+  idx->len = p;
+  return idx->error ? -3 : (int) p;
+}
+
+int rlp_index_list(bytes_t* b, rlp_index_t* idx) {
+  bytes_t list;
+  if (rlp_decode(b, 0, &list) != 2) {
+    idx->len   = 0;
+    idx->error = 0;
+    idx->list  = bytes(NULL, 0);
+    return 0;
+  }
+  return rlp_index(&list, idx);
+}
+
 int rlp_decode_in_list(bytes_t* b, int index, bytes_t* dst) {
   if (rlp_decode(b, 0, dst) != 2) return 0;
   return rlp_decode(dst, index, dst);
@@ -101,6 +101,68 @@ int rlp_decode_in_list(bytes_t* b, int index, bytes_t* dst);
  */
 int rlp_decode_len(bytes_t* b);
 
+#ifndef RLP_INDEX_MAX
+#define RLP_INDEX_MAX 17 /**< max number of items stored in a rlp_index_t, which fits branch nodes and blockheaders */
+#endif
+
+/**
+ * the positions of all items of a list, found by decoding it once.
+ * 
+ * Decoding many items of the same list with `rlp_decode` rescans the list for each item.
+ * Since the struct is small enough to be put on the stack, there is nothing to free.
+ * 
+ * ```c
+ * rlp_index_t header;
+ * if (rlp_index_list(raw_header, &header) <= BLOCKHEADER_NUMBER) return -1;
+ * 
+ * bytes_t number, receipt_root;
+ * rlp_index_get(&header, BLOCKHEADER_NUMBER, &number);
+ * rlp_index_get(&header, BLOCKHEADER_RECEIPT_ROOT, &receipt_root);
+ * ```
+ */
+typedef struct {
+  bytes_t list;                 /**< the decoded data */
+  int     len;                  /**< number of valid items found */
+  int     error;                /**< if the data ended within the item at len, this is -1 */
+  bytes_t items[RLP_INDEX_MAX]; /**< the first items */
+  int8_t  types[RLP_INDEX_MAX]; /**< the type of each item (1 : item, 2 : list) */
+} rlp_index_t;
+
+/**
+ * decodes all items of the given bytes and stores their position in the index.
+ * 
+ * \param b the ptr to the incoming bytes to decode.
+ * \param idx the index to fill.
+ * 
+ * \return the number of elements found like `rlp_decode_len` or a negative value if the data are invalid.
+ */
+int rlp_index(bytes_t* b, rlp_index_t* idx);
+
+/**
+ * expects a list as first item (like a blockheader) and decodes all items within this list.
+ * 
+ * \return the number of elements found or 0 if the first item is no list.
+ */
+int rlp_index_list(bytes_t* b, rlp_index_t* idx);
+
+/**
+ * returns the item with the given index like `rlp_decode`, but without decoding the list again.
+ * If the index<0 the number of elements is returned.
+ * 
+ * \return
+ * - 0 : means item out of range
+ * - 1 : item found
+ * - 2 : list found
+ * - -1 : invalid data
+ */
+static inline int rlp_index_get(rlp_index_t* idx, int index, bytes_t* dst) {
+  if (index >= RLP_INDEX_MAX) return rlp_decode(&idx->list, index, dst);
+  if (index < 0) return idx->error ? -3 : idx->len;
+  if (index >= idx->len) return idx->error;
+  *dst = idx->items[index];
+  return idx->types[index];
+}
+
 /**
  * encode a item as single string and add it to the bytes_builder.
  * 
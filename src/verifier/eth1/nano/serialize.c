@@ -105,138 +105,337 @@ int rlp_add(bytes_builder_t* rlp, d_token_t* t, int ml) {
 #define HASH 32
 #define BLOOM 256
 
-bytes_t* serialize_account(d_token_t* a) {
-  bytes_builder_t* rlp = bb_new();
+#define OP_ITEM 0 /**< a value, which will be encoded as rlp-item */
+#define OP_RAW 1  /**< already rlp-encoded data, which is copied as is */
+#define OP_LIST 2 /**< a list containing the next `count` ops */
+
+/** a resolved value or the start of a list. */
+typedef struct {
+  bytes_t  data;   /**< the value without leading zeros. if data.data is NULL the value is stored in tmp */
+  uint32_t fill;   /**< number of zeros to write in front of the value */
+  uint32_t count;  /**< number of ops within the list */
+  uint32_t len;    /**< the length of the payload of a list */
+  uint8_t  type;   /**< one of OP_ITEM, OP_RAW or OP_LIST */
+  uint8_t  tmp[4]; /**< storage for integer values */
+} rlp_op_t;
+
+/**
+ * an rlp-encoder working in two phases.
+ *
+ * First all values are resolved from the tokens into a flat list of ops, so the tokens are only read once.
+ * The sizing pass then calculates the exact length of all lists, which allows the write pass
+ * to write directly into one buffer, without moving data to prepend the length of a list.
+ */
+typedef struct {
+  rlp_op_t* ops;       /**< the ops (points to stack until it grows) */
+  uint32_t  len;       /**< number of ops */
+  uint32_t  size;      /**< capacity of ops */
+  rlp_op_t  stack[24]; /**< the initial storage, which is enough for all lists except receipts with logs */
+} rlp_encoder_t;
+
+static void enc_init(rlp_encoder_t* e) {
+  e->ops  = e->stack;
+  e->len  = 0;
+  e->size = sizeof(e->stack) / sizeof(rlp_op_t);
+}
+
+static void enc_free(rlp_encoder_t* e) {
+  if (e->ops != e->stack) _free(e->ops);
+}
+
+static rlp_op_t* enc_op(rlp_encoder_t* e, uint8_t type) {
+  if (e->len == e->size) {
+    rlp_op_t* ops = _malloc(e->size * 2 * sizeof(rlp_op_t));
+    memcpy(ops, e->ops, e->len * sizeof(rlp_op_t));
+    enc_free(e);
+    e->ops = ops;
+    e->size *= 2;
+  }
+  rlp_op_t* op = e->ops + e->len++;
+  op->type     = type;
+  op->fill     = 0;
+  return op;
+}
+
+/** adds the bytes as item like `rlp_add_bytes` does. */
+static void enc_bytes(rlp_encoder_t* e, bytes_t b, int ml) {
+  // if this is a unit we need to make sure we remove the leading zeros.
+  while (ml == 0 && b.len > 1 && *b.data == 0) {
+    b.len--;
+    b.data++;
+  }
+
+  if (ml == 0 && b.len == 1 && b.data[0] == 0) b.len = 0;
+  if (ml < 0) ml = b.len ? -ml : 0;
+
+  rlp_op_t* op = enc_op(e, OP_ITEM);
+  op->data     = b;
+  // we need to fill left
+  if ((uint32_t) ml > b.len) op->fill = ml - b.len;
+}
+
+/** adds the value of the token like `rlp_add` does. */
+static void enc_token(rlp_encoder_t* e, d_token_t* t, int ml) {
+  uint8_t tmp[4];
+  switch (d_type(t)) {
+    case T_INTEGER: {
+      tmp[3]       = t->len & 0xFF;
+      tmp[2]       = (t->len & 0xFF00) >> 8;
+      tmp[1]       = (t->len & 0xFF0000) >> 16;
+      tmp[0]       = (t->len & 0xF000000) >> 24;
+      uint32_t l   = tmp[0] ? 4 : (tmp[1] ? 3 : (tmp[2] ? 2 : (tmp[3] ? 1 : 0)));
+      enc_bytes(e, bytes(tmp + 4 - l, l), ml);
+      // the ops may be moved, so the integer is copied and found through data.data == NULL
+      rlp_op_t* op = e->ops + e->len - 1;
+      memcpy(op->tmp + 4 - op->data.len, op->data.data, op->data.len);
+      op->data.data = NULL;
+      break;
+    }
+    case T_BYTES:
+      enc_bytes(e, bytes(t->data, t->len), ml);
+      break;
+    case T_NULL:
+      enc_bytes(e, bytes(tmp, 0), ml);
+      break;
+    default:
+      break;
+  }
+}
+
+static void enc_raw(rlp_encoder_t* e, bytes_t b) {
+  enc_op(e, OP_RAW)->data = b;
+}
+
+/** starts a list and returns its index, which must be passed to enc_list_end. */
+static uint32_t enc_list(rlp_encoder_t* e) {
+  enc_op(e, OP_LIST);
+  return e->len - 1;
+}
+
+static void enc_list_end(rlp_encoder_t* e, uint32_t index) {
+  e->ops[index].count = e->len - index - 1;
+}
+
+static inline const uint8_t* op_data(rlp_op_t* op) {
+  return op->data.data ? op->data.data : op->tmp + 4 - op->data.len;
+}
+
+static inline uint32_t length_size(uint32_t len) {
+  return len < 56 ? 1 : (len < 0x100 ? 2 : (len < 0x10000 ? 3 : (len < 0x1000000 ? 4 : 5)));
+}
+
+/** the sizing pass: calculates the payload of all lists and returns the encoded length of n ops. */
+static uint32_t enc_size(rlp_op_t* ops, uint32_t n) {
+  uint32_t len = 0, l;
+  for (uint32_t i = 0; i < n; i++) {
+    rlp_op_t* op = ops + i;
+    switch (op->type) {
+      case OP_LIST:
+        op->len = enc_size(op + 1, op->count);
+        len += length_size(op->len) + op->len;
+        i += op->count;
+        break;
+      case OP_RAW:
+        len += op->data.len;
+        break;
+      default:
+        l = op->fill + op->data.len;
+        len += (l == 1 && (op->fill || *op_data(op) < 0x80)) ? 1 : length_size(l) + l;
+    }
+  }
+  return len;
+}
+
+static uint8_t* write_length(uint8_t* dst, uint32_t len, uint8_t offset) {
+  if (len < 56) {
+    *(dst++) = offset + len;
+    return dst;
+  }
+  int n    = length_size(len) - 1;
+  *(dst++) = offset + 55 + n;
+  for (; n; n--) *(dst++) = len >> (8 * (n - 1));
+  return dst;
+}
+
+/** the write pass: writes all ops and returns the end of the written data. */
+static uint8_t* enc_write(rlp_op_t* ops, uint32_t n, uint8_t* dst) {
+  for (rlp_op_t* op = ops; op < ops + n; op++) {
+    if (op->type == OP_LIST)
+      dst = write_length(dst, op->len, 0xc0);
+    else if (op->type == OP_RAW) {
+      memcpy(dst, op->data.data, op->data.len);
+      dst += op->data.len;
+    } else {
+      uint32_t l = op->fill + op->data.len;
+      if (l == 1 && (op->fill || *op_data(op) < 0x80)) {
+        *(dst++) = op->fill ? 0 : *op_data(op);
+        continue;
+      }
+      dst = write_length(dst, l, 0x80);
+      memset(dst, 0, op->fill);
+      memcpy(dst + op->fill, op_data(op), op->data.len);
+      dst += l;
+    }
+  }
+  return dst;
+}
+
+/** finishes the encoding with exactly one allocation and frees the encoder. */
+static bytes_t* enc_finish(rlp_encoder_t* e) {
+  bytes_t* res = _malloc(sizeof(bytes_t));
+  res->len     = enc_size(e->ops, e->len);
+  res->data    = _malloc(res->len);
+  enc_write(e->ops, e->len, res->data);
+  enc_free(e);
+  return res;
+}
+
+static void account_ops(rlp_encoder_t* e, d_token_t* a) {
+  uint32_t list = enc_list(e);
   // clang-format off
-  rlp_add(rlp, d_get(a,K_NONCE)              , UINT);
-  rlp_add(rlp, d_get(a,K_BALANCE)            , UINT);
-  rlp_add(rlp, d_getl(a,K_STORAGE_HASH, 32)  , HASH);
-  rlp_add(rlp, d_getl(a,K_CODE_HASH, 32)     , HASH);
+  enc_token(e, d_get(a,K_NONCE)              , UINT);
+  enc_token(e, d_get(a,K_BALANCE)            , UINT);
+  enc_token(e, d_getl(a,K_STORAGE_HASH, 32)  , HASH);
+  enc_token(e, d_getl(a,K_CODE_HASH, 32)     , HASH);
   // clang-format on
-  return bb_move_to_bytes(rlp_encode_to_list(rlp));
+  enc_list_end(e, list);
 }
 
-bytes_t* serialize_tx(d_token_t* tx) {
-  bytes_builder_t* rlp = bb_new();
+bytes_t* serialize_account(d_token_t* a) {
+  rlp_encoder_t e;
+  enc_init(&e);
+  account_ops(&e, a);
+  return enc_finish(&e);
+}
+
+static void tx_ops(rlp_encoder_t* e, d_token_t* tx) {
+  uint32_t list = enc_list(e);
   // clang-format off
-  rlp_add(rlp, d_get(tx,K_NONCE)             , UINT);
-  rlp_add(rlp, d_get(tx,K_GAS_PRICE)         , UINT);
-  rlp_add(rlp, d_get_or(tx,K_GAS,K_GAS_LIMIT), UINT);
-  rlp_add(rlp, d_getl(tx,K_TO, 20)           , ADDRESS);
-  rlp_add(rlp, d_get(tx,K_VALUE)             , UINT);
-  rlp_add(rlp, d_get_or(tx,K_INPUT,K_DATA)   , BYTES);
-  rlp_add(rlp, d_get(tx,K_V)                 , UINT);
-  rlp_add(rlp, d_getl(tx,K_R, 32)            , UINT);
-  rlp_add(rlp, d_getl(tx,K_S, 32)            , UINT);
+  enc_token(e, d_get(tx,K_NONCE)             , UINT);
+  enc_token(e, d_get(tx,K_GAS_PRICE)         , UINT);
+  enc_token(e, d_get_or(tx,K_GAS,K_GAS_LIMIT), UINT);
+  enc_token(e, d_getl(tx,K_TO, 20)           , ADDRESS);
+  enc_token(e, d_get(tx,K_VALUE)             , UINT);
+  enc_token(e, d_get_or(tx,K_INPUT,K_DATA)   , BYTES);
+  enc_token(e, d_get(tx,K_V)                 , UINT);
+  enc_token(e, d_getl(tx,K_R, 32)            , UINT);
+  enc_token(e, d_getl(tx,K_S, 32)            , UINT);
   // clang-format on
-  return bb_move_to_bytes(rlp_encode_to_list(rlp));
+  enc_list_end(e, list);
+}
+
+bytes_t* serialize_tx(d_token_t* tx) {
+  rlp_encoder_t e;
+  enc_init(&e);
+  tx_ops(&e, tx);
+  return enc_finish(&e);
+}
+
+uint32_t serialize_tx_to(d_token_t* tx, bytes_builder_t* bb) {
+  rlp_encoder_t e;
+  enc_init(&e);
+  tx_ops(&e, tx);
+  uint32_t len = enc_size(e.ops, e.len);
+  if (bb_check_size(bb, len) == 0) {
+    enc_write(e.ops, e.len, bb->b.data + bb->b.len);
+    bb->b.len += len;
+  } else
+    len = 0;
+  enc_free(&e);
+  return len;
 }
 
 bytes_t* serialize_tx_raw(bytes_t nonce, bytes_t gas_price, bytes_t gas_limit, bytes_t to, bytes_t value, bytes_t data, uint64_t v, bytes_t r, bytes_t s) {
-  bytes_builder_t* rlp = bb_new();
+  rlp_encoder_t e;
+  uint8_t       tmp[8], *p = tmp, l = 8;
+  enc_init(&e);
+  uint32_t list = enc_list(&e);
   // clang-format off
-  rlp_add_bytes(rlp, nonce             , UINT);
-  rlp_add_bytes(rlp, gas_price         , UINT);
-  rlp_add_bytes(rlp, gas_limit         , UINT);
-  rlp_add_bytes(rlp, to                , ADDRESS);
-  rlp_add_bytes(rlp, value             , UINT);
-  rlp_add_bytes(rlp, data              , BYTES);
+  enc_bytes(&e, nonce             , UINT);
+  enc_bytes(&e, gas_price         , UINT);
+  enc_bytes(&e, gas_limit         , UINT);
+  enc_bytes(&e, to                , ADDRESS);
+  enc_bytes(&e, value             , UINT);
+  enc_bytes(&e, data              , BYTES);
   if (v) {
-     uint8_t tmp[8],*p=tmp,l=8;
-     long_to_bytes(v,tmp);
-     optimize_len(p,l);
-    rlp_add_bytes(rlp, bytes(p,l)        , UINT);
-    rlp_add_bytes(rlp, r                 , UINT);
-    rlp_add_bytes(rlp, s                 , UINT);
+    long_to_bytes(v, tmp);
+    optimize_len(p, l);
+    enc_bytes(&e, bytes(p, l)     , UINT);
+    enc_bytes(&e, r               , UINT);
+    enc_bytes(&e, s               , UINT);
   }
-
   // clang-format on
-  return bb_move_to_bytes(rlp_encode_to_list(rlp));
+  enc_list_end(&e, list);
+  return enc_finish(&e);
 }
 
 bytes_t* serialize_block_header(d_token_t* block) {
-  bytes_builder_t* rlp = bb_new();
-  d_token_t *      sealed_fields, *t;
-  int              i;
+  d_token_t *   sealed_fields, *t;
+  int           i;
+  rlp_encoder_t e;
+  enc_init(&e);
+  uint32_t list = enc_list(&e);
   // clang-format off
-  rlp_add(rlp, d_getl(block,K_PARENT_HASH, 32)      , HASH);
-  rlp_add(rlp, d_get(block,K_SHA3_UNCLES)           , HASH);
-  
+  enc_token(&e, d_getl(block,K_PARENT_HASH, 32)      , HASH);
+  enc_token(&e, d_get(block,K_SHA3_UNCLES)           , HASH);
+
   if ((t = d_getl(block, K_MINER, 20)) || (t = d_getl(block, K_COINBASE, 20)))
-    rlp_add(rlp, t                                  , ADDRESS);  
+    enc_token(&e, t                                  , ADDRESS);
 
-  rlp_add(rlp, d_getl(block,K_STATE_ROOT, 32)       , HASH);
-  rlp_add(rlp, d_getl(block,K_TRANSACTIONS_ROOT, 32), HASH);
+  enc_token(&e, d_getl(block,K_STATE_ROOT, 32)       , HASH);
+  enc_token(&e, d_getl(block,K_TRANSACTIONS_ROOT, 32), HASH);
 
   if ((t = d_getl(block, K_RECEIPT_ROOT, 32)) || (t = d_getl(block, K_RECEIPTS_ROOT, 32)))
-    rlp_add(rlp, t                                  , HASH);
+    enc_token(&e, t                                  , HASH);
 
-  rlp_add(rlp, d_getl(block,K_LOGS_BLOOM, 256)      , BLOOM);
-  rlp_add(rlp, d_get(block,K_DIFFICULTY)            , UINT);
-  rlp_add(rlp, d_get(block,K_NUMBER)                , UINT);
-  rlp_add(rlp, d_get(block,K_GAS_LIMIT)             , UINT);
-  rlp_add(rlp, d_get(block,K_GAS_USED)              , UINT);
-  rlp_add(rlp, d_get(block,K_TIMESTAMP)             , UINT);
-  rlp_add(rlp, d_get(block,K_EXTRA_DATA)            , BYTES);
+  enc_token(&e, d_getl(block,K_LOGS_BLOOM, 256)      , BLOOM);
+  enc_token(&e, d_get(block,K_DIFFICULTY)            , UINT);
+  enc_token(&e, d_get(block,K_NUMBER)                , UINT);
+  enc_token(&e, d_get(block,K_GAS_LIMIT)             , UINT);
+  enc_token(&e, d_get(block,K_GAS_USED)              , UINT);
+  enc_token(&e, d_get(block,K_TIMESTAMP)             , UINT);
+  enc_token(&e, d_get(block,K_EXTRA_DATA)            , BYTES);
 
   // if there are sealed field we take them as raw already rlp-encoded data and add them.
   if ((sealed_fields=d_get(block,K_SEAL_FIELDS))) {
     for (i=0,t=sealed_fields+1;i<d_len(sealed_fields);i++,t=d_next(t))
-       bb_write_raw_bytes(rlp,t->data, t->len);   // we need to check if the nodes is within the bounds!
+      enc_raw(&e, bytes(t->data, t->len));   // we need to check if the nodes is within the bounds!
   }
   else {
     // good old proof of work...
-    rlp_add(rlp, d_getl(block,K_MIX_HASH, 32)                     , HASH);
-    rlp_add(rlp, d_get(block,K_NONCE)                        , BYTES);
+    enc_token(&e, d_getl(block,K_MIX_HASH, 32)       , HASH);
+    enc_token(&e, d_get(block,K_NONCE)               , BYTES);
   }
   // clang-format on
-  return bb_move_to_bytes(rlp_encode_to_list(rlp));
+  enc_list_end(&e, list);
+  return enc_finish(&e);
 }
 
 bytes_t* serialize_tx_receipt(d_token_t* receipt) {
-  bytes_builder_t* bb          = bb_new();
-  bytes_builder_t* rlp         = bb_new();
-  bytes_builder_t* rlp_log     = bb_new();
-  bytes_builder_t* rlp_topics  = bb_new();
-  bytes_builder_t* rlp_loglist = bb_new();
-  d_token_t *      t, *logs, *l, *topics;
-  int              i, j;
-
+  d_token_t*    t;
+  rlp_encoder_t e;
+  enc_init(&e);
+  uint32_t list = enc_list(&e);
   // clang-format off
   // we only add it if it exists since this EIP came later.
   if ((t = d_get(receipt, K_STATUS)) || (t = d_getl(receipt, K_ROOT, 32)))
-    rlp_add(rlp, t                                 , UINT);
+    enc_token(&e, t                                 , UINT);
 
-  rlp_add(rlp, d_get(receipt,K_CUMULATIVE_GAS_USED), UINT);
-  rlp_add(rlp, d_getl(receipt,K_LOGS_BLOOM, 256)   , BLOOM);
-
-  if ((logs =  d_get(receipt,K_LOGS))) {
-    // iterate over log-entries
-    for (i = 0,l=logs+1; i < d_len(logs); i++, l=d_next(l)) {
-      bb_clear(rlp_log);
-
-      rlp_add(rlp_log, d_getl(l, K_ADDRESS, 20)    , ADDRESS);
-
-      topics = d_get(l,K_TOPICS);
-      bb_clear(rlp_topics);
-      for (j = 0, t = topics+1; j < d_len(topics); j++, t=d_next(t))
-         rlp_add( rlp_topics, t, HASH);
-
-      rlp_encode_list(rlp_log, &rlp_topics->b);
-
-      rlp_add(rlp_log, d_get(l,K_DATA)             ,BYTES);
-      rlp_encode_list(rlp_loglist, &rlp_log->b);
-    }
+  enc_token(&e, d_get(receipt,K_CUMULATIVE_GAS_USED), UINT);
+  enc_token(&e, d_getl(receipt,K_LOGS_BLOOM, 256)   , BLOOM);
+  // clang-format on
 
+  uint32_t logs = enc_list(&e);
+  for (d_iterator_t it = d_iter(d_get(receipt, K_LOGS)); it.left; d_iter_next(&it)) {
+    uint32_t log = enc_list(&e);
+    enc_token(&e, d_getl(it.token, K_ADDRESS, 20), ADDRESS);
+    uint32_t topics = enc_list(&e);
+    for (d_iterator_t iter = d_iter(d_get(it.token, K_TOPICS)); iter.left; d_iter_next(&iter)) enc_token(&e, iter.token, HASH);
+    enc_list_end(&e, topics);
+    enc_token(&e, d_get(it.token, K_DATA), BYTES);
+    enc_list_end(&e, log);
   }
-
-  // clang-format on
-  rlp_encode_list(rlp, &rlp_loglist->b);
-  rlp_encode_to_list(rlp);
-
-  bb_free(bb);
-  bb_free(rlp_log);
-  bb_free(rlp_topics);
-  bb_free(rlp_loglist);
-  return bb_move_to_bytes(rlp);
-}
\ No newline at end of file
+  enc_list_end(&e, logs);
+  enc_list_end(&e, list);
+  return enc_finish(&e);
+}
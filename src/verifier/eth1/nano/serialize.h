@@ -60,6 +60,18 @@ bytes_t* serialize_tx_receipt(d_token_t* receipt);
 
 bytes_t* serialize_tx(d_token_t* tx);
 
+/**
+ * appends the rlp-encoded transaction to the builder.
+ * 
+ * The exact length is calculated before writing, so the builder grows at most once and many transactions can share one buffer.
+ * 
+ * \param tx the json-onject as descibed in [eth_getTransactionByHash](https://github.com/ethereum/wiki/wiki/JSON-RPC#eth_gettransactionbyhash)
+ * \param bb the builder to write to.
+ * 
+ * \return the length of the encoded transaction, which is written at the end of the builder or 0 if the builder could not grow.
+ */
+uint32_t serialize_tx_to(d_token_t* tx, bytes_builder_t* bb);
+
 /**
  * creates rlp-encoded raw bytes for a transaction from direct values.
  * 
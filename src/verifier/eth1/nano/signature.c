@@ -36,58 +36,87 @@
 #include "../../../core/client/keys.h"
 #include "../../../core/util/data.h"
 #include "../../../core/util/mem.h"
-#include "../../../third-party/crypto/ecdsa.h"
-#include "../../../third-party/crypto/secp256k1.h"
+#include "../../../verifier/eth1/nano/ecrecover.h"
 #include "../../../verifier/eth1/nano/eth_nano.h"
 #include <string.h>
 
-bytes_t* ecrecover_signature(bytes_t* msg_hash, d_token_t* sig) {
+/** checks the messagehash and copies r and s of the signature into sdata. */
+static bool get_signature(bytes_t* msg_hash, d_token_t* sig, uint8_t* sdata, int* v) {
 
   // check messagehash
   bytes_t* sig_msg_hash = d_get_byteskl(sig, K_MSG_HASH, 32);
-  if (sig_msg_hash && !b_cmp(sig_msg_hash, msg_hash)) return NULL;
+  if (sig_msg_hash && !b_cmp(sig_msg_hash, msg_hash)) return false;
 
-  uint8_t  pubkey[65], sdata[64];
-  bytes_t  pubkey_bytes = {.len = 64, .data = ((uint8_t*) &pubkey) + 1};
-  bytes_t* r            = d_get_byteskl(sig, K_R, 32);
-  bytes_t* s            = d_get_byteskl(sig, K_S, 32);
-  int      v            = d_get_intk(sig, K_V);
+  bytes_t* r = d_get_byteskl(sig, K_R, 32);
+  bytes_t* s = d_get_byteskl(sig, K_S, 32);
+  *v         = d_get_intk(sig, K_V);
 
   // correct v
-  if (v >= 27) v -= 27;
+  if (*v >= 27) *v -= 27;
   if (r == NULL || s == NULL || r->len + s->len != 64)
-    return NULL;
+    return false;
 
   // concat r and s
   memcpy(sdata, r->data, r->len);
   memcpy(sdata + r->len, s->data, s->len);
+  return true;
+}
+
+bytes_t* ecrecover_signature(bytes_t* msg_hash, d_token_t* sig) {
+  uint8_t pubkey[65], sdata[64];
+  bytes_t pubkey_bytes = {.len = 64, .data = ((uint8_t*) &pubkey) + 1};
+  int     v;
 
   // verify signature
-  if (ecdsa_recover_pub_from_sig(&secp256k1, pubkey, sdata, msg_hash->data, v) == 0)
+  if (get_signature(msg_hash, sig, sdata, &v) && ecrecover_pub(sdata, v, msg_hash->data, pubkey) == 0)
     // hash it and return the last 20 bytes as address
     return sha3_to(&pubkey_bytes, sdata) == 0 ? b_new((char*) sdata + 12, 20) : NULL;
   else
     return NULL;
 }
 
-int eth_verify_signature(in3_vctx_t* vc, bytes_t* msg_hash, d_token_t* sig) {
-  // recover the signature
-  int      res  = 0, i;
-  bytes_t* addr = ecrecover_signature(msg_hash, sig);
+int eth_verify_signatures(in3_vctx_t* vc, bytes_t* msg_hash, d_token_t** sigs, int len) {
+  if (!len) return 0;
+  int          res = 0, n = 0, v, i, j;
+  ecrecover_t* recs  = _malloc(len * (sizeof(ecrecover_t) + 64));
+  uint8_t*     sdata = (uint8_t*) (recs + len);
+  uint8_t      hash[32];
+
+  // all valid signatures are recovered with one batch
+  for (i = 0; i < len; i++) {
+    if (get_signature(msg_hash, sigs[i], sdata + n * 64, &v)) {
+      recs[n] = (ecrecover_t){.sig = sdata + n * 64, .hash = msg_hash->data, .recid = v};
+      n++;
+    } else
+      vc_err(vc, "could not recover the signature");
+  }
+  if (n) ecrecover_pub_batch(recs, n);
+
+  for (i = 0; i < n; i++) {
+    // if we can not recover, no bit is set.
+    if (recs[i].res) {
+      vc_err(vc, "could not recover the signature");
+      continue;
+    }
 
-  // if we can not recover, we return 0, so no but set.
-  if (addr == NULL) return 0 * vc_err(vc, "could not recover the signature");
+    // the address is the last 20 bytes of the hashed public key
+    bytes_t pub = {.len = 64, .data = recs[i].pub + 1};
+    bytes_t addr = {.len = 20, .data = hash + 12};
+    sha3_to(&pub, hash);
 
-  // try to find the signature requested
-  for (i = 0; i < vc->config->signers_length; i++) {
-    if (b_cmp(vc->config->signers + i, addr)) {
-      // adn set the bit depending on the index.
-      res = 1 << i;
-      break;
+    // try to find the signature requested and set the bit depending on the index.
+    for (j = 0; j < vc->config->signers_length; j++) {
+      if (b_cmp(vc->config->signers + j, &addr)) {
+        res |= 1 << j;
+        break;
+      }
     }
   }
 
-  b_free(addr);
-
+  _free(recs);
   return res;
 }
+
+int eth_verify_signature(in3_vctx_t* vc, bytes_t* msg_hash, d_token_t* sig) {
+  return eth_verify_signatures(vc, msg_hash, &sig, 1);
+}
@@ -43,20 +43,25 @@
 #include "../../../verifier/eth1/nano/serialize.h"
 #include <string.h>
 
-bytes_t* create_tx_path(uint32_t index) {
-  uint8_t data[4];
-  bytes_t b = {.len = 4, .data = data};
-
+bytes_t create_tx_path_to(uint32_t index, uint8_t* dst) {
+  bytes_t path = {.len = 1, .data = dst};
   if (index == 0)
-    b.len = 0;
+    *dst = 0x80;
+  else if (index < 0x80)
+    *dst = index;
   else {
-    int_to_bytes(index, data);
-    b_optimize_len(&b);
+    // a short item with the index as big endian without leading zeros
+    int l = index > 0xFFFFFF ? 4 : (index > 0xFFFF ? 3 : (index > 0xFF ? 2 : 1));
+    *dst  = 0x80 + l;
+    for (path.len = l + 1; l; l--, index >>= 8) dst[l] = index & 0xFF;
   }
+  return path;
+}
 
-  bytes_builder_t* bb = bb_new();
-  rlp_encode_item(bb, &b);
-  return bb_move_to_bytes(bb);
+bytes_t* create_tx_path(uint32_t index) {
+  uint8_t data[5];
+  bytes_t path = create_tx_path_to(index, data);
+  return b_dup(&path);
 }
 
 in3_ret_t eth_verify_eth_getTransactionReceipt(in3_vctx_t* vc, bytes_t* tx_hash) {
@@ -83,40 +88,40 @@ in3_ret_t eth_verify_eth_getTransactionReceipt(in3_vctx_t* vc, bytes_t* tx_hash)
     return vc_err(vc, "No Block-Proof!");
 
   // verify the header
+  rlp_index_t header;
   res = eth_verify_blockheader(vc, blockHeader, d_bytes(block_hash));
+  rlp_index_list(blockHeader, &header);
 
   // make sure the blocknumner on the receipt is correct
-  if (res == IN3_OK && (rlp_decode_in_list(blockHeader, BLOCKHEADER_NUMBER, &root) != 1 || bytes_to_long(root.data, root.len) != d_get_longk(vc->result, K_BLOCK_NUMBER)))
+  if (res == IN3_OK && (rlp_index_get(&header, BLOCKHEADER_NUMBER, &root) != 1 || bytes_to_long(root.data, root.len) != d_get_longk(vc->result, K_BLOCK_NUMBER)))
     res = vc_err(vc, "wrong blocknumber in the result");
 
   if (res == IN3_OK) {
     // encode the tx_path
-    bytes_t* path = create_tx_path(d_get_intk(vc->proof, K_TX_INDEX));
+    uint8_t path_data[5];
+    bytes_t path = create_tx_path_to(d_get_intk(vc->proof, K_TX_INDEX), path_data);
 
     // verify the merkle proof for the receipt
-    if (rlp_decode_in_list(blockHeader, BLOCKHEADER_RECEIPT_ROOT, &root) != 1)
+    if (rlp_index_get(&header, BLOCKHEADER_RECEIPT_ROOT, &root) != 1)
       res = vc_err(vc, "no receipt_root");
     else {
-      bytes_t*  receipt_raw = serialize_tx_receipt(vc->result);
-      bytes_t** proof       = d_create_bytes_vec(d_get(vc->proof, K_MERKLE_PROOF));
+      bytes_t* receipt_raw = serialize_tx_receipt(vc->result);
 
-      if (!proof || !trie_verify_proof(&root, path, proof, receipt_raw))
+      if (!trie_verify_proof_token(&root, &path, d_get(vc->proof, K_MERKLE_PROOF), receipt_raw))
         res = vc_err(vc, "Could not verify the merkle proof");
 
       b_free(receipt_raw);
-      if (proof) _free(proof);
     }
 
     // now we need to verify the transactionIndex by making sure we can do the merkle proof for the same transactionhash and transaction index.
     if (res == IN3_OK) {
-      bytes_t   raw_transaction = {.len = 0, .data = NULL};
-      bytes_t** proof           = d_create_bytes_vec(d_get(vc->proof, K_TX_PROOF));
+      bytes_t raw_transaction = {.len = 0, .data = NULL};
 
       // get the transaction root and do the merkle proof.
-      if (rlp_decode_in_list(blockHeader, BLOCKHEADER_TRANSACTIONS_ROOT, &root) != 1)
+      if (rlp_index_get(&header, BLOCKHEADER_TRANSACTIONS_ROOT, &root) != 1)
         res = vc_err(vc, "no tx root");
       else {
-        if (!proof || !trie_verify_proof(&root, path, proof, &raw_transaction))
+        if (!trie_verify_proof_token(&root, &path, d_get(vc->proof, K_TX_PROOF), &raw_transaction))
           res = vc_err(vc, "Could not verify the tx proof");
         else if (raw_transaction.data == NULL)
           res = vc_err(vc, "No value returned after verification");
@@ -128,9 +133,7 @@ in3_ret_t eth_verify_eth_getTransactionReceipt(in3_vctx_t* vc, bytes_t* tx_hash)
             res = vc_err(vc, "The TransactionHash is not the same as expected");
         }
       }
-      if (proof) _free(proof);
     }
-    b_free(path);
   }
 
   // if this was all successfull, we still need to make sure all values are correct in the result.
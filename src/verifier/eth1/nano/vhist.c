@@ -44,15 +44,74 @@
 
 #define VALIDATOR_LIST_KEY "validatorlist_%d"
 
-static in3_ret_t bb_find(bytes_builder_t* bb, uint8_t* v, size_t l) {
-  if (v) {
-    for (size_t i = 0; i < bb->b.len; i += l)
-      if (!memcmp(bb->b.data + i, v, l))
-        return (i / l);
+#define TRANSITION_SIZE (8 + sizeof(vhist_engine_t) + 4) // block, engine and number of validators of a transition in diffs
+
+static uint32_t vldtr_slot(vhist_t* vh, uint8_t* address) {
+  return bytes_to_int(address, 4) & vh->vldtrs_mask;
+}
+
+static in3_ret_t vh_find_validator(vhist_t* vh, uint8_t* address) {
+  if (!vh->vldtrs_index) return IN3_EFIND;
+  for (uint32_t i = vldtr_slot(vh, address); vh->vldtrs_index[i]; i = (i + 1) & vh->vldtrs_mask) {
+    if (!memcmp(vh->vldtrs->b.data + (vh->vldtrs_index[i] - 1) * 20, address, 20))
+      return vh->vldtrs_index[i] - 1;
   }
   return IN3_EFIND;
 }
 
+static void vh_insert_validator(vhist_t* vh, uint32_t pos) {
+  uint32_t i = vldtr_slot(vh, vh->vldtrs->b.data + pos * 20);
+  while (vh->vldtrs_index[i]) i = (i + 1) & vh->vldtrs_mask;
+  vh->vldtrs_index[i] = pos + 1;
+}
+
+static void vh_index_validator(vhist_t* vh, uint32_t pos) {
+  if (vh->vldtrs_index && (pos + 1) * 2 <= vh->vldtrs_mask + 1)
+    vh_insert_validator(vh, pos);
+  else {
+    // grow the hash set, so it is never more than half full
+    uint32_t size = 16;
+    while (size < (pos + 1) * 4) size <<= 1;
+    _free(vh->vldtrs_index);
+    vh->vldtrs_index = _calloc(size, sizeof(uint32_t));
+    vh->vldtrs_mask  = size - 1;
+    for (uint32_t i = 0; i <= pos; i++) vh_insert_validator(vh, i);
+  }
+}
+
+static void vh_index_transition(vhist_t* vh, uint32_t offset) {
+  const uint32_t  len = vh->transitions_len;
+  vh_transition_t t   = {.block = bytes_to_long(vh->diffs->b.data + offset, 8), .offset = offset};
+  uint32_t        i   = len;
+  vh->transitions     = len ? _realloc(vh->transitions, (len + 1) * sizeof(vh_transition_t), len * sizeof(vh_transition_t)) : _malloc(sizeof(vh_transition_t));
+
+  // transitions are usually added in order, but we keep them sorted anyway
+  for (; i && vh->transitions[i - 1].block > t.block; i--) vh->transitions[i] = vh->transitions[i - 1];
+  vh->transitions[i]     = t;
+  vh->transitions_len    = len + 1;
+  vh->current_transition = 0;
+}
+
+static void vh_build_index(vhist_t* vh) {
+  for (uint32_t i = 0; i < vh->vldtrs->b.len / 20; i++) vh_index_validator(vh, i);
+  for (uint32_t offset = 0; offset + TRANSITION_SIZE <= vh->diffs->b.len; offset += TRANSITION_SIZE + bytes_to_int(vh->diffs->b.data + offset + TRANSITION_SIZE - 4, 4) * 4)
+    vh_index_transition(vh, offset);
+}
+
+/** finds the last transition starting at or before the block. */
+static vh_transition_t* vh_find_transition(vhist_t* vh, uint64_t block) {
+  if (!vh->transitions_len) return NULL;
+  uint32_t lo = 0, hi = vh->transitions_len;
+  while (hi - lo > 1) {
+    const uint32_t mid = (lo + hi) / 2;
+    if (vh->transitions[mid].block <= block)
+      lo = mid;
+    else
+      hi = mid;
+  }
+  return vh->transitions + lo;
+}
+
 static vhist_engine_t stoengine(const char* str) {
   vhist_engine_t vhe = ENGINE_UNKNOWN;
   if (!str)
@@ -65,7 +124,7 @@ static vhist_engine_t stoengine(const char* str) {
 }
 
 vhist_t* vh_new() {
-  vhist_t* vh = _malloc(sizeof(*vh));
+  vhist_t* vh = _calloc(1, sizeof(*vh));
   if (vh == NULL) return NULL;
   vh->vldtrs = bb_new();
   vh->diffs  = bb_new();
@@ -111,52 +170,42 @@ void vh_free(vhist_t* vh) {
   if (vh) {
     bb_free(vh->diffs);
     bb_free(vh->vldtrs);
+    if (vh->current) bb_free(vh->current);
+    _free(vh->transitions);
+    _free(vh->vldtrs_index);
   }
   _free(vh);
 }
 
-uint32_t vh_find_block(vhist_t* vh, uint64_t block, uint32_t* prevsz) {
-  uint64_t       blk    = 0;
-  uint32_t       sz     = 0;
-  size_t         i      = 0;
-  vhist_engine_t engine = ENGINE_UNKNOWN;
+bytes_t* vh_get_validators(vhist_t* vh, uint64_t block) {
+  vh_transition_t* t = vh_find_transition(vh, block);
+  if (!t) return NULL;
 
-  for (i = 0; i < vh->diffs->b.len;) {
-    bb_read_next(vh->diffs, &i, &blk);
-    bb_read_next(vh->diffs, &i, &engine);
-    bb_read_next(vh->diffs, &i, &sz);
-    if (blk > block) {
-      i -= ((*prevsz * 4) + 12 + sizeof(engine));
-      break;
-    }
-    i += sz * 4;
-    *prevsz = sz;
+  // the validators are only materialized once per transition
+  const uint32_t n = t - vh->transitions + 1;
+  if (vh->current_transition != n) {
+    const uint8_t* p   = vh->diffs->b.data + t->offset + TRANSITION_SIZE;
+    const uint32_t len = bytes_to_int(p - 4, 4);
+    if (!vh->current) vh->current = bb_new();
+    bb_clear(vh->current);
+    for (uint32_t i = 0; i < len; i++)
+      bb_write_raw_bytes(vh->current, vh->vldtrs->b.data + bytes_to_int(p + i * 4, 4) * 20, 20);
+    vh->current_transition = n;
   }
-
-  // If block exceeds last block at which there was a validator list change,
-  // send latest validator list
-  if (i >= vh->diffs->b.len) i -= (*prevsz) * 4;
-  return i;
+  return &vh->current->b;
 }
 
 bytes_builder_t* vh_get_validators_for_block(vhist_t* vh, uint64_t block) {
-  bytes_builder_t* bb  = bb_new();
-  uint32_t         pos = 0, prevsz = 0;
-  if (bb == NULL) return NULL;
-  uint32_t i = vh_find_block(vh, block, &prevsz);
-  for (size_t j = 0; j < prevsz; ++j) {
-    bb_read_next(vh->diffs, &i, &pos);
-    bb_write_raw_bytes(bb, vh->vldtrs->b.data + (pos * 20), 20);
-  }
+  bytes_builder_t* bb = bb_new();
+  bytes_t*         v  = vh_get_validators(vh, block);
+  if (bb && v) bb_write_raw_bytes(bb, v->data, v->len);
   return bb;
 }
 
 vhist_engine_t vh_get_engine_for_block(vhist_t* vh, uint64_t block) {
-  vhist_engine_t engine = ENGINE_UNKNOWN;
-  uint32_t       prevsz = 0;
-  uint32_t       i      = vh_find_block(vh, block, &prevsz);
-  i -= (4 + sizeof(vhist_engine_t));
-  bb_read_next(vh->diffs, &i, &engine);
+  vhist_engine_t   engine = ENGINE_UNKNOWN;
+  vh_transition_t* t      = vh_find_transition(vh, block);
+  if (t) memcpy(&engine, vh->diffs->b.data + t->offset + 8, sizeof(engine));
   return engine;
 }
 
@@ -180,22 +229,26 @@ void vh_add_state(vhist_t* vh, d_token_t* state, bool is_spec) {
   } else
     blk = d_get_longk(state, K_BLOCK);
 
+  const uint32_t offset = vh->diffs->b.len;
   bb_write_long(vh->diffs, blk);
   bb_write_raw_bytes(vh->diffs, &engine, sizeof(engine));
   bb_write_int(vh->diffs, d_len(vs));
   if (d_type(vs) == T_ARRAY) {
     for (d_iterator_t vitr = d_iter(vs); vitr.left; d_iter_next(&vitr)) {
       b   = (d_type(vitr.token) == T_STRING) ? hex_to_new_bytes(d_string(vitr.token), 40) : d_bytesl(vitr.token, 20);
-      ret = bb_find(vh->vldtrs, b->data, 20);
+      ret = vh_find_validator(vh, b->data);
       if (ret == IN3_EFIND) {
-        bb_write_int(vh->diffs, vh->vldtrs->b.len / 20);
+        ret = vh->vldtrs->b.len / 20;
+        bb_write_int(vh->diffs, ret);
         bb_write_fixed_bytes(vh->vldtrs, b);
+        vh_index_validator(vh, ret);
       } else {
         bb_write_int(vh->diffs, ret);
       }
       if (d_type(vitr.token) == T_STRING) b_free(b);
     }
   }
+  vh_index_transition(vh, offset);
 }
 
 void vh_cache_save(vhist_t* vh, in3_t* c) {
@@ -237,6 +290,7 @@ vhist_t* vh_cache_retrieve(in3_t* c) {
         vh->vldtrs->b.len = b_.len;
         rlp_decode(v_, 3, &b_);
         b_read(&b_, 0, &vh->last_change_block);
+        vh_build_index(vh);
       }
       b_free(v_);
     }
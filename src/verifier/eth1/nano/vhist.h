@@ -46,10 +46,22 @@ typedef enum {
   ENGINE_CLIQUE
 } vhist_engine_t;
 
+/** a change of the validators, starting with the given block */
+typedef struct {
+  uint64_t block;  /**< the first block of the validator set */
+  uint32_t offset; /**< the position of the transition within the diffs */
+} vh_transition_t;
+
 typedef struct {
   bytes_builder_t* diffs;
   bytes_builder_t* vldtrs;
   uint64_t         last_change_block;
+  vh_transition_t* transitions;        /**< index of all transitions in diffs, sorted by block */
+  uint32_t         transitions_len;    /**< number of transitions */
+  uint32_t*        vldtrs_index;       /**< hash set with the position + 1 of each address in vldtrs */
+  uint32_t         vldtrs_mask;        /**< size of the hash set - 1 */
+  bytes_builder_t* current;            /**< the materialized validators of current_transition */
+  uint32_t         current_transition; /**< the transition (+1) of the materialized validators */
 } vhist_t;
 
 vhist_t*         vh_new();
@@ -57,6 +69,7 @@ vhist_t*         vh_init_spec(d_token_t* spec);
 vhist_t*         vh_init_nodelist(d_token_t* nodelist);
 void             vh_free(vhist_t* vh);
 bytes_builder_t* vh_get_validators_for_block(vhist_t* vh, uint64_t block);
+bytes_t*         vh_get_validators(vhist_t* vh, uint64_t block); /**< returns the validators for the block. The result is owned by the vhist and valid until it changes. */
 vhist_engine_t   vh_get_engine_for_block(vhist_t* vh, uint64_t block);
 void             vh_add_state(vhist_t* vh, d_token_t* state, bool is_spec);
 void             vh_cache_save(vhist_t* vh, in3_t* c);
@@ -474,12 +474,18 @@ int run_evm(d_token_t* test, uint32_t props, uint64_t* ms, char* fork_name, int
 
 #ifdef EVM_GAS
     evm.accounts = NULL;
+    memset(&evm.account_index, 0, sizeof(evm_index_t));
     evm.gas      = d_get_long(exec, "gas");
     evm.code     = d_to_bytes(d_get(exec, K_CODE));
     evm.parent   = NULL;
     evm.logs     = NULL;
     evm.init_gas = 0;
 #endif
+#ifdef EVM_TRACE
+    evm.tracer      = evm_get_tracer();
+    evm.call_depth  = 0;
+    evm.code_hashed = 0;
+#endif
 
   } else if (transaction) {
     indexes        = d_get(d_get_at(d_get(post, key(fork_name)), test_index), key("indexes"));
@@ -512,11 +518,17 @@ int run_evm(d_token_t* test, uint32_t props, uint64_t* ms, char* fork_name, int
 
 #ifdef EVM_GAS
     evm.accounts = NULL;
+    memset(&evm.account_index, 0, sizeof(evm_index_t));
     evm.gas      = d_long(get_test_val(transaction, "gasLimit", indexes));
     evm.parent   = NULL;
     evm.logs     = NULL;
     evm.refund   = 0;
     evm.init_gas = evm.gas;
+#ifdef EVM_TRACE
+    evm.tracer      = evm_get_tracer();
+    evm.call_depth  = 0;
+    evm.code_hashed = 0;
+#endif
 
     // prepare all accounts
     read_accounts(&evm, d_get(test, key("pre")));
@@ -615,9 +627,11 @@ int run_evm(d_token_t* test, uint32_t props, uint64_t* ms, char* fork_name, int
           ac->storage = s->next;
           _free(s);
         }
+        evm_index_free(&ac->storage_index);
         evm.accounts = ac->next;
         _free(ac);
       }
+      evm_index_free(&evm.account_index);
 
       // read the accounts from pre-state
       read_accounts(&evm, d_get(test, key("pre")));
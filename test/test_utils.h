@@ -35,7 +35,9 @@
 #ifndef IN3_TEST_UTILS_H
 #define IN3_TEST_UTILS_H
 
+#include "../src/core/util/mem.h"
 #include "unity/unity.h"
+#include <stdio.h>
 #include <sys/time.h>
 
 #ifdef __cplusplus
@@ -60,6 +62,22 @@ extern "C" {
     TEST_LOG_INTERNAL(#t, "Completed in %fs\n", TIMING_GET()); \
   } while (0)
 
+/** reads the recorded request `test/testdata/requests/<name>.json`. The returned string must be freed. */
+static inline char* read_testdata(const char* name) {
+  char filename[200];
+  sprintf(filename, "../test/testdata/requests/%s.json", name);
+  FILE* f = fopen(filename, "r");
+  TEST_ASSERT_NOT_NULL_MESSAGE(f, filename);
+  fseek(f, 0, SEEK_END);
+  long length = ftell(f);
+  fseek(f, 0, SEEK_SET);
+  char* buffer   = _malloc(length + 1);
+  length         = fread(buffer, 1, length, f);
+  buffer[length] = 0;
+  fclose(f);
+  return buffer;
+}
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,252 @@
+/*******************************************************************************
+ * This file is part of the Incubed project.
+ * Sources: https://github.com/slockit/in3-c
+ * 
+ * Copyright (C) 2018-2019 slock.it GmbH, Blockchains LLC
+ * 
+ * 
+ * COMMERCIAL LICENSE USAGE
+ * 
+ * Licensees holding a valid commercial license may use this file in accordance 
+ * with the commercial license agreement provided with the Software or, alternatively, 
+ * in accordance with the terms contained in a written agreement between you and 
+ * slock.it GmbH/Blockchains LLC. For licensing terms and conditions or further 
+ * information please contact slock.it at in3@slock.it.
+ * 	
+ * Alternatively, this file may be used under the AGPL license as follows:
+ *    
+ * AGPL LICENSE USAGE
+ * 
+ * This program is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Affero General Public License as published by the Free Software 
+ * Foundation, either version 3 of the License, or (at your option) any later version.
+ *  
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY 
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A 
+ * PARTICULAR PURPOSE. See the GNU Affero General Public License for more details.
+ * [Permissions of this strong copyleft license are conditioned on making available 
+ * complete source code of licensed works and modifications, which include larger 
+ * works using a licensed work, under the same license. Copyright and license notices 
+ * must be preserved. Contributors provide an express grant of patent rights.]
+ * You should have received a copy of the GNU Affero General Public License along 
+ * with this program. If not, see <https://www.gnu.org/licenses/>.
+ *******************************************************************************/
+
+#ifndef TEST
+#define TEST
+#endif
+#ifndef TEST
+#define DEBUG
+#endif
+
+#include "../../src/core/util/mem.h"
+#include "../../src/core/util/utils.h"
+#include "../../src/third-party/tommath/tommath.h"
+#include "../../src/verifier/eth1/evm/big.h"
+#include "../../src/verifier/eth1/evm/precompiled.h"
+#include "../test_utils.h"
+#include <string.h>
+
+#define ROUNDS 2000
+
+static uint64_t seed = 0x9E3779B97F4A7C15ULL;
+
+static uint64_t next_rand() {
+  seed ^= seed << 13;
+  seed ^= seed >> 7;
+  seed ^= seed << 17;
+  return seed;
+}
+
+/** creates a random number, preferring bytes of 0x00 and 0xff to hit the edge cases of the division. */
+static wlen_t random_big(uint8_t* dst, wlen_t max) {
+  wlen_t l = 1 + next_rand() % max;
+  for (wlen_t i = 0; i < l; i++) {
+    uint64_t r = next_rand() % 4;
+    dst[i]     = r == 0 ? 0 : (r == 1 ? 0xFF : next_rand() & 0xFF);
+  }
+  if (!*dst) *dst = 1;
+  return l;
+}
+
+static void assert_mp(mp_int* expected, uint8_t* res, int l) {
+  uint8_t tmp[80];
+  size_t  ml;
+  mp_export(tmp, &ml, 1, sizeof(uint8_t), 1, 0, expected);
+  if (!ml) tmp[ml++] = 0;
+  while (l > 1 && !*res) {
+    // results may contain leading zeros
+    res++;
+    l--;
+  }
+  TEST_ASSERT_EQUAL(ml, l);
+  TEST_ASSERT_EQUAL_MEMORY(tmp, res, ml);
+}
+
+static void init_mp(mp_int* a, mp_int* b, mp_int* c, mp_int* d) {
+  mp_init(a);
+  mp_init(b);
+  mp_init(c);
+  mp_init(d);
+}
+
+static void clear_mp(mp_int* a, mp_int* b, mp_int* c, mp_int* d) {
+  mp_clear(a);
+  mp_clear(b);
+  mp_clear(c);
+  mp_clear(d);
+}
+
+/** sets 2^256 */
+static void set_word_mod(mp_int* m) {
+  uint8_t tmp[33];
+  memset(tmp, 0, 33);
+  *tmp = 1;
+  mp_import(m, 33, 1, sizeof(uint8_t), 1, 0, tmp);
+}
+
+static void test_mulmod() {
+  uint8_t a[32], b[32], m[32], res[65];
+  mp_int  ma, mb, mm, mr, mw;
+  init_mp(&ma, &mb, &mm, &mr);
+  mp_init(&mw);
+  set_word_mod(&mw);
+  for (int i = 0; i < ROUNDS; i++) {
+    wlen_t la = random_big(a, 32), lb = random_big(b, 32), lm = random_big(m, 32);
+    mp_import(&ma, la, 1, sizeof(uint8_t), 1, 0, a);
+    mp_import(&mb, lb, 1, sizeof(uint8_t), 1, 0, b);
+    mp_import(&mm, lm, 1, sizeof(uint8_t), 1, 0, m);
+    mp_mul(&ma, &mb, &ma);
+    mp_div(&ma, &mm, NULL, &mr);
+    assert_mp(&mr, res, big_mulmod(a, la, b, lb, m, lm, res));
+
+    mp_div(&ma, &mw, NULL, &mr);
+    assert_mp(&mr, res, big_mul(a, la, b, lb, res, 32));
+  }
+  clear_mp(&ma, &mb, &mm, &mr);
+  mp_clear(&mw);
+}
+
+static void test_divmod() {
+  uint8_t a[65], b[32], res[65];
+  mp_int  ma, mb, mq, mr;
+  init_mp(&ma, &mb, &mq, &mr);
+  for (int i = 0; i < ROUNDS; i++) {
+    wlen_t la = random_big(a, i % 2 ? 65 : 32), lb = random_big(b, 32);
+    mp_import(&ma, la, 1, sizeof(uint8_t), 1, 0, a);
+    mp_import(&mb, lb, 1, sizeof(uint8_t), 1, 0, b);
+    mp_div(&ma, &mb, &mq, &mr);
+    assert_mp(&mr, res, big_mod(a, la, b, lb, 0, res));
+    if (la <= 32) assert_mp(&mq, res, big_div(a, la, b, lb, 0, res));
+  }
+  clear_mp(&ma, &mb, &mq, &mr);
+}
+
+static void test_exp() {
+  uint8_t a[32], b[32], res[65];
+  mp_int  ma, mb, mm, mr;
+  init_mp(&ma, &mb, &mm, &mr);
+  set_word_mod(&mm);
+  for (int i = 0; i < ROUNDS / 10; i++) {
+    wlen_t la = random_big(a, 32), lb = random_big(b, 32);
+    mp_import(&ma, la, 1, sizeof(uint8_t), 1, 0, a);
+    mp_import(&mb, lb, 1, sizeof(uint8_t), 1, 0, b);
+    mp_exptmod(&ma, &mb, &mm, &mr);
+    assert_mp(&mr, res, big_exp(a, la, b, lb, res));
+  }
+  clear_mp(&ma, &mb, &mm, &mr);
+}
+
+/** compares big_modexp with tommath for moduli of the given length. */
+static void check_modexp(uint8_t* m, uint32_t lm, int rounds) {
+  uint8_t base[512], exp[64], res[256], tmp[256];
+  mp_int  ma, mb, mm, mr;
+  init_mp(&ma, &mb, &mm, &mr);
+  mp_import(&mm, lm, 1, sizeof(uint8_t), 1, 0, m);
+  for (int i = 0; i < rounds; i++) {
+    uint32_t lb = 1 + next_rand() % (lm * 2), le = 1 + next_rand() % 64;
+    for (uint32_t n = 0; n < lb; n++) base[n] = next_rand();
+    for (uint32_t n = 0; n < le; n++) exp[n] = next_rand();
+    mp_import(&ma, lb, 1, sizeof(uint8_t), 1, 0, base);
+    mp_import(&mb, le, 1, sizeof(uint8_t), 1, 0, exp);
+    mp_exptmod(&ma, &mb, &mm, &mr);
+    size_t ml;
+    memset(tmp, 0, lm);
+    mp_export(tmp + lm - mp_unsigned_bin_size(&mr), &ml, 1, sizeof(uint8_t), 1, 0, &mr);
+    TEST_ASSERT_EQUAL(0, big_modexp(base, lb, exp, le, m, lm, res));
+    TEST_ASSERT_EQUAL_MEMORY(tmp, res, lm);
+  }
+  clear_mp(&ma, &mb, &mm, &mr);
+}
+
+static void test_modexp() {
+  uint8_t m[256], res[4];
+  for (uint32_t lm = 1; lm <= 256; lm = lm < 40 ? lm + 1 : lm * 2) {
+    int rounds = lm <= 32 ? ROUNDS / 40 : 4;
+    // odd
+    for (uint32_t n = 0; n < lm; n++) m[n] = next_rand();
+    m[0] |= 1;
+    m[lm - 1] |= 1;
+    check_modexp(m, lm, rounds);
+    // even
+    m[lm - 1] &= 0xFE;
+    check_modexp(m, lm, rounds);
+    // power of 2 with and without leading zeros
+    memset(m, 0, lm);
+    m[lm - 1 - next_rand() % lm] = 1 << (next_rand() % 8);
+    check_modexp(m, lm, rounds);
+  }
+
+  // x^0 = 1, x % 1 = 0 and x % 0 = 0
+  uint8_t zero[2] = {0, 0}, one[2] = {0, 1}, x[2] = {0x12, 0x34};
+  big_modexp(x, 2, zero, 2, x, 2, res);
+  TEST_ASSERT_EQUAL_MEMORY(one, res, 2);
+  big_modexp(x, 2, x, 2, one, 2, res);
+  TEST_ASSERT_EQUAL_MEMORY(zero, res, 2);
+  big_modexp(x, 2, x, 2, zero, 2, res);
+  TEST_ASSERT_EQUAL_MEMORY(zero, res, 2);
+  big_modexp(x, 2, zero, 0, one, 1, res);
+  TEST_ASSERT_EQUAL(0, *res);
+}
+
+/*
+ * Main
+ */
+/** runs the modexp precompile with the given lengths and only 3 bytes of operands. */
+static int run_modexp(uint32_t l_base, uint32_t l_exp, uint32_t l_mod, uint64_t gas) {
+  uint8_t data[99] = {0};
+  int_to_bytes(l_base, data + 28);
+  int_to_bytes(l_exp, data + 60);
+  int_to_bytes(l_mod, data + 92);
+  data[96] = 3, data[97] = 5, data[98] = 7;
+  evm_t evm;
+  memset(&evm, 0, sizeof(evm));
+  evm.call_data = bytes(data, 99);
+  evm.gas       = gas;
+  int res       = pre_modexp(&evm);
+  if (res == 0 && l_exp == 1 && l_mod == 1) TEST_ASSERT_EQUAL(5, evm.return_data.data[0]); // 3^5 % 7
+  _free(evm.return_data.data);
+  return res;
+}
+
+static void test_modexp_lengths() {
+  TEST_ASSERT_EQUAL(0, run_modexp(1, 1, 1, 10000000));
+  // lengths far beyond the input must fail before anything is allocated for them
+  TEST_ASSERT_EQUAL(EVM_ERROR_OUT_OF_GAS, run_modexp(1, 1, 0x10000000, 10000000));
+  TEST_ASSERT_EQUAL(EVM_ERROR_OUT_OF_GAS, run_modexp(0x10000000, 1, 1, 10000000));
+  TEST_ASSERT_EQUAL(EVM_ERROR_OUT_OF_GAS, run_modexp(1, 0x10000000, 1, 10000000));
+  // even if the gas would pay for them
+  TEST_ASSERT_EQUAL(EVM_ERROR_OUT_OF_GAS, run_modexp(1, 0x1000000, 1, 0xFFFFFFFFFFFFULL));
+  TEST_ASSERT_EQUAL(EVM_ERROR_OUT_OF_GAS, run_modexp(1, MODEXP_MAX_LEN + 1, 1, 0xFFFFFFFFFFFFULL));
+  TEST_ASSERT_EQUAL(0, run_modexp(1, MODEXP_MAX_LEN, 1, 0xFFFFFFFFFFFFULL));
+}
+
+int main() {
+  TESTS_BEGIN();
+  RUN_TEST(test_mulmod);
+  RUN_TEST(test_divmod);
+  RUN_TEST(test_exp);
+  RUN_TEST(test_modexp);
+  RUN_TEST(test_modexp_lengths);
+  return TESTS_END();
+}
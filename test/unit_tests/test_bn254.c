@@ -0,0 +1,324 @@
+/*******************************************************************************
+ * This file is part of the Incubed project.
+ * Sources: https://github.com/slockit/in3-c
+ * 
+ * Copyright (C) 2018-2019 slock.it GmbH, Blockchains LLC
+ * 
+ * 
+ * COMMERCIAL LICENSE USAGE
+ * 
+ * Licensees holding a valid commercial license may use this file in accordance 
+ * with the commercial license agreement provided with the Software or, alternatively, 
+ * in accordance with the terms contained in a written agreement between you and 
+ * slock.it GmbH/Blockchains LLC. For licensing terms and conditions or further 
+ * information please contact slock.it at in3@slock.it.
+ * 	
+ * Alternatively, this file may be used under the AGPL license as follows:
+ *    
+ * AGPL LICENSE USAGE
+ * 
+ * This program is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Affero General Public License as published by the Free Software 
+ * Foundation, either version 3 of the License, or (at your option) any later version.
+ *  
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY 
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A 
+ * PARTICULAR PURPOSE. See the GNU Affero General Public License for more details.
+ * [Permissions of this strong copyleft license are conditioned on making available 
+ * complete source code of licensed works and modifications, which include larger 
+ * works using a licensed work, under the same license. Copyright and license notices 
+ * must be preserved. Contributors provide an express grant of patent rights.]
+ * You should have received a copy of the GNU Affero General Public License along 
+ * with this program. If not, see <https://www.gnu.org/licenses/>.
+ *******************************************************************************/
+
+#ifndef TEST
+#define TEST
+#endif
+#ifndef TEST
+#define DEBUG
+#endif
+
+#include "../../src/core/util/utils.h"
+#include "../../src/third-party/tommath/tommath.h"
+#include "../../src/verifier/eth1/evm/bn254.h"
+#include "../test_utils.h"
+#include <string.h>
+
+#define G1 "0000000000000000000000000000000000000000000000000000000000000001"  \
+           "0000000000000000000000000000000000000000000000000000000000000002"
+#define G1_NEG "0000000000000000000000000000000000000000000000000000000000000001" \
+               "30644e72e131a029b85045b68181585d97816a916871ca8d3c208c16d87cfd45"
+#define G1_2 "030644e72e131a029b85045b68181585d97816a916871ca8d3c208c16d87cfd3" \
+             "15ed738c0e0a7c92e7845f96b2ae9c0a68a6a449e3538fc7ff3ebf7a5a18a2c4"
+#define G1_3 "0769bf9ac56bea3ff40232bcb1b6bd159315d84715b8e679f2d355961915abf0" \
+             "2ab799bee0489429554fdb7c8d086475319e63b40b9c5b57cdf1ff3dd9fe2261"
+#define G2 "198e9393920d483a7260bfb731fb5d25f1aa493335a9e71297e485b7aef312c2" \
+           "1800deef121f1e76426a00665e5c4479674322d4f75edadd46debd5cd992f6ed" \
+           "090689d0585ff075ec9e99ad690c3395bc4b313370b38ef355acdadcd122975b" \
+           "12c85ea5db8c6deb4aab71808dcb408fe3d1e7690c43d37b4ce6cc0166fa7daa"
+#define G2_2 "203e205db4f19b37b60121b83a7333706db86431c6d835849957ed8c3928ad79" \
+             "27dc7234fd11d3e8c36c59277c3e6f149d5cd3cfa9a62aee49f8130962b4b3b9" \
+             "195e8aa5b7827463722b8c153931579d3505566b4edf48d498e185f0509de152" \
+             "04bb53b8977e5f92a0bc372742c4830944a59b4fe6b1c0466e2a6dad122b5d2e"
+#define ORDER "30644e72e131a029b85045b68181585d2833e84879b9709143e1f593f0000001"
+
+static int hex(const char* data, uint8_t* dst) {
+  return hex_to_bytes(data, -1, dst, strlen(data) / 2);
+}
+
+// affine tommath implementation the evm used before bn254.c, kept here as the baseline for test_bench_tommath
+#define FIELD_P "30644e72e131a029b85045b68181585d97816a916871ca8d3c208c16d87cfd47"
+
+typedef struct {
+  mp_int x, y;
+  int    inf;
+} tm_point_t;
+
+static void tm_init(tm_point_t* p) {
+  mp_init_multi(&p->x, &p->y, NULL);
+  p->inf = 1;
+}
+
+static void tm_clear(tm_point_t* p) {
+  mp_clear_multi(&p->x, &p->y, NULL);
+}
+
+static void tm_import(tm_point_t* p, const uint8_t* data) {
+  mp_import(&p->x, 32, 1, sizeof(uint8_t), 1, 0, data);
+  mp_import(&p->y, 32, 1, sizeof(uint8_t), 1, 0, data + 32);
+  p->inf = mp_iszero(&p->x) && mp_iszero(&p->y);
+}
+
+static void tm_export(tm_point_t* p, uint8_t* dst) {
+  memset(dst, 0, 64);
+  if (p->inf) return;
+  mp_to_unsigned_bin(&p->x, dst + 32 - mp_unsigned_bin_size(&p->x));
+  mp_to_unsigned_bin(&p->y, dst + 64 - mp_unsigned_bin_size(&p->y));
+}
+
+// r = l^2 - x1 - x2, y = l * (x1 - r) - y1
+static void tm_finish(tm_point_t* r, mp_int* l, tm_point_t* p, mp_int* x2, mp_int* m) {
+  mp_int x, t;
+  mp_init_multi(&x, &t, NULL);
+  mp_sqrmod(l, m, &x);
+  mp_submod(&x, &p->x, m, &x);
+  mp_submod(&x, x2, m, &x);
+  mp_submod(&p->x, &x, m, &t);
+  mp_mulmod(l, &t, m, &t);
+  mp_submod(&t, &p->y, m, &r->y);
+  mp_exch(&x, &r->x);
+  r->inf = 0;
+  mp_clear_multi(&x, &t, NULL);
+}
+
+static void tm_double(tm_point_t* r, tm_point_t* p, mp_int* m) {
+  if (p->inf || mp_iszero(&p->y)) {
+    r->inf = 1;
+    return;
+  }
+  mp_int l, t;
+  mp_init_multi(&l, &t, NULL);
+  mp_sqrmod(&p->x, m, &l);
+  mp_mul_d(&l, 3, &l);
+  mp_mul_2(&p->y, &t);
+  mp_invmod(&t, m, &t);
+  mp_mulmod(&l, &t, m, &l);
+  mp_copy(&p->x, &t);
+  tm_finish(r, &l, p, &t, m);
+  mp_clear_multi(&l, &t, NULL);
+}
+
+static void tm_add(tm_point_t* r, tm_point_t* p, tm_point_t* q, mp_int* m) {
+  if (p->inf || q->inf) {
+    tm_point_t* s = p->inf ? q : p;
+    mp_copy(&s->x, &r->x);
+    mp_copy(&s->y, &r->y);
+    r->inf = s->inf;
+    return;
+  }
+  if (mp_cmp(&p->x, &q->x) == MP_EQ) {
+    if (mp_cmp(&p->y, &q->y) == MP_EQ)
+      tm_double(r, p, m);
+    else
+      r->inf = 1;
+    return;
+  }
+  mp_int l, t, x2;
+  mp_init_multi(&l, &t, &x2, NULL);
+  mp_copy(&q->x, &x2);
+  mp_submod(&q->y, &p->y, m, &l);
+  mp_submod(&q->x, &p->x, m, &t);
+  mp_invmod(&t, m, &t);
+  mp_mulmod(&l, &t, m, &l);
+  tm_finish(r, &l, p, &x2, m);
+  mp_clear_multi(&l, &t, &x2, NULL);
+}
+
+static void tm_mul(tm_point_t* r, tm_point_t* p, const uint8_t* scalar, mp_int* m) {
+  r->inf = 1;
+  for (int i = 0; i < 256; i++) {
+    tm_double(r, r, m);
+    if (scalar[i >> 3] & (0x80 >> (i & 7))) tm_add(r, r, p, m);
+  }
+}
+
+static void test_g1_add() {
+  uint8_t a[64], b[64], res[64], expected[64];
+  hex(G1, a);
+  hex(G1_2, b);
+  hex(G1_3, expected);
+  TEST_ASSERT_EQUAL(0, bn254_g1_add(a, b, res));
+  TEST_ASSERT_EQUAL_MEMORY(expected, res, 64);
+
+  // doubling
+  hex(G1_2, expected);
+  TEST_ASSERT_EQUAL(0, bn254_g1_add(a, a, res));
+  TEST_ASSERT_EQUAL_MEMORY(expected, res, 64);
+
+  // P + -P = 0
+  hex(G1_NEG, b);
+  memset(expected, 0, 64);
+  TEST_ASSERT_EQUAL(0, bn254_g1_add(a, b, res));
+  TEST_ASSERT_EQUAL_MEMORY(expected, res, 64);
+
+  // P + 0 = P
+  memset(b, 0, 64);
+  TEST_ASSERT_EQUAL(0, bn254_g1_add(a, b, res));
+  TEST_ASSERT_EQUAL_MEMORY(a, res, 64);
+
+  // not on curve
+  b[63] = 1;
+  TEST_ASSERT_EQUAL(-1, bn254_g1_add(a, b, res));
+}
+
+static void test_g1_mul() {
+  uint8_t a[64], k[32], res[64], expected[64];
+  hex(G1, a);
+  memset(k, 0, 32);
+  k[31] = 3;
+  hex(G1_3, expected);
+  TEST_ASSERT_EQUAL(0, bn254_g1_mul(a, k, res));
+  TEST_ASSERT_EQUAL_MEMORY(expected, res, 64);
+
+  // (order - 1) * P = -P
+  hex(ORDER, k);
+  k[31]--;
+  hex(G1_NEG, expected);
+  TEST_ASSERT_EQUAL(0, bn254_g1_mul(a, k, res));
+  TEST_ASSERT_EQUAL_MEMORY(expected, res, 64);
+
+  // order * P = 0
+  k[31]++;
+  memset(expected, 0, 64);
+  TEST_ASSERT_EQUAL(0, bn254_g1_mul(a, k, res));
+  TEST_ASSERT_EQUAL_MEMORY(expected, res, 64);
+
+  // x >= p
+  hex(G1_NEG, a);
+  memcpy(a, a + 32, 32);
+  TEST_ASSERT_EQUAL(-1, bn254_g1_mul(a, k, res));
+}
+
+static void test_pairing() {
+  uint8_t data[192 * 2];
+
+  // e(P, Q) * e(-P, Q) = 1
+  hex(G1 G2 G1_NEG G2, data);
+  TEST_ASSERT_EQUAL(1, bn254_pairing_check(data, 2));
+
+  // e(2P, Q) * e(-P, 2Q) = 1
+  hex(G1_2 G2 G1_NEG G2_2, data);
+  TEST_ASSERT_EQUAL(1, bn254_pairing_check(data, 2));
+
+  // e(3P, Q) * e(-P, 2Q) != 1
+  hex(G1_3 G2 G1_NEG G2_2, data);
+  TEST_ASSERT_EQUAL(0, bn254_pairing_check(data, 2));
+
+  // e(P, Q) != 1
+  TEST_ASSERT_EQUAL(0, bn254_pairing_check(data + 192, 1));
+
+  // the empty product is 1
+  TEST_ASSERT_EQUAL(1, bn254_pairing_check(data, 0));
+
+  // Q is not on the curve
+  data[192 + 191] ^= 1;
+  TEST_ASSERT_EQUAL(-1, bn254_pairing_check(data, 2));
+}
+
+static void test_bench() {
+  uint8_t a[64], k[32], res[64], data[192 * 2];
+  hex(G1, a);
+  hex(ORDER, k);
+  k[31]--;
+  hex(G1 G2 G1_NEG G2, data);
+  for (int i = 0; i < 100; i++) TEST_ASSERT_EQUAL(0, bn254_g1_mul(a, k, res));
+  for (int i = 0; i < 10; i++) TEST_ASSERT_EQUAL(1, bn254_pairing_check(data, 2));
+}
+
+static void test_bench_tommath() {
+  struct timeval begin, end;
+  uint8_t        a[64], b[64], k[32], res[64], tm_res[64];
+  double         t_add, t_add_tm, t_mul, t_mul_tm;
+  mp_int         m;
+  tm_point_t     p, q, r;
+  mp_init(&m);
+  hex(FIELD_P, k);
+  mp_import(&m, 32, 1, sizeof(uint8_t), 1, 0, k);
+  tm_init(&p);
+  tm_init(&q);
+  tm_init(&r);
+  hex(G1, a);
+  hex(G1_2, b);
+  hex(ORDER, k);
+  k[31]--;
+
+  TIMING_START();
+  for (int i = 0; i < 1000; i++) bn254_g1_add(a, b, res);
+  TIMING_END();
+  t_add = TIMING_GET() * 1000;
+  TIMING_START();
+  for (int i = 0; i < 1000; i++) {
+    tm_import(&p, a);
+    tm_import(&q, b);
+    tm_add(&r, &p, &q, &m);
+    tm_export(&r, tm_res);
+  }
+  TIMING_END();
+  t_add_tm = TIMING_GET() * 1000;
+  TEST_ASSERT_EQUAL_MEMORY(tm_res, res, 64);
+
+  TIMING_START();
+  for (int i = 0; i < 10; i++) bn254_g1_mul(a, k, res);
+  TIMING_END();
+  t_mul = TIMING_GET() * 100000;
+  TIMING_START();
+  for (int i = 0; i < 10; i++) {
+    tm_import(&p, a);
+    tm_mul(&r, &p, k, &m);
+    tm_export(&r, tm_res);
+  }
+  TIMING_END();
+  t_mul_tm = TIMING_GET() * 100000;
+  TEST_ASSERT_EQUAL_MEMORY(tm_res, res, 64);
+
+  TEST_LOG("g1_add %.1fus (tommath %.1fus), g1_mul %.1fus (tommath %.1fus)\n", t_add, t_add_tm, t_mul, t_mul_tm);
+  tm_clear(&p);
+  tm_clear(&q);
+  tm_clear(&r);
+  mp_clear(&m);
+}
+
+/*
+ * Main
+ */
+int main() {
+  struct timeval begin, end;
+  TESTS_BEGIN();
+  RUN_TEST(test_g1_add);
+  RUN_TEST(test_g1_mul);
+  RUN_TEST(test_pairing);
+  RUN_TIMED_TEST(test_bench);
+  RUN_TEST(test_bench_tommath);
+  return TESTS_END();
+}
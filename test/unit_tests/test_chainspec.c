@@ -0,0 +1,244 @@
+/*******************************************************************************
+ * This file is part of the Incubed project.
+ * Sources: https://github.com/slockit/in3-c
+ * 
+ * Copyright (C) 2018-2019 slock.it GmbH, Blockchains LLC
+ * 
+ * 
+ * COMMERCIAL LICENSE USAGE
+ * 
+ * Licensees holding a valid commercial license may use this file in accordance 
+ * with the commercial license agreement provided with the Software or, alternatively, 
+ * in accordance with the terms contained in a written agreement between you and 
+ * slock.it GmbH/Blockchains LLC. For licensing terms and conditions or further 
+ * information please contact slock.it at in3@slock.it.
+ * 	
+ * Alternatively, this file may be used under the AGPL license as follows:
+ *    
+ * AGPL LICENSE USAGE
+ * 
+ * This program is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Affero General Public License as published by the Free Software 
+ * Foundation, either version 3 of the License, or (at your option) any later version.
+ *  
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY 
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A 
+ * PARTICULAR PURPOSE. See the GNU Affero General Public License for more details.
+ * [Permissions of this strong copyleft license are conditioned on making available 
+ * complete source code of licensed works and modifications, which include larger 
+ * works using a licensed work, under the same license. Copyright and license notices 
+ * must be preserved. Contributors provide an express grant of patent rights.]
+ * You should have received a copy of the GNU Affero General Public License along 
+ * with this program. If not, see <https://www.gnu.org/licenses/>.
+ *******************************************************************************/
+
+#ifndef TEST
+#define TEST
+#endif
+#ifndef TEST
+#define DEBUG
+#endif
+
+#include "../../src/core/util/bytes.h"
+#include "../../src/core/util/data.h"
+#include "../../src/core/util/mem.h"
+#include "../../src/verifier/eth1/nano/chains.h"
+#include "../../src/verifier/eth1/nano/chainspec.h"
+#include "../../src/verifier/eth1/nano/rlp.h"
+#include "../test_utils.h"
+#include <string.h>
+
+// a aura-spec with the multi-validators in random order and eips activated at 50, 100 and 200
+#define AURA_SPEC "{\"params\":{\"networkID\":42,\"accountStartNonce\":0,"                                 \
+                  "\"eip155Transition\":50,\"eip140Transition\":100,\"eip658Transition\":100,"              \
+                  "\"eip145Transition\":200},"                                                              \
+                  "\"engine\":{\"authorityRound\":{\"params\":{\"validators\":{\"multi\":{"                 \
+                  "\"300\":{\"list\":[\"0x0000000000000000000000000000000000000003\"]},"                    \
+                  "\"0\":{\"list\":[\"0x0000000000000000000000000000000000000001\"]},"                      \
+                  "\"100\":{\"safeContract\":\"0x0000000000000000000000000000000000000002\"}}}}}},"         \
+                  "\"genesis\":{}}"
+
+static void free_spec(chainspec_t* spec) {
+  for (unsigned int i = 0; i < spec->consensus_transitions_len; i++) {
+    if (spec->consensus_transitions[i].validators.data) _free(spec->consensus_transitions[i].validators.data);
+    if (spec->consensus_transitions[i].contract) _free(spec->consensus_transitions[i].contract);
+  }
+  _free(spec->consensus_transitions);
+  _free(spec->eip_transitions);
+  _free(spec);
+}
+
+static chainspec_t* create_spec(json_ctx_t** ctx) {
+  *ctx = parse_json(AURA_SPEC);
+  TEST_ASSERT_NOT_NULL(*ctx);
+  return chainspec_create_from_json((*ctx)->result);
+}
+
+// checks the transitions of the spec at, right before and past the transition blocks
+static void check_spec(chainspec_t* spec) {
+  TEST_ASSERT_EQUAL(4, spec->eip_transitions_len);
+  TEST_ASSERT_FALSE(chainspec_get_eip(spec, 0).eip155);
+  TEST_ASSERT_FALSE(chainspec_get_eip(spec, 49).eip155);
+  TEST_ASSERT_TRUE(chainspec_get_eip(spec, 50).eip155);
+  TEST_ASSERT_FALSE(chainspec_get_eip(spec, 99).eip140);
+  TEST_ASSERT_TRUE(chainspec_get_eip(spec, 100).eip140);
+  TEST_ASSERT_TRUE(chainspec_get_eip(spec, 100).eip658);
+  TEST_ASSERT_FALSE(chainspec_get_eip(spec, 199).eip145);
+  TEST_ASSERT_TRUE(chainspec_get_eip(spec, 200).eip145);
+  TEST_ASSERT_TRUE(chainspec_get_eip(spec, 0xFFFFFFFFFFFFFFFFULL).eip145);
+  TEST_ASSERT_TRUE(chainspec_get_eip(spec, 0xFFFFFFFFFFFFFFFFULL).eip155);
+
+  // the multi-validators must be sorted by block
+  TEST_ASSERT_EQUAL(3, spec->consensus_transitions_len);
+  for (unsigned int i = 0; i < spec->consensus_transitions_len; i++) TEST_ASSERT_EQUAL(ETH_POA_AURA, spec->consensus_transitions[i].type);
+  TEST_ASSERT_EQUAL(0, spec->consensus_transitions[0].transition_block);
+  TEST_ASSERT_EQUAL(100, spec->consensus_transitions[1].transition_block);
+  TEST_ASSERT_EQUAL(300, spec->consensus_transitions[2].transition_block);
+  TEST_ASSERT_EQUAL(20, spec->consensus_transitions[0].validators.len);
+  TEST_ASSERT_EQUAL(1, spec->consensus_transitions[0].validators.data[19]);
+  TEST_ASSERT_NULL(spec->consensus_transitions[0].contract);
+  TEST_ASSERT_EQUAL(0, spec->consensus_transitions[1].validators.len);
+  TEST_ASSERT_EQUAL(2, spec->consensus_transitions[1].contract[19]);
+  TEST_ASSERT_EQUAL(20, spec->consensus_transitions[2].validators.len);
+  TEST_ASSERT_EQUAL(3, spec->consensus_transitions[2].validators.data[19]);
+
+  TEST_ASSERT_EQUAL_PTR(spec->consensus_transitions, chainspec_get_consensus(spec, 0));
+  TEST_ASSERT_EQUAL_PTR(spec->consensus_transitions, chainspec_get_consensus(spec, 99));
+  TEST_ASSERT_EQUAL_PTR(spec->consensus_transitions + 1, chainspec_get_consensus(spec, 100));
+  TEST_ASSERT_EQUAL_PTR(spec->consensus_transitions + 1, chainspec_get_consensus(spec, 299));
+  TEST_ASSERT_EQUAL_PTR(spec->consensus_transitions + 2, chainspec_get_consensus(spec, 300));
+  TEST_ASSERT_EQUAL_PTR(spec->consensus_transitions + 2, chainspec_get_consensus(spec, 0xFFFFFFFFFFFFFFFFULL));
+}
+
+static void test_chainspec_json() {
+  json_ctx_t*  ctx  = NULL;
+  chainspec_t* spec = create_spec(&ctx);
+  TEST_ASSERT_NOT_NULL(spec);
+  TEST_ASSERT_EQUAL(42, spec->network_id);
+  check_spec(spec);
+  free_spec(spec);
+  json_free(ctx);
+}
+
+static void test_chainspec_bin() {
+  json_ctx_t*      ctx  = NULL;
+  chainspec_t*     spec = create_spec(&ctx);
+  bytes_builder_t* bb   = bb_new();
+  TEST_ASSERT_EQUAL(IN3_OK, chainspec_to_bin(spec, bb));
+  free_spec(spec);
+  json_free(ctx);
+
+  // the decoded spec points to the raw data, so we keep it until the spec is freed.
+  spec = chainspec_from_bin(bb->b.data);
+  TEST_ASSERT_NOT_NULL(spec);
+  TEST_ASSERT_EQUAL(42, spec->network_id);
+  check_spec(spec);
+  _free(spec);
+  bb_free(bb);
+}
+
+static void test_chainspec_builtin() {
+  // we decode the snapshot directly, since chainspec_get would keep the spec in its cache.
+  chainspec_t* spec = chainspec_from_bin(CHAINSPEC_KOVAN);
+  TEST_ASSERT_NOT_NULL(spec);
+  TEST_ASSERT_EQUAL(0x2a, spec->network_id);
+  TEST_ASSERT_TRUE(spec->eip_transitions_len > 1);
+  TEST_ASSERT_TRUE(spec->consensus_transitions_len > 1);
+
+  for (unsigned int i = 1; i < spec->eip_transitions_len; i++) {
+    const uint64_t block = spec->eip_transitions[i].transition_block;
+    eip_t          eip   = chainspec_get_eip(spec, block);
+    TEST_ASSERT_EQUAL_MEMORY(&spec->eip_transitions[i].eips, &eip, sizeof(eip_t));
+    eip = chainspec_get_eip(spec, block - 1);
+    TEST_ASSERT_EQUAL_MEMORY(&spec->eip_transitions[i - 1].eips, &eip, sizeof(eip_t));
+  }
+  eip_t eip = chainspec_get_eip(spec, 0xFFFFFFFFFFFFFFFFULL);
+  TEST_ASSERT_EQUAL_MEMORY(&spec->eip_transitions[spec->eip_transitions_len - 1].eips, &eip, sizeof(eip_t));
+
+  for (unsigned int i = 1; i < spec->consensus_transitions_len; i++) {
+    const uint64_t block = spec->consensus_transitions[i].transition_block;
+    TEST_ASSERT_EQUAL_PTR(spec->consensus_transitions + i, chainspec_get_consensus(spec, block));
+    TEST_ASSERT_EQUAL_PTR(spec->consensus_transitions + i - 1, chainspec_get_consensus(spec, block - 1));
+  }
+  TEST_ASSERT_EQUAL_PTR(spec->consensus_transitions + spec->consensus_transitions_len - 1, chainspec_get_consensus(spec, 0xFFFFFFFFFFFFFFFFULL));
+  _free(spec);
+}
+
+static void add_byte(bytes_builder_t* bb, uint8_t val) {
+  bytes_t tmp = {.data = &val, .len = val ? 1 : 0};
+  rlp_encode_item(bb, &tmp);
+}
+
+/** creates a spec with one eip- and one consensus-transition, where the eips have the given length and the validators may be a list instead of an item. */
+static bytes_builder_t* create_bin(uint8_t version, uint32_t eip_len, bool validators_as_list) {
+  bytes_builder_t* bb    = bb_new();
+  bytes_builder_t* list  = bb_new();
+  bytes_builder_t* inner = bb_new();
+  uint8_t          eips[sizeof(eip_t)];
+  bytes_t          tmp = {.data = eips, .len = eip_len};
+  memset(eips, 0, sizeof(eips));
+
+  add_byte(bb, version);
+  add_byte(bb, 0x2a);
+  add_byte(bb, 0);
+  add_byte(list, 0);
+  rlp_encode_item(list, &tmp);
+  rlp_encode_list(bb, &list->b);
+
+  bb_clear(list);
+  add_byte(list, 0);
+  add_byte(list, ETH_POA_AURA);
+  add_byte(inner, 1);
+  if (validators_as_list)
+    rlp_encode_list(list, &inner->b);
+  else
+    rlp_encode_item(list, &inner->b);
+  add_byte(list, 0);
+  rlp_encode_list(bb, &list->b);
+  rlp_encode_to_list(bb);
+
+  bb_free(inner);
+  bb_free(list);
+  return bb;
+}
+
+static void test_chainspec_bin_errors() {
+  const int        mem = mem_stack_size();
+  bytes_builder_t* bb  = create_bin(1, sizeof(eip_t), false);
+  chainspec_t*     spec = chainspec_from_bin(bb->b.data);
+  TEST_ASSERT_NOT_NULL(spec);
+  TEST_ASSERT_EQUAL(1, spec->eip_transitions_len);
+  TEST_ASSERT_EQUAL(1, spec->consensus_transitions_len);
+  _free(spec);
+  bb_free(bb);
+
+  // invalid version is detected before anything is allocated
+  bb = create_bin(2, sizeof(eip_t), false);
+  TEST_ASSERT_NULL(chainspec_from_bin(bb->b.data));
+  bb_free(bb);
+
+  // the eips are too short, which fails after the spec was allocated
+  bb = create_bin(1, sizeof(eip_t) - 1, false);
+  TEST_ASSERT_NULL(chainspec_from_bin(bb->b.data));
+  bb_free(bb);
+
+  // validators are a list, which fails within the consensus-transitions
+  bb = create_bin(1, sizeof(eip_t), true);
+  TEST_ASSERT_NULL(chainspec_from_bin(bb->b.data));
+  bb_free(bb);
+
+  // the partial specs must be freed
+  TEST_ASSERT_EQUAL(mem, mem_stack_size());
+}
+
+/*
+ * Main
+ */
+int main() {
+  TESTS_BEGIN();
+  RUN_TEST(test_chainspec_json);
+  RUN_TEST(test_chainspec_bin);
+  RUN_TEST(test_chainspec_builtin);
+  RUN_TEST(test_chainspec_bin_errors);
+  return TESTS_END();
+}
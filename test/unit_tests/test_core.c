@@ -45,6 +45,7 @@
 #include "../../src/core/util/data.h"
 #include "../../src/core/util/debug.h"
 #include "../../src/core/util/utils.h"
+#include "../../src/third-party/crypto/sha3.h"
 #include "../../src/verifier/eth1/nano/eth_nano.h"
 #include "../test_utils.h"
 #include <stdio.h>
@@ -139,6 +140,97 @@ static void test_utils() {
   TEST_ASSERT_TRUE(memiszero(mem, 20));
 }
 
+/** known hashes of the bytes i * 7 with lengths around the block size of 136 bytes. */
+static const struct {
+  int         len;
+  const char* hash;
+} sha3_vectors[] = {
+    {0, "c5d2460186f7233c927e7db2dcc703c0e500b653ca82273b7bfad8045d85a470"},
+    {135, "154f5dc27520a599653a2b10189cf53f5ce03b7c594d11fd98f67012ea304b6c"},
+    {136, "81e7ecb492d033f1692e770a6eb874e70aac45ec10da93483fc8d3537805c097"},
+    {137, "a595973359b39ba1fec5cf8f40710c5a213e76281dd4f174f1ea83106ee7759b"},
+    {272, "99d5a295c114ab3f94028d25825ea798399dacfc613f0193fb32c3c4973f1777"},
+    {300, "e8d0c605aa90a1fe3feb493ad761f5313ddd79b377b06ed215e8c883341c33ae"}};
+#define SHA3_VECTORS (int) (sizeof(sha3_vectors) / sizeof(sha3_vectors[0]))
+
+static void test_sha3_vectors() {
+  uint8_t data[300], hashes[SHA3_VECTORS * 32], expected[SHA3_VECTORS * 32];
+  bytes_t msgs[SHA3_VECTORS], *ptrs[SHA3_VECTORS];
+  for (int i = 0; i < 300; i++) data[i] = i * 7;
+  for (int i = 0; i < SHA3_VECTORS; i++) {
+    hex_to_bytes(sha3_vectors[i].hash, 64, expected + i * 32, 32);
+    msgs[i] = bytes(data, sha3_vectors[i].len);
+    ptrs[i] = msgs + i;
+    sha3_to(msgs + i, hashes);
+    TEST_ASSERT_EQUAL_MEMORY(expected + i * 32, hashes, 32);
+  }
+
+  // all messages at once, so the lanes of the parallel hashing get different lengths
+  sha3_many(ptrs, SHA3_VECTORS, hashes);
+  TEST_ASSERT_EQUAL_MEMORY(expected, hashes, SHA3_VECTORS * 32);
+
+#if KECCAK_X4
+  // unused lanes are passed as NULL
+  for (int unused = 0; unused < 4; unused++) {
+    const unsigned char* in[4];
+    unsigned char*       out[4];
+    size_t               len[4];
+    memset(hashes, 0, sizeof(hashes));
+    for (int i = 0; i < 4; i++) {
+      int v  = (i + 2) % SHA3_VECTORS;
+      in[i]  = i == unused ? NULL : data;
+      len[i] = i == unused ? 0 : (size_t) sha3_vectors[v].len;
+      out[i] = i == unused ? NULL : hashes + i * 32;
+    }
+    keccak_256_x4(in, len, out);
+    for (int i = 0; i < 4; i++) {
+      if (i != unused) TEST_ASSERT_EQUAL_MEMORY(expected + ((i + 2) % SHA3_VECTORS) * 32, hashes + i * 32, 32);
+    }
+  }
+#endif
+}
+
+static void test_sha3_many() {
+  // lengths around the block size of 136 bytes, including empty messages
+  int      lens[] = {0, 1, 32, 135, 136, 137, 271, 272, 532, 64, 0, 300, 33};
+  int      n      = sizeof(lens) / sizeof(int);
+  uint8_t  data[600], hashes[13 * 32], expected[32];
+  bytes_t  msgs[13], *ptrs[13];
+  for (int i = 0; i < 600; i++) data[i] = i * 7;
+  for (int l = 1; l <= n; l++) {
+    for (int i = 0; i < l; i++) {
+      msgs[i] = bytes(data + i, lens[i]);
+      ptrs[i] = msgs + i;
+    }
+    sha3_many(ptrs, l, hashes);
+    for (int i = 0; i < l; i++) {
+      sha3_to(msgs + i, expected);
+      TEST_ASSERT_EQUAL_MEMORY(expected, hashes + i * 32, 32);
+    }
+  }
+}
+
+static void test_sha3_speed() {
+  // known hash of an empty message
+  uint8_t data[4096], hash[32];
+  bytes_t b = bytes(data, 0);
+  sha3_to(&b, hash);
+  TEST_ASSERT_EQUAL_MEMORY("\xc5\xd2\x46\x01\x86\xf7\x23\x3c\x92\x7e\x7d\xb2\xdc\xc7\x03\xc0\xe5\x00\xb6\x53\xca\x82\x27\x3b\x7b\xfa\xd8\x04\x5d\x85\xa4\x70", hash, 32);
+
+  // short messages like trie nodes and public keys and long messages
+  int            sizes[] = {64, 532, 4096};
+  struct timeval begin, end;
+  memset(data, 0xAB, sizeof(data));
+  for (int s = 0; s < 3; s++) {
+    int n = (1 << 22) / sizes[s];
+    b     = bytes(data, sizes[s]);
+    TIMING_START();
+    for (int i = 0; i < n; i++) sha3_to(&b, hash);
+    TIMING_END();
+    TEST_LOG("keccak256 of %4i bytes: %.1f MB/s\n", sizes[s], (double) n * sizes[s] / TIMING_GET() / 1000000);
+  }
+}
+
 /*
  * Main
  */
@@ -152,5 +244,8 @@ int main() {
   RUN_TEST(test_json);
   RUN_TEST(test_str_replace);
   RUN_TEST(test_utils);
+  RUN_TEST(test_sha3_vectors);
+  RUN_TEST(test_sha3_many);
+  RUN_TEST(test_sha3_speed);
   return TESTS_END();
 }
@@ -0,0 +1,175 @@
+/*******************************************************************************
+ * This file is part of the Incubed project.
+ * Sources: https://github.com/slockit/in3-c
+ * 
+ * Copyright (C) 2018-2019 slock.it GmbH, Blockchains LLC
+ * 
+ * 
+ * COMMERCIAL LICENSE USAGE
+ * 
+ * Licensees holding a valid commercial license may use this file in accordance 
+ * with the commercial license agreement provided with the Software or, alternatively, 
+ * in accordance with the terms contained in a written agreement between you and 
+ * slock.it GmbH/Blockchains LLC. For licensing terms and conditions or further 
+ * information please contact slock.it at in3@slock.it.
+ * 	
+ * Alternatively, this file may be used under the AGPL license as follows:
+ *    
+ * AGPL LICENSE USAGE
+ * 
+ * This program is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Affero General Public License as published by the Free Software 
+ * Foundation, either version 3 of the License, or (at your option) any later version.
+ *  
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY 
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A 
+ * PARTICULAR PURPOSE. See the GNU Affero General Public License for more details.
+ * [Permissions of this strong copyleft license are conditioned on making available 
+ * complete source code of licensed works and modifications, which include larger 
+ * works using a licensed work, under the same license. Copyright and license notices 
+ * must be preserved. Contributors provide an express grant of patent rights.]
+ * You should have received a copy of the GNU Affero General Public License along 
+ * with this program. If not, see <https://www.gnu.org/licenses/>.
+ *******************************************************************************/
+
+#ifndef TEST
+#define TEST
+#endif
+#ifndef TEST
+#define DEBUG
+#endif
+
+#include "../../src/third-party/crypto/ecdsa.h"
+#include "../../src/third-party/crypto/secp256k1.h"
+#include "../../src/verifier/eth1/nano/ecrecover.h"
+#include "../test_utils.h"
+#include <string.h>
+
+#define ROUNDS 200
+
+static uint64_t seed = 0x9E3779B97F4A7C15ULL;
+
+static uint64_t next_rand() {
+  seed ^= seed << 13;
+  seed ^= seed >> 7;
+  seed ^= seed << 17;
+  return seed;
+}
+
+static void random_bytes(uint8_t* dst, int len) {
+  for (int i = 0; i < len; i++) dst[i] = next_rand() & 0xFF;
+}
+
+/** recovers the signature with both implementations and compares the results. */
+static void check_recover(const uint8_t* sig, int recid, const uint8_t* hash) {
+  uint8_t expected[65], pub[65];
+  int     res = ecdsa_recover_pub_from_sig(&secp256k1, expected, sig, hash, recid);
+  TEST_ASSERT_EQUAL(res, ecrecover_pub(sig, recid, hash, pub));
+  if (!res) TEST_ASSERT_EQUAL_MEMORY(expected, pub, 65);
+}
+
+static void test_ecrecover_signed() {
+  uint8_t pk[32], hash[32], sig[64], recid, pub[65], expected[65];
+  for (int i = 0; i < ROUNDS; i++) {
+    random_bytes(pk, 32);
+    random_bytes(hash, 32);
+    TEST_ASSERT_EQUAL(0, ecdsa_sign_digest(&secp256k1, pk, hash, sig, &recid, NULL));
+    ecdsa_get_public_key65(&secp256k1, pk, expected);
+    TEST_ASSERT_EQUAL(0, ecrecover_pub(sig, recid, hash, pub));
+    TEST_ASSERT_EQUAL_MEMORY(expected, pub, 65);
+  }
+}
+
+static void test_ecrecover_edge_cases() {
+  uint8_t sig[64], hash[32];
+  // random r and s, which are only a valid point for about half of them
+  for (int i = 0; i < ROUNDS; i++) {
+    random_bytes(sig, 64);
+    random_bytes(hash, 32);
+    check_recover(sig, next_rand() & 3, hash);
+  }
+
+  // r and s close to 0 and n, hashes of 0 and above n
+  static const uint8_t n_minus_1[32] = {0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFE,
+                                        0xBA, 0xAE, 0xDC, 0xE6, 0xAF, 0x48, 0xA0, 0x3B, 0xBF, 0xD2, 0x5E, 0x8C, 0xD0, 0x36, 0x41, 0x40};
+  uint8_t              values[5][32];
+  memset(values, 0, sizeof(values));
+  values[1][31] = 1;
+  memcpy(values[2], n_minus_1, 32);
+  memcpy(values[3], n_minus_1, 32);
+  values[3][31]++; // n
+  memset(values[4], 0xFF, 32);
+  for (int r = 0; r < 5; r++) {
+    for (int s = 0; s < 5; s++) {
+      for (int h = 0; h < 5; h++) {
+        memcpy(sig, values[r], 32);
+        memcpy(sig + 32, values[s], 32);
+        for (int recid = 0; recid < 4; recid++) check_recover(sig, recid, values[h]);
+      }
+    }
+  }
+
+  // small r with recid 2 and 3 (x = r + n)
+  memset(sig, 0, 64);
+  for (int i = 0; i < 64; i++) {
+    sig[31] = i + 1;
+    sig[63] = i + 7;
+    check_recover(sig, 2 + (i & 1), values[2]);
+  }
+}
+
+static void test_ecrecover_batch() {
+  uint8_t     pk[32], hashes[20][32], sigs[20][64], recid, expected[20][65];
+  ecrecover_t batch[20];
+  for (int n = 1; n <= 20; n++) {
+    for (int i = 0; i < n; i++) {
+      random_bytes(pk, 32);
+      random_bytes(hashes[i], 32);
+      ecdsa_sign_digest(&secp256k1, pk, hashes[i], sigs[i], &recid, NULL);
+      ecdsa_get_public_key65(&secp256k1, pk, expected[i]);
+      batch[i] = (ecrecover_t){.sig = sigs[i], .hash = hashes[i], .recid = recid};
+      // every third signature is invalid
+      if (i % 3 == 1) memset(sigs[i], 0, 32);
+    }
+    ecrecover_pub_batch(batch, n);
+    for (int i = 0; i < n; i++) {
+      TEST_ASSERT_EQUAL(i % 3 == 1, batch[i].res);
+      if (!batch[i].res) TEST_ASSERT_EQUAL_MEMORY(expected[i], batch[i].pub, 65);
+    }
+  }
+}
+
+static void test_ecrecover_speed() {
+  uint8_t        pk[32], hash[32], sig[64], recid, pub[65];
+  struct timeval begin, end;
+  ecrecover_t    batch[64];
+  random_bytes(pk, 32);
+  random_bytes(hash, 32);
+  ecdsa_sign_digest(&secp256k1, pk, hash, sig, &recid, NULL);
+  for (int i = 0; i < 64; i++) batch[i] = (ecrecover_t){.sig = sig, .hash = hash, .recid = recid};
+
+  TIMING_START();
+  for (int i = 0; i < 64; i++) ecdsa_recover_pub_from_sig(&secp256k1, pub, sig, hash, recid);
+  TIMING_END();
+  TEST_LOG("trezor-crypto : %.1f us\n", TIMING_GET() * 1000000 / 64);
+  TIMING_START();
+  for (int i = 0; i < 64; i++) ecrecover_pub(sig, recid, hash, pub);
+  TIMING_END();
+  TEST_LOG("ecrecover_pub : %.1f us\n", TIMING_GET() * 1000000 / 64);
+  TIMING_START();
+  ecrecover_pub_batch(batch, 64);
+  TIMING_END();
+  TEST_LOG("batch of 64   : %.1f us\n", TIMING_GET() * 1000000 / 64);
+}
+
+/*
+ * Main
+ */
+int main() {
+  TESTS_BEGIN();
+  RUN_TEST(test_ecrecover_signed);
+  RUN_TEST(test_ecrecover_edge_cases);
+  RUN_TEST(test_ecrecover_batch);
+  RUN_TEST(test_ecrecover_speed);
+  return TESTS_END();
+}
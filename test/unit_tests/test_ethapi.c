@@ -83,6 +83,32 @@ static void test_get_balance() {
   in3_free(in3);
 }
 
+static in3_t* get_balance_cached() {
+  in3_t*    in3 = init_in3(mock_transport, 0x5);
+  address_t account;
+  hex_to_bytes("0xF99dbd3CFc292b11F74DeEa9fa730825Ee0b56f2", -1, account, 20);
+  TEST_ASSERT_TRUE(as_double(eth_getBalance(in3, account, BLKNUM(1555415))) > 0.0);
+  return in3;
+}
+
+static void test_node_cache_resize() {
+  in3_t* in3 = get_balance_cached();
+  int    mem = mem_stack_size();
+  in3_free(in3);
+  const int freed = mem - mem_stack_size();
+
+  in3                = get_balance_cached();
+  in3_chain_t* chain = in3_find_chain(in3, 0x5);
+  TEST_ASSERT_NOT_NULL(chain->cached_nodes);
+  TEST_ASSERT_EQUAL(64, chain->cached_nodes_len);
+
+  // a smaller limit after the cache was allocated must still free all its entries
+  in3->max_cached_nodes = 1;
+  mem                   = mem_stack_size();
+  in3_free(in3);
+  TEST_ASSERT_EQUAL(freed, mem - mem_stack_size());
+}
+
 static void test_get_tx_count() {
   in3_t* in3 = init_in3(mock_transport, 0x5);
 
@@ -589,6 +615,7 @@ int main() {
   RUN_TEST(test_eth_chain_id);
   RUN_TEST(test_eth_get_storage_at);
   RUN_TEST(test_get_balance);
+  RUN_TEST(test_node_cache_resize);
   RUN_TEST(test_block_number);
   RUN_TEST(test_eth_gas_price);
   RUN_TEST(test_eth_getblock_number);
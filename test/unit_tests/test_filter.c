@@ -41,13 +41,16 @@
 
 #include "../../src/core/client/cache.h"
 #include "../../src/core/client/context.h"
+#include "../../src/core/client/keys.h"
 #include "../../src/core/client/nodelist.h"
 #include "../../src/core/util/data.h"
 #include "../../src/core/util/log.h"
+#include "../../src/api/eth1/eth_api.h"
 #include "../../src/verifier/eth1/basic/eth_basic.h"
 #include "../../src/verifier/eth1/basic/filter.h"
 #include "../test_utils.h"
 #include "../util/transport.h"
+#include <inttypes.h>
 #include <stdio.h>
 #include <unistd.h>
 
@@ -58,17 +61,21 @@
     _free(opt);                                               \
   } while (0)
 
-static void test_filter() {
-
+/** creates a client without nodelist updates, which sends each request once with the given transport. */
+static in3_t* new_client(chain_id_t chain_id, in3_transport_send transport, in3_proof_t proof) {
   in3_register_eth_basic();
-
-  in3_t* c            = in3_for_chain(ETH_CHAIN_ID_MAINNET);
-  c->transport        = test_transport;
+  in3_t* c            = in3_for_chain(chain_id);
+  c->transport        = transport;
   c->auto_update_list = false;
-  c->proof            = PROOF_NONE;
+  c->proof            = proof;
   c->signature_count  = 0;
-
+  c->max_attempts     = 1;
   for (int i = 0; i < c->chains_length; i++) c->chains[i].nodelist_upd8_params = NULL;
+  return c;
+}
+
+static void test_filter() {
+  in3_t* c = new_client(ETH_CHAIN_ID_MAINNET, test_transport, PROOF_NONE);
 
   char *result = NULL, *error = NULL;
   add_response("eth_blockNumber", "[]", "\"0x84cf52\"", NULL, NULL);
@@ -182,15 +189,7 @@ static void test_filter_from_block_manip() {
 }
 
 static void test_filter_creation() {
-  in3_register_eth_basic();
-
-  in3_t* c            = in3_for_chain(ETH_CHAIN_ID_MAINNET);
-  c->transport        = test_transport;
-  c->auto_update_list = false;
-  c->proof            = PROOF_NONE;
-  c->signature_count  = 0;
-
-  for (int i = 0; i < c->chains_length; i++) c->chains[i].nodelist_upd8_params = NULL;
+  in3_t* c = new_client(ETH_CHAIN_ID_MAINNET, test_transport, PROOF_NONE);
 
   TEST_ASSERT_FALSE(filter_remove(c, 1));
   TEST_ASSERT_EQUAL(IN3_EINVAL, filter_add(c, FILTER_EVENT, NULL));
@@ -209,15 +208,7 @@ static void test_filter_creation() {
 }
 
 static void test_filter_changes() {
-  in3_register_eth_basic();
-
-  in3_t* c            = in3_for_chain(ETH_CHAIN_ID_MAINNET);
-  c->transport        = test_transport;
-  c->auto_update_list = false;
-  c->proof            = PROOF_NONE;
-  c->signature_count  = 0;
-
-  for (int i = 0; i < c->chains_length; i++) c->chains[i].nodelist_upd8_params = NULL;
+  in3_t* c = new_client(ETH_CHAIN_ID_MAINNET, test_transport, PROOF_NONE);
 
   in3_ctx_t* ctx = ctx_new(c, "{\"method\":\"eth_getBlockByNumber\",\"params\":[\"latest\",false]}");
   TEST_ASSERT_EQUAL(IN3_EUNKNOWN, filter_get_changes(ctx, 1, NULL));
@@ -282,6 +273,288 @@ static void test_filter_changes() {
   in3_free(c);
 }
 
+static uint64_t logs_max_range = 700;
+static int      logs_batches   = 0;
+
+// serves eth_getLogs-batches with 2 logs per request (for the first and the last block) and fails for ranges above logs_max_range. The latest block is 0x84cf52.
+static in3_ret_t logs_transport(in3_request_t* req) {
+  json_ctx_t* r  = parse_json(req->payload);
+  sb_t*       sb = &req->results->result;
+  logs_batches++;
+  sb_add_char(sb, '[');
+  for (d_iterator_t it = d_iter(r->result); it.left; d_iter_next(&it)) {
+    d_token_t* opt  = d_get_at(d_get(it.token, key("params")), 0);
+    uint64_t   from = d_get_longk(opt, K_FROM_BLOCK), to = d_get_longk(opt, K_TO_BLOCK);
+    char       res[300];
+    if (!strcmp(d_get_stringk(it.token, K_METHOD), "eth_blockNumber"))
+      sprintf(res, "{\"id\":%i,\"jsonrpc\":\"2.0\",\"result\":\"0x84cf52\"}", d_get_intk(it.token, K_ID));
+    else if (to - from >= logs_max_range)
+      sprintf(res, "{\"id\":%i,\"jsonrpc\":\"2.0\",\"error\":{\"code\":-32005,\"message\":\"query returned more than 10000 results\"}}", d_get_intk(it.token, K_ID));
+    else
+      sprintf(res, "{\"id\":%i,\"jsonrpc\":\"2.0\",\"result\":[{\"blockNumber\":\"0x%" PRIx64 "\"},{\"blockNumber\":\"0x%" PRIx64 "\"}]}", d_get_intk(it.token, K_ID), from, to);
+    if (sb->data[sb->len - 1] != '[') sb_add_char(sb, ',');
+    sb_add_chars(sb, res);
+  }
+  sb_add_char(sb, ']');
+  json_free(r);
+  return IN3_OK;
+}
+
+typedef struct {
+  uint64_t next;
+  int      chunks;
+} logs_range_t;
+
+static in3_ret_t check_chunk(void* data, d_token_t* logs) {
+  logs_range_t* range = data;
+  TEST_ASSERT_EQUAL(2, d_len(logs));
+  TEST_ASSERT_EQUAL_UINT64(range->next, d_get_longk(d_get_at(logs, 0), K_BLOCK_NUMBER));
+  range->next = d_get_longk(d_get_at(logs, 1), K_BLOCK_NUMBER) + 1;
+  range->chunks++;
+  return IN3_OK;
+}
+
+static void test_filter_logs_chunked() {
+  in3_t* c = new_client(ETH_CHAIN_ID_MAINNET, logs_transport, PROOF_NONE);
+
+  // the whole range is passed on in order, although the node only serves 700 blocks
+  logs_range_t range = {.next = 0x84c000, .chunks = 0};
+  char*        fopt  = "{\"fromBlock\":\"0x84c000\",\"toBlock\":\"0x84e70f\",\"address\":\"0xF0AD5cAd05e10572EfcEB849f6Ff0c68f9700455\"}";
+  TEST_ASSERT_EQUAL(IN3_OK, filter_get_logs(c, fopt, 0x84cf52, check_chunk, &range, NULL));
+  TEST_ASSERT_EQUAL_UINT64(0x84e710, range.next);
+  TEST_ASSERT_GREATER_THAN(10000 / 700, range.chunks);
+
+  // latest is used as upper bound
+  range = (logs_range_t){.next = 0x84c000, .chunks = 0};
+  fopt  = "{\"fromBlock\":\"0x84c000\",\"address\":\"0xF0AD5cAd05e10572EfcEB849f6Ff0c68f9700455\"}";
+  TEST_ASSERT_EQUAL(IN3_OK, filter_get_logs(c, fopt, 0x84cf52, check_chunk, &range, NULL));
+  TEST_ASSERT_EQUAL_UINT64(0x84cf53, range.next);
+
+  // a node serving only single blocks fails
+  logs_max_range = 0;
+  logs_batches   = 0;
+  char* error    = NULL;
+  range          = (logs_range_t){.next = 0x84c000, .chunks = 0};
+  TEST_ASSERT_NOT_EQUAL(IN3_OK, filter_get_logs(c, fopt, 0x84cf52, check_chunk, &range, &error));
+  TEST_ASSERT_EQUAL(0, range.chunks);
+  TEST_ASSERT_EQUAL(11, logs_batches); // 2000 -> 1000 -> .. -> 1 blocks
+  _free(error);
+  logs_max_range = 700;
+
+  in3_free(c);
+}
+
+static in3_ret_t free_chunk(void* data, eth_log_t* logs) {
+  int* chunks = data;
+  (*chunks)++;
+  for (eth_log_t* next; logs; logs = next) {
+    next = logs->next;
+    log_free(logs);
+  }
+  return IN3_OK;
+}
+
+static void test_filter_logs_with_api() {
+  in3_register_eth_api();
+
+  in3_t* c = new_client(ETH_CHAIN_ID_MAINNET, logs_transport, PROOF_NONE);
+
+  // the batches are sent as they are and the missing toBlock is resolved with eth_blockNumber
+  char*      fopt  = "{\"fromBlock\":\"0x84c000\",\"address\":\"0xF0AD5cAd05e10572EfcEB849f6Ff0c68f9700455\"}";
+  eth_log_t* logs  = eth_getLogs(c, fopt);
+  uint64_t   next  = 0x84c000;
+  int        count = 0;
+  TEST_ASSERT_NOT_NULL_MESSAGE(logs, eth_last_error());
+  for (eth_log_t* l = logs; l; l = l->next, count++) {
+    // each chunk has a log for its first and its last block
+    if (count % 2)
+      next = l->block_number + 1;
+    else
+      TEST_ASSERT_EQUAL_UINT64(next, l->block_number);
+  }
+  TEST_ASSERT_EQUAL_UINT64(0x84cf53, next);
+  TEST_ASSERT_GREATER_THAN(2 * (0xf53 / 700), count);
+  free_chunk(&count, logs);
+
+  // each chunk is passed on and freed by the callback
+  int chunks = 0;
+  TEST_ASSERT_EQUAL(IN3_OK, eth_streamLogs(c, fopt, free_chunk, &chunks));
+  TEST_ASSERT_EQUAL(count / 2, chunks);
+
+  in3_free(c);
+}
+
+static json_ctx_t* recorded_logs = NULL;
+
+// serves eth_getLogs-batches with the recorded logs and proofs of the blocks within the requested range.
+static in3_ret_t recorded_logs_transport(in3_request_t* req) {
+  json_ctx_t* r        = parse_json(req->payload);
+  d_token_t*  response = d_get_at(d_get(d_get_at(recorded_logs->result, 0), key("response")), 0);
+  d_token_t*  proofs   = d_get(d_get(d_get(response, K_IN3), K_PROOF), K_LOG_PROOF);
+  sb_t*       sb       = &req->results->result;
+  char        tmp[100];
+  sb_add_char(sb, '[');
+  for (d_iterator_t it = d_iter(r->result); it.left; d_iter_next(&it)) {
+    d_token_t* opt  = d_get_at(d_get(it.token, key("params")), 0);
+    uint64_t   from = d_get_longk(opt, K_FROM_BLOCK), to = d_get_longk(opt, K_TO_BLOCK);
+    sprintf(tmp, "%s{\"id\":%i,\"jsonrpc\":\"2.0\",\"result\":[", sb->len > 1 ? "," : "", d_get_intk(it.token, K_ID));
+    sb_add_chars(sb, tmp);
+    for (d_iterator_t l = d_iter(d_get(response, K_RESULT)); l.left; d_iter_next(&l)) {
+      if (d_get_longk(l.token, K_BLOCK_NUMBER) < from || d_get_longk(l.token, K_BLOCK_NUMBER) > to) continue;
+      char* json = d_create_json(l.token);
+      if (sb->data[sb->len - 1] != '[') sb_add_char(sb, ',');
+      sb_add_chars(sb, json);
+      _free(json);
+    }
+    sb_add_chars(sb, "],\"in3\":{\"proof\":{\"type\":\"logProof\",\"logProof\":{");
+    for (d_iterator_t p = d_iter(proofs); p.left; d_iter_next(&p)) {
+      char* block = d_get_keystr(p.token->key);
+      if (strtoull(block, NULL, 16) < from || strtoull(block, NULL, 16) > to) continue;
+      char* json = d_create_json(p.token);
+      if (sb->data[sb->len - 1] != '{') sb_add_char(sb, ',');
+      sprintf(tmp, "\"%s\":", block);
+      sb_add_chars(sb_add_chars(sb, tmp), json);
+      _free(json);
+    }
+    sb_add_chars(sb, "}}}}");
+  }
+  sb_add_char(sb, ']');
+  json_free(r);
+  return IN3_OK;
+}
+
+static in3_ret_t count_logs(void* data, d_token_t* logs) {
+  *((int*) data) += d_len(logs);
+  return IN3_OK;
+}
+
+static void test_filter_logs_proof() {
+  char*  recorded = read_testdata("eth_getLogs");
+  in3_t* c        = new_client(ETH_CHAIN_ID_KOVAN, recorded_logs_transport, PROOF_STANDARD);
+  recorded_logs   = parse_json(recorded);
+
+  // the range of 0x10e5 blocks is split into 3 chunks, which are verified independently
+  char* fopt  = "{\"fromBlock\":\"0x7ae000\",\"toBlock\":\"0x7af0e4\",\"address\":\"0x27a37a1210df14f7e058393d026e2fb53b7cf8c1\"}";
+  int   count = 0;
+  char* error = NULL;
+  TEST_ASSERT_EQUAL_MESSAGE(IN3_OK, filter_get_logs(c, fopt, 0x7af0e4, count_logs, &count, &error), error);
+  TEST_ASSERT_EQUAL(2, count);
+
+  // the same with the eth api
+  in3_register_eth_api();
+  eth_log_t* logs = eth_getLogs(c, fopt);
+  TEST_ASSERT_NOT_NULL_MESSAGE(logs, eth_last_error());
+  TEST_ASSERT_EQUAL_UINT64(0x7ae16b, logs->block_number);
+  TEST_ASSERT_NOT_NULL(logs->next);
+  TEST_ASSERT_EQUAL_UINT64(0x7af0e4, logs->next->block_number);
+  TEST_ASSERT_NULL(logs->next->next);
+  count = 0;
+  free_chunk(&count, logs);
+
+  in3_free(c);
+  json_free(recorded_logs);
+  _free(recorded);
+}
+
+static uint64_t forked_block  = 0;
+static uint64_t latest_block  = 0x84cf95;
+static int      signed_blocks = 0;
+static int      min_finality  = 0xFFFF;
+static int      max_finality  = 0;
+
+// serves eth_getBlockByNumber-batches with blocks whose hash ends with the blocknumber (+1 for the forked block).
+static in3_ret_t blocks_transport(in3_request_t* req) {
+  json_ctx_t* r  = parse_json(req->payload);
+  sb_t*       sb = &req->results->result;
+  logs_batches++;
+  sb_add_char(sb, '[');
+  for (d_iterator_t it = d_iter(r->result); it.left; d_iter_next(&it)) {
+    uint64_t n = d_long(d_get_at(d_get(it.token, key("params")), 0));
+    char     res[300];
+    if (d_get(d_get(it.token, K_IN3), key("signers"))) signed_blocks++;
+    if (d_get_int(d_get(it.token, K_IN3), "finality") > max_finality) max_finality = d_get_int(d_get(it.token, K_IN3), "finality");
+    if (d_get_int(d_get(it.token, K_IN3), "finality") < min_finality) min_finality = d_get_int(d_get(it.token, K_IN3), "finality");
+    if (!strcmp(d_get_stringk(it.token, K_METHOD), "eth_blockNumber"))
+      sprintf(res, "{\"id\":%i,\"jsonrpc\":\"2.0\",\"result\":\"0x%" PRIx64 "\"}", d_get_intk(it.token, K_ID), latest_block);
+    else
+      sprintf(res, "{\"id\":%i,\"jsonrpc\":\"2.0\",\"result\":{\"number\":\"0x%" PRIx64 "\",\"hash\":\"0x%064" PRIx64 "\",\"parentHash\":\"0x%064" PRIx64 "\"}}",
+              d_get_intk(it.token, K_ID), n, n == forked_block ? n + 1 : n, n - 1);
+    if (sb->data[sb->len - 1] != '[') sb_add_char(sb, ',');
+    sb_add_chars(sb, res);
+  }
+  sb_add_char(sb, ']');
+  json_free(r);
+  return IN3_OK;
+}
+
+static void test_filter_blocks_batched() {
+  in3_t* c = new_client(ETH_CHAIN_ID_MAINNET, blocks_transport, PROOF_NONE);
+
+  // 150 blocks are fetched with 3 requests
+  bytes32_t hashes[150];
+  logs_batches = 0;
+  TEST_ASSERT_EQUAL(IN3_OK, filter_get_block_hashes(c, 0x84cf00, 0x84cf95, hashes, NULL));
+  TEST_ASSERT_EQUAL(3, logs_batches);
+  for (int i = 0; i < 150; i++) TEST_ASSERT_EQUAL_UINT64(0x84cf00 + i, bytes_to_long(hashes[i] + 24, 8));
+
+  // a block which is not the parent of the next one is rejected
+  forked_block = 0x84cf20;
+  TEST_ASSERT_EQUAL(IN3_EINVALDT, filter_get_block_hashes(c, 0x84cf00, 0x84cf95, hashes, NULL));
+  forked_block = 0;
+
+  // only the newest block is requested with signatures
+  c->proof           = PROOF_STANDARD;
+  c->signature_count = 1;
+  logs_batches       = 0;
+  signed_blocks      = 0;
+  // the transport sends no proof, so the first batch fails its verification.
+  TEST_ASSERT_EQUAL(IN3_ERPC, filter_get_block_hashes(c, 0x84cf00, 0x84cf95, hashes, NULL));
+  TEST_ASSERT_EQUAL(1, logs_batches);
+  TEST_ASSERT_EQUAL(1, signed_blocks);
+
+  in3_free(c);
+}
+
+static void test_filter_blocks_with_api() {
+  in3_register_eth_api();
+
+  in3_t* c = new_client(ETH_CHAIN_ID_MAINNET, blocks_transport, PROOF_NONE);
+
+  // the batches are sent as they are
+  bytes32_t hashes[150];
+  logs_batches = 0;
+  TEST_ASSERT_EQUAL(IN3_OK, filter_get_block_hashes(c, 0x84cf00, 0x84cf95, hashes, NULL));
+  TEST_ASSERT_EQUAL(3, logs_batches);
+  for (int i = 0; i < 150; i++) TEST_ASSERT_EQUAL_UINT64(0x84cf00 + i, bytes_to_long(hashes[i] + 24, 8));
+
+  // and a block filter returns all new blocks
+  bytes32_t* block_hashes = NULL;
+  latest_block            = 0x84cf00;
+  size_t id               = eth_newBlockFilter(c);
+  TEST_ASSERT_GREATER_THAN(0, id);
+  latest_block = 0x84cf95;
+  TEST_ASSERT_EQUAL(0x95, eth_getFilterChanges(c, id, &block_hashes, NULL));
+  for (int i = 0; i < 0x95; i++) TEST_ASSERT_EQUAL_UINT64(0x84cf01 + i, bytes_to_long(block_hashes[i] + 24, 8));
+  free(block_hashes);
+
+  // the in3-section of a request can not change the signatures or finality the client asks for
+  c->proof           = PROOF_STANDARD;
+  c->finality        = 10;
+  c->signature_count = 1;
+  signed_blocks      = 0;
+  min_finality       = 0xFFFF;
+  max_finality       = 0;
+  in3_ctx_t* ctx     = ctx_new(c, "[{\"method\":\"eth_getBlockByNumber\",\"params\":[\"0x84cf00\",false],\"in3\":{\"finality\":50,\"signatureCount\":0}},"
+                                  "{\"method\":\"eth_getBlockByNumber\",\"params\":[\"0x84cf01\",false],\"in3\":{\"finality\":0,\"signatureCount\":0}}]");
+  in3_send_ctx(ctx);
+  TEST_ASSERT_EQUAL(10, min_finality);
+  TEST_ASSERT_EQUAL(10, max_finality);
+  TEST_ASSERT_EQUAL(2, signed_blocks);
+  ctx_free(ctx);
+
+  in3_free(c);
+}
+
 /*
  * Main
  */
@@ -293,5 +566,10 @@ int main() {
   RUN_TEST(test_filter_from_block_manip);
   RUN_TEST(test_filter_creation);
   RUN_TEST(test_filter_changes);
+  RUN_TEST(test_filter_logs_chunked);
+  RUN_TEST(test_filter_blocks_batched);
+  RUN_TEST(test_filter_logs_with_api);
+  RUN_TEST(test_filter_blocks_with_api);
+  RUN_TEST(test_filter_logs_proof);
   return TESTS_END();
 }
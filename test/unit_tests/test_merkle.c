@@ -0,0 +1,331 @@
+/*******************************************************************************
+ * This file is part of the Incubed project.
+ * Sources: https://github.com/slockit/in3-c
+ * 
+ * Copyright (C) 2018-2019 slock.it GmbH, Blockchains LLC
+ * 
+ * 
+ * COMMERCIAL LICENSE USAGE
+ * 
+ * Licensees holding a valid commercial license may use this file in accordance 
+ * with the commercial license agreement provided with the Software or, alternatively, 
+ * in accordance with the terms contained in a written agreement between you and 
+ * slock.it GmbH/Blockchains LLC. For licensing terms and conditions or further 
+ * information please contact slock.it at in3@slock.it.
+ * 	
+ * Alternatively, this file may be used under the AGPL license as follows:
+ *    
+ * AGPL LICENSE USAGE
+ * 
+ * This program is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Affero General Public License as published by the Free Software 
+ * Foundation, either version 3 of the License, or (at your option) any later version.
+ *  
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY 
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A 
+ * PARTICULAR PURPOSE. See the GNU Affero General Public License for more details.
+ * [Permissions of this strong copyleft license are conditioned on making available 
+ * complete source code of licensed works and modifications, which include larger 
+ * works using a licensed work, under the same license. Copyright and license notices 
+ * must be preserved. Contributors provide an express grant of patent rights.]
+ * You should have received a copy of the GNU Affero General Public License along 
+ * with this program. If not, see <https://www.gnu.org/licenses/>.
+ *******************************************************************************/
+
+#ifndef TEST
+#define TEST
+#endif
+#ifndef TEST
+#define DEBUG
+#endif
+
+#include "../../src/core/client/client.h"
+#include "../../src/core/client/keys.h"
+#include "../../src/core/util/data.h"
+#include "../../src/core/util/mem.h"
+#include "../../src/core/util/utils.h"
+#include "../../src/verifier/eth1/nano/eth_nano.h"
+#include "../../src/verifier/eth1/nano/merkle.h"
+#include "../../src/verifier/eth1/nano/rlp.h"
+#include "../../src/verifier/eth1/nano/serialize.h"
+#include "../test_utils.h"
+#include <stdio.h>
+#include <string.h>
+
+#define ROUNDS 2000
+
+typedef struct {
+  const char* name;
+  bytes_t     root;
+  bytes_t     path;
+  d_token_t*  proof;
+} proof_t;
+
+static json_ctx_t* read_proof(const char* name) {
+  char*       buffer = read_testdata(name);
+  json_ctx_t* ctx    = parse_json(buffer);
+  _free(buffer);
+  return ctx;
+}
+
+static d_token_t* get_in3_proof(json_ctx_t* ctx) {
+  d_token_t* t = d_type(ctx->result) == T_ARRAY ? d_get_at(ctx->result, 0) : ctx->result;
+  return d_get(d_get(d_get_at(d_get(t, key("response")), 0), K_IN3), K_PROOF);
+}
+
+/** collects the account, storage and receipt proofs from the testdata. */
+static int collect_proofs(json_ctx_t* storage, json_ctx_t* receipt, proof_t* proofs, uint8_t* hashes) {
+  d_token_t* p       = get_in3_proof(storage);
+  bytes_t    block   = d_to_bytes(d_get(p, K_BLOCK));
+  d_token_t* account = d_get(p, K_ACCOUNTS) + 1;
+  uint8_t    storage_key[32];
+  int        n = 0;
+
+  proofs[n] = (proof_t){.name = "account", .path = bytes(hashes, 32), .proof = d_get(account, K_ACCOUNT_PROOF)};
+  rlp_decode_in_list(&block, BLOCKHEADER_STATE_ROOT, &proofs[n].root);
+  sha3_to(d_get_byteskl(account, K_ADDRESS, 20), hashes);
+  n++;
+
+  d_token_t* storage_proof = d_get_at(d_get(account, K_STORAGE_PROOF), 0);
+  proofs[n]                = (proof_t){.name = "storage", .root = d_to_bytes(d_get(account, K_STORAGE_HASH)), .path = bytes(hashes + 32, 32), .proof = d_get(storage_proof, K_PROOF)};
+  d_bytes_to(d_get(storage_proof, K_KEY), storage_key, 32);
+  bytes_t k = bytes(storage_key, 32);
+  sha3_to(&k, hashes + 32);
+  n++;
+
+  p         = get_in3_proof(receipt);
+  block     = d_to_bytes(d_get(p, K_BLOCK));
+  proofs[n] = (proof_t){.name = "receipt", .path = create_tx_path_to(d_get_intk(p, K_TX_INDEX), hashes + 64), .proof = d_get(p, K_MERKLE_PROOF)};
+  rlp_decode_in_list(&block, BLOCKHEADER_RECEIPT_ROOT, &proofs[n].root);
+  return ++n;
+}
+
+static void test_tx_path() {
+  uint32_t indexes[] = {0, 1, 0x7f, 0x80, 0xff, 0x100, 0xabcd, 0x10000, 0x123456, 0x1000000, 0xffffffff};
+  uint8_t  data[5];
+  for (size_t i = 0; i < sizeof(indexes) / sizeof(uint32_t); i++) {
+    bytes_t* expected = create_tx_path(indexes[i]);
+    bytes_t  path     = create_tx_path_to(indexes[i], data);
+    TEST_ASSERT_TRUE(b_cmp(expected, &path));
+
+    // compare with the rlp encoding of the index
+    uint8_t          tmp[4];
+    bytes_t          b  = bytes(tmp, 4);
+    bytes_builder_t* bb = bb_new();
+    int_to_bytes(indexes[i], tmp);
+    b_optimize_len(&b);
+    if (!indexes[i]) b.len = 0;
+    rlp_encode_item(bb, &b);
+    TEST_ASSERT_TRUE(b_cmp(&bb->b, &path));
+    bb_free(bb);
+    b_free(expected);
+  }
+}
+
+static void test_verify_proofs() {
+  json_ctx_t *storage = read_proof("eth_getStorageAt"), *receipt = read_proof("eth_getTransactionReceipt");
+  proof_t     proofs[3];
+  uint8_t     hashes[96];
+  int         n = collect_proofs(storage, receipt, proofs, hashes);
+
+  for (int i = 0; i < n; i++) {
+    proof_t*  p     = proofs + i;
+    bytes_t   value = {.data = NULL, .len = 0};
+    bytes_t** vec   = d_create_bytes_vec(p->proof);
+
+    // the value is returned and must match afterwards
+    TEST_ASSERT_TRUE_MESSAGE(trie_verify_proof_token(&p->root, &p->path, p->proof, &value), p->name);
+    TEST_ASSERT_NOT_NULL(value.data);
+    TEST_ASSERT_TRUE(trie_verify_proof(&p->root, &p->path, vec, &value));
+    TEST_ASSERT_TRUE(trie_verify_proof_token(&p->root, &p->path, p->proof, &value));
+
+    // a different value, root or path must fail
+    bytes_t wrong = {.data = value.data, .len = value.len - 1};
+    TEST_ASSERT_FALSE(trie_verify_proof_token(&p->root, &p->path, p->proof, &wrong));
+    p->root.data[31] ^= 1;
+    TEST_ASSERT_FALSE(trie_verify_proof_token(&p->root, &p->path, p->proof, &value));
+    p->root.data[31] ^= 1;
+    p->path.data[0] ^= 0x10;
+    TEST_ASSERT_FALSE(trie_verify_proof_token(&p->root, &p->path, p->proof, &value));
+    p->path.data[0] ^= 0x10;
+
+    // missing or invalid proofs
+    TEST_ASSERT_FALSE(trie_verify_proof_token(&p->root, &p->path, NULL, &value));
+    TEST_ASSERT_FALSE(trie_verify_proof_token(&p->root, &p->path, p->proof + 1, &value));
+    _free(vec);
+  }
+  json_free(storage);
+  json_free(receipt);
+}
+
+static void test_verify_speed() {
+  json_ctx_t *   storage = read_proof("eth_getStorageAt"), *receipt = read_proof("eth_getTransactionReceipt");
+  proof_t        proofs[3];
+  uint8_t        hashes[96];
+  int            n = collect_proofs(storage, receipt, proofs, hashes);
+  struct timeval begin, end;
+
+  for (int i = 0; i < n; i++) {
+    proof_t* p = proofs + i;
+    bytes_t  value;
+    TIMING_START();
+    for (int r = 0; r < ROUNDS; r++) {
+      value = bytes(NULL, 0);
+      trie_verify_proof_token(&p->root, &p->path, p->proof, &value);
+    }
+    TIMING_END();
+    TEST_LOG("%-8s proof with %i nodes: %.2f us\n", p->name, d_len(p->proof), TIMING_GET() * 1000000 / ROUNDS);
+  }
+  json_free(storage);
+  json_free(receipt);
+}
+
+/** verifies all storage proofs of the accounts one by one and as multiproof. */
+static void test_multiproof() {
+  json_ctx_t*    ctx      = read_proof("eth_call");
+  d_token_t*     accounts = d_get(get_in3_proof(ctx), K_ACCOUNTS);
+  uint8_t        hash[32], storage_key[32];
+  bytes_t        path = bytes(hash, 32), k = bytes(storage_key, 32);
+  int            verified = 0;
+  struct timeval begin, end;
+
+  for (d_iterator_t account = d_iter(accounts); account.left; d_iter_next(&account)) {
+    d_token_t*        storage = d_get(account.token, K_STORAGE_PROOF);
+    bytes_t           root    = d_to_bytes(d_get(account.token, K_STORAGE_HASH));
+    trie_multiproof_t mp      = {0};
+    int               nodes   = 0;
+    if (d_len(storage) < 2) continue;
+
+    for (d_iterator_t p = d_iter(storage); p.left; d_iter_next(&p)) {
+      TEST_ASSERT_TRUE(trie_multiproof_add(&mp, d_get(p.token, K_PROOF)));
+      nodes += d_len(d_get(p.token, K_PROOF));
+    }
+
+    for (d_iterator_t p = d_iter(storage); p.left; d_iter_next(&p)) {
+      bytes_t single = bytes(NULL, 0), multi = bytes(NULL, 0);
+      d_bytes_to(d_get(p.token, K_KEY), storage_key, 32);
+      sha3_to(&k, hash);
+      verified++;
+      if (d_type(d_get(p.token, K_VALUE)) == T_INTEGER && !d_int(d_get(p.token, K_VALUE))) {
+        // the value does not exist
+        TEST_ASSERT_TRUE(trie_verify_proof_token(&root, &path, d_get(p.token, K_PROOF), NULL));
+        TEST_ASSERT_TRUE(trie_multiproof_verify(&mp, &root, &path, NULL));
+        TEST_ASSERT_EQUAL(trie_verify_proof_token(&root, &path, d_get(p.token, K_PROOF), &single), trie_multiproof_verify(&mp, &root, &path, &multi));
+        TEST_ASSERT_NULL(multi.data);
+      } else {
+        TEST_ASSERT_TRUE(trie_verify_proof_token(&root, &path, d_get(p.token, K_PROOF), &single));
+        TEST_ASSERT_TRUE(trie_multiproof_verify(&mp, &root, &path, &multi));
+        TEST_ASSERT_TRUE(b_cmp(&single, &multi));
+        TEST_ASSERT_TRUE(trie_multiproof_verify(&mp, &root, &path, &multi));
+        bytes_t wrong = {.data = multi.data, .len = multi.len - 1};
+        TEST_ASSERT_FALSE(trie_multiproof_verify(&mp, &root, &path, &wrong));
+        TEST_ASSERT_FALSE(trie_multiproof_verify(&mp, &root, &path, NULL));
+      }
+    }
+    TEST_ASSERT_TRUE(mp.len < nodes);
+
+    // a wrong root is never found
+    root.data[0] ^= 1;
+    bytes_t value = bytes(NULL, 0);
+    TEST_ASSERT_FALSE(trie_multiproof_verify(&mp, &root, &path, &value));
+    root.data[0] ^= 1;
+
+    // compare the time for all keys
+    TIMING_START();
+    for (int r = 0; r < ROUNDS; r++) {
+      for (d_iterator_t p = d_iter(storage); p.left; d_iter_next(&p)) {
+        value = bytes(NULL, 0);
+        trie_verify_proof_token(&root, &path, d_get(p.token, K_PROOF), &value);
+      }
+    }
+    TIMING_END();
+    double single = TIMING_GET();
+    TIMING_START();
+    for (int r = 0; r < ROUNDS; r++) {
+      trie_multiproof_t tmp = {0};
+      for (d_iterator_t p = d_iter(storage); p.left; d_iter_next(&p)) trie_multiproof_add(&tmp, d_get(p.token, K_PROOF));
+      for (d_iterator_t p = d_iter(storage); p.left; d_iter_next(&p)) {
+        value = bytes(NULL, 0);
+        trie_multiproof_verify(&tmp, &root, &path, &value);
+      }
+      trie_multiproof_free(&tmp);
+    }
+    TIMING_END();
+    TEST_LOG("%i storage proofs with %i nodes (%i unique): single %.2f us, multiproof %.2f us\n", d_len(storage), nodes, mp.len, single * 1000000 / ROUNDS, TIMING_GET() * 1000000 / ROUNDS);
+    trie_multiproof_free(&mp);
+  }
+  TEST_ASSERT_TRUE(verified > 2);
+  json_free(ctx);
+}
+
+static void free_node_cache(in3_cached_node_t* cache, int size) {
+  for (int i = 0; i < size; i++) {
+    if (cache[i].data.data) _free(cache[i].data.data);
+  }
+  _free(cache);
+}
+
+/** verifies the proofs with a node cache of different sizes. */
+static void test_node_cache() {
+  json_ctx_t *   storage = read_proof("eth_getStorageAt"), *receipt = read_proof("eth_getTransactionReceipt");
+  proof_t        proofs[3];
+  uint8_t        hashes[96];
+  int            n     = collect_proofs(storage, receipt, proofs, hashes), sizes[] = {1, 3, 64};
+  struct timeval begin, end;
+
+  for (int s = 0; s < 3; s++) {
+    in3_cached_node_t* cache = _calloc(sizes[s], sizeof(in3_cached_node_t));
+    for (int r = 0; r < 3; r++) {
+      for (int i = 0; i < n; i++) {
+        proof_t* p     = proofs + i;
+        bytes_t  value = bytes(NULL, 0), expected = bytes(NULL, 0);
+        TEST_ASSERT_TRUE(trie_verify_proof_token(&p->root, &p->path, p->proof, &expected));
+        TEST_ASSERT_TRUE_MESSAGE(trie_verify_proof_cached(&p->root, &p->path, p->proof, &value, cache, sizes[s]), p->name);
+        TEST_ASSERT_TRUE(b_cmp(&expected, &value));
+
+        // a changed node must not match the cached one
+        bytes_t* node = d_bytes(p->proof + 1);
+        node->data[node->len - 1] ^= 1;
+        TEST_ASSERT_FALSE(trie_verify_proof_cached(&p->root, &p->path, p->proof, &value, cache, sizes[s]));
+        node->data[node->len - 1] ^= 1;
+      }
+    }
+    free_node_cache(cache, sizes[s]);
+  }
+
+  // the second account proof only compares the nodes
+  proof_t*           p     = proofs;
+  in3_cached_node_t* cache = _calloc(64, sizeof(in3_cached_node_t));
+  bytes_t            value;
+  double             uncached;
+  TIMING_START();
+  for (int r = 0; r < ROUNDS; r++) {
+    value = bytes(NULL, 0);
+    trie_verify_proof_token(&p->root, &p->path, p->proof, &value);
+  }
+  TIMING_END();
+  uncached = TIMING_GET();
+  TIMING_START();
+  for (int r = 0; r < ROUNDS; r++) {
+    value = bytes(NULL, 0);
+    trie_verify_proof_cached(&p->root, &p->path, p->proof, &value, cache, 64);
+  }
+  TIMING_END();
+  TEST_LOG("account proof: %.2f us, with node cache %.2f us\n", uncached * 1000000 / ROUNDS, TIMING_GET() * 1000000 / ROUNDS);
+  free_node_cache(cache, 64);
+  json_free(storage);
+  json_free(receipt);
+}
+
+/*
+ * Main
+ */
+int main() {
+  TESTS_BEGIN();
+  RUN_TEST(test_tx_path);
+  RUN_TEST(test_verify_proofs);
+  RUN_TEST(test_verify_speed);
+  RUN_TEST(test_multiproof);
+  RUN_TEST(test_node_cache);
+  return TESTS_END();
+}
@@ -0,0 +1,298 @@
+/*******************************************************************************
+ * This file is part of the Incubed project.
+ * Sources: https://github.com/slockit/in3-c
+ * 
+ * Copyright (C) 2018-2019 slock.it GmbH, Blockchains LLC
+ * 
+ * 
+ * COMMERCIAL LICENSE USAGE
+ * 
+ * Licensees holding a valid commercial license may use this file in accordance 
+ * with the commercial license agreement provided with the Software or, alternatively, 
+ * in accordance with the terms contained in a written agreement between you and 
+ * slock.it GmbH/Blockchains LLC. For licensing terms and conditions or further 
+ * information please contact slock.it at in3@slock.it.
+ * 	
+ * Alternatively, this file may be used under the AGPL license as follows:
+ *    
+ * AGPL LICENSE USAGE
+ * 
+ * This program is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Affero General Public License as published by the Free Software 
+ * Foundation, either version 3 of the License, or (at your option) any later version.
+ *  
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY 
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A 
+ * PARTICULAR PURPOSE. See the GNU Affero General Public License for more details.
+ * [Permissions of this strong copyleft license are conditioned on making available 
+ * complete source code of licensed works and modifications, which include larger 
+ * works using a licensed work, under the same license. Copyright and license notices 
+ * must be preserved. Contributors provide an express grant of patent rights.]
+ * You should have received a copy of the GNU Affero General Public License along 
+ * with this program. If not, see <https://www.gnu.org/licenses/>.
+ *******************************************************************************/
+
+#ifndef TEST
+#define TEST
+#endif
+#ifndef TEST
+#define DEBUG
+#endif
+
+#include "../../src/core/client/keys.h"
+#include "../../src/core/util/bytes.h"
+#include "../../src/core/util/mem.h"
+#include "../../src/core/util/utils.h"
+#include "../../src/verifier/eth1/nano/rlp.h"
+#include "../../src/verifier/eth1/nano/serialize.h"
+#include "../test_utils.h"
+#include <stdio.h>
+#include <string.h>
+
+/** creates a list with 17 fields like a blockheader with sealed fields and a nested list at the end. */
+static bytes_builder_t* create_header() {
+  bytes_builder_t* bb = bb_new();
+  uint8_t          data[256];
+  int              sizes[] = {32, 32, 20, 32, 32, 32, 256, 1, 4, 4, 0, 4, 32, 1, 65, 1, 60};
+  for (int i = 0; i < 17; i++) {
+    bytes_t item = bytes(data, sizes[i]);
+    memset(data, i + 1, sizes[i]);
+    if (i == 16)
+      rlp_encode_list(bb, &item);
+    else
+      rlp_encode_item(bb, &item);
+  }
+  return rlp_encode_to_list(bb);
+}
+
+/** compares every item of the index with rlp_decode. */
+static void check_index(bytes_t* b) {
+  rlp_index_t idx;
+  bytes_t     expected, found;
+  int         len = rlp_index(b, &idx);
+  TEST_ASSERT_EQUAL(rlp_decode_len(b), len);
+  for (int i = 0; i < RLP_INDEX_MAX + 5; i++) {
+    expected = found = bytes(NULL, 0);
+    int r            = rlp_decode(b, i, &expected);
+    TEST_ASSERT_EQUAL_MESSAGE(r < 0 ? -1 : r, rlp_index_get(&idx, i, &found), "wrong type");
+    if (r > 0) {
+      TEST_ASSERT_TRUE(expected.data == found.data);
+      TEST_ASSERT_EQUAL(expected.len, found.len);
+    }
+  }
+}
+
+static void test_rlp_index_header() {
+  bytes_builder_t* bb     = create_header();
+  bytes_t          header = bb->b, list;
+  rlp_index_t      idx;
+  TEST_ASSERT_EQUAL(2, rlp_decode(&header, 0, &list));
+  TEST_ASSERT_EQUAL(17, rlp_decode_len(&list));
+  check_index(&header);
+  check_index(&list);
+  TEST_ASSERT_EQUAL(rlp_decode_len(&list), rlp_index_list(&header, &idx));
+
+  // truncated data
+  for (uint32_t l = 1; l < list.len; l += 7) {
+    bytes_t part = bytes(list.data, l);
+    check_index(&part);
+  }
+  bb_free(bb);
+}
+
+static void test_rlp_index_items() {
+  bytes_builder_t* bb = bb_new();
+  uint8_t          data[300];
+  memset(data, 0x42, sizeof(data));
+
+  // single bytes, short and long items and lists
+  for (int i = 0; i < 25; i++) {
+    bytes_t item = bytes(data, (i * 37) % 300);
+    if (i % 5 == 3) data[0] = i;
+    if (i % 4 == 1)
+      rlp_encode_list(bb, &item);
+    else
+      rlp_encode_item(bb, &item);
+    check_index(&bb->b);
+  }
+
+  // not a list
+  rlp_index_t idx;
+  TEST_ASSERT_EQUAL(0, rlp_index_list(&bb->b, &idx));
+  TEST_ASSERT_EQUAL(0, rlp_index_get(&idx, 0, &bb->b));
+  bb_free(bb);
+}
+
+static void test_rlp_index_invalid() {
+  rlp_index_t idx;
+  uint8_t     too_long[]   = {0xbb, 0xff, 0xff, 0xff, 0xfd}; // length would wrap the offset
+  uint8_t     no_advance[] = {0xbb, 0xff, 0xff, 0xff, 0xfb}; // h + l would wrap to 0
+  uint8_t     truncated[]  = {0xb9, 0xff};                   // length of the length exceeds the data
+  uint8_t     huge[]       = {0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0x01};
+  bytes_t     b;
+
+  b = bytes(too_long, sizeof(too_long));
+  TEST_ASSERT_EQUAL(-3, rlp_index(&b, &idx));
+  TEST_ASSERT_EQUAL(0, idx.len);
+  b = bytes(no_advance, sizeof(no_advance));
+  TEST_ASSERT_EQUAL(-3, rlp_index(&b, &idx));
+  b = bytes(truncated, sizeof(truncated));
+  TEST_ASSERT_EQUAL(-3, rlp_index(&b, &idx));
+  b = bytes(huge, sizeof(huge));
+  TEST_ASSERT_EQUAL(-3, rlp_index(&b, &idx));
+  TEST_ASSERT_EQUAL(-1, rlp_index_get(&idx, 0, &b));
+}
+
+static void test_rlp_index_speed() {
+  bytes_builder_t* bb     = create_header();
+  bytes_t          header = bb->b, item;
+  rlp_index_t      idx;
+  struct timeval   begin, end;
+  int              n = 0, rounds = 100000;
+  double           decode_time;
+
+  TIMING_START();
+  for (int r = 0; r < rounds; r++) {
+    for (int i = 0; i < 17; i++) n += rlp_decode_in_list(&header, i, &item);
+  }
+  TIMING_END();
+  decode_time = TIMING_GET();
+  TIMING_START();
+  for (int r = 0; r < rounds; r++) {
+    rlp_index_list(&header, &idx);
+    for (int i = 0; i < 17; i++) n -= rlp_index_get(&idx, i, &item);
+  }
+  TIMING_END();
+  TEST_ASSERT_EQUAL(0, n);
+  bb_free(bb);
+  TEST_LOG("all fields of a header: rlp_decode %.3f us, rlp_index %.3f us\n", decode_time * 1000000 / rounds, TIMING_GET() * 1000000 / rounds);
+}
+
+static json_ctx_t* read_result(const char* name, d_token_t** result) {
+  char*       buffer = read_testdata(name);
+  json_ctx_t* ctx    = parse_json(buffer);
+  _free(buffer);
+  d_token_t* t = d_type(ctx->result) == T_ARRAY ? d_get_at(ctx->result, 0) : ctx->result;
+  *result      = d_get(d_get_at(d_get(t, key("response")), 0), K_RESULT);
+  return ctx;
+}
+
+/** the transaction encoded with the bytes_builder as reference. */
+static bytes_t* serialize_tx_bb(d_token_t* tx) {
+  bytes_builder_t* rlp = bb_new();
+  rlp_add(rlp, d_get(tx, K_NONCE), 0);
+  rlp_add(rlp, d_get(tx, K_GAS_PRICE), 0);
+  rlp_add(rlp, d_get_or(tx, K_GAS, K_GAS_LIMIT), 0);
+  rlp_add(rlp, d_getl(tx, K_TO, 20), -20);
+  rlp_add(rlp, d_get(tx, K_VALUE), 0);
+  rlp_add(rlp, d_get_or(tx, K_INPUT, K_DATA), -1);
+  rlp_add(rlp, d_get(tx, K_V), 0);
+  rlp_add(rlp, d_getl(tx, K_R, 32), 0);
+  rlp_add(rlp, d_getl(tx, K_S, 32), 0);
+  return bb_move_to_bytes(rlp_encode_to_list(rlp));
+}
+
+/** the receipt encoded with the bytes_builder as reference. */
+static bytes_t* serialize_receipt_bb(d_token_t* receipt) {
+  bytes_builder_t *rlp = bb_new(), *log = bb_new(), *topics = bb_new(), *logs = bb_new();
+  d_token_t*       t;
+  if ((t = d_get(receipt, K_STATUS)) || (t = d_getl(receipt, K_ROOT, 32))) rlp_add(rlp, t, 0);
+  rlp_add(rlp, d_get(receipt, K_CUMULATIVE_GAS_USED), 0);
+  rlp_add(rlp, d_getl(receipt, K_LOGS_BLOOM, 256), 256);
+  for (d_iterator_t l = d_iter(d_get(receipt, K_LOGS)); l.left; d_iter_next(&l)) {
+    bb_clear(log);
+    bb_clear(topics);
+    rlp_add(log, d_getl(l.token, K_ADDRESS, 20), -20);
+    for (d_iterator_t it = d_iter(d_get(l.token, K_TOPICS)); it.left; d_iter_next(&it)) rlp_add(topics, it.token, 32);
+    rlp_encode_list(log, &topics->b);
+    rlp_add(log, d_get(l.token, K_DATA), -1);
+    rlp_encode_list(logs, &log->b);
+  }
+  rlp_encode_list(rlp, &logs->b);
+  bb_free(log);
+  bb_free(topics);
+  bb_free(logs);
+  return bb_move_to_bytes(rlp_encode_to_list(rlp));
+}
+
+static void test_serialize_block() {
+  d_token_t*  block;
+  json_ctx_t* ctx = read_result("eth_getBlockByNumber", &block);
+  uint8_t     hash[32];
+
+  // the blockhash and the transaction hashes must match
+  bytes_t* header = serialize_block_header(block);
+  sha3_to(header, hash);
+  TEST_ASSERT_EQUAL_MEMORY(d_get_byteskl(block, K_HASH, 32)->data, hash, 32);
+  b_free(header);
+
+  // all transactions are written to one small builder, so it needs to grow
+  bytes_builder_t* raw = bb_newl(8);
+  for (d_iterator_t it = d_iter(d_get(block, K_TRANSACTIONS)); it.left; d_iter_next(&it)) {
+    bytes_t *tx = serialize_tx(it.token), *expected = serialize_tx_bb(it.token);
+    uint32_t offset = raw->b.len;
+    TEST_ASSERT_TRUE(b_cmp(expected, tx));
+    TEST_ASSERT_EQUAL(tx->len, serialize_tx_to(it.token, raw));
+    TEST_ASSERT_EQUAL(offset + tx->len, raw->b.len);
+    TEST_ASSERT_EQUAL_MEMORY(tx->data, raw->b.data + offset, tx->len);
+    sha3_to(tx, hash);
+    TEST_ASSERT_EQUAL_MEMORY(d_get_byteskl(it.token, K_HASH, 32)->data, hash, 32);
+    b_free(tx);
+    b_free(expected);
+  }
+  TEST_ASSERT_TRUE(raw->b.len > 8);
+  bb_free(raw);
+  json_free(ctx);
+}
+
+static void test_serialize_receipt() {
+  d_token_t*  receipt;
+  json_ctx_t* ctx      = read_result("eth_getTransactionReceipt", &receipt);
+  bytes_t *   raw      = serialize_tx_receipt(receipt),
+          *expected = serialize_receipt_bb(receipt);
+  TEST_ASSERT_TRUE(d_len(d_get(receipt, K_LOGS)) > 0);
+  TEST_ASSERT_TRUE(b_cmp(expected, raw));
+  b_free(raw);
+  b_free(expected);
+  json_free(ctx);
+}
+
+static void test_serialize_speed() {
+  d_token_t *    block, *tx;
+  json_ctx_t*    ctx    = read_result("eth_getBlockByNumber", &block);
+  int            rounds = 20000;
+  struct timeval begin, end;
+  double         bb_time;
+  tx = d_get_at(d_get(block, K_TRANSACTIONS), 0);
+
+  TIMING_START();
+  for (int r = 0; r < rounds; r++) b_free(serialize_tx_bb(tx));
+  TIMING_END();
+  bb_time = TIMING_GET();
+  TIMING_START();
+  for (int r = 0; r < rounds; r++) b_free(serialize_tx(tx));
+  TIMING_END();
+  double alloc_time = TIMING_GET();
+  TIMING_START();
+  bytes_builder_t* raw = bb_newl(1000);
+  for (int r = 0; r < rounds; r++, raw->b.len = 0) serialize_tx_to(tx, raw);
+  TIMING_END();
+  bb_free(raw);
+  TEST_LOG("serialize tx: bytes_builder %.3f us, serialize_tx %.3f us, serialize_tx_to %.3f us\n", bb_time * 1000000 / rounds, alloc_time * 1000000 / rounds, TIMING_GET() * 1000000 / rounds);
+  json_free(ctx);
+}
+
+/*
+ * Main
+ */
+int main() {
+  TESTS_BEGIN();
+  RUN_TEST(test_rlp_index_header);
+  RUN_TEST(test_rlp_index_items);
+  RUN_TEST(test_rlp_index_invalid);
+  RUN_TEST(test_rlp_index_speed);
+  RUN_TEST(test_serialize_block);
+  RUN_TEST(test_serialize_receipt);
+  RUN_TEST(test_serialize_speed);
+  return TESTS_END();
+}
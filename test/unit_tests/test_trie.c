@@ -0,0 +1,163 @@
+/*******************************************************************************
+ * This file is part of the Incubed project.
+ * Sources: https://github.com/slockit/in3-c
+ * 
+ * Copyright (C) 2018-2019 slock.it GmbH, Blockchains LLC
+ * 
+ * 
+ * COMMERCIAL LICENSE USAGE
+ * 
+ * Licensees holding a valid commercial license may use this file in accordance 
+ * with the commercial license agreement provided with the Software or, alternatively, 
+ * in accordance with the terms contained in a written agreement between you and 
+ * slock.it GmbH/Blockchains LLC. For licensing terms and conditions or further 
+ * information please contact slock.it at in3@slock.it.
+ * 	
+ * Alternatively, this file may be used under the AGPL license as follows:
+ *    
+ * AGPL LICENSE USAGE
+ * 
+ * This program is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Affero General Public License as published by the Free Software 
+ * Foundation, either version 3 of the License, or (at your option) any later version.
+ *  
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY 
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A 
+ * PARTICULAR PURPOSE. See the GNU Affero General Public License for more details.
+ * [Permissions of this strong copyleft license are conditioned on making available 
+ * complete source code of licensed works and modifications, which include larger 
+ * works using a licensed work, under the same license. Copyright and license notices 
+ * must be preserved. Contributors provide an express grant of patent rights.]
+ * You should have received a copy of the GNU Affero General Public License along 
+ * with this program. If not, see <https://www.gnu.org/licenses/>.
+ *******************************************************************************/
+
+#ifndef TEST
+#define TEST
+#endif
+#ifndef TEST
+#define DEBUG
+#endif
+
+#include "../../src/core/util/mem.h"
+#include "../../src/core/util/utils.h"
+#include "../../src/verifier/eth1/basic/trie.h"
+#include "../../src/verifier/eth1/nano/eth_nano.h"
+#include "../test_utils.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/** fills n items with random keys (or tx-paths if key_len is 0) and random values with 32 up to max_len bytes. */
+static trie_kv_t* create_items(int n, int key_len, int max_len) {
+  trie_kv_t* items = _malloc(n * (sizeof(trie_kv_t) + 32 + max_len));
+  uint8_t*   data  = (uint8_t*) (items + n);
+  for (int i = 0; i < n; i++, data += 32 + max_len) {
+    if (key_len)
+      for (int k = 0; k < key_len; k++) data[k] = rand();
+    items[i].key   = key_len ? bytes(data, key_len) : create_tx_path_to(i, data);
+    items[i].value = bytes(data + 32, 32 + rand() % (max_len - 31));
+    for (uint32_t k = 0; k < items[i].value.len; k++) items[i].value.data[k] = rand();
+  }
+  return items;
+}
+
+static void set_root(trie_kv_t* items, int n, uint8_t* root) {
+  trie_t* trie = trie_new();
+  for (int i = 0; i < n; i++) trie_set_value(trie, &items[i].key, &items[i].value);
+  memcpy(root, trie->root, 32);
+  trie_free(trie);
+}
+
+static void test_empty_root() {
+  bytes32_t root;
+  trie_build_root(NULL, 0, root);
+  TEST_ASSERT_EQUAL_MEMORY("\x56\xe8\x1f\x17\x1b\xcc\x55\xa6\xff\x83\x45\xe6\x92\xc0\xf8\x6e\x5b\x48\xe0\x1b\x99\x6c\xad\xc0\x01\x62\x2f\xb5\xe3\x63\xb4\x21", root, 32);
+}
+
+static void test_build_root() {
+  int sizes[] = {1, 2, 3, 15, 16, 17, 127, 128, 129, 300};
+  srand(1);
+  for (int key_len = 0; key_len <= 32; key_len += 16) {
+    for (int max_len = 32; max_len <= 256; max_len *= 2) {
+      for (size_t s = 0; s < sizeof(sizes) / sizeof(int); s++) {
+        bytes32_t  expected, root;
+        int        n     = sizes[s];
+        trie_kv_t* items = create_items(n, key_len, max_len);
+        set_root(items, n, expected);
+        trie_build_root(items, n, root);
+        TEST_ASSERT_EQUAL_MEMORY(expected, root, 32);
+        _free(items);
+      }
+    }
+  }
+}
+
+/** small values create embedded nodes, so we use the known roots of the ethereum trie tests. */
+static void test_build_root_embedded() {
+  char* tests[][9] = {
+      {"8aad789dff2f538bca5d8ea56e8abe10f4c7ba3a5dea95fea4cd6e7c3a1168d3", "doe", "reindeer", "dog", "puppy", "dogglesworth", "cat", NULL},
+      {"5991bb8c6514148a29db676a14ac506cd2cd5775ace63c30a4fe457715e9ac84", "do", "verb", "horse", "stallion", "doge", "coin", "dog", "puppy"},
+      {"17beaa1648bafa633cda809c90c04af50fc8aed3cb40d16efbddee6fdf63c4c3", "foo", "bar", "food", "bass", NULL},
+      {"3f67c7a47520f79faa29255d2d3c084a7a6df0453116ed7232ff10277a8be68b", "be", "e", "dog", "puppy", "bed", "d", NULL},
+      {"8452568af70d8d140f58d941338542f645fcca50094b20f3c3d8c3df49337928", "test", "test", "te", "testy", NULL}};
+
+  for (size_t t = 0; t < sizeof(tests) / sizeof(tests[0]); t++) {
+    trie_kv_t items[4];
+    bytes32_t root, expected;
+    int       n = 0;
+    for (; n < 4 && tests[t][1 + n * 2]; n++) {
+      items[n].key   = bytes((uint8_t*) tests[t][1 + n * 2], strlen(tests[t][1 + n * 2]));
+      items[n].value = bytes((uint8_t*) tests[t][2 + n * 2], strlen(tests[t][2 + n * 2]));
+    }
+    hex_to_bytes(tests[t][0], 64, expected, 32);
+    trie_build_root(items, n, root);
+    TEST_ASSERT_EQUAL_MEMORY(expected, root, 32);
+  }
+}
+
+static void test_build_root_duplicates() {
+  bytes32_t  expected, root;
+  trie_kv_t* items = create_items(20, 0, 40);
+  set_root(items, 20, expected);
+
+  // the same key twice and an empty value
+  trie_kv_t* more = _malloc(22 * sizeof(trie_kv_t));
+  memcpy(more, items, 20 * sizeof(trie_kv_t));
+  more[20] = items[3];
+  more[21] = (trie_kv_t){.key = bytes((uint8_t*) "\x55", 1), .value = bytes(NULL, 0)};
+  trie_build_root(more, 22, root);
+  TEST_ASSERT_EQUAL_MEMORY(expected, root, 32);
+  _free(more);
+  _free(items);
+}
+
+static void test_build_root_speed() {
+  struct timeval begin, end;
+  bytes32_t      expected, root;
+  trie_kv_t*     items = create_items(300, 0, 200);
+  double         set_time;
+  TIMING_START();
+  for (int i = 0; i < 10; i++) set_root(items, 300, expected);
+  TIMING_END();
+  set_time = TIMING_GET();
+  TIMING_START();
+  for (int i = 0; i < 10; i++) trie_build_root(items, 300, root);
+  TIMING_END();
+  TEST_ASSERT_EQUAL_MEMORY(expected, root, 32);
+  TEST_LOG("300 transactions: trie_set_value %.2f ms, trie_build_root %.2f ms\n", set_time * 100, TIMING_GET() * 100);
+  _free(items);
+}
+
+/*
+ * Main
+ */
+int main() {
+  TESTS_BEGIN();
+  RUN_TEST(test_empty_root);
+  RUN_TEST(test_build_root);
+  RUN_TEST(test_build_root_embedded);
+  RUN_TEST(test_build_root_duplicates);
+  RUN_TEST(test_build_root_speed);
+  return TESTS_END();
+}
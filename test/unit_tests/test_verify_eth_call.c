@@ -0,0 +1,145 @@
+/*******************************************************************************
+ * This file is part of the Incubed project.
+ * Sources: https://github.com/slockit/in3-c
+ * 
+ * Copyright (C) 2018-2019 slock.it GmbH, Blockchains LLC
+ * 
+ * 
+ * COMMERCIAL LICENSE USAGE
+ * 
+ * Licensees holding a valid commercial license may use this file in accordance 
+ * with the commercial license agreement provided with the Software or, alternatively, 
+ * in accordance with the terms contained in a written agreement between you and 
+ * slock.it GmbH/Blockchains LLC. For licensing terms and conditions or further 
+ * information please contact slock.it at in3@slock.it.
+ * 	
+ * Alternatively, this file may be used under the AGPL license as follows:
+ *    
+ * AGPL LICENSE USAGE
+ * 
+ * This program is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Affero General Public License as published by the Free Software 
+ * Foundation, either version 3 of the License, or (at your option) any later version.
+ *  
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY 
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A 
+ * PARTICULAR PURPOSE. See the GNU Affero General Public License for more details.
+ * [Permissions of this strong copyleft license are conditioned on making available 
+ * complete source code of licensed works and modifications, which include larger 
+ * works using a licensed work, under the same license. Copyright and license notices 
+ * must be preserved. Contributors provide an express grant of patent rights.]
+ * You should have received a copy of the GNU Affero General Public License along 
+ * with this program. If not, see <https://www.gnu.org/licenses/>.
+ *******************************************************************************/
+
+#ifndef TEST
+#define TEST
+#endif
+
+#include "../../src/core/client/context.h"
+#include "../../src/core/client/keys.h"
+#include "../../src/core/util/data.h"
+#include "../../src/core/util/mem.h"
+#include "../../src/api/eth1/eth_api.h"
+#include "../../src/verifier/eth1/full/eth_full.h"
+#include "../test_utils.h"
+#include <stdio.h>
+#include <string.h>
+
+extern char* read_json_response_buffer(char* path);
+
+static char* batch_response = NULL;
+
+static in3_ret_t batch_transport(in3_request_t* req) {
+  for (int i = 0; i < req->urls_len; i++)
+    sb_add_chars(&req->results[i].result, batch_response);
+  return IN3_OK;
+}
+
+/**
+ * sends the same eth_call n times within one batch, so all but the first can reuse the verified account proofs.
+ * if wrong_result is a index, the result of this response is changed.
+ */
+static in3_ret_t send_call_batch(int n, uint8_t max_threads, int wrong_result) {
+  char*       buffer = read_json_response_buffer("../test/testdata/requests/eth_call.json");
+  json_ctx_t* json   = parse_json(buffer);
+  TEST_ASSERT_NOT_NULL(json);
+  d_token_t*  test     = d_get_at(json->result, 0);
+  str_range_t params   = d_to_json(d_get(d_get(test, key("request")), key("params")));
+  str_range_t response = d_to_json(d_get_at(d_get(test, key("response")), 0));
+
+  sb_t* req = sb_new("[");
+  sb_t* res = sb_new("[");
+  for (int i = 0; i < n; i++) {
+    if (i) sb_add_char(req, ',');
+    if (i) sb_add_char(res, ',');
+    sb_add_chars(req, "{\"method\":\"eth_call\",\"params\":");
+    sb_add_range(req, params.data, 0, params.len);
+    sb_add_char(req, '}');
+    size_t start = res->len;
+    sb_add_range(res, response.data, 0, response.len);
+    // the result starts with 0x00
+    if (i == wrong_result) strstr(strstr(res->data + start, "\"result\""), "0x")[2] = '1';
+  }
+  sb_add_char(req, ']');
+  sb_add_char(res, ']');
+  batch_response = res->data;
+
+  in3_t* c            = in3_for_chain(ETH_CHAIN_ID_MAINNET);
+  c->transport        = batch_transport;
+  c->max_attempts     = 1;
+  c->max_threads      = max_threads;
+  c->request_count    = 1;
+  c->auto_update_list = false;
+  c->proof            = PROOF_STANDARD;
+  for (int j = 0; j < c->chains_length; j++) c->chains[j].nodelist_upd8_params = NULL;
+
+  in3_ctx_t* ctx = ctx_new(c, req->data);
+  in3_ret_t  ret = in3_send_ctx(ctx);
+  TEST_ASSERT_EQUAL(n, ctx->len);
+  if (ret == IN3_OK) {
+    TEST_ASSERT_NULL(ctx->error);
+    for (int i = 0; i < n; i++)
+      TEST_ASSERT_NOT_NULL(d_get(ctx->responses[i], K_RESULT));
+  } else
+    TEST_ASSERT_NOT_NULL(ctx->error);
+
+  ctx_free(ctx);
+  in3_free(c);
+  sb_free(req);
+  sb_free(res);
+  json_free(json);
+  _free(buffer);
+  return ret;
+}
+
+static void test_eth_call_batch() {
+  TEST_ASSERT_EQUAL(IN3_OK, send_call_batch(3, 1, -1));
+}
+
+/** the evms of the batch run in parallel tasks (if build with THREADS) */
+static void test_eth_call_batch_parallel() {
+  TEST_ASSERT_EQUAL(IN3_OK, send_call_batch(8, 4, -1));
+}
+
+/** a wrong result must not be marked as verified by the batch, no matter which request it belongs to */
+static void test_eth_call_batch_wrong_result() {
+  for (int i = 0; i < 4; i++)
+    TEST_ASSERT_NOT_EQUAL(IN3_OK, send_call_batch(4, 4, i));
+}
+
+/** the same batch must also pass through the handler of the eth api, which is registered in the usual client setup */
+static void test_eth_call_batch_with_api() {
+  in3_register_eth_api();
+  test_eth_call_batch();
+}
+
+int main() {
+  in3_register_eth_full();
+  TESTS_BEGIN();
+  RUN_TEST(test_eth_call_batch);
+  RUN_TEST(test_eth_call_batch_with_api);
+  RUN_TEST(test_eth_call_batch_parallel);
+  RUN_TEST(test_eth_call_batch_wrong_result);
+  return TESTS_END();
+}
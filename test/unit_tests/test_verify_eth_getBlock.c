@@ -0,0 +1,313 @@
+/*******************************************************************************
+ * This file is part of the Incubed project.
+ * Sources: https://github.com/slockit/in3-c
+ * 
+ * Copyright (C) 2018-2019 slock.it GmbH, Blockchains LLC
+ * 
+ * 
+ * COMMERCIAL LICENSE USAGE
+ * 
+ * Licensees holding a valid commercial license may use this file in accordance 
+ * with the commercial license agreement provided with the Software or, alternatively, 
+ * in accordance with the terms contained in a written agreement between you and 
+ * slock.it GmbH/Blockchains LLC. For licensing terms and conditions or further 
+ * information please contact slock.it at in3@slock.it.
+ * 	
+ * Alternatively, this file may be used under the AGPL license as follows:
+ *    
+ * AGPL LICENSE USAGE
+ * 
+ * This program is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Affero General Public License as published by the Free Software 
+ * Foundation, either version 3 of the License, or (at your option) any later version.
+ *  
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY 
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A 
+ * PARTICULAR PURPOSE. See the GNU Affero General Public License for more details.
+ * [Permissions of this strong copyleft license are conditioned on making available 
+ * complete source code of licensed works and modifications, which include larger 
+ * works using a licensed work, under the same license. Copyright and license notices 
+ * must be preserved. Contributors provide an express grant of patent rights.]
+ * You should have received a copy of the GNU Affero General Public License along 
+ * with this program. If not, see <https://www.gnu.org/licenses/>.
+ *******************************************************************************/
+
+#ifndef TEST
+#define TEST
+#endif
+#ifndef TEST
+#define DEBUG
+#endif
+
+#include "../../src/core/client/client.h"
+#include "../../src/core/client/context.h"
+#include "../../src/core/client/keys.h"
+#include "../../src/core/util/data.h"
+#include "../../src/core/util/mem.h"
+#include "../../src/core/util/stringbuilder.h"
+#include "../../src/third-party/crypto/ecdsa.h"
+#include "../../src/third-party/crypto/secp256k1.h"
+#include "../../src/verifier/eth1/basic/eth_basic.h"
+#include "../../src/verifier/eth1/basic/trie.h"
+#include "../../src/verifier/eth1/nano/eth_nano.h"
+#include "../../src/verifier/eth1/nano/serialize.h"
+#include "../test_utils.h"
+#include <inttypes.h>
+#include <stdio.h>
+#include <string.h>
+
+/** the recorded block, with its transactions repeated to fill the block */
+typedef struct {
+  char*       json;
+  json_ctx_t* ctx;
+  d_token_t*  block;
+} replay_t;
+
+/** updates the indexes, raw values and hashes of the transactions, the transactionRoot and the blockhash after the transactions changed. */
+static void replay_update(replay_t* r) {
+  d_token_t* txs   = d_get(r->block, K_TRANSACTIONS);
+  int        n     = d_len(txs), i = 0;
+  trie_kv_t* items = _malloc(n * (sizeof(trie_kv_t) + sizeof(bytes_t*) + 5));
+  bytes_t**  raw   = (bytes_t**) (items + n);
+  uint8_t*   paths = (uint8_t*) (raw + n);
+  for (d_iterator_t it = d_iter(txs); it.left; d_iter_next(&it), i++) {
+    d_token_t* index = d_get(it.token, K_TRANSACTION_INDEX);
+    bytes_t*   prev  = d_get_bytesk(it.token, K_RAW);
+    TEST_ASSERT_EQUAL(T_INTEGER, d_type(index));
+    index->len     = (T_INTEGER << 28) | i;
+    raw[i]         = serialize_tx(it.token);
+    items[i].key   = create_tx_path_to(i, paths + i * 5);
+    items[i].value = *raw[i];
+    TEST_ASSERT_EQUAL(prev->len, raw[i]->len);
+    memcpy(prev->data, raw[i]->data, raw[i]->len);
+    sha3_to(raw[i], d_get_byteskl(it.token, K_HASH, 32)->data);
+  }
+
+  // the items are sorted while building the root, so we free the values through our own references.
+  trie_build_root(items, n, d_get_byteskl(r->block, K_TRANSACTIONS_ROOT, 32)->data);
+  for (i = 0; i < n; i++) b_free(raw[i]);
+  _free(items);
+
+  bytes_t* header = serialize_block_header(r->block);
+  sha3_to(header, d_get_byteskl(r->block, K_HASH, 32)->data);
+  b_free(header);
+  for (d_iterator_t it = d_iter(txs); it.left; d_iter_next(&it))
+    memcpy(d_get_byteskl(it.token, K_BLOCK_HASH, 32)->data, d_get_byteskl(r->block, K_HASH, 32)->data, 32);
+}
+
+/** the mainnet block 0x6a5c56 with its transactions repeated n times. indexes, transactionRoot and blockhash are updated to match. */
+static void replay_block(replay_t* r, int n) {
+  char*       recorded = read_testdata("eth_getBlockByNumber");
+  json_ctx_t* ctx      = parse_json(recorded);
+  d_token_t*  block    = d_get(d_get_at(d_get(d_get_at(ctx->result, 0), key("response")), 0), K_RESULT);
+  d_token_t*  txs      = d_get(block, K_TRANSACTIONS);
+  str_range_t b = d_to_json(block), t = d_to_json(txs);
+  sb_t*       sb = sb_new(NULL);
+  sb_add_range(sb, b.data, 0, t.data - b.data);
+  sb_add_char(sb, '[');
+  for (int i = 0; i < n; i++) {
+    str_range_t tx = d_to_json(d_get_at(txs, i % d_len(txs)));
+    if (i) sb_add_char(sb, ',');
+    sb_add_range(sb, tx.data, 0, tx.len);
+  }
+  sb_add_char(sb, ']');
+  sb_add_range(sb, t.data + t.len, 0, b.data + b.len - t.data - t.len);
+  json_free(ctx);
+  _free(recorded);
+
+  r->json  = sb->data;
+  r->ctx   = parse_json(r->json);
+  r->block = r->ctx->result;
+  _free(sb);
+  replay_update(r);
+}
+
+static void replay_free(replay_t* r) {
+  json_free(r->ctx);
+  _free(r->json);
+}
+
+/** verifies the block and checks the error message, if one is expected. */
+static in3_ret_t verify_block(replay_t* r, uint8_t threads, const char* error) {
+  char        req[]  = "{\"id\":1,\"jsonrpc\":\"2.0\",\"method\":\"eth_getBlockByNumber\",\"params\":[\"0x6a5c56\",true]}";
+  in3_t*      c      = in3_for_chain(ETH_CHAIN_ID_MAINNET);
+  in3_ctx_t*  ctx    = ctx_new(c, req);
+  json_ctx_t* proof  = parse_json("{}");
+  c->max_threads     = threads;
+  in3_vctx_t vc      = {.ctx = ctx, .chain = in3_find_chain(c, ETH_CHAIN_ID_MAINNET), .result = r->block, .request = ctx->requests[0], .proof = proof->result, .config = ctx->requests_configs};
+  in3_ret_t  res     = eth_verify_eth_getBlock(&vc, NULL, 0);
+#ifdef ERR_MSG
+  if (error) TEST_ASSERT_NOT_NULL_MESSAGE(ctx->error && strstr(ctx->error, error) ? ctx->error : NULL, ctx->error ? ctx->error : error);
+#else
+  (void) error;
+#endif
+  json_free(proof);
+  ctx_free(ctx);
+  in3_free(c);
+  return res;
+}
+
+static void test_replayed_block() {
+  replay_t r;
+  replay_block(&r, 50);
+  TEST_ASSERT_EQUAL(IN3_OK, verify_block(&r, 1, NULL));
+  TEST_ASSERT_EQUAL(IN3_OK, verify_block(&r, 4, NULL));
+
+  // a changed signature in the middle of the block must be detected, even if the hashes and roots are updated to match.
+  bytes_t* s = d_get_byteskl(d_get_at(d_get(r.block, K_TRANSACTIONS), 25), K_S, 32);
+  s->data[10] ^= 1;
+  replay_update(&r);
+  TEST_ASSERT_NOT_EQUAL(IN3_OK, verify_block(&r, 1, "invalid public Key"));
+  TEST_ASSERT_NOT_EQUAL(IN3_OK, verify_block(&r, 4, "invalid public Key"));
+  replay_free(&r);
+}
+
+static void test_replayed_block_speed() {
+  replay_t       r;
+  struct timeval begin, end;
+  double         single;
+  replay_block(&r, 300);
+  TIMING_START();
+  TEST_ASSERT_EQUAL(IN3_OK, verify_block(&r, 1, NULL));
+  TIMING_END();
+  single = TIMING_GET();
+  TIMING_START();
+  TEST_ASSERT_EQUAL(IN3_OK, verify_block(&r, 4, NULL));
+  TIMING_END();
+  TEST_LOG("block with 300 transactions: 1 thread %.2f ms, 4 threads %.2f ms\n", single * 1000, TIMING_GET() * 1000);
+  replay_free(&r);
+}
+
+static void test_block_linked_to_verified() {
+  replay_t r;
+  replay_block(&r, 5);
+  char                 req[]  = "{\"id\":1,\"jsonrpc\":\"2.0\",\"method\":\"eth_getBlockByNumber\",\"params\":[\"0x6a5c56\",true]}";
+  in3_t*               c      = in3_for_chain(ETH_CHAIN_ID_MAINNET);
+  in3_ctx_t*           ctx    = ctx_new(c, req);
+  json_ctx_t*          proof  = parse_json("{}");
+  in3_request_config_t config = {.signers_length = 1};
+  in3_vctx_t           vc     = {.ctx = ctx, .chain = in3_find_chain(c, ETH_CHAIN_ID_MAINNET), .result = r.block, .request = ctx->requests[0], .proof = proof->result, .config = &config};
+  bytes_t*             header = serialize_block_header(r.block);
+  bytes_t*             hash   = d_get_byteskl(r.block, K_HASH, 32);
+
+  // without signatures the header can not be verified
+  TEST_ASSERT_EQUAL(IN3_EUNKNOWN, eth_verify_blockheader(&vc, header, hash));
+
+  // but it is the parent of a verified block
+  vc.chain->verified_hashes                 = _calloc(c->max_verified_hashes, sizeof(in3_verified_hash_t));
+  vc.chain->verified_hashes[0].block_number = 0x6a5c57;
+  memcpy(vc.chain->verified_hashes[0].parent_hash, hash->data, 32);
+  TEST_ASSERT_EQUAL(IN3_OK, eth_verify_blockheader(&vc, header, hash));
+  TEST_ASSERT_EQUAL_UINT64(0x6a5c56, vc.chain->verified_hashes[1].block_number);
+  TEST_ASSERT_EQUAL_MEMORY(hash->data, vc.chain->verified_hashes[1].hash, 32);
+  TEST_ASSERT_EQUAL_MEMORY(d_get_byteskl(r.block, K_PARENT_HASH, 32)->data, vc.chain->verified_hashes[1].parent_hash, 32);
+
+  // a different parent is rejected
+  vc.chain->verified_hashes[1].block_number = 0;
+  vc.chain->verified_hashes[0].parent_hash[0] ^= 1;
+  TEST_ASSERT_EQUAL(IN3_EUNKNOWN, eth_verify_blockheader(&vc, header, hash));
+
+  b_free(header);
+  json_free(proof);
+  ctx_free(ctx);
+  in3_free(c);
+  replay_free(&r);
+}
+
+/** signs the blockhash like a node would and adds the signature to the json-array. */
+static void add_signature(sb_t* sb, in3_chain_t* chain, bytes_t* hash, uint64_t number, const uint8_t* pk) {
+  uint8_t msg[96], sig[64], recid = 0;
+  bytes_t data = bytes(msg, chain->version > 1 ? 96 : 64);
+  char    tmp[300], hex[65];
+  memcpy(msg, hash->data, 32);
+  memset(msg + 32, 0, 32);
+  long_to_bytes(number, msg + 56);
+  if (chain->version > 1) memcpy(msg + 64, chain->registry_id, 32);
+  sha3_to(&data, msg);
+  TEST_ASSERT_EQUAL(0, ecdsa_sign_digest(&secp256k1, pk, msg, sig, &recid, NULL));
+
+  bytes_to_hex(hash->data, 32, hex);
+  sprintf(tmp, "%s{\"block\":%" PRIu64 ",\"blockHash\":\"0x%s\"", sb->len > 1 ? "," : "", number, hex);
+  sb_add_chars(sb, tmp);
+  bytes_to_hex(sig, 32, hex);
+  sprintf(tmp, ",\"r\":\"0x%s\"", hex);
+  sb_add_chars(sb, tmp);
+  bytes_to_hex(sig + 32, 32, hex);
+  sprintf(tmp, ",\"s\":\"0x%s\",\"v\":%d}", hex, recid + 27);
+  sb_add_chars(sb, tmp);
+}
+
+static in3_ret_t verify_signatures(replay_t* r, in3_vctx_t* vc, char* signatures) {
+  sb_t* sb = sb_new("{\"signatures\":");
+  sb_add_chars(sb, signatures);
+  sb_add_char(sb, '}');
+  json_ctx_t* proof  = parse_json(sb->data);
+  bytes_t*    header = serialize_block_header(r->block);
+  vc->proof          = proof->result;
+  in3_ret_t res      = eth_verify_blockheader(vc, header, d_get_byteskl(r->block, K_HASH, 32));
+  b_free(header);
+  json_free(proof);
+  sb_free(sb);
+  return res;
+}
+
+static void test_block_signatures() {
+  replay_t r;
+  replay_block(&r, 5);
+  char                 req[] = "{\"id\":1,\"jsonrpc\":\"2.0\",\"method\":\"eth_getBlockByNumber\",\"params\":[\"0x6a5c56\",true]}";
+  in3_t*               c     = in3_for_chain(ETH_CHAIN_ID_MAINNET);
+  in3_ctx_t*           ctx   = ctx_new(c, req);
+  in3_chain_t*         chain = in3_find_chain(c, ETH_CHAIN_ID_MAINNET);
+  uint8_t              pk[3][32], pub[65], addr[3][20];
+  bytes_t              signers[2];
+  in3_request_config_t config = {.signers = signers, .signers_length = 2};
+  in3_vctx_t           vc     = {.ctx = ctx, .chain = chain, .result = r.block, .request = ctx->requests[0], .config = &config};
+  bytes_t*             hash   = d_get_byteskl(r.block, K_HASH, 32);
+  bytes_t              other  = bytes(pk[2], 32);
+
+  // two requested signers and one node we did not ask
+  for (int i = 0; i < 3; i++) {
+    memset(pk[i], i + 1, 32);
+    ecdsa_get_public_key65(&secp256k1, pk[i], pub);
+    bytes_t pub_bytes = bytes(pub + 1, 64);
+    sha3_to(&pub_bytes, pub);
+    memcpy(addr[i], pub + 12, 20);
+    if (i < 2) signers[i] = bytes(addr[i], 20);
+  }
+
+  sb_t* sb = sb_new("[");
+  add_signature(sb, chain, hash, 0x6a5c56, pk[0]);
+  add_signature(sb, chain, hash, 0x6a5c56, pk[2]);
+  sb_add_char(sb, ']');
+  TEST_ASSERT_EQUAL(IN3_EUNKNOWN, verify_signatures(&r, &vc, sb->data));
+
+  // a signature for a different block is ignored
+  sb->len = sb->len - 1;
+  add_signature(sb, chain, &other, 0x6a5c56, pk[1]);
+  sb_add_char(sb, ']');
+  TEST_ASSERT_EQUAL(IN3_EUNKNOWN, verify_signatures(&r, &vc, sb->data));
+
+  // all requested signers are recovered with one batch
+  sb->len = sb->len - 1;
+  add_signature(sb, chain, hash, 0x6a5c56, pk[1]);
+  sb_add_char(sb, ']');
+  TEST_ASSERT_EQUAL(IN3_OK, verify_signatures(&r, &vc, sb->data));
+  TEST_ASSERT_EQUAL_UINT64(0x6a5c56, chain->verified_hashes[0].block_number);
+
+  sb_free(sb);
+  ctx_free(ctx);
+  in3_free(c);
+  replay_free(&r);
+}
+
+/*
+ * Main
+ */
+int main() {
+  TESTS_BEGIN();
+  RUN_TEST(test_replayed_block);
+  RUN_TEST(test_replayed_block_speed);
+  RUN_TEST(test_block_linked_to_verified);
+  RUN_TEST(test_block_signatures);
+  return TESTS_END();
+}
@@ -36,8 +36,17 @@
 #define TEST
 #endif
 
+#include "../src/core/client/context.h"
+#include "../src/core/client/keys.h"
 #include "../src/core/util/bytes.h"
 #include "../src/core/util/data.h"
+#include "../src/core/util/mem.h"
+#include "../src/core/util/stringbuilder.h"
+#include "../src/verifier/eth1/basic/eth_basic.h"
+#include "../src/verifier/eth1/basic/trie.h"
+#include "../src/verifier/eth1/nano/eth_nano.h"
+#include "../src/verifier/eth1/nano/rlp.h"
+#include <inttypes.h>
 #include <stdio.h>
 #include <string.h>
 
@@ -150,6 +159,196 @@ static void test_verify_eth_getLog_filter_topics() {
   json_free(jreq);
 }
 
+#define LOG_BLOCKS 3
+static const int receipts_per_block[LOG_BLOCKS] = {2, 3, 2};
+
+typedef enum {
+  LOGS_VALID,
+  LOGS_WRONG_DATA,    /**< the data of the second log of a receipt is changed */
+  LOGS_WRONG_TX_HASH, /**< the txhash of the first receipt in the last block is changed in the proof */
+} logs_tamper_t;
+
+/** adds all nodes of the trie as proof, since the verifier picks the nodes it needs by their hash. */
+static void add_trie_proof(sb_t* sb, const char* prefix, trie_t* trie) {
+  sb_add_chars(sb, prefix);
+  for (trie_node_t* n = trie->nodes; n; n = n->next) sb_add_bytes(sb, n == trie->nodes ? "[" : ",", &n->data, 1, false);
+  sb_add_char(sb, ']');
+}
+
+static void add_item(bytes_builder_t* bb, uint8_t* data, uint32_t len) {
+  bytes_t b = bytes(data, len);
+  rlp_encode_item(bb, &b);
+}
+
+/** adds the content of the list builder as list and clears it. */
+static void add_list(bytes_builder_t* bb, bytes_builder_t* list) {
+  rlp_encode_list(bb, &list->b);
+  bb_clear(list);
+}
+
+/** the k-th receipt of all blocks has k % 3 + 1 logs. */
+static int logs_of_receipt(int k) {
+  return k % 3 + 1;
+}
+
+static void add_log(sb_t* result, uint64_t number, int index, int k, int l, uint8_t* tx_hash, uint8_t* block_hash, logs_tamper_t tamper) {
+  uint8_t address[20], topic[32];
+  char    tmp[200];
+  memset(address, 0x42, 20);
+  memset(topic, k * 4 + l, 32);
+  bytes_t a = bytes(address, 20), t = bytes(topic, 32), data = bytes(topic, 4 + l), th = bytes(tx_hash, 32), bh = bytes(block_hash, 32);
+  if (tamper == LOGS_WRONG_DATA && l == 1) data.len--;
+  sprintf(tmp, "%s{\"blockNumber\":\"0x%" PRIx64 "\",\"transactionIndex\":\"0x%x\",\"transactionLogIndex\":\"0x%x\",\"logIndex\":\"0x%x\",\"removed\":false",
+          result->len > 1 ? "," : "", number, index, l, l);
+  sb_add_chars(result, tmp);
+  sb_add_bytes(result, ",\"address\":", &a, 1, false);
+  sb_add_bytes(result, ",\"data\":", &data, 1, false);
+  sb_add_bytes(result, ",\"topics\":", &t, 1, true);
+  sb_add_bytes(result, ",\"transactionHash\":", &th, 1, false);
+  sb_add_bytes(result, ",\"blockHash\":", &bh, 1, false);
+  sb_add_char(result, '}');
+}
+
+/**
+ * creates the result and proof of a eth_getLogs request with LOG_BLOCKS blocks and 1 to 3 logs per receipt.
+ * All txhashes start with the same nibble, so all receipts collide in the txhash index of the verifier.
+ */
+static void create_logs(sb_t* result, sb_t* proof, logs_tamper_t tamper) {
+  uint8_t          zero[256], address[20], topic[32], tx_hashes[3][32], block_hash[32], path_data[5], nonce[4] = {0}, status = 1;
+  char             tmp[100];
+  bytes_builder_t *tx = bb_new(), *receipt = bb_new(), *logs = bb_new(), *log = bb_new(), *topics = bb_new(), *header = bb_new();
+  bytes_t          path;
+  memset(zero, 0, sizeof(zero));
+  memset(address, 0x42, 20);
+  sb_add_char(result, '[');
+  sb_add_chars(proof, "{\"type\":\"logProof\",\"logProof\":{");
+
+  for (int b = 0, k = 0; b < LOG_BLOCKS; b++) {
+    trie_t*  txs      = trie_new();
+    trie_t*  receipts = trie_new();
+    uint64_t number   = 0x100 + b;
+    int      first    = k;
+
+    for (int i = 0; i < receipts_per_block[b]; i++, k++) {
+      // a transaction with a txhash starting with 0x?0
+      do {
+        bb_clear(tx);
+        if (!++nonce[3]) nonce[2]++;
+        add_item(tx, nonce, 4);
+        add_item(tx, zero, 32); // long enough to not be embedded in the trie
+        rlp_encode_to_list(tx);
+        sha3_to(&tx->b, tx_hashes[i]);
+      } while (tx_hashes[i][0] & 0x0f);
+
+      for (int l = 0; l < logs_of_receipt(k); l++) {
+        memset(topic, k * 4 + l, 32);
+        add_item(topics, topic, 32);
+        add_item(log, address, 20);
+        add_list(log, topics);
+        add_item(log, topic, 4 + l);
+        add_list(logs, log);
+      }
+      add_item(receipt, &status, 1);
+      add_item(receipt, nonce, 4); // cumulative gas
+      add_item(receipt, zero, 256);
+      add_list(receipt, logs);
+      rlp_encode_to_list(receipt);
+
+      path = create_tx_path_to(i, path_data);
+      trie_set_value(txs, &path, &tx->b);
+      trie_set_value(receipts, &path, &receipt->b);
+      bb_clear(receipt);
+    }
+
+    // the header only needs the roots and the number
+    add_item(header, zero, 32); // parent hash
+    add_item(header, zero, 32); // sha3 uncles
+    add_item(header, zero, 20); // miner
+    add_item(header, zero, 32); // state root
+    add_item(header, txs->root, 32);
+    add_item(header, receipts->root, 32);
+    add_item(header, zero, 256); // logs bloom
+    add_item(header, nonce, 4);  // difficulty
+    bb_write_byte(header, 0x82);
+    bb_write_long_be(header, number, 2);
+    for (int i = 0; i < 3; i++) add_item(header, nonce, 4); // gas limit, gas used and timestamp
+    add_item(header, zero, 0);                              // extra data
+    add_item(header, zero, 32);                             // mix hash
+    add_item(header, zero, 8);                              // nonce
+    rlp_encode_to_list(header);
+    sha3_to(&header->b, block_hash);
+
+    sprintf(tmp, "%s\"0x%" PRIx64 "\":{\"number\":%i,\"block\":", b ? "," : "", number, (int) number);
+    sb_add_chars(proof, tmp);
+    sb_add_bytes(proof, NULL, &header->b, 1, false);
+    sb_add_chars(proof, ",\"receipts\":{");
+    for (int i = 0; i < receipts_per_block[b]; i++) {
+      for (int l = 0; l < logs_of_receipt(first + i); l++) add_log(result, number, i, first + i, l, tx_hashes[i], block_hash, tamper);
+      if (tamper == LOGS_WRONG_TX_HASH && b == LOG_BLOCKS - 1 && i == 0) tx_hashes[i][31] ^= 1;
+      bytes_t th = bytes(tx_hashes[i], 32);
+      sb_add_bytes(proof, i ? "," : NULL, &th, 1, false);
+      sb_add_bytes(proof, ":{\"txHash\":", &th, 1, false);
+      sprintf(tmp, ",\"txIndex\":%i", i);
+      sb_add_chars(proof, tmp);
+      add_trie_proof(proof, ",\"proof\":", receipts);
+      add_trie_proof(proof, ",\"txProof\":", txs);
+      sb_add_char(proof, '}');
+    }
+    sb_add_chars(proof, "}}");
+    bb_clear(header);
+    trie_free(txs);
+    trie_free(receipts);
+  }
+  sb_add_char(result, ']');
+  sb_add_chars(proof, "}}");
+  bb_free(tx);
+  bb_free(receipt);
+  bb_free(logs);
+  bb_free(log);
+  bb_free(topics);
+  bb_free(header);
+}
+
+/** verifies the created logs and checks the error message, if one is expected. */
+static in3_ret_t verify_logs(logs_tamper_t tamper, uint8_t threads, const char* error) {
+  sb_t        result = {0}, proof = {0};
+  in3_t*      c      = in3_for_chain(ETH_CHAIN_ID_MAINNET);
+  in3_ctx_t*  ctx    = ctx_new(c, "{\"id\":1,\"jsonrpc\":\"2.0\",\"method\":\"eth_getLogs\",\"params\":[{\"fromBlock\":\"0x100\",\"toBlock\":\"0x102\"}]}");
+  create_logs(sb_init(&result), sb_init(&proof), tamper);
+  json_ctx_t* jresult = parse_json(result.data);
+  json_ctx_t* jproof  = parse_json(proof.data);
+  TEST_ASSERT_NOT_NULL(jresult);
+  TEST_ASSERT_NOT_NULL(jproof);
+  c->max_threads = threads;
+  in3_vctx_t vc  = {.ctx = ctx, .chain = in3_find_chain(c, ETH_CHAIN_ID_MAINNET), .result = jresult->result, .request = ctx->requests[0], .proof = jproof->result, .config = ctx->requests_configs};
+  in3_ret_t  res = eth_verify_eth_getLog(&vc, d_len(jresult->result));
+#ifdef ERR_MSG
+  if (error) TEST_ASSERT_NOT_NULL_MESSAGE(ctx->error && strstr(ctx->error, error) ? ctx->error : NULL, ctx->error ? ctx->error : error);
+#else
+  (void) error;
+#endif
+  json_free(jresult);
+  json_free(jproof);
+  _free(result.data);
+  _free(proof.data);
+  ctx_free(ctx);
+  in3_free(c);
+  return res;
+}
+
+static void test_verify_eth_getLog_blocks() {
+  // 7 receipts with 13 logs in 3 blocks, which all share the first slot of the txhash index
+  TEST_ASSERT_EQUAL(IN3_OK, verify_logs(LOGS_VALID, 1, NULL));
+  TEST_ASSERT_EQUAL(IN3_OK, verify_logs(LOGS_VALID, 4, NULL));
+
+  // the second log of a receipt is checked against the already decoded logs of the receipt
+  TEST_ASSERT_NOT_EQUAL(IN3_OK, verify_logs(LOGS_WRONG_DATA, 1, "invalid data"));
+
+  // an invalid proof of the last block is reported, no matter which thread verified it
+  TEST_ASSERT_NOT_EQUAL(IN3_OK, verify_logs(LOGS_WRONG_TX_HASH, 1, "invalid tx hash"));
+  TEST_ASSERT_NOT_EQUAL(IN3_OK, verify_logs(LOGS_WRONG_TX_HASH, 4, "invalid tx hash"));
+}
+
 int main() {
   TESTS_BEGIN();
   RUN_TEST(test_verify_eth_getLog_filter_default);
@@ -157,5 +356,6 @@ int main() {
   RUN_TEST(test_verify_eth_getLog_filter_range);
   RUN_TEST(test_verify_eth_getLog_filter_blockhash);
   RUN_TEST(test_verify_eth_getLog_filter_topics);
+  RUN_TEST(test_verify_eth_getLog_blocks);
   return TESTS_END();
 }
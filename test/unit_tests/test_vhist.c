@@ -0,0 +1,167 @@
+/*******************************************************************************
+ * This file is part of the Incubed project.
+ * Sources: https://github.com/slockit/in3-c
+ * 
+ * Copyright (C) 2018-2019 slock.it GmbH, Blockchains LLC
+ * 
+ * 
+ * COMMERCIAL LICENSE USAGE
+ * 
+ * Licensees holding a valid commercial license may use this file in accordance 
+ * with the commercial license agreement provided with the Software or, alternatively, 
+ * in accordance with the terms contained in a written agreement between you and 
+ * slock.it GmbH/Blockchains LLC. For licensing terms and conditions or further 
+ * information please contact slock.it at in3@slock.it.
+ * 	
+ * Alternatively, this file may be used under the AGPL license as follows:
+ *    
+ * AGPL LICENSE USAGE
+ * 
+ * This program is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Affero General Public License as published by the Free Software 
+ * Foundation, either version 3 of the License, or (at your option) any later version.
+ *  
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY 
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A 
+ * PARTICULAR PURPOSE. See the GNU Affero General Public License for more details.
+ * [Permissions of this strong copyleft license are conditioned on making available 
+ * complete source code of licensed works and modifications, which include larger 
+ * works using a licensed work, under the same license. Copyright and license notices 
+ * must be preserved. Contributors provide an express grant of patent rights.]
+ * You should have received a copy of the GNU Affero General Public License along 
+ * with this program. If not, see <https://www.gnu.org/licenses/>.
+ *******************************************************************************/
+
+#ifndef TEST
+#define TEST
+#endif
+#ifndef TEST
+#define DEBUG
+#endif
+
+#include "../../src/core/util/data.h"
+#include "../../src/core/util/mem.h"
+#include "../../src/core/util/stringbuilder.h"
+#include "../test_utils.h"
+#include <stdio.h>
+#include <string.h>
+
+#ifdef POA
+#include "../../src/verifier/eth1/nano/vhist.h"
+#else
+// the validator history is only part of the library with POA, so we compile it here.
+#define POA
+#include "../../src/verifier/eth1/nano/vhist.c"
+#endif
+
+/** creates a spec with a transition every 100 blocks starting at block 100. Each transition has 5 validators out of a pool of 40 addresses. */
+static json_ctx_t* create_spec(int transitions, char** json) {
+  sb_t* sb = sb_new("[");
+  char  tmp[120];
+  for (int t = 0; t < transitions; t++) {
+    sprintf(tmp, "%s{\"block\":%d,\"engine\":\"%s\",\"list\":[", t ? "," : "", (t + 1) * 100, t % 2 ? "authorityRound" : "clique");
+    sb_add_chars(sb, tmp);
+    for (int v = 0; v < 5; v++) {
+      sprintf(tmp, "%s\"0x%040x\"", v ? "," : "", 0x1000 + (t + v) % 40);
+      sb_add_chars(sb, tmp);
+    }
+    sb_add_chars(sb, "]}");
+  }
+  sb_add_char(sb, ']');
+  *json = sb->data;
+  _free(sb);
+  return parse_json(*json);
+}
+
+/** checks the validators and the engine of the given transition. */
+static void check_transition(vhist_t* vh, uint64_t block, int t) {
+  bytes_t* v = vh_get_validators(vh, block);
+  TEST_ASSERT_NOT_NULL(v);
+  TEST_ASSERT_EQUAL(100, v->len);
+  for (int i = 0; i < 5; i++) TEST_ASSERT_EQUAL_HEX16(0x1000 + (t + i) % 40, bytes_to_int(v->data + i * 20 + 16, 4));
+  TEST_ASSERT_EQUAL(t % 2 ? ENGINE_AURA : ENGINE_CLIQUE, vh_get_engine_for_block(vh, block));
+
+  bytes_builder_t* bb = vh_get_validators_for_block(vh, block);
+  TEST_ASSERT_EQUAL(100, bb->b.len);
+  TEST_ASSERT_EQUAL_MEMORY(v->data, bb->b.data, 100);
+  bb_free(bb);
+}
+
+static void test_vhist_transitions() {
+  char*       json;
+  json_ctx_t* spec = create_spec(200, &json);
+  vhist_t*    vh   = vh_init_spec(spec->result);
+  TEST_ASSERT_EQUAL(200, vh->transitions_len);
+  TEST_ASSERT_EQUAL(40 * 20, vh->vldtrs->b.len);
+
+  // blocks before the first transition use the first one
+  check_transition(vh, 0, 0);
+  check_transition(vh, 99, 0);
+
+  // just before, at and after each transition, in a order which does not match the cached transition
+  for (int t = 1; t < 200; t++) {
+    check_transition(vh, (t + 1) * 100 - 1, t - 1);
+    check_transition(vh, (t + 1) * 100 + 1, t);
+    check_transition(vh, (t + 1) * 100, t);
+  }
+
+  // past the last one
+  check_transition(vh, 20100, 199);
+  check_transition(vh, UINT64_MAX, 199);
+
+  vh_free(vh);
+  json_free(spec);
+  _free(json);
+}
+
+static void test_vhist_duplicates() {
+  char*       json = "[{\"block\":0,\"engine\":\"authorityRound\",\"list\":[\"0x0000000000000000000000000000000000000001\",\"0x0000000000000000000000000000000000000002\",\"0x0000000000000000000000000000000000000001\"]},"
+               "{\"block\":10,\"engine\":\"authorityRound\",\"list\":[\"0x0000000000000000000000000000000000000002\",\"0x0000000000000000000000000000000000000003\"]},"
+               "{\"block\":5,\"engine\":\"clique\",\"list\":[\"0x0000000000000000000000000000000000000003\"]}]";
+  json_ctx_t* spec = parse_json(json);
+  vhist_t*    vh   = vh_init_spec(spec->result);
+
+  // each address is only stored once
+  TEST_ASSERT_EQUAL(3 * 20, vh->vldtrs->b.len);
+
+  // but duplicates within a transition are kept in order
+  bytes_t* v = vh_get_validators(vh, 4);
+  TEST_ASSERT_EQUAL(3 * 20, v->len);
+  TEST_ASSERT_EQUAL(1, v->data[19]);
+  TEST_ASSERT_EQUAL(2, v->data[39]);
+  TEST_ASSERT_EQUAL(1, v->data[59]);
+
+  // the transitions are sorted by block, although the spec is not
+  TEST_ASSERT_EQUAL(ENGINE_CLIQUE, vh_get_engine_for_block(vh, 5));
+  TEST_ASSERT_EQUAL(20, vh_get_validators(vh, 9)->len);
+  TEST_ASSERT_EQUAL(3, vh_get_validators(vh, 9)->data[19]);
+  TEST_ASSERT_EQUAL(ENGINE_AURA, vh_get_engine_for_block(vh, 10));
+  v = vh_get_validators(vh, 10);
+  TEST_ASSERT_EQUAL(2 * 20, v->len);
+  TEST_ASSERT_EQUAL(2, v->data[19]);
+  TEST_ASSERT_EQUAL(3, v->data[39]);
+
+  vh_free(vh);
+  json_free(spec);
+}
+
+static void test_vhist_empty() {
+  vhist_t* vh = vh_new();
+  TEST_ASSERT_NULL(vh_get_validators(vh, 0));
+  TEST_ASSERT_EQUAL(ENGINE_UNKNOWN, vh_get_engine_for_block(vh, 0));
+  bytes_builder_t* bb = vh_get_validators_for_block(vh, 0);
+  TEST_ASSERT_EQUAL(0, bb->b.len);
+  bb_free(bb);
+  vh_free(vh);
+}
+
+/*
+ * Main
+ */
+int main() {
+  TESTS_BEGIN();
+  RUN_TEST(test_vhist_transitions);
+  RUN_TEST(test_vhist_duplicates);
+  RUN_TEST(test_vhist_empty);
+  return TESTS_END();
+}
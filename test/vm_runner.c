@@ -42,6 +42,7 @@
 #include "../src/core/util/log.h"
 #include "../src/core/util/mem.h"
 #include "../src/verifier/eth1/evm/evm.h"
+#include "../src/verifier/eth1/evm/trace.h"
 #include <inttypes.h>
 #include <stdio.h>
 #include <stdlib.h>
@@ -126,7 +127,12 @@ int run_test(d_token_t* test, int counter, char* name, uint32_t props) {
     print_error("Unknown TestType!");
   }
 
+#ifdef EVM_TRACE
+  // a registered profiler keeps its allocations across tests.
+  if (mem_get_memleak_cnt() && !evm_get_tracer()) {
+#else
   if (mem_get_memleak_cnt()) {
+#endif
     in3_log_debug(" -- Memory Leak detected by malloc #%i!", mem_get_memleak_cnt());
     if (!fail) fail = 1;
   }
@@ -195,6 +201,9 @@ int main(int argc, char* argv[]) {
   char** names        = malloc(sizeof(char*));
   names[0]            = NULL;
   uint32_t props      = 0;
+#ifdef EVM_TRACE
+  evm_profile_t* profile = NULL;
+#endif
   char*    skip_tests = getenv("IN3_SKIPTESTS");
   if (skip_tests) {
     char* token = strtok(skip_tests, ",");
@@ -219,6 +228,10 @@ int main(int argc, char* argv[]) {
       in3_log_set_level(LOG_TRACE);
     else if (strcmp(argv[i], "-c") == 0)
       props |= EVM_PROP_CONSTANTINOPL;
+#ifdef EVM_TRACE
+    else if (strcmp(argv[i], "-p") == 0 && !profile)
+      evm_set_tracer(&(profile = evm_profile_new())->tracer);
+#endif
     else if (strlen(argv[i])) {
       //      if (strstr(argv[i], "exp") || strstr(argv[i], "loop-mulmod")) {
       //        printf("\nskipping %s\n", argv[i]);
@@ -235,6 +248,15 @@ int main(int argc, char* argv[]) {
   }
 
   int ret = runRequests(names, testIndex, membrk, props);
+#ifdef EVM_TRACE
+  if (profile) {
+    char* json = evm_profile_to_json(profile, 20);
+    printf("\n%s\n", json);
+    _free(json);
+    evm_set_tracer(NULL);
+    evm_profile_free(profile);
+  }
+#endif
   free(names);
   return ret;
 }
\ No newline at end of file